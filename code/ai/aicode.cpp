@@ -23,6 +23,7 @@
 #include "ai/aigoals.h"
 #include "ai/aiinternal.h"
 #include "ai/ailua.h"
+#include "ai/aitargetgrid.h"
 #include "asteroid/asteroid.h"
 #include "autopilot/autopilot.h"
 #include "cmeasure/cmeasure.h"
@@ -1044,6 +1045,8 @@ void ai_init()
 
 		atexit(free_ai_stuff);
 
+		ai_target_grid_init();
+
 		ai_inited = 1;
 	}
 
@@ -2359,6 +2362,50 @@ void evaluate_object_as_nearest_objnum(eval_nearest_objnum *eno)
 }
 
 
+static SCP_vector<int> Nearest_objnum_candidates;
+
+/**
+ * Evaluates only the ships the target grid finds within reach, in the same order as a full scan would.
+ * @return false if the grid is not in use, the caller then has to check every ship
+ */
+static bool evaluate_grid_ships_as_nearest_objnum(eval_nearest_objnum *eno)
+{
+	if (Ai_target_query == AiTargetQuery::SCAN)
+		return false;
+
+	// Even fighters, whose distance is halved, can't win from more than twice the range away.
+	// Big ships are measured to their bounding box, but the grid always returns those.
+	if (!ai_target_grid_query(&Objects[eno->objnum].pos, 2.0f * eno->range, false, eno->enemy_team_mask, Nearest_objnum_candidates))
+		return false;
+
+	eval_nearest_objnum scan_eno = *eno;
+
+	for (int candidate : Nearest_objnum_candidates) {
+		if (Objects[candidate].flags[Object::Object_Flags::Should_be_dead])
+			continue;
+
+		eno->trial_objp = &Objects[candidate];
+		evaluate_object_as_nearest_objnum(eno);
+	}
+
+	if (Ai_target_query == AiTargetQuery::VERIFY) {
+		for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+			if (Objects[so->objnum].flags[Object::Object_Flags::Should_be_dead])
+				continue;
+
+			scan_eno.trial_objp = &Objects[so->objnum];
+			evaluate_object_as_nearest_objnum(&scan_eno);
+		}
+
+		if (scan_eno.nearest_objnum != eno->nearest_objnum) {
+			mprintf(("AI target grid: %s picked %d instead of %d out of %d candidates (range %.1f)\n", Ships[Objects[eno->objnum].instance].ship_name,
+				eno->nearest_objnum, scan_eno.nearest_objnum, static_cast<int>(Nearest_objnum_candidates.size()), eno->range));
+		}
+	}
+
+	return true;
+}
+
 /**
  * Given an object and an enemy team, return the index of the nearest enemy object.
  * Unless aip->targeted_subsys != NULL, don't allow to attack objects with OF_PROTECTED bit set.
@@ -2391,12 +2438,14 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	eno.check_danger_weapon_objnum = 0;
 
 	// go through the list of all ships and evaluate as potential targets
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		if (Objects[so->objnum].flags[Object::Object_Flags::Should_be_dead])
-			continue;
+	if (!evaluate_grid_ships_as_nearest_objnum(&eno)) {
+		for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+			if (Objects[so->objnum].flags[Object::Object_Flags::Should_be_dead])
+				continue;
 
-		eno.trial_objp = &Objects[so->objnum];
-		evaluate_object_as_nearest_objnum(&eno);
+			eno.trial_objp = &Objects[so->objnum];
+			evaluate_object_as_nearest_objnum(&eno);
+		}
 	}
 
 	// check if danger_weapon_objnum has will show a stealth ship
@@ -0,0 +1,261 @@
+#include "ai/aitargetgrid.h"
+
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "globalincs/linklist.h"
+#include "iff_defs/iff_defs.h"
+#include "network/multi_obj.h"
+#include "object/object.h"
+#include "ship/ship.h"
+
+#include <algorithm>
+
+AiTargetQuery Ai_target_query = AiTargetQuery::SCAN;
+
+namespace {
+
+// Edge length of a grid cell.  Most queries are for a few kilometers, so this keeps them at a few hundred cells.
+constexpr float TARGET_GRID_CELL_SIZE = 2000.0f;
+
+// Cell coordinates are packed into 21 bits each
+constexpr int TARGET_GRID_CELL_LIMIT = (1 << 20) - 1;
+
+struct target_grid_entry {
+	vec3d pos;			// position at the time of the build
+	float radius;
+	int objnum;
+	int team_mask;		// iff_get_mask() of the ship's team
+	int list_index;		// position in Ship_obj_list
+	uint64_t cell_key;
+};
+
+// Grid_entries is sorted by cell, Grid_cells maps each occupied cell to its range of entries
+SCP_vector<target_grid_entry> Grid_entries;
+SCP_unordered_map<uint64_t, std::pair<size_t, size_t>> Grid_cells;
+
+// Ships which are returned by every query, see ai_target_grid_query()
+SCP_vector<target_grid_entry> Grid_always_entries;
+
+SCP_vector<const target_grid_entry*> Grid_candidates;
+
+// How far a ship may have moved away from its entry since the build
+float Grid_slack = 0.0f;
+bool Grid_valid = false;
+
+int target_grid_cell_coord(float value)
+{
+	float cell = floorf(value / TARGET_GRID_CELL_SIZE);
+	return static_cast<int>(std::max(-static_cast<float>(TARGET_GRID_CELL_LIMIT), std::min(cell, static_cast<float>(TARGET_GRID_CELL_LIMIT))));
+}
+
+uint64_t target_grid_cell_key(int x, int y, int z)
+{
+	constexpr uint64_t mask = (uint64_t(1) << 21) - 1;
+	return ((static_cast<uint64_t>(x) & mask) << 42) | ((static_cast<uint64_t>(y) & mask) << 21) | (static_cast<uint64_t>(z) & mask);
+}
+
+/**
+ * Whether the position of a ship at the start of the frame is a good enough guess for where it is later on
+ */
+bool target_grid_can_bucket(object* objp, const ship* shipp)
+{
+	// the AI measures the distance to these to their bounding box instead
+	if (Ship_info[shipp->ship_info_index].is_big_or_huge())
+		return false;
+
+	if (objp->radius > TARGET_GRID_CELL_SIZE * 0.5f)
+		return false;
+
+	// these can move much faster than their own physics would allow
+	if (objp->flags[Object::Object_Flags::Player_ship] || object_is_docked(objp) || multi_oo_is_interp_object(objp))
+		return false;
+
+	return !shipp->is_arriving() && !shipp->is_departing();
+}
+
+const char* ai_target_query_name(AiTargetQuery mode)
+{
+	switch (mode) {
+		case AiTargetQuery::SCAN:
+			return "scan";
+		case AiTargetQuery::GRID:
+			return "grid";
+		case AiTargetQuery::VERIFY:
+			return "verify";
+		default:
+			UNREACHABLE("Unhandled AI target query mode %d!", static_cast<int>(mode));
+			return "";
+	}
+}
+
+bool ai_target_query_parse(const char* name, AiTargetQuery* mode)
+{
+	for (auto candidate : {AiTargetQuery::SCAN, AiTargetQuery::GRID, AiTargetQuery::VERIFY}) {
+		if (!stricmp(name, ai_target_query_name(candidate))) {
+			*mode = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}
+
+DCF(ai_target_query, "Selects how the AI finds the ships within range of a ship or turret")
+{
+	SCP_string arg;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: ai_target_query [scan|grid|verify]\n");
+		dc_printf("\tscan    Evaluates every ship as a potential target\n");
+		dc_printf("\tgrid    Only evaluates the ships near enough according to a grid rebuilt every frame\n");
+		dc_printf("\tverify  Does both and logs any query on which they disagree\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("AI target query is '%s', the grid currently holds %d ships (%d in no cell)\n",
+			ai_target_query_name(Ai_target_query), static_cast<int>(Grid_entries.size() + Grid_always_entries.size()), static_cast<int>(Grid_always_entries.size()));
+		return;
+	}
+
+	dc_stuff_string_white(arg);
+	if (!ai_target_query_parse(arg.c_str(), &Ai_target_query)) {
+		dc_printf("Error: Unknown AI target query '%s'\n", arg.c_str());
+	}
+}
+
+void ai_target_grid_init()
+{
+	if (Cmdline_ai_target_query != nullptr && !ai_target_query_parse(Cmdline_ai_target_query, &Ai_target_query)) {
+		Warning(LOCATION, "Unknown AI target query '%s' given to -ai_target_query! Valid values are 'scan', 'grid' and 'verify'.", Cmdline_ai_target_query);
+	}
+}
+
+void ai_target_grid_build(float frametime)
+{
+	Grid_entries.clear();
+	Grid_cells.clear();
+	Grid_always_entries.clear();
+	Grid_valid = false;
+
+	if (Ai_target_query == AiTargetQuery::SCAN)
+		return;
+
+	float max_speed = 0.0f;
+	int list_index = 0;
+
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so), ++list_index) {
+		auto objp = &Objects[so->objnum];
+		if (objp->flags[Object::Object_Flags::Should_be_dead])
+			continue;
+
+		auto shipp = &Ships[objp->instance];
+
+		target_grid_entry entry;
+		entry.pos = objp->pos;
+		entry.radius = objp->radius;
+		entry.objnum = so->objnum;
+		entry.team_mask = iff_get_mask(shipp->team);
+		entry.list_index = list_index;
+
+		if (!target_grid_can_bucket(objp, shipp)) {
+			entry.cell_key = 0;
+			Grid_always_entries.push_back(entry);
+			continue;
+		}
+
+		entry.cell_key = target_grid_cell_key(target_grid_cell_coord(objp->pos.xyz.x), target_grid_cell_coord(objp->pos.xyz.y), target_grid_cell_coord(objp->pos.xyz.z));
+		Grid_entries.push_back(entry);
+
+		max_speed = std::max({max_speed, vm_vec_mag(&objp->phys_info.vel), vm_vec_mag(&objp->phys_info.max_vel), vm_vec_mag(&objp->phys_info.afterburner_max_vel)});
+	}
+
+	std::sort(Grid_entries.begin(), Grid_entries.end(), [](const target_grid_entry& a, const target_grid_entry& b) {
+		return a.cell_key < b.cell_key;
+	});
+
+	for (size_t begin = 0; begin < Grid_entries.size();) {
+		size_t end = begin + 1;
+		while (end < Grid_entries.size() && Grid_entries[end].cell_key == Grid_entries[begin].cell_key)
+			++end;
+
+		Grid_cells[Grid_entries[begin].cell_key] = std::make_pair(begin, end);
+		begin = end;
+	}
+
+	// Ships keep moving while the AI runs, so allow for twice the fastest of them plus a bit of rounding
+	Grid_slack = 2.0f * max_speed * frametime + 1.0f;
+	Grid_valid = true;
+}
+
+void ai_target_grid_invalidate()
+{
+	Grid_valid = false;
+}
+
+bool ai_target_grid_query(const vec3d* pos, float range, bool add_target_radius, int team_mask, SCP_vector<int>& objnums_out)
+{
+	objnums_out.clear();
+
+	if (!Grid_valid)
+		return false;
+
+	Grid_candidates.clear();
+
+	for (auto& entry : Grid_always_entries) {
+		if (entry.team_mask & team_mask)
+			Grid_candidates.push_back(&entry);
+	}
+
+	auto consider = [&](const target_grid_entry& entry) {
+		if (!(entry.team_mask & team_mask))
+			return;
+
+		float limit = range + Grid_slack + (add_target_radius ? entry.radius : 0.0f);
+		if (vm_vec_dist_squared(pos, &entry.pos) > limit * limit)
+			return;
+
+		Grid_candidates.push_back(&entry);
+	};
+
+	// bucketed ships are never larger than half a cell
+	float reach = range + Grid_slack + (add_target_radius ? TARGET_GRID_CELL_SIZE * 0.5f : 0.0f);
+
+	int min_cell[3], max_cell[3];
+	float num_cells = 1.0f;
+	for (int axis = 0; axis < 3; ++axis) {
+		min_cell[axis] = target_grid_cell_coord(pos->a1d[axis] - reach);
+		max_cell[axis] = target_grid_cell_coord(pos->a1d[axis] + reach);
+		num_cells *= static_cast<float>(max_cell[axis] - min_cell[axis] + 1);
+	}
+
+	if (num_cells > static_cast<float>(Grid_cells.size())) {
+		// cheaper to look at every bucketed ship than at every cell in range
+		for (auto& entry : Grid_entries)
+			consider(entry);
+	} else {
+		for (int x = min_cell[0]; x <= max_cell[0]; ++x) {
+			for (int y = min_cell[1]; y <= max_cell[1]; ++y) {
+				for (int z = min_cell[2]; z <= max_cell[2]; ++z) {
+					auto cell = Grid_cells.find(target_grid_cell_key(x, y, z));
+					if (cell == Grid_cells.end())
+						continue;
+
+					for (size_t i = cell->second.first; i < cell->second.second; ++i)
+						consider(Grid_entries[i]);
+				}
+			}
+		}
+	}
+
+	std::sort(Grid_candidates.begin(), Grid_candidates.end(), [](const target_grid_entry* a, const target_grid_entry* b) {
+		return a->list_index < b->list_index;
+	});
+
+	for (auto entry : Grid_candidates)
+		objnums_out.push_back(entry->objnum);
+
+	return true;
+}
@@ -0,0 +1,40 @@
+#ifndef _AI_TARGET_GRID_H
+#define _AI_TARGET_GRID_H
+
+#include "globalincs/pstypes.h"
+
+// How get_nearest_objnum() and get_nearest_turret_objnum() find the ships that are close enough to be picked
+enum class AiTargetQuery : uint8_t {
+	SCAN,	// evaluate every ship in Ship_obj_list
+	GRID,	// only evaluate the ships the per-frame target grid returns for the query range
+	VERIFY	// do both and log any query on which they pick a different target (debugging only)
+};
+
+extern AiTargetQuery Ai_target_query;
+
+void ai_target_grid_init();
+
+// Buckets all ships by position, team and Ship_obj_list order. Called once per frame before any AI runs.
+void ai_target_grid_build(float frametime);
+
+// Called once the ships have moved, queries fall back to a full scan until the next build
+void ai_target_grid_invalidate();
+
+/**
+ * @brief Finds the ships of the given teams which may be within range of a position
+ *
+ * @details The result is conservative: it contains every ship that has been within range at any point of the frame,
+ * plus all ships for which the distance to their center says little about how close they are (big and huge ships,
+ * docked, arriving or departing ships and players). The object numbers are returned in Ship_obj_list order, so
+ * evaluating them picks the same target a full scan of Ship_obj_list would.
+ *
+ * @param pos Position to search around
+ * @param range Largest distance between pos and the center of a ship
+ * @param add_target_radius If true, range is measured to the surface of each ship instead of its center
+ * @param team_mask Only return ships whose team matches this mask
+ * @param objnums_out The found objects
+ * @return false if there is no grid right now, the caller then has to check every ship itself
+ */
+bool ai_target_grid_query(const vec3d* pos, float range, bool add_target_radius, int team_mask, SCP_vector<int>& objnums_out);
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "ai/aibig.h"
 #include "ai/aiinternal.h"
+#include "ai/aitargetgrid.h"
 #include "asteroid/asteroid.h"
 #include "debugconsole/console.h"
 #include "freespace.h"
@@ -757,6 +758,48 @@ void evaluate_obj_as_target(object *objp, eval_enemy_obj_struct *eeo)
 	} // end asteroid selection
 }
 
+static SCP_vector<int> Turret_target_candidates;
+
+/**
+ * Evaluates only the ships the target grid finds within weapon range of the turret, in the same order as a full scan.
+ * @return false if the grid is not in use, the caller then has to check every ship
+ */
+static bool evaluate_grid_ships_as_target(eval_enemy_obj_struct *eeo)
+{
+	if (Ai_target_query == AiTargetQuery::SCAN)
+		return false;
+
+	// ships are only considered as attackers while their surface is within weapon range
+	if (!ai_target_grid_query(eeo->tpos, eeo->weapon_travel_dist, true, eeo->enemy_team_mask, Turret_target_candidates))
+		return false;
+
+	eval_enemy_obj_struct scan_eeo = *eeo;
+
+	for (int candidate : Turret_target_candidates) {
+		auto objp = &Objects[candidate];
+		if (objp->flags[Object::Object_Flags::Should_be_dead])
+			continue;
+		evaluate_obj_as_target(objp, eeo);
+	}
+
+	// the stealth check rolls the dice, so a mismatch here can also just be bad luck
+	if (Ai_target_query == AiTargetQuery::VERIFY) {
+		for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+			auto objp = &Objects[so->objnum];
+			if (objp->flags[Object::Object_Flags::Should_be_dead])
+				continue;
+			evaluate_obj_as_target(objp, &scan_eeo);
+		}
+
+		if (scan_eeo.nearest_attacker_objnum != eeo->nearest_attacker_objnum) {
+			mprintf(("AI target grid: turret on %s picked %d instead of %d out of %d candidates (range %.1f)\n", Ships[Objects[eeo->turret_parent_objnum].instance].ship_name,
+				eeo->nearest_attacker_objnum, scan_eeo.nearest_attacker_objnum, static_cast<int>(Turret_target_candidates.size()), eeo->weapon_travel_dist));
+		}
+	}
+
+	return true;
+}
+
 /**
  * Given an object and an enemy team, return the index of the nearest enemy object.
  *
@@ -1007,11 +1050,13 @@ int get_nearest_turret_objnum(int turret_parent_objnum, const ship_subsys *turre
 				case 1:
 					//Return if a ship is found
 					// Ship_used_list
-					for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-						auto objp = &Objects[so->objnum];
-						if (objp->flags[Object::Object_Flags::Should_be_dead])
-							continue;
-						evaluate_obj_as_target(objp, &eeo);
+					if (!evaluate_grid_ships_as_target(&eeo)) {
+						for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
+							auto objp = &Objects[so->objnum];
+							if (objp->flags[Object::Object_Flags::Should_be_dead])
+								continue;
+							evaluate_obj_as_target(objp, &eeo);
+						}
 					}
 
 					// next highest priority is attacking ship
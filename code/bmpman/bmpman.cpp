@@ -32,6 +32,7 @@
 #include "tgautils/tgautils.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "ktxutils/ktxutils.h"
 
 #include <cctype>
@@ -115,6 +116,64 @@ static bool bm_is_anim(bitmap_entry* entry)
 		(entry->type == BM_TYPE_PNG && entry->info.ani.apng.is_apng));
 }
 
+/**
+ * Key of the file name index, which lets bm_load_sub_fast() find an already loaded bitmap without comparing against
+ * every slot. The name is lower case and without extension, matching what strextcmp() considers equal.
+ */
+struct bm_name_key {
+	SCP_string name;
+	int dir_type;
+	bool animated;
+
+	bool operator==(const bm_name_key& other) const {
+		return dir_type == other.dir_type && animated == other.animated && name == other.name;
+	}
+};
+
+struct bm_name_key_hash {
+	size_t operator()(const bm_name_key& key) const {
+		return SCP_hash<SCP_string>()(key.name) ^ (static_cast<size_t>(key.dir_type) << 1) ^ static_cast<size_t>(key.animated);
+	}
+};
+
+// Handles of all used slots by name. There can be more than one if Bm_ignore_duplicates was set at some point.
+static SCP_unordered_map<bm_name_key, SCP_vector<int>, bm_name_key_hash> Bm_name_index;
+
+// Statistics of bm_load_sub_fast(), shown by the bmpman debug command
+static uint Bm_name_lookups = 0;
+static uint Bm_name_lookup_hits = 0;
+static uint Bm_name_lookup_candidates = 0;
+
+static bm_name_key bm_make_name_key(const char* filename, int dir_type, bool animated) {
+	auto ext = strrchr(filename, '.');
+	SCP_string name(filename, (ext != nullptr) ? static_cast<size_t>(ext - filename) : strlen(filename));
+	SCP_tolower(name);
+
+	return {std::move(name), dir_type, animated};
+}
+
+/**
+ * Adds a slot to the name index. Must be called once the file name, type and dir_type of the entry are set.
+ */
+static void bm_name_index_add(bitmap_entry* entry) {
+	Bm_name_index[bm_make_name_key(entry->filename, entry->dir_type, bm_is_anim(entry))].push_back(entry->handle);
+}
+
+/**
+ * Removes a slot from the name index. Must be called before the entry is cleared.
+ */
+static void bm_name_index_remove(bitmap_entry* entry) {
+	auto it = Bm_name_index.find(bm_make_name_key(entry->filename, entry->dir_type, bm_is_anim(entry)));
+	if (it == Bm_name_index.end())
+		return;
+
+	auto& handles = it->second;
+	handles.erase(std::remove(handles.begin(), handles.end(), entry->handle), handles.end());
+
+	if (handles.empty())
+		Bm_name_index.erase(it);
+}
+
 bitmap_slot* bm_get_slot(int handle, bool separate_ani_frames) {
 	Assertion(handle >= 0, "Invalid handle %d passed to bm_get_slot!", handle);
 
@@ -483,6 +542,9 @@ DCF(bmpman, "Shows/changes bitmap caching parameters and usage") {
 		} else {
 			dc_printf("\tNo RAM limit\n");
 		}
+
+		dc_printf("Name index: " SIZE_T_ARG " names, %u lookups, %u hits, %u slots compared\n", Bm_name_index.size(),
+			Bm_name_lookups, Bm_name_lookup_hits, Bm_name_lookup_candidates);
 		return;
 	}
 
@@ -538,6 +600,7 @@ void bm_close() {
 			}
 		}
 		bm_blocks.clear();
+		Bm_name_index.clear();
 		bm_inited = false;
 	}
 }
@@ -591,6 +654,8 @@ int bm_create(int bpp, int w, int h, void *data, int flags) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	bm_update_memory_used(n, (int)entry->mem_taken);
 
 	gr_bm_create(bm_get_slot(n));
@@ -644,6 +709,8 @@ int bm_create_3d(int bpp, int w, int h, int d, void* data) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	bm_update_memory_used(n, (int)entry->mem_taken);
 
 	gr_bm_create(bm_get_slot(n));
@@ -1339,6 +1406,8 @@ int bm_load(const char *real_filename, int dir_type) {
 
 	entry->load_count++;
 
+	bm_name_index_add(entry);
+
 	if (img_cfp != nullptr)
 		cfclose(img_cfp);
 
@@ -1853,6 +1922,8 @@ int bm_load_animation(const char *real_filename, int *nframes, int *fps, int *ke
 			entry->info.ani.apng.is_apng = false;
 		}
 
+		bm_name_index_add(entry);
+
 		if (first_entry->bm.w != entry->bm.w || first_entry->bm.h != entry->bm.h) {
 			// We found a frame with a different size than the first frame -> this can't be used as a texture array
 			is_array = false;
@@ -1938,32 +2009,32 @@ int bm_load_sub_fast(const char *real_filename, int *handle, int dir_type, bool
 	if (Bm_ignore_duplicates)
 		return 0;
 
-	for (auto& block : bm_blocks) {
-		for (auto& slot : block) {
-			auto& entry = slot.entry;
-			if (entry.type == BM_TYPE_NONE)
-				continue;
+	++Bm_name_lookups;
 
-			if (entry.dir_type != dir_type)
-				continue;
+	auto it = Bm_name_index.find(bm_make_name_key(real_filename, dir_type, animated_type));
+	if (it == Bm_name_index.end())
+		return 0;
 
-			bool animated = bm_is_anim(&entry);
+	// use the first matching slot, like a search through all slots would
+	bitmap_entry* found = nullptr;
+	for (auto candidate : it->second) {
+		++Bm_name_lookup_candidates;
 
-			if (animated_type && !animated)
-				continue;
-			else if (!animated_type && animated)
-				continue;
+		auto entry = bm_get_entry(candidate);
+		Assertion(entry->handle == candidate && entry->type != BM_TYPE_NONE, "Bitmap name index is out of date for handle %d!", candidate);
 
-			if (!strextcmp(real_filename, entry.filename)) {
-				entry.load_count++;
-				*handle = entry.handle;
-				return 1;
-			}
-		}
+		if (found == nullptr || candidate < found->handle)
+			found = entry;
 	}
 
-	// not found to be loaded already
-	return 0;
+	if (found == nullptr)
+		return 0;
+
+	++Bm_name_lookup_hits;
+
+	found->load_count++;
+	*handle = found->handle;
+	return 1;
 }
 
 int bm_load_sub_slow(const char *real_filename, const int num_ext, const char **ext_list, CFILE **img_cfp, int dir_type) {
@@ -2260,6 +2331,44 @@ void bm_lock_apng(int /*handle*/, bitmap_slot *bs, bitmap *bmp, int bpp, uint /*
 }
 
 
+/**
+ * Reads the pixel data of a DDS file into data, which has to hold size bytes
+ *
+ * Only touches its arguments, so this may be called from a worker thread.
+ */
+static int bm_read_dds_data(const char* filename, int dir_type, BM_TYPE comp_type, ubyte* data, size_t size, ubyte* bpp)
+{
+	int error = dds_read_bitmap(filename, data, bpp, dir_type);
+
+#if BYTE_ORDER == BIG_ENDIAN
+	// same as with TGA, we need to byte swap 16 & 32-bit, uncompressed, DDS images
+	if ((comp_type == BM_TYPE_DDS) || (comp_type == BM_TYPE_CUBEMAP_DDS)) {
+		size_t i = 0;
+
+		if (*bpp == 32) {
+			unsigned int *swap_tmp;
+
+			for (i = 0; i < size; i += 4) {
+				swap_tmp = (unsigned int *)(data + i);
+				*swap_tmp = INTEL_INT(*swap_tmp);
+			}
+		} else if (*bpp == 16) {
+			unsigned short *swap_tmp;
+
+			for (i = 0; i < size; i += 2) {
+				swap_tmp = (unsigned short *)(data + i);
+				*swap_tmp = INTEL_SHORT(*swap_tmp);
+			}
+		}
+	}
+#else
+	SCP_UNUSED(comp_type);
+	SCP_UNUSED(size);
+#endif
+
+	return error;
+}
+
 void bm_lock_dds(int handle, bitmap_slot *bs, bitmap *bmp, int /*bpp*/, uint /*flags*/) {
 	ubyte *data = NULL;
 	int error;
@@ -2285,30 +2394,7 @@ void bm_lock_dds(int handle, bitmap_slot *bs, bitmap *bmp, int /*bpp*/, uint /*f
 	// this will populate filename[] whether it's EFF or not
 	EFF_FILENAME_CHECK;
 
-	error = dds_read_bitmap(filename, data, &dds_bpp, be->dir_type);
-
-#if BYTE_ORDER == BIG_ENDIAN
-	// same as with TGA, we need to byte swap 16 & 32-bit, uncompressed, DDS images
-	if ((be->comp_type == BM_TYPE_DDS) || (be->comp_type == BM_TYPE_CUBEMAP_DDS)) {
-		size_t i = 0;
-
-		if (dds_bpp == 32) {
-			unsigned int *swap_tmp;
-
-			for (i = 0; i < be->mem_taken; i += 4) {
-				swap_tmp = (unsigned int *)(data + i);
-				*swap_tmp = INTEL_INT(*swap_tmp);
-			}
-		} else if (dds_bpp == 16) {
-			unsigned short *swap_tmp;
-
-			for (i = 0; i < be->mem_taken; i += 2) {
-				swap_tmp = (unsigned short *)(data + i);
-				*swap_tmp = INTEL_SHORT(*swap_tmp);
-			}
-		}
-	}
-#endif
+	error = bm_read_dds_data(filename, be->dir_type, be->comp_type, data, be->mem_taken, &dds_bpp);
 
 	bmp->bpp = dds_bpp;
 	bmp->data = (ptr_u)data;
@@ -2621,6 +2707,8 @@ int bm_make_render_target(int width, int height, int flags) {
 
 	entry->handle = n;
 
+	bm_name_index_add(entry);
+
 	if (entry->mem_taken) {
 		entry->bm.data = (ptr_u)bm_malloc(n, entry->mem_taken);
 	}
@@ -2679,6 +2767,119 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+// Largest amount of decoded image data bm_page_in_stop() keeps around ahead of the texture upload
+static const size_t PAGE_IN_STAGING_BUDGET = 256 * 1024 * 1024;
+
+/**
+ * A bitmap which bm_page_in_stop() decodes on a worker thread while the main thread uploads the ones before it
+ */
+struct bm_staged_image {
+	int handle = -1;
+	BM_TYPE type = BM_TYPE_NONE;
+	BM_TYPE comp_type = BM_TYPE_NONE;
+	int dir_type = CF_TYPE_ANY;
+	char filename[MAX_FILENAME_LEN];
+	size_t size = 0;
+
+	// Filled in by bm_decode_staged()
+	ubyte* data = nullptr;
+	int bpp = 0;
+
+	threading::JobCounter done;
+};
+
+/**
+ * Whether the data of a bitmap can be read without the main thread
+ *
+ * That is only the case for the types which decode to the same data regardless of the lock flags and whose readers
+ * neither use the bm_set_components() format nor any global decoder state. Animations are left out since uploading
+ * one frame may lock all the others.
+ */
+static bool bm_can_stage(bitmap_entry* entry)
+{
+	if (Is_standalone || bm_is_anim(entry))
+		return false;
+
+	switch (entry->type) {
+	case BM_TYPE_DDS:
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+	case BM_TYPE_BC7:
+	case BM_TYPE_CUBEMAP_DDS:
+	case BM_TYPE_CUBEMAP_DXT1:
+	case BM_TYPE_CUBEMAP_DXT3:
+	case BM_TYPE_CUBEMAP_DXT5:
+		return entry->mem_taken > 0;
+
+	case BM_TYPE_PNG:
+		return entry->bm.w * entry->bm.h > 0;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Reads the data of a staged bitmap into its own buffer, runs on a worker thread
+ *
+ * This does the same as bm_lock_dds() and bm_lock_png() except for touching the bitmap slot. On failure the buffer is
+ * freed again and bm_lock() later runs into (and reports) the same error on the main thread.
+ */
+static void bm_decode_staged(bm_staged_image* img)
+{
+	TRACE_SCOPE(tracing::PageInDecode);
+
+	img->data = static_cast<ubyte*>(vm_malloc(img->size));
+	if (img->data == nullptr)
+		return;
+
+	memset(img->data, 0, img->size);
+
+	bool success;
+	if (img->type == BM_TYPE_PNG) {
+		img->bpp = 32;
+		success = png_read_bitmap(img->filename, img->data, &img->bpp, img->bpp >> 3, img->dir_type) == PNG_ERROR_NONE;
+	} else {
+		ubyte dds_bpp = 0;
+		success = bm_read_dds_data(img->filename, img->dir_type, img->comp_type, img->data, img->size, &dds_bpp) == DDS_ERROR_NONE;
+		img->bpp = dds_bpp;
+	}
+
+	if (!success) {
+		vm_free(img->data);
+		img->data = nullptr;
+	}
+}
+
+/**
+ * Hands the data of a decoded bitmap over to its slot, so the following bm_lock() does not read the file again
+ */
+static void bm_commit_staged(bm_staged_image* img)
+{
+	if (img->data == nullptr)
+		return;
+
+	auto bs = bm_get_slot(img->handle);
+	auto be = &bs->entry;
+	auto bmp = &be->bm;
+
+	bm_free_data(bs);
+
+	bmp->bpp = img->bpp;
+	bmp->data = reinterpret_cast<ptr_u>(img->data);
+	bmp->flags = 0;
+	bmp->palette = nullptr;
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size == 0);
+	be->data_size = img->size;
+	bm_texture_ram += img->size;
+#endif
+
+	img->data = nullptr;
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2693,6 +2894,45 @@ void bm_page_in_stop() {
 
 	int bm_preloading = 1;
 
+	// Reading and decoding the files is done by the worker threads ahead of the upload. Only as many bitmaps are
+	// decoded in advance as fit into PAGE_IN_STAGING_BUDGET, but always at least the next one.
+	SCP_vector<std::unique_ptr<bm_staged_image>> staged;
+	size_t next_decode = 0;
+	size_t next_commit = 0;
+	size_t staged_bytes = 0;
+
+	if (threading::is_threading()) {
+		for (auto& block : bm_blocks) {
+			for (auto& slot : block) {
+				auto& entry = slot.entry;
+
+				if ((entry.type != BM_TYPE_NONE) && (entry.type != BM_TYPE_RENDER_TARGET_DYNAMIC)
+					&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC) && entry.preloaded && bm_can_stage(&entry)) {
+					std::unique_ptr<bm_staged_image> img(new bm_staged_image());
+					img->handle = entry.handle;
+					img->type = entry.type;
+					img->comp_type = entry.comp_type;
+					img->dir_type = entry.dir_type;
+					strcpy_s(img->filename, entry.filename);
+					img->size = (entry.type == BM_TYPE_PNG) ? static_cast<size_t>(entry.bm.w * entry.bm.h * 4) : entry.mem_taken;
+
+					staged.push_back(std::move(img));
+				}
+			}
+		}
+	}
+
+	auto decode_ahead = [&]() {
+		while (next_decode < staged.size() && (staged_bytes == 0 || staged_bytes + staged[next_decode]->size <= PAGE_IN_STAGING_BUDGET)) {
+			auto img = staged[next_decode++].get();
+			staged_bytes += img->size;
+
+			threading::submit_job([img]() { bm_decode_staged(img); }, &img->done);
+		}
+	};
+
+	decode_ahead();
+
 	for (auto& block : bm_blocks) {
 		for (auto& slot : block) {
 			auto& entry = slot.entry;
@@ -2701,7 +2941,19 @@ void bm_page_in_stop() {
 				&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC)) {
 				if (entry.preloaded) {
 					TRACE_SCOPE(tracing::PageInSingleBitmap);
+					if (next_commit < staged.size() && staged[next_commit]->handle == entry.handle) {
+						auto img = staged[next_commit++].get();
+
+						decode_ahead();
+						threading::wait_for(img->done);
+						bm_commit_staged(img);
+
+						staged_bytes -= img->size;
+						decode_ahead();
+					}
+
 					if (bm_preloading) {
+						TRACE_SCOPE(tracing::PageInUpload);
 						if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
 							mprintf(("Out of VRAM.  Done preloading.\n"));
 							bm_preloading = 0;
@@ -2737,6 +2989,14 @@ void bm_page_in_stop() {
 		}
 	}
 
+	// only left over if a slot changed while paging in, don't leak what was decoded for it
+	for (auto& img : staged) {
+		threading::wait_for(img->done);
+		if (img->data != nullptr) {
+			vm_free(img->data);
+		}
+	}
+
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
 #ifndef NDEBUG
@@ -2969,6 +3229,8 @@ int bm_release(int handle, int clear_render_targets) {
 		for (i = 0; i < total; i++) {
 			auto entry = bm_get_entry(first + i);
 
+			bm_name_index_remove(entry);
+
 			memset(entry, 0, sizeof(bitmap_entry));
 
 			entry->type = BM_TYPE_NONE;
@@ -2994,6 +3256,7 @@ int bm_release(int handle, int clear_render_targets) {
 
 		bm_free_data(slot, true);		// clears flags, bbp, data, etc
 
+		bm_name_index_remove(entry);
 
 		memset(entry, 0, sizeof(bitmap_entry));
 
@@ -3057,7 +3320,10 @@ int bm_reload(int bitmap_handle, const char* filename) {
 		return -1;
 	}
 
+	bm_name_index_remove(entry);
 	strcpy_s(entry->filename, filename);
+	bm_name_index_add(entry);
+
 	return bitmap_handle;
 }
 
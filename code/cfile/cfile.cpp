@@ -35,6 +35,7 @@
 
 
 #include <limits>
+#include <mutex>
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -96,6 +97,9 @@ static SCP_vector<SCP_string> Cfile_stack;
 
 std::array<CFILE, MAX_CFILE_BLOCKS> Cfile_block_list;
 
+// Guards the type of the blocks in Cfile_block_list, files may be opened and closed from worker threads
+static std::mutex Cfile_block_mutex;
+
 static const char *Cfile_cdrom_dir = NULL;
 
 //
@@ -104,7 +108,7 @@ static const char *Cfile_cdrom_dir = NULL;
 static int cfget_cfile_block();
 static CFILE *cf_open_fill_cfblock(const char* source, int line, const char* original_filename, FILE * fp, int type);
 static CFILE *cf_open_packed_cfblock(const char* source, int line, const char* original_filename, FILE *fp, int type, size_t offset, size_t size);
-static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const char* original_filename, const void* data, size_t size, int dir_type);
+static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const char* original_filename, const void* data, size_t size, int dir_type, std::shared_ptr<const void> data_owner);
 
 static void cf_chksum_long_init();
 
@@ -760,7 +764,7 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 
 	// In-Memory files are a bit different from normal files so we need to handle them separately
 	if (res.data_ptr != nullptr) {
-		return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), res.data_ptr, res.size, dir_type);
+		return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), res.data_ptr, res.size, dir_type, res.data_owner);
 	}
 	else {
 		// "file_path" should already be a fully qualified path, so just try to open it
@@ -814,14 +818,18 @@ static int cfget_cfile_block()
 	int i;
 	CFILE* cfile;
 
-	for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
-		cfile = &Cfile_block_list[i];
-		if (cfile->type == CFILE_BLOCK_UNUSED) {
-			cfile->data = nullptr;
-			cfile->fp = nullptr;
-			cfile->type = CFILE_BLOCK_USED;
-			cf_clear_compression_info(cfile);
-			return i;
+	{
+		std::lock_guard<std::mutex> guard(Cfile_block_mutex);
+
+		for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
+			cfile = &Cfile_block_list[i];
+			if (cfile->type == CFILE_BLOCK_UNUSED) {
+				cfile->data = nullptr;
+				cfile->fp = nullptr;
+				cfile->type = CFILE_BLOCK_USED;
+				cf_clear_compression_info(cfile);
+				return i;
+			}
 		}
 	}
 
@@ -857,6 +865,9 @@ int cfclose( CFILE * cfile )
 		// VP  do nothing
 	}
 	cf_clear_compression_info(cfile);
+	cfile->data_owner.reset();
+
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
 	cfile->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
@@ -947,7 +958,7 @@ static CFILE *cf_open_packed_cfblock(const char* source, int line, const char* o
 
 }
 
-static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const char* original_filename, const void* data, size_t size, int dir_type)
+static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const char* original_filename, const void* data, size_t size, int dir_type, std::shared_ptr<const void> data_owner)
 {
 	int cfile_block_index;
 
@@ -968,6 +979,7 @@ static CFILE *cf_open_memory_fill_cfblock(const char* source, int line, const ch
 
 		cf_init_lowlevel_read_code(cfp, 0, size, 0 );
 		cfp->data = data;
+		cfp->data_owner = std::move(data_owner);
 
 		return cfp;
 	}
@@ -995,6 +1007,22 @@ const void *cf_returndata(CFILE *cfile)
 	return cfile->data;
 }
 
+const void *cf_get_data_view(CFILE *cfile, size_t *size_out)
+{
+	Assert(cfile != nullptr);
+
+	// compressed pack entries always go through a file pointer
+	if (cfile->data == nullptr) {
+		return nullptr;
+	}
+
+	if (size_out != nullptr) {
+		*size_out = cfile->size;
+	}
+
+	return cf_returndata(cfile);
+}
+
 // cutoff point where cfread() will throw an error when it hits this limit
 // if 'len' is 0 then this check will be disabled
 void cf_set_max_read_len( CFILE * cfile, size_t len )
@@ -1409,9 +1437,9 @@ static uint CRCTable[256];
 #define CF_CHKSUM_SAMPLE_SIZE				512
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size)
+ushort cf_add_chksum_short(ushort seed, const ubyte *buffer, int size)
 {
-	ubyte *ptr = buffer;
+	const ubyte *ptr = buffer;
 	uint sum1, sum2;
 
 	sum1 = sum2 = (int)(seed);
@@ -1427,10 +1455,10 @@ ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size)
 }
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-uint cf_add_chksum_long(uint seed, ubyte *buffer, size_t size)
+uint cf_add_chksum_long(uint seed, const ubyte *buffer, size_t size)
 {
 	uint crc;
-	ubyte *p;
+	const ubyte *p;
 
 	p = buffer;
 	crc = seed;	
@@ -1487,6 +1515,28 @@ static int cf_chksum_do(CFILE *cfile, ushort *chk_short, uint *chk_long, int max
 		max_size = cfilelength(cfile);
 	}
 	
+	// files that are already in memory can be checksummed in place, using the same chunks as below
+	size_t view_size;
+	auto view = static_cast<const ubyte*>(cf_get_data_view(cfile, &view_size));
+
+	if (view != nullptr) {
+		size_t pos = static_cast<size_t>(cftell(cfile));
+		size_t end = MIN(pos + static_cast<size_t>(max_size), view_size);
+
+		for (size_t chunk = pos; chunk < end; chunk += CF_CHKSUM_SAMPLE_SIZE) {
+			auto chunk_len = static_cast<int>(MIN(end - chunk, static_cast<size_t>(CF_CHKSUM_SAMPLE_SIZE)));
+
+			if (is_long) {
+				*chk_long = cf_add_chksum_long(*chk_long, view + chunk, chunk_len);
+			} else {
+				*chk_short = cf_add_chksum_short(*chk_short, view + chunk, chunk_len);
+			}
+		}
+
+		cfseek(cfile, static_cast<int>(end), CF_SEEK_SET);
+		return 1;
+	}
+
 	cf_total = 0;
 	do {
 		// determine how much we want to read
@@ -256,6 +256,11 @@ int cfeof(CFILE *cfile);
 // Return the data pointer associated with the CFILE structure (for memory mapped files)
 const void *cf_returndata(CFILE *cfile);
 
+// Returns a read-only pointer to the whole (uncompressed) content of the file if it is already in memory, which is the
+// case for built-in files and, with -vp_mmap, for files in pack files.  The pointer stays valid until the file is
+// closed.  Returns nullptr if the file has to be read with cfread().
+const void *cf_get_data_view(CFILE *cfile, size_t *size_out = nullptr);
+
 // get the 2 byte checksum of the passed filename - return 0 if operation failed, 1 if succeeded
 int cf_chksum_short(const char *filename, ushort *chksum, int max_size = -1, int cf_type = CF_TYPE_ANY );
 
@@ -275,10 +280,10 @@ int cf_chksum_pack(const char *filename, uint *chk_long, bool full = false);
 // convenient for misc checksumming purposes ------------------------------------------
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-ushort cf_add_chksum_short(ushort seed, ubyte *buffer, int size);
+ushort cf_add_chksum_short(ushort seed, const ubyte *buffer, int size);
 
 // update cur_chksum with the chksum of the new_data of size new_data_size
-uint cf_add_chksum_long(uint seed, ubyte *buffer, size_t size);
+uint cf_add_chksum_long(uint seed, const ubyte *buffer, size_t size);
 
 // convenient for misc checksumming purposes ------------------------------------------
 
@@ -375,6 +380,7 @@ struct CFileLocation {
 	size_t offset        = 0;
 	time_t m_time        = 0;
 	const void* data_ptr = nullptr;
+	std::shared_ptr<const void> data_owner; // keeps data_ptr valid if it points into a memory mapped pack file
 
 	explicit CFileLocation(bool found_in = false) : found(found_in) {}
 };
@@ -266,13 +266,6 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 	if(buf == NULL)
 		return 0;
 
-	// cfread() not supported for memory-mapped files
-	if(cfile->data != nullptr)
-	{
-		Warning(LOCATION, "Writing is not supported for mem-mapped files");
-		return 0;
-	}
-
 	size_t advance = 0;
 	int items_read;
 	if (cfile->fp) {
@@ -280,15 +273,18 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 		items_read = fscanf(cfile->fp, LUA_NUMBER_SCAN, buf);
 		advance = (size_t) (ftell(cfile->fp)-orig_pos);
 	} else {
-		int read;
+		// The data is not null terminated (and for pack files continues with the next file), so scan a terminated copy
+		// of the next few bytes.  That is plenty for any number that can be stored in a double.
+		char number[128];
+		size_t len = MIN(sizeof(number) - 1, cfile->size - cfile->raw_position);
+		memcpy(number, reinterpret_cast<const char*>(cfile->data) + cfile->raw_position, len);
+		number[len] = '\0';
+
+		int read = 0;
 		// %n returns the number of bytes currently read so we append that to the scan format at the end so it will return
 		// how many bytes we have consumed
-		items_read = sscanf(reinterpret_cast<const char*>(cfile->data), LUA_NUMBER_SCAN "%n", buf, &read);
-		if (items_read == 2) {
-			// We need to correct the items read counter since we read one additional item
-			items_read = 1;
-		}
-		advance = (size_t) read;
+		items_read = sscanf(number, LUA_NUMBER_SCAN "%n", buf, &read);
+		advance = (items_read == 1) ? (size_t) read : 0;
 	}
 	cfile->raw_position += advance;
 	Assertion(cfile->raw_position <= cfile->size, "Invalid raw_position value detected!");
@@ -16,6 +16,8 @@
 
 #include "globalincs/pstypes.h"
 
+#include <memory>
+
 // The following Cfile_block data is private to cfile.cpp
 // DO NOT MOVE the Cfile_block* information to cfile.h / do not extern this data
 //
@@ -38,6 +40,7 @@ struct CFILE {
 	int dir_type;        // directory location
 	FILE* fp;                // File pointer if opening an individual file
 	const void* data;            // Pointer for memory-mapped file access.  NULL if not mem-mapped.
+	std::shared_ptr<const void> data_owner; // Keeps a memory mapped pack file mapped while this file is open
 	size_t lib_offset;
 	size_t raw_position;
 	size_t size;                // for packed files
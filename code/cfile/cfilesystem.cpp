@@ -13,8 +13,12 @@
 #include <cstring>
 #include <cstdio>
 #include <cerrno>
+#include <memory>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 #ifdef _WIN32
 #include <io.h>
@@ -32,9 +36,12 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #endif
 
 #include "cfile/cfile.h"
+#include "cfile/cfilecompression.h"
 #include "cfile/cfilesystem.h"
 #include "cmdline/cmdline.h"
 #include "globalincs/pstypes.h"
@@ -63,7 +70,13 @@ typedef struct cf_root {
 	SCP_unordered_map<int, SCP_string> pathTypeToRealPath;
 #endif
 
-	cf_root() : roottype(-1), location_flags(0) {}
+	// With -vp_mmap, pack files are mapped into memory the first time a file in them is looked up.  Open files share
+	// ownership of the mapping so it is only unmapped once the root and every file read from it are gone.
+	bool		mapping_attempted;
+	std::shared_ptr<const ubyte>	mapped_data;
+	size_t		mapped_size;
+
+	cf_root() : roottype(-1), location_flags(0), mapping_attempted(false), mapped_size(0) {}
 } cf_root;
 
 // convenient type for sorting (see cf_build_pack_list())
@@ -116,6 +129,16 @@ typedef struct cf_file_block {
 static uint Num_files = 0;
 static SCP_vector<std::unique_ptr<cf_file_block>> File_blocks;
 
+// Lower case name_ext -> indices of all files with that name.  The indices are ascending, which is the same order
+// as the file list itself and therefore root precedence.  Built at the end of cf_build_file_list().
+static SCP_unordered_map<SCP_string, SCP_vector<uint>> File_name_index;
+
+// Statistics for the lookups in the file list, only gathered with -cfile_benchmark and logged when the list is freed.
+// Atomic since bmpman opens files from worker threads during page in.
+static std::atomic<uint> File_lookup_count{0};
+static std::atomic<uint> File_lookup_candidates{0};
+static std::atomic<std::chrono::steady_clock::rep> File_lookup_ticks{0};
+
 // Return a pointer to to file 'index'.
 cf_file *cf_get_file(int index)
 {
@@ -188,6 +211,122 @@ cf_root *cf_create_root()
 	return &Root_blocks[block]->roots[offset];
 }
 
+// Guards the lazy mapping of pack files, lookups may come from any thread
+static std::mutex Pack_mapping_mutex;
+
+// Maps a whole pack file read-only. On failure the root is just left unmapped and files are read through fopen().
+static void cf_map_pack_file(cf_root *root)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(root->path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		mprintf(("CFILE: Could not open '%s' for mapping (error %lu)\n", root->path.c_str(), GetLastError()));
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+		CloseHandle(file);
+		return;
+	}
+
+	// the view keeps the file open by itself
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (mapping == nullptr) {
+		mprintf(("CFILE: Could not map '%s' (error %lu)\n", root->path.c_str(), GetLastError()));
+		return;
+	}
+
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		mprintf(("CFILE: Could not map '%s' (error %lu)\n", root->path.c_str(), GetLastError()));
+		CloseHandle(mapping);
+		return;
+	}
+
+	root->mapped_data.reset(static_cast<const ubyte*>(view), [mapping](const ubyte *data) {
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+	});
+	root->mapped_size = static_cast<size_t>(size.QuadPart);
+#else
+	int fd = open(root->path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		mprintf(("CFILE: Could not open '%s' for mapping: %s\n", root->path.c_str(), strerror(errno)));
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0 || static_cast<unsigned long long>(st.st_size) > SIZE_MAX) {
+		close(fd);
+		return;
+	}
+
+	// the mapping keeps the file open by itself
+	auto size = static_cast<size_t>(st.st_size);
+	void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (view == MAP_FAILED) {
+		mprintf(("CFILE: Could not map '%s': %s\n", root->path.c_str(), strerror(errno)));
+		return;
+	}
+
+	root->mapped_data.reset(static_cast<const ubyte*>(view), [size](const ubyte *data) {
+		munmap(const_cast<ubyte*>(data), size);
+	});
+	root->mapped_size = size;
+#endif
+}
+
+/**
+ * @brief Returns where a file of a pack is in memory if its pack file is mapped (see -vp_mmap)
+ *
+ * Compressed files return nullptr since they need to go through the decompression code of a regular pack file CFILE.
+ */
+static std::shared_ptr<const void> cf_get_pack_file_data(cf_root *root, const cf_file *f)
+{
+	if (!Cmdline_vp_mmap || f->pack_offset < 1)
+		return nullptr;
+
+	std::shared_ptr<const ubyte> mapping;
+	{
+		std::lock_guard<std::mutex> guard(Pack_mapping_mutex);
+
+		if (!root->mapping_attempted) {
+			root->mapping_attempted = true;
+			cf_map_pack_file(root);
+		}
+
+		mapping = root->mapped_data;
+	}
+
+	if (mapping == nullptr)
+		return nullptr;
+
+	auto offset = static_cast<size_t>(f->pack_offset);
+	auto size = static_cast<size_t>(f->size);
+
+	// the pack file changed since the index was built
+	if (offset > root->mapped_size || size > root->mapped_size - offset)
+		return nullptr;
+
+	const ubyte *data = mapping.get() + offset;
+
+	if (size > 16) {
+		int header;
+		memcpy(&header, data, sizeof(header));
+
+		if (comp_check_header(INTEL_INT(header)) == COMP_HEADER_MATCH)
+			return nullptr;
+	}
+
+	// points at the file but keeps the whole mapping alive
+	return std::shared_ptr<const void>(mapping, data);
+}
+
 struct _file_list_t {
 	SCP_string name;
 	SCP_string sub_path;
@@ -1144,6 +1283,21 @@ void cf_search_memory_root(int root_index) {
 	mprintf(( "%i files\n", num_files ));
 }
 
+static void cf_build_file_index()
+{
+	File_name_index.clear();
+	File_name_index.reserve(Num_files);
+
+	SCP_string key;
+
+	for (uint ui = 0; ui < Num_files; ui++) {
+		key = cf_get_file(ui)->name_ext;
+		SCP_tolower(key);
+
+		File_name_index[key].push_back(ui);
+	}
+}
+
 void cf_build_file_list()
 {
 	int i;
@@ -1180,8 +1334,12 @@ void cf_build_file_list()
 	critical_shadowed.clear();
 	critical_shadowed.shrink_to_fit();
 #endif
+
+	cf_build_file_index();
 }
 
+static void cf_benchmark_file_lookups();
+
 
 void cf_build_secondary_filelist(const char *cdrom_dir)
 {
@@ -1197,11 +1355,25 @@ void cf_build_secondary_filelist(const char *cdrom_dir)
 	cf_build_file_list();
 
 	mprintf(( "Found %d roots and %d files.\n", Num_roots, Num_files ));
+
+	if (Cmdline_cfile_benchmark) {
+		cf_benchmark_file_lookups();
+	}
 }
 
 void cf_free_secondary_filelist()
 {
-	// Free the root blocks
+	if (File_lookup_count > 0) {
+		mprintf(("CFILE: %u file list lookups checked %u files in %.3f ms\n", File_lookup_count.load(), File_lookup_candidates.load(),
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(File_lookup_ticks.load())).count()));
+	}
+
+	File_name_index.clear();
+	File_lookup_count = 0;
+	File_lookup_candidates = 0;
+	File_lookup_ticks = 0;
+
+	// Free the root blocks, mapped pack files stay mapped until the last file opened from them is closed
 	Root_blocks.clear();
 	Num_roots = 0;
 
@@ -1238,6 +1410,136 @@ static bool sub_path_match(const SCP_string &search, const SCP_string &index)
 	return !stricmp(search.c_str(), index.c_str());
 }
 
+/**
+ * Finds the first file in the file list with the given name, following root precedence
+ *
+ * @param filename       Lower or mixed case filename & extension, without any directories
+ * @param sub_path       Subfolder the file has to be in, empty to allow any
+ * @param pathtype       See CF_TYPE_ defines in CFILE.H
+ * @param location_flags Specifies where to search for the specified flag
+ * @param use_index      Only check the files with that name instead of the whole list
+ *
+ * @return The index of the file or -1 if there is none
+ */
+static int cf_find_file_in_list(const SCP_string &filename, const SCP_string &sub_path, int pathtype, uint32_t location_flags, bool use_index)
+{
+	// every file that is opened goes through here, so don't even read the clock unless asked to
+	const bool gather_stats = Cmdline_cfile_benchmark;
+	const auto start = gather_stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+	uint candidates = 0;
+	int found = -1;
+
+	auto matches = [&](uint ui) {
+		cf_file *f = cf_get_file(ui);
+		candidates++;
+
+		// only search paths we're supposed to...
+		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
+			return false;
+
+		if (location_flags != CF_LOCATION_ALL) {
+			// If a location flag was specified we need to check if the root of this file satisfies the request
+			auto root = cf_get_root(f->root_index);
+
+			if (!cf_check_location_flags(root->location_flags, location_flags)) {
+				// Root does not satisfy location flags
+				return false;
+			}
+		}
+
+		if ( !sub_path_match(sub_path, f->sub_path) ) {
+			return false;
+		}
+
+		// file either not localized or localized version not found
+		return !stricmp(filename.c_str(), f->name_ext.c_str());
+	};
+
+	if (use_index) {
+		SCP_string key = filename;
+		SCP_tolower(key);
+
+		auto entry = File_name_index.find(key);
+
+		if (entry != File_name_index.end()) {
+			for (auto ui : entry->second) {
+				if (matches(ui)) {
+					found = static_cast<int>(ui);
+					break;
+				}
+			}
+		}
+	} else {
+		for (uint ui = 0; ui < Num_files; ui++) {
+			if (matches(ui)) {
+				found = static_cast<int>(ui);
+				break;
+			}
+		}
+	}
+
+	if (gather_stats) {
+		File_lookup_count++;
+		File_lookup_candidates += candidates;
+		File_lookup_ticks += (std::chrono::steady_clock::now() - start).count();
+	}
+
+	return found;
+}
+
+/**
+ * Looks up a sample of the indexed files (and some which don't exist) with and without the file index, checks
+ * that both agree and logs how long they took.  Enabled with -cfile_benchmark.
+ */
+static void cf_benchmark_file_lookups()
+{
+	const uint max_samples = 10000;
+	const uint step = MAX(Num_files / max_samples, 1u);
+	const SCP_string no_sub_path;
+
+	SCP_vector<std::pair<SCP_string, int>> samples;
+
+	for (uint ui = 0; ui < Num_files; ui += step) {
+		cf_file *f = cf_get_file(ui);
+
+		samples.emplace_back(f->name_ext, f->pathtype_index);
+		samples.emplace_back(f->name_ext, CF_TYPE_ANY);
+		samples.emplace_back("missing_" + f->name_ext, f->pathtype_index);
+	}
+
+	if (samples.empty()) {
+		return;
+	}
+
+	SCP_vector<int> linear_results, index_results;
+	std::chrono::steady_clock::duration times[2];
+
+	for (int use_index = 0; use_index < 2; use_index++) {
+		auto &results = use_index ? index_results : linear_results;
+		auto start = std::chrono::steady_clock::now();
+
+		for (auto &sample : samples) {
+			results.push_back(cf_find_file_in_list(sample.first, no_sub_path, sample.second, CF_LOCATION_ALL, use_index != 0));
+		}
+
+		times[use_index] = std::chrono::steady_clock::now() - start;
+	}
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < samples.size(); i++) {
+		if (linear_results[i] != index_results[i]) {
+			if (mismatches < 10) {
+				mprintf(("CFILE: Lookup of '%s' found file %d in the file list but %d in the index!\n", samples[i].first.c_str(), linear_results[i], index_results[i]));
+			}
+			mismatches++;
+		}
+	}
+
+	mprintf(("CFILE: " SIZE_T_ARG " lookups in %u files (%u names): %.3f ms scanning the list, %.3f ms using the index, " SIZE_T_ARG " mismatches\n",
+		samples.size(), Num_files, static_cast<uint>(File_name_index.size()),
+		std::chrono::duration<double, std::milli>(times[0]).count(), std::chrono::duration<double, std::milli>(times[1]).count(), mismatches));
+}
+
 static time_t get_mtime(int fd)
 {
 #ifdef _WIN32
@@ -1380,54 +1682,38 @@ CFileLocation cf_find_file_location(const char* filespec, int pathtype, uint32_t
 	}
 
 	// Search the pak files and CD-ROM.
-	for (ui = 0; ui < Num_files; ui++ )	{
-		cf_file *f = cf_get_file(ui);
-
-		// only search paths we're supposed to...
-		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
-			continue;
-
-		if (location_flags != CF_LOCATION_ALL) {
-			// If a location flag was specified we need to check if the root of this file satisfies the request
-			auto root = cf_get_root(f->root_index);
+	int file_index = cf_find_file_in_list(filename, sub_path, pathtype, location_flags, true);
+
+	if (file_index >= 0) {
+		cf_file *f = cf_get_file(file_index);
+		CFileLocation res(true);
+		res.size = static_cast<size_t>(f->size);
+		res.offset = (size_t)f->pack_offset;
+		res.data_ptr = f->data;
+		res.name_ext = f->name_ext;
+		res.m_time = f->write_time;
+
+		if (f->data != nullptr) {
+			// This is an in-memory file so we just copy the pathtype name + file name
+			res.full_name = Pathtypes[f->pathtype_index].path;
+			res.full_name += DIR_SEPARATOR_STR;
+			res.full_name += f->sub_path;
+			res.full_name += f->name_ext;
+		} else if (f->pack_offset < 1) {
+			// This is a real file, return the actual file path
+			res.full_name = f->real_name;
+		} else {
+			// File is in a pack file
+			cf_root *r = cf_get_root(f->root_index);
 
-			if (!cf_check_location_flags(root->location_flags, location_flags)) {
-				// Root does not satisfy location flags
-				continue;
-			}
-		}
+			res.full_name = r->path;
 
-		if ( !sub_path_match(sub_path, f->sub_path) ) {
-			continue;
+			// with -vp_mmap the file can be read straight from the mapping, like an in-memory file
+			res.data_owner = cf_get_pack_file_data(r, f);
+			res.data_ptr = res.data_owner.get();
 		}
 
-		// file either not localized or localized version not found
-		if ( !stricmp(filename.c_str(), f->name_ext.c_str()) ) {
-			CFileLocation res(true);
-			res.size = static_cast<size_t>(f->size);
-			res.offset = (size_t)f->pack_offset;
-			res.data_ptr = f->data;
-			res.name_ext = f->name_ext;
-			res.m_time = f->write_time;
-
-			if (f->data != nullptr) {
-				// This is an in-memory file so we just copy the pathtype name + file name
-				res.full_name = Pathtypes[f->pathtype_index].path;
-				res.full_name += DIR_SEPARATOR_STR;
-				res.full_name += f->sub_path;
-				res.full_name += f->name_ext;
-			} else if (f->pack_offset < 1) {
-				// This is a real file, return the actual file path
-				res.full_name = f->real_name;
-			} else {
-				// File is in a pack file
-				cf_root *r = cf_get_root(f->root_index);
-
-				res.full_name = r->path;
-			}
-
-			return res;
-		}
+		return res;
 	}
 		
 	return CFileLocation();
@@ -1569,9 +1855,39 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 
 	file_list_index.reserve( MIN(ext_num * 4, (int)Num_files) );
 
+	// If the base name has no period and all extensions are the same length and start with one, a base match can only
+	// be the base name plus one of the extensions, so the name index has all of them.  Otherwise check every file.
+	bool use_index = (filespec.find('.') == SCP_string::npos);
+
+	for (cur_ext = 0; use_index && (cur_ext < ext_num); cur_ext++) {
+		if ( (ext_list[cur_ext][0] != '.') || (filespec.length() + strlen(ext_list[cur_ext]) != filespec_len_big) )
+			use_index = false;
+	}
+
+	SCP_vector<uint> candidates;
+
+	if (use_index) {
+		SCP_string key;
+
+		for (cur_ext = 0; cur_ext < ext_num; cur_ext++) {
+			key = filespec + ext_list[cur_ext];
+			SCP_tolower(key);
+
+			auto entry = File_name_index.find(key);
+
+			if (entry != File_name_index.end()) {
+				candidates.insert(candidates.end(), entry->second.begin(), entry->second.end());
+			}
+		}
+
+		// back into file list order, which also drops the duplicates of extensions listed twice
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
 	// next, run though and pick out base matches
-	for (ui = 0; ui < Num_files; ui++) {
-		cf_file *f = cf_get_file(ui);
+	for (ui = 0; ui < (use_index ? static_cast<uint>(candidates.size()) : Num_files); ui++) {
+		cf_file *f = cf_get_file(use_index ? candidates[ui] : ui);
 
 		// ... only search paths that we're supposed to
 		if ( (num_search_dirs == 1) && (pathtype != f->pathtype_index) )
@@ -1649,6 +1965,10 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 					cf_root *r = cf_get_root(f->root_index);
 
 					res.full_name = r->path;
+
+					// with -vp_mmap the file can be read straight from the mapping, like an in-memory file
+					res.data_owner = cf_get_pack_file_data(r, f);
+					res.data_ptr = res.data_owner.get();
 				}
 
 				// found it, so cleanup and return
@@ -233,6 +233,7 @@ Flag exe_params[] =
 	{ "-set_cpu_affinity",	"Sets processor affinity to config value",	true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-set_cpu_affinity", },
 	{ "-nograb",			"Disables mouse grabbing",					true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nograb", },
 	{ "-noshadercache",		"Disables the shader cache",				true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noshadercache", },
+	{ "-nomodelcache",		"Disables the model cache",					true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nomodelcache", },
 	{ "-prefer_ipv4",		"Prefer IPv4 DNS lookups",					true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-prefer_ipv4", },
 	{ "-prefer_ipv6",		"Prefer IPv6 DNS lookups",					true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-prefer_ipv6", },
 	{ "-log_multi_packet",	"Log multi packet types ",					true,	0,									EASY_DEFAULT,					"Troubleshoot", "http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-log_multi_packet",},
@@ -271,6 +272,7 @@ Flag exe_params[] =
 	{ "-profile_frame_time","Profile frame time",						true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_frame_time", },
 	{ "-profile_write_file", "Write profiling information to file",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_write_file", },
 	{ "-json_profiling",	"Generate JSON profiling output",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-json_profiling", },
+	{ "-binary_profiling",	"Generate binary profiling output",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-binary_profiling", },
 	{ "-debug_window",		"Enable the debug window",					true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-debug_window", },
 	{ "-gr_debug",		"Output graphics debug information",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gr_debug", },
 	{ "-stdout_log",		"Output log file to stdout",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-stdout_log", },
@@ -428,12 +430,14 @@ cmdline_parm almission_arg("-almission", "Autoload multiplayer mission", AT_STRI
 cmdline_parm ingamejoin_arg("-ingame_join", NULL, AT_NONE);	// Cmdline_ingamejoin
 cmdline_parm mpnoreturn_arg("-mpnoreturn", NULL, AT_NONE);	// Cmdline_mpnoreturn  -- Removes 'Return to Flight Deck' in respawn dialog -C
 cmdline_parm objupd_arg("-cap_object_update", "Multiplayer object update cap (0-3)", AT_INT);
+cmdline_parm compress_objupd_arg("-compress_object_update", "Compress object updates sent to clients with lz4", AT_NONE);
 cmdline_parm gateway_ip_arg("-gateway_ip", "Set gateway IP address", AT_STRING);
 
 char *Cmdline_almission = nullptr;	//DTP for autoload multi mission.
 int Cmdline_ingamejoin = 1;
 int Cmdline_mpnoreturn = 0;
 int Cmdline_objupd = 3;		// client object updates on LAN by default
+bool Cmdline_compress_objupd = false;
 char *Cmdline_gateway_ip = nullptr;
 
 // Launcher related options
@@ -461,6 +465,7 @@ cmdline_parm no_geo_sdr_effects("-no_geo_effects", NULL, AT_NONE);
 cmdline_parm set_cpu_affinity("-set_cpu_affinity", NULL, AT_NONE);
 cmdline_parm nograb_arg("-nograb", NULL, AT_NONE);
 cmdline_parm noshadercache_arg("-noshadercache", NULL, AT_NONE);
+cmdline_parm nomodelcache_arg("-nomodelcache", nullptr, AT_NONE);
 cmdline_parm prefer_ipv4_arg("-prefer_ipv4", nullptr, AT_NONE);
 cmdline_parm prefer_ipv6_arg("-prefer_ipv6", nullptr, AT_NONE);
 cmdline_parm log_multi_packet_arg("-log_multi_packet", nullptr, AT_NONE);
@@ -485,6 +490,7 @@ bool Cmdline_no_geo_sdr_effects = false;
 bool Cmdline_set_cpu_affinity = false;
 bool Cmdline_nograb = false;
 bool Cmdline_noshadercache = false;
+bool Cmdline_nomodelcache = false;
 bool Cmdline_prefer_ipv4 = false;
 bool Cmdline_prefer_ipv6 = false;
 bool Cmdline_dump_packet_type = false;
@@ -523,6 +529,7 @@ cmdline_parm benchmark_mode_arg("-benchmark_mode", NULL, AT_NONE); //Cmdline_ben
 cmdline_parm pilot_arg("-pilot", nullptr, AT_STRING); //Cmdline_pilot
 cmdline_parm noninteractive_arg("-noninteractive", NULL, AT_NONE); //Cmdline_noninteractive
 cmdline_parm json_profiling("-json_profiling", NULL, AT_NONE); //Cmdline_json_profiling
+cmdline_parm binary_profiling("-binary_profiling", "Write trace events to tracing/trace.fstrace, see tools/trace_converter", AT_NONE); //Cmdline_binary_profiling
 cmdline_parm show_video_info("-show_video_info", NULL, AT_NONE); //Cmdline_show_video_info
 cmdline_parm frame_profile_arg("-profile_frame_time", NULL, AT_NONE); //Cmdline_frame_profile
 cmdline_parm debug_window_arg("-debug_window", NULL, AT_NONE);	// Cmdline_debug_window
@@ -535,6 +542,18 @@ cmdline_parm override_arg("-override_data", "Enable override directory", AT_NONE
 cmdline_parm imgui_debug_arg("-imgui_debug", nullptr, AT_NONE);
 cmdline_parm vulkan("-vulkan", nullptr, AT_NONE);
 cmdline_parm multithreading("-threads", nullptr, AT_INT);
+cmdline_parm collision_broadphase_arg("-collision_broadphase", "Collision broadphase: sort, sap or verify", AT_STRING); // Cmdline_collision_broadphase
+cmdline_parm object_move_arg("-object_move", "Object movement: serial, parallel or verify", AT_STRING); // Cmdline_object_move
+cmdline_parm cfile_benchmark_arg("-cfile_benchmark", "Time file lookups with and without the file index at startup", AT_NONE); // Cmdline_cfile_benchmark
+cmdline_parm vp_mmap_arg("-vp_mmap", "Memory-map VP files instead of reading them through file handles", AT_NONE); // Cmdline_vp_mmap
+cmdline_parm ai_target_query_arg("-ai_target_query", "AI target query: scan, grid or verify", AT_STRING); // Cmdline_ai_target_query
+cmdline_parm light_filter_arg("-light_filter", "Light filter: linear, clustered or verify", AT_STRING); // Cmdline_light_filter
+cmdline_parm sexp_event_eval_arg("-sexp_event_eval", "SEXP event evaluation: poll, dependencies or verify", AT_STRING); // Cmdline_sexp_event_eval
+cmdline_parm sexp_bytecode_arg("-sexp_bytecode", "Evaluate mission events through formulas compiled at mission load", AT_NONE); // Cmdline_sexp_bytecode
+cmdline_parm sexp_profile_arg("-sexp_profile", "Profile mission events and SEXP operators, written to sexp_profile.csv/json at mission end", AT_NONE); // Cmdline_sexp_profile
+cmdline_parm sim_benchmark_arg("-sim_benchmark", "Run the -start_mission mission for this many frames at a fixed timestep, then write sim_benchmark.csv/json and quit", AT_INT); // Cmdline_sim_benchmark
+cmdline_parm sim_benchmark_fps_arg("-sim_benchmark_fps", "Simulated frames per second of -sim_benchmark, 60 by default", AT_INT); // Cmdline_sim_benchmark_fps
+cmdline_parm sim_benchmark_autopilot_arg("-sim_benchmark_autopilot", "Let the AI fly the player ship during -sim_benchmark", AT_NONE); // Cmdline_sim_benchmark_autopilot
 
 char *Cmdline_start_mission = NULL;
 int Cmdline_dis_collisions = 0;
@@ -563,6 +582,7 @@ bool Cmdline_benchmark_mode = false;
 const char *Cmdline_pilot = nullptr;
 bool Cmdline_noninteractive = false;
 bool Cmdline_json_profiling = false;
+bool Cmdline_binary_profiling = false;
 bool Cmdline_frame_profile = false;
 bool Cmdline_show_video_info = false;
 bool Cmdline_debug_window = false;
@@ -574,6 +594,18 @@ bool Cmdline_override_data = false;
 bool Cmdline_show_imgui_debug = false;
 bool Cmdline_vulkan = false;
 int Cmdline_multithreading = 1;
+const char *Cmdline_collision_broadphase = nullptr;
+const char *Cmdline_object_move = nullptr;
+const char *Cmdline_ai_target_query = nullptr;
+bool Cmdline_cfile_benchmark = false;
+bool Cmdline_vp_mmap = false;
+const char *Cmdline_light_filter = nullptr;
+const char *Cmdline_sexp_event_eval = nullptr;
+bool Cmdline_sexp_bytecode = false;
+bool Cmdline_sexp_profile = false;
+int Cmdline_sim_benchmark = 0;
+int Cmdline_sim_benchmark_fps = 60;
+bool Cmdline_sim_benchmark_autopilot = false;
 
 // Other
 cmdline_parm get_flags_arg(GET_FLAGS_STRING, "Output the launcher flags file", AT_STRING);
@@ -1664,6 +1696,10 @@ bool SetCmdlineParams()
 		Cmdline_mpnoreturn = 1;
 	}
 
+	if (compress_objupd_arg.found()) {
+		Cmdline_compress_objupd = true;
+	}
+
 	// run with no sound
 	if ( nosound_arg.found() ) {
 		Cmdline_freespace_no_sound = 1;
@@ -2129,6 +2165,11 @@ bool SetCmdlineParams()
 		Cmdline_noshadercache = true;
 	}
 
+	if (nomodelcache_arg.found())
+	{
+		Cmdline_nomodelcache = true;
+	}
+
 	if (lang_arg.found()) 
 	{
 		Cmdline_lang = lang_arg.str();
@@ -2294,6 +2335,11 @@ bool SetCmdlineParams()
 		Cmdline_json_profiling = true;
 	}
 
+	if (binary_profiling.found())
+	{
+		Cmdline_binary_profiling = true;
+	}
+
 	if (frame_profile_arg.found() )
 	{
 		Cmdline_frame_profile = true;
@@ -2413,6 +2459,58 @@ bool SetCmdlineParams()
 		Cmdline_multithreading = abs(multithreading.get_int());
 	}
 
+	if (collision_broadphase_arg.found()) {
+		Cmdline_collision_broadphase = collision_broadphase_arg.str();
+	}
+
+	if (object_move_arg.found()) {
+		Cmdline_object_move = object_move_arg.str();
+	}
+
+	if (ai_target_query_arg.found()) {
+		Cmdline_ai_target_query = ai_target_query_arg.str();
+	}
+
+	if (cfile_benchmark_arg.found()) {
+		Cmdline_cfile_benchmark = true;
+	}
+
+	if (vp_mmap_arg.found()) {
+		Cmdline_vp_mmap = true;
+	}
+
+	if (light_filter_arg.found()) {
+		Cmdline_light_filter = light_filter_arg.str();
+	}
+
+	if (sexp_event_eval_arg.found()) {
+		Cmdline_sexp_event_eval = sexp_event_eval_arg.str();
+	}
+
+	if (sexp_bytecode_arg.found()) {
+		Cmdline_sexp_bytecode = true;
+	}
+
+	if (sexp_profile_arg.found()) {
+		Cmdline_sexp_profile = true;
+	}
+
+	if (sim_benchmark_arg.found()) {
+		Cmdline_sim_benchmark = MAX(sim_benchmark_arg.get_int(), 0);
+	}
+
+	if (sim_benchmark_fps_arg.found()) {
+		Cmdline_sim_benchmark_fps = sim_benchmark_fps_arg.get_int();
+		if (Cmdline_sim_benchmark_fps < 1 || Cmdline_sim_benchmark_fps > 1000) {
+			ReleaseWarning(LOCATION, "Simulation benchmark rate must be between 1 and 1000 frames per second, using 60!");
+			Cmdline_sim_benchmark_fps = 60;
+		}
+	}
+
+	if (sim_benchmark_autopilot_arg.found()) {
+		Cmdline_sim_benchmark_autopilot = true;
+	}
+
 	return true; 
 }
 
@@ -98,6 +98,7 @@ extern char *Cmdline_almission;	// DTP for autoload mission (for multi only)
 extern int Cmdline_ingamejoin;
 extern int Cmdline_mpnoreturn;
 extern int Cmdline_objupd;
+extern bool Cmdline_compress_objupd;
 extern char *Cmdline_gateway_ip;
 
 // Launcher related options
@@ -121,6 +122,7 @@ extern bool Cmdline_no_geo_sdr_effects;
 extern bool Cmdline_set_cpu_affinity;
 extern bool Cmdline_nograb;
 extern bool Cmdline_noshadercache;
+extern bool Cmdline_nomodelcache;
 extern bool Cmdline_prefer_ipv4;
 extern bool Cmdline_prefer_ipv6;
 extern bool Cmdline_dump_packet_type;
@@ -149,6 +151,7 @@ extern bool Cmdline_benchmark_mode;
 extern const char *Cmdline_pilot;
 extern bool Cmdline_noninteractive;
 extern bool Cmdline_json_profiling;
+extern bool Cmdline_binary_profiling;
 extern bool Cmdline_frame_profile;
 extern bool Cmdline_show_video_info;
 extern bool Cmdline_debug_window;
@@ -160,6 +163,18 @@ extern bool Cmdline_override_data;
 extern bool Cmdline_show_imgui_debug;
 extern bool Cmdline_vulkan;
 extern int Cmdline_multithreading;
+extern const char *Cmdline_collision_broadphase;
+extern const char *Cmdline_object_move;
+extern const char *Cmdline_ai_target_query;
+extern bool Cmdline_cfile_benchmark;
+extern bool Cmdline_vp_mmap;
+extern const char *Cmdline_light_filter;
+extern const char *Cmdline_sexp_event_eval;
+extern bool Cmdline_sexp_bytecode;
+extern bool Cmdline_sexp_profile;
+extern int Cmdline_sim_benchmark;
+extern int Cmdline_sim_benchmark_fps;
+extern bool Cmdline_sim_benchmark_autopilot;
 
 enum class WeaponSpewType { NONE = 0, STANDARD, ALL };
 extern WeaponSpewType Cmdline_spew_weapon_stats;
@@ -409,9 +409,6 @@ Done:
 	return retval;
 }
 
-static void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
-static uint32_t BLOCK_SIZE = 0;
-
 //reads pixel info from a dds file
 int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 {
@@ -473,6 +470,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		const int num_faces = (dds_header.dwCaps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
 		const bool has_depth = (dds_header.dwFlags & DDSD_DEPTH) == DDSD_DEPTH;
 
+		// local rather than static, bmpman reads DDS files on several threads at once
+		void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
+		uint32_t BLOCK_SIZE = 0;
+
 		switch (dds_header.ddspf.dwFourCC) {
 			case FOURCC_DX10:
 				decompress_dds = bcdec_bc7;
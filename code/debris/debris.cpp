@@ -914,9 +914,10 @@ void debris_hit(object *debris_obj, object * /*other_obj*/, vec3d *hitpos, float
 /**
  * See if poor debris object *obj got whacked by evil *other_obj at point *hitpos.
  * NOTE: debris_hit_info pointer NULL for debris:weapon collision, otherwise debris:ship collision.
+ * For debris:weapon collisions the collision info is stored in weapon_collision_info if given, otherwise it is attached to the weapon directly.
  * @return true if hit, else return false.
  */
-int debris_check_collision(object *pdebris, object *other_obj, vec3d *hitpos, collision_info_struct *debris_hit_info, vec3d* hitNormal)
+int debris_check_collision(object *pdebris, object *other_obj, vec3d *hitpos, collision_info_struct *debris_hit_info, vec3d* hitNormal, mc_info* weapon_collision_info)
 {
 	mc_info	mc;
 
@@ -956,9 +957,14 @@ int debris_check_collision(object *pdebris, object *other_obj, vec3d *hitpos, co
 			}
 		}
 
-		weapon *wp = &Weapons[other_obj->instance];
-		wp->collisionInfo = new mc_info;	// The weapon will free this memory later
-		*wp->collisionInfo = mc;
+		if (weapon_collision_info != nullptr) {
+			// the caller takes care of handing this to the weapon
+			*weapon_collision_info = mc;
+		} else {
+			weapon *wp = &Weapons[other_obj->instance];
+			wp->collisionInfo = new mc_info;	// The weapon will free this memory later
+			*wp->collisionInfo = mc;
+		}
 
 		return mc.num_hits;
 	}
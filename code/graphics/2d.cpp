@@ -1895,6 +1895,9 @@ bool gr_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps, int d_mode,
 		height = 480;
 		depth = 16;
 		center_aspect_ratio = -1.0f;
+	} else if (Cmdline_sim_benchmark > 0) {
+		// the simulation benchmark doesn't draw anything either
+		mode = GR_STUB;
 	}
 
 	gr_init_function_pointers(mode);
@@ -1997,8 +2000,8 @@ bool gr_init(std::unique_ptr<os::GraphicsOperations>&& graphicsOps, int d_mode,
 
 	bool missing_installation = false;
 	if (!running_unittests && Web_cursor == nullptr) {
-		if (Is_standalone) {
-			// Cursors don't work in standalone mode, just check if the animation exists.
+		if (gr_screen.mode == GR_STUB) {
+			// Cursors don't work with the stub renderer, just check if the animation exists.
 			auto handle = bm_load_animation("cursorweb");
 			if (handle < 0) {
 				missing_installation = true;
@@ -0,0 +1,38 @@
+#include "graphics/render_queue.h"
+
+void radix_sort_draws(SCP_vector<draw_sort_entry>& entries, SCP_vector<draw_sort_entry>& scratch)
+{
+	if (entries.size() < 2) {
+		return;
+	}
+
+	uint64_t any_set = 0;
+	uint64_t all_set = ~uint64_t(0);
+	for (auto& entry : entries) {
+		any_set |= entry.key;
+		all_set &= entry.key;
+	}
+	auto differing = any_set ^ all_set;
+
+	scratch.resize(entries.size());
+
+	for (int shift = 0; shift < 64; shift += 8) {
+		if (((differing >> shift) & 0xFF) == 0) {
+			continue;
+		}
+
+		size_t offsets[257] = {};
+		for (auto& entry : entries) {
+			++offsets[((entry.key >> shift) & 0xFF) + 1];
+		}
+		for (int i = 1; i < 257; ++i) {
+			offsets[i] += offsets[i - 1];
+		}
+
+		for (auto& entry : entries) {
+			scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+
+		entries.swap(scratch);
+	}
+}
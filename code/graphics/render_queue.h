@@ -27,18 +27,50 @@ public:
 	void submit_buffer_data();
 
 	void add_matrix(const matrix4 &mat);
+
+	// Appends all matrices of another buffer and returns the offset at which they start in this one
+	size_t append(const model_batch_buffer &other);
+};
+
+/**
+ * Places value in bits [shift, shift + bits) of a draw sort key. Values which need more bits are truncated, draws
+ * which only differ in the cut off bits then just end up less well grouped.
+ */
+inline uint64_t draw_sort_key_field(int value, int bits, int shift)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(value)) & ((uint64_t(1) << bits) - 1)) << shift;
+}
+
+struct draw_sort_entry {
+	uint64_t key;
+	int index;
 };
 
+/**
+ * @brief Stable LSD radix sort of draws by their key, 8 bits per pass
+ *
+ * Passes over bytes which are the same in every key are skipped, so the cost is linear in the number of draws.
+ *
+ * @param entries The draws to sort
+ * @param scratch Buffer of the same size, passed in so it can be reused between frames
+ */
+void radix_sort_draws(SCP_vector<draw_sort_entry>& entries, SCP_vector<draw_sort_entry>& scratch);
+
 template <typename Derived, typename DrawEntryT>
 class render_queue {
 protected:
 	SCP_vector<DrawEntryT> _elements;
 	SCP_vector<int> _keys;
+	SCP_vector<uint64_t> _sort_keys;	// one per element, see push_element()
+	SCP_vector<draw_sort_entry> _sort_entries;
+	SCP_vector<draw_sort_entry> _sort_scratch;
 	transform_stack _transforms;
 	scene_lights _lights;
 	graphics::util::UniformBuffer _dataBuffer;
 	vec3d _scale;
-	inline static model_batch_buffer _batchBuffer; // shared across instances so we don't need to do the malloc again
+	inline static model_batch_buffer _sharedBatchBuffer; // shared across instances so we don't need to do the malloc again
+	model_batch_buffer _ownBatchBuffer; // used instead by queues that are filled on worker threads
+	model_batch_buffer* _batchBuffer = &_sharedBatchBuffer;
 	bool _initialized = false;
 
 public:
@@ -53,12 +85,13 @@ public:
 	{
 		_elements.clear();
 		_keys.clear();
+		_sort_keys.clear();
 		_transforms.clear();
 		_scale.xyz.x = 1.0f;
 		_scale.xyz.y = 1.0f;
 		_scale.xyz.z = 1.0f;
 		_initialized = false;
-		_batchBuffer.reset();
+		_batchBuffer->reset();
 	}
 
 	void push_transform(const vec3d* pos, const matrix* orient)
@@ -66,6 +99,12 @@ public:
 		_transforms.push(pos, orient);
 	}
 
+	// Pushes a transform that has already been combined with the ones below it
+	void push_transform(const matrix4& transform)
+	{
+		_transforms.push_and_replace(transform);
+	}
+
 	void pop_transform()
 	{
 		_transforms.pop();
@@ -94,7 +133,7 @@ public:
 
 	void start_model_batch(int n_models)
 	{
-		_batchBuffer.set_num_models(n_models);
+		_batchBuffer->set_num_models(n_models);
 	}
 
 	void add_submodel_to_batch(int model_num)
@@ -107,7 +146,7 @@ public:
 
 		transform.a1d[15] = 0.0f;
 
-		_batchBuffer.set_model_transform(transform, model_num);
+		_batchBuffer->set_model_transform(transform, model_num);
 	}
 
 	void init_render(bool sort = true)
@@ -116,7 +155,7 @@ public:
 			self().sort_draws();
 		}
 
-		_batchBuffer.submit_buffer_data();
+		_batchBuffer->submit_buffer_data();
 
 		self().build_uniform_buffer();
 
@@ -136,17 +175,50 @@ public:
 		gr_alpha_mask_set(0, 1.0f);
 	}
 
-	void push_element(DrawEntryT&& entry)
+	/**
+	 * @brief Queues a draw
+	 *
+	 * @param entry The draw
+	 * @param sort_key sort_draws() orders the draws by this key, ascending. Draws with the same key keep the order in
+	 * which they were added.
+	 */
+	void push_element(DrawEntryT&& entry, uint64_t sort_key = 0)
 	{
 		_elements.push_back(std::move(entry));
 		_keys.push_back(static_cast<int>(_elements.size() - 1));
+		_sort_keys.push_back(sort_key);
 	}
 
 	void sort_draws()
 	{
-		const auto& d = self();
-		std::sort(_keys.begin(), _keys.end(),
-		          [&d](int a, int b) { return d.sort_draw_pair(a, b); });
+		_sort_entries.resize(_keys.size());
+		for (size_t i = 0; i < _keys.size(); ++i) {
+			_sort_entries[i].key = _sort_keys[_keys[i]];
+			_sort_entries[i].index = _keys[i];
+		}
+
+		radix_sort_draws(_sort_entries, _sort_scratch);
+
+		for (size_t i = 0; i < _keys.size(); ++i) {
+			_keys[i] = _sort_entries[i].index;
+		}
+	}
+
+	size_t num_draws() const
+	{
+		return _keys.size();
+	}
+
+	// The i-th draw in the order render_all() submits them
+	const DrawEntryT& get_draw(size_t i) const
+	{
+		return _elements[_keys[i]];
+	}
+
+	// The sort key of the i-th draw in the order render_all() submits them
+	uint64_t get_sort_key(size_t i) const
+	{
+		return _sort_keys[_keys[i]];
 	}
 
 private:
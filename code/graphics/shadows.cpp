@@ -913,7 +913,7 @@ void shadow_render_list::add_draw(const indexed_vertex_source* vert_src,
 
 	entry.model_matrix = model_matrix;
 	entry.scale = scale;
-	entry.transform_buffer_offset = _batchBuffer.get_buffer_offset();
+	entry.transform_buffer_offset = _batchBuffer->get_buffer_offset();
 
 	entry.flags = 0;
 	entry.vert_src = vert_src;
@@ -936,18 +936,6 @@ void shadow_render_list::add_draw(const indexed_vertex_source* vert_src,
 	push_element(std::move(entry));
 }
 
-bool shadow_render_list::sort_draw_pair(int a, int b) const
-{
-	auto* draw_call_a = &_elements[a];
-	auto* draw_call_b = &_elements[b];
-
-	if (draw_call_a->flags != draw_call_b->flags) {
-		return draw_call_a->flags < draw_call_b->flags;
-	}
-
-	return a < b;
-}
-
 void shadow_render_list::build_uniform_buffer()
 {
 	GR_DEBUG_SCOPE("Build shadow uniform buffer");
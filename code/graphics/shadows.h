@@ -106,8 +106,8 @@ public:
 private:
 	void build_uniform_buffer();
 	void render_buffer(const shadow_batch_entry& entry);
-	bool sort_draw_pair(int a, int b) const;
 
+	// shadow map draws are submitted in the order they were added
 	void sort_draws() {}
 
 	static void render_submodel_children(shadow_render_list* list,
@@ -40,6 +40,11 @@ static bool Timestamp_sudo_paused = false;
 
 static uint64_t Timestamp_microseconds_at_mission_start = 0;
 
+// With a fixed step, the timestamps don't follow the performance counter but a counter that moves on by exactly one
+// step every frame, however long the frame really took
+static uint64_t Timestamp_fixed_step = 0;
+static uint64_t Timestamp_fixed_counter = 0;
+
 
 static uint64_t timestamp_get_raw(bool start_frame = false);
 
@@ -53,6 +58,11 @@ static uint64_t get_performance_counter()
 	return counter - Timer_base_value;
 }
 
+static uint64_t get_timestamp_counter()
+{
+	return (Timestamp_fixed_step > 0) ? Timestamp_fixed_counter : get_performance_counter();
+}
+
 void timer_close()
 {
 	if ( Timer_inited )	{
@@ -80,6 +90,9 @@ void timer_init()
 
 void timer_start_frame()
 {
+	if (Timestamp_fixed_step > 0)
+		Timestamp_fixed_counter += Timestamp_fixed_step;
+
 	// take a snapshot of the raw timestamp at the beginning of the frame
 	timestamp_get_raw(true);
 }
@@ -149,7 +162,7 @@ static uint64_t timestamp_get_raw(bool start_frame)
 		if (Timestamp_is_paused)
 			timestamp_raw = Timestamp_paused_at_counter;
 		else
-			timestamp_raw = get_performance_counter();
+			timestamp_raw = get_timestamp_counter();
 
 		timestamp_raw -= Timestamp_offset_from_counter;
 	}
@@ -583,7 +596,7 @@ void timestamp_pause(bool sudo)
 		return;
 	Timestamp_is_paused = true;
 
-	Timestamp_paused_at_counter = get_performance_counter();
+	Timestamp_paused_at_counter = get_timestamp_counter();
 }
 
 void timestamp_unpause(bool sudo)
@@ -596,7 +609,7 @@ void timestamp_unpause(bool sudo)
 		return;
 	Timestamp_is_paused = false;
 
-	auto counter = get_performance_counter();
+	auto counter = get_timestamp_counter();
 
 	if (Timestamp_offset_from_counter == 0) {
 		Timestamp_offset_from_counter = counter;
@@ -611,6 +624,28 @@ bool timestamp_is_paused()
 	return Timestamp_is_paused;
 }
 
+void timestamp_set_fixed_step(int microseconds)
+{
+	Assertion(Timer_inited, "Timer should be initialized at this point!");
+	Assertion(microseconds >= 0, "A negative step doesn't make sense.");
+
+	auto counter = get_performance_counter();
+
+	if (microseconds > 0) {
+		// carry on from where the performance counter is
+		if (Timestamp_fixed_step == 0)
+			Timestamp_fixed_counter = counter;
+
+		Timestamp_fixed_step = static_cast<uint64_t>(microseconds / Timer_to_microseconds + 0.5L);
+	} else if (Timestamp_fixed_step > 0) {
+		// move the offsets so that the timestamps carry on from the fixed counter instead of jumping
+		Timestamp_offset_from_counter += counter - Timestamp_fixed_counter;
+		Timestamp_paused_at_counter += counter - Timestamp_fixed_counter;
+
+		Timestamp_fixed_step = 0;
+	}
+}
+
 void timestamp_adjust_pause_offset(int delta_milliseconds)
 {
 	Assertion(!Timestamp_is_paused, "This function is not needed if the game is actually paused.");
@@ -618,7 +653,7 @@ void timestamp_adjust_pause_offset(int delta_milliseconds)
 
 	// act like we were paused for a certain period of time, even though we weren't
 	if (Timestamp_offset_from_counter == 0) {
-		Timestamp_offset_from_counter = get_performance_counter();
+		Timestamp_offset_from_counter = get_timestamp_counter();
 	} else {
 		Timestamp_offset_from_counter += static_cast<uint64_t>(static_cast<uint64_t>(delta_milliseconds) * MICROSECONDS_PER_MILLISECOND / Timer_to_microseconds);
 	}
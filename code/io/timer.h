@@ -232,6 +232,10 @@ void timestamp_unpause(bool sudo);
 bool timestamp_is_paused();
 void timestamp_adjust_pause_offset(int delta_milliseconds);
 
+// Makes the timestamps move on by exactly this many microseconds per timer_start_frame(), no matter how much real
+// time passed, so that a run can be repeated exactly.  0 goes back to real time.
+void timestamp_set_fixed_step(int microseconds);
+
 enum class TIMER_DIRECTION { FORWARD, BACKWARD };
 // Alters the timestamp time forward or backward.  Use with caution!
 void timestamp_adjust_seconds(float delta_seconds, TIMER_DIRECTION dir);
@@ -0,0 +1,234 @@
+#include "lighting/light_clusters.h"
+
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "lighting/lighting.h"
+#include "math/vecmat.h"
+
+#include <algorithm>
+
+LightFilterMode Light_filter_mode = LightFilterMode::CLUSTERED;
+
+namespace {
+
+// Depth of the first slice, everything closer than this (including behind the view) ends up in slice 0
+constexpr float CLUSTER_NEAR = 10.0f;
+
+// Depth of the last slice, everything further away is clamped into it
+constexpr float CLUSTER_FAR = 40000.0f;
+
+const char* light_filter_mode_name(LightFilterMode mode)
+{
+	switch (mode) {
+		case LightFilterMode::LINEAR:
+			return "linear";
+		case LightFilterMode::CLUSTERED:
+			return "clustered";
+		case LightFilterMode::VERIFY:
+			return "verify";
+		default:
+			UNREACHABLE("Unhandled light filter mode %d!", static_cast<int>(mode));
+			return "";
+	}
+}
+
+bool light_filter_mode_parse(const char* name, LightFilterMode* mode)
+{
+	for (auto candidate : {LightFilterMode::LINEAR, LightFilterMode::CLUSTERED, LightFilterMode::VERIFY}) {
+		if (!stricmp(name, light_filter_mode_name(candidate))) {
+			*mode = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}
+
+DCF(light_filter, "Selects how the lights reaching a model are found")
+{
+	SCP_string arg;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: light_filter [linear|clustered|verify]\n");
+		dc_printf("\tlinear     Tests every light of the scene against each model\n");
+		dc_printf("\tclustered  Only tests the lights in the view space clusters around each model\n");
+		dc_printf("\tverify     Does both and logs any model for which they disagree\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("Light filter is '%s'\n", light_filter_mode_name(Light_filter_mode));
+		return;
+	}
+
+	dc_stuff_string_white(arg);
+	if (!light_filter_mode_parse(arg.c_str(), &Light_filter_mode)) {
+		dc_printf("Error: Unknown light filter '%s'\n", arg.c_str());
+	}
+}
+
+void light_cluster_init()
+{
+	if (Cmdline_light_filter != nullptr && !light_filter_mode_parse(Cmdline_light_filter, &Light_filter_mode)) {
+		Warning(LOCATION, "Unknown light filter '%s' given to -light_filter! Valid values are 'linear', 'clustered' and 'verify'.", Cmdline_light_filter);
+	}
+}
+
+int light_cluster_grid::cell_range::num_cells() const
+{
+	return (max[0] - min[0] + 1) * (max[1] - min[1] + 1) * (max[2] - min[2] + 1);
+}
+
+int light_cluster_grid::cell_index(int x, int y, int slice) const
+{
+	return (slice * TILES_Y + y) * TILES_X + x;
+}
+
+int light_cluster_grid::tile(float ratio, float tan_half, int num_tiles) const
+{
+	float t = floorf((ratio / tan_half + 1.0f) * 0.5f * static_cast<float>(num_tiles));
+
+	// written so that NaN ends up in the first tile
+	if (!(t >= 0.0f)) {
+		return 0;
+	}
+	if (t >= static_cast<float>(num_tiles)) {
+		return num_tiles - 1;
+	}
+	return static_cast<int>(t);
+}
+
+int light_cluster_grid::slice(float depth) const
+{
+	static const float slice_scale = static_cast<float>(SLICES - 1) / logf(CLUSTER_FAR / CLUSTER_NEAR);
+
+	if (!(depth >= CLUSTER_NEAR)) {
+		return 0;
+	}
+
+	float s = 1.0f + floorf(logf(depth / CLUSTER_NEAR) * slice_scale);
+	if (s >= static_cast<float>(SLICES)) {
+		return SLICES - 1;
+	}
+	return static_cast<int>(s);
+}
+
+light_cluster_grid::cell_range light_cluster_grid::cells_for_sphere(const vec3d& pos, float rad) const
+{
+	vec3d offset, view;
+	vm_vec_sub(&offset, &pos, &Eye_pos);
+	vm_vec_rotate(&view, &offset, &Eye_orient);
+
+	float z_min = view.xyz.z - rad;
+	float z_max = view.xyz.z + rad;
+
+	cell_range range;
+	range.min[2] = slice(z_min);
+	range.max[2] = slice(z_max);
+
+	if (!(z_min >= CLUSTER_NEAR)) {
+		// the sphere reaches the near slice, which holds everything close to or behind the view
+		range.min[0] = 0;
+		range.max[0] = TILES_X - 1;
+		range.min[1] = 0;
+		range.max[1] = TILES_Y - 1;
+		return range;
+	}
+
+	// x/z over the bounding box of the sphere is largest and smallest at its corners
+	range.min[0] = tile(std::min((view.xyz.x - rad) / z_min, (view.xyz.x - rad) / z_max), Tan_x, TILES_X);
+	range.max[0] = tile(std::max((view.xyz.x + rad) / z_min, (view.xyz.x + rad) / z_max), Tan_x, TILES_X);
+	range.min[1] = tile(std::min((view.xyz.y - rad) / z_min, (view.xyz.y - rad) / z_max), Tan_y, TILES_Y);
+	range.max[1] = tile(std::max((view.xyz.y + rad) / z_min, (view.xyz.y + rad) / z_max), Tan_y, TILES_Y);
+
+	return range;
+}
+
+void light_cluster_grid::build(const SCP_vector<light>& lights, const vec3d& eye_pos, const matrix& eye_orient, float tan_x, float tan_y)
+{
+	Eye_pos = eye_pos;
+	Eye_orient = eye_orient;
+	Tan_x = tan_x;
+	Tan_y = tan_y;
+
+	Cell_offsets.assign(NUM_CELLS + 1, 0);
+	Cell_lights.clear();
+	Unbucketed_lights.clear();
+
+	SCP_vector<std::pair<uint32_t, cell_range>> bucketed;
+
+	for (size_t i = 0; i < lights.size(); ++i) {
+		const auto& l = lights[i];
+
+		if (l.type == Light_Type::Tube) {
+			// the tube filter measures the distance to the infinite line through the tube, so this can't be bounded
+			Unbucketed_lights.push_back(static_cast<uint32_t>(i));
+			continue;
+		} else if (l.type != Light_Type::Point) {
+			// the filter ignores all other types
+			continue;
+		}
+
+		auto range = cells_for_sphere(l.vec, l.radb);
+		if (range.num_cells() > NUM_CELLS / 4) {
+			Unbucketed_lights.push_back(static_cast<uint32_t>(i));
+			continue;
+		}
+
+		for (int s = range.min[2]; s <= range.max[2]; ++s) {
+			for (int y = range.min[1]; y <= range.max[1]; ++y) {
+				for (int x = range.min[0]; x <= range.max[0]; ++x) {
+					++Cell_offsets[cell_index(x, y, s) + 1];
+				}
+			}
+		}
+
+		bucketed.emplace_back(static_cast<uint32_t>(i), range);
+	}
+
+	for (int i = 0; i < NUM_CELLS; ++i) {
+		Cell_offsets[i + 1] += Cell_offsets[i];
+	}
+
+	Cell_lights.resize(Cell_offsets[NUM_CELLS]);
+
+	// lights are added in ascending order, so every cell ends up sorted
+	SCP_vector<uint32_t> fill(Cell_offsets.begin(), Cell_offsets.end() - 1);
+	for (auto& entry : bucketed) {
+		auto& range = entry.second;
+
+		for (int s = range.min[2]; s <= range.max[2]; ++s) {
+			for (int y = range.min[1]; y <= range.max[1]; ++y) {
+				for (int x = range.min[0]; x <= range.max[0]; ++x) {
+					Cell_lights[fill[cell_index(x, y, s)]++] = entry.first;
+				}
+			}
+		}
+	}
+}
+
+bool light_cluster_grid::query(const vec3d* pos, float rad, SCP_vector<size_t>& candidates_out) const
+{
+	auto range = cells_for_sphere(*pos, rad);
+	if (range.num_cells() > NUM_CELLS / 4) {
+		return false;
+	}
+
+	candidates_out.assign(Unbucketed_lights.begin(), Unbucketed_lights.end());
+
+	for (int s = range.min[2]; s <= range.max[2]; ++s) {
+		for (int y = range.min[1]; y <= range.max[1]; ++y) {
+			for (int x = range.min[0]; x <= range.max[0]; ++x) {
+				auto cell = cell_index(x, y, s);
+				candidates_out.insert(candidates_out.end(), Cell_lights.begin() + Cell_offsets[cell], Cell_lights.begin() + Cell_offsets[cell + 1]);
+			}
+		}
+	}
+
+	std::sort(candidates_out.begin(), candidates_out.end());
+	candidates_out.erase(std::unique(candidates_out.begin(), candidates_out.end()), candidates_out.end());
+
+	return true;
+}
@@ -0,0 +1,80 @@
+#ifndef _LIGHT_CLUSTERS_H
+#define _LIGHT_CLUSTERS_H
+
+#include "globalincs/pstypes.h"
+
+struct light;
+
+// How scene_lights::setLightFilter() finds the point and tube lights that reach a model
+enum class LightFilterMode : uint8_t {
+	LINEAR,		// test every light of the scene
+	CLUSTERED,	// only test the lights of the view space clusters the model overlaps
+	VERIFY		// do both and log any model for which they find different lights (debugging only)
+};
+
+extern LightFilterMode Light_filter_mode;
+
+void light_cluster_init();
+
+/**
+ * @brief Buckets the point and tube lights of a scene into a view space froxel grid
+ *
+ * @details The view frustum is split into tiles along x and y and into slices along the view direction which get
+ * exponentially deeper. Everything outside of the frustum is clamped into the border cells. A light is added to every
+ * cell its bounding sphere may touch and a query returns the lights of every cell the queried sphere may touch, so the
+ * result is conservative no matter which view the grid was built for.
+ */
+class light_cluster_grid
+{
+public:
+	static constexpr int TILES_X = 16;
+	static constexpr int TILES_Y = 9;
+	static constexpr int SLICES = 24;
+	static constexpr int NUM_CELLS = TILES_X * TILES_Y * SLICES;
+
+	/**
+	 * @param lights The lights of the scene, indices into this are what query() returns
+	 * @param eye_pos Position of the view
+	 * @param eye_orient Orientation of the view
+	 * @param tan_x Tangent of half the horizontal field of view
+	 * @param tan_y Tangent of half the vertical field of view
+	 */
+	void build(const SCP_vector<light>& lights, const vec3d& eye_pos, const matrix& eye_orient, float tan_x, float tan_y);
+
+	/**
+	 * @brief Finds the lights whose area of effect may overlap a sphere
+	 *
+	 * @param pos Center of the sphere
+	 * @param rad Radius of the sphere
+	 * @param candidates_out Receives the light indices in ascending order, without duplicates
+	 * @return false if the sphere covers so much of the grid that testing every light is cheaper
+	 */
+	bool query(const vec3d* pos, float rad, SCP_vector<size_t>& candidates_out) const;
+
+private:
+	struct cell_range {
+		int min[3];
+		int max[3];
+
+		int num_cells() const;
+	};
+
+	int cell_index(int x, int y, int slice) const;
+	int tile(float ratio, float tan_half, int num_tiles) const;
+	int slice(float depth) const;
+	cell_range cells_for_sphere(const vec3d& pos, float rad) const;
+
+	vec3d Eye_pos;
+	matrix Eye_orient;
+	float Tan_x = 1.0f;
+	float Tan_y = 1.0f;
+
+	// Lights of cell i are Cell_lights[Cell_offsets[i]] up to Cell_lights[Cell_offsets[i + 1]]
+	SCP_vector<uint32_t> Cell_offsets;
+	SCP_vector<uint32_t> Cell_lights;
+
+	// Lights which cover too much of the grid to be bucketed, these are returned by every query
+	SCP_vector<uint32_t> Unbucketed_lights;
+};
+
+#endif
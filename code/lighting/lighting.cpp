@@ -15,6 +15,7 @@
 #include "graphics/2d.h"
 #include "graphics/color.h"
 #include "graphics/light.h"
+#include "lighting/light_clusters.h"
 #include "lighting/lighting.h"
 #include "lighting/lighting_profiles.h"
 #include "math/vecmat.h"
@@ -591,58 +592,113 @@ void scene_lights::addLight(const light *light_ptr)
 	Assert(light_ptr != NULL);
 
 	AllLights.push_back(*light_ptr);
+	LightGridDirty = true;
 
 	if ( light_ptr->type == Light_Type::Directional ) {
 		StaticLightIndices.push_back(AllLights.size() - 1);
 	}
 }
 
+static bool light_reaches_sphere(const light& l, const vec3d *pos, float rad)
+{
+	switch ( l.type ) {
+		case Light_Type::Point: {
+			vec3d to_light;
+			float dist_squared, max_dist_squared;
+			vm_vec_sub( &to_light, &l.vec, pos );
+			dist_squared = vm_vec_mag_squared(&to_light);
+
+			max_dist_squared = l.radb+rad;
+			max_dist_squared *= max_dist_squared;
+
+			return dist_squared < max_dist_squared;
+		}
+		case Light_Type::Tube: {
+			vec3d nearest;
+			float dist_squared, max_dist_squared;
+			vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+
+			max_dist_squared = l.radb+rad;
+			max_dist_squared *= max_dist_squared;
+
+			return dist_squared < max_dist_squared;
+		}
+		default:
+			// directional lights are always set, the others are not filtered in
+			return false;
+	}
+}
+
+void scene_lights::filterLights(const vec3d *pos, float rad, const SCP_vector<size_t> *candidates)
+{
+	if ( candidates == nullptr ) {
+		for ( size_t i = 0; i < AllLights.size(); ++i ) {
+			if ( light_reaches_sphere(AllLights[i], pos, rad) ) {
+				FilteredLights.push_back(i);
+			}
+		}
+	} else {
+		for ( auto i : *candidates ) {
+			if ( light_reaches_sphere(AllLights[i], pos, rad) ) {
+				FilteredLights.push_back(i);
+			}
+		}
+	}
+}
+
+void scene_lights::prepareLightFilter()
+{
+	// Below this many lights testing all of them is as fast as looking them up
+	constexpr size_t LIGHT_GRID_MIN_LIGHTS = 32;
+
+	if ( Light_filter_mode == LightFilterMode::LINEAR || !LightGridDirty ) {
+		return;
+	}
+
+	LightGridDirty = false;
+	LightGrid.reset();
+
+	if ( AllLights.size() - StaticLightIndices.size() < LIGHT_GRID_MIN_LIGHTS ) {
+		return;
+	}
+
+	float tan_y = tanf(g3_get_hfov(Eye_fov) * 0.5f);
+	if ( !(tan_y > 0.01f) ) {
+		tan_y = 1.0f;
+	}
+	float aspect = (gr_screen.clip_height > 0) ? i2fl(gr_screen.clip_width) / i2fl(gr_screen.clip_height) : 1.0f;
+
+	auto grid = std::make_shared<light_cluster_grid>();
+	grid->build(AllLights, Eye_position, Eye_matrix, tan_y * aspect, tan_y);
+
+	LightGrid = std::move(grid);
+}
+
 void scene_lights::setLightFilter(const vec3d *pos, float rad)
 {
-	size_t i = 0;
 	// clear out current filtered lights
 	FilteredLights.clear();
 
-	for ( auto& l : AllLights ) {
-		switch ( l.type ) {
-			case Light_Type::Directional:
-				++i;
-				continue;
-			case Light_Type::Point: {
-				vec3d to_light;
-				float dist_squared, max_dist_squared;
-				vm_vec_sub( &to_light, &l.vec, pos );
-				dist_squared = vm_vec_mag_squared(&to_light);
-
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
-
-				if ( dist_squared < max_dist_squared )	{
-					FilteredLights.push_back(i);
-				}
-			}
-			break;
-			case Light_Type::Tube: {
-				vec3d nearest;
-				float dist_squared, max_dist_squared;
-				vm_vec_dist_squared_to_line(pos,&l.vec,&l.vec2,&nearest,&dist_squared);
+	prepareLightFilter();
 
-				max_dist_squared = l.radb+rad;
-				max_dist_squared *= max_dist_squared;
+	if ( Light_filter_mode == LightFilterMode::LINEAR || LightGrid == nullptr || !LightGrid->query(pos, rad, LightCandidates) ) {
+		filterLights(pos, rad, nullptr);
+		return;
+	}
 
-				if ( dist_squared < max_dist_squared ) {
-					FilteredLights.push_back(i);
-				}
-			}
-			break;
+	filterLights(pos, rad, &LightCandidates);
 
-			case Light_Type::Cone:
-				break;
+	if ( Light_filter_mode == LightFilterMode::VERIFY ) {
+		auto clustered_count = FilteredLights.size();
+		LightCandidates.assign(FilteredLights.begin(), FilteredLights.end());
 
-			default:
-				break;
+		FilteredLights.clear();
+		filterLights(pos, rad, nullptr);
+
+		if ( LightCandidates != FilteredLights ) {
+			mprintf(("Light clusters: found %d lights instead of %d for a sphere of radius %.1f at (%.1f, %.1f, %.1f)\n", static_cast<int>(clustered_count),
+				static_cast<int>(FilteredLights.size()), rad, pos->xyz.x, pos->xyz.y, pos->xyz.z));
 		}
-		++i;
 	}
 }
 
@@ -671,6 +727,30 @@ light_indexing_info scene_lights::bufferLights()
 	return light_info;
 }
 
+void scene_lights::copyLights(const scene_lights &other)
+{
+	AllLights = other.AllLights;
+	StaticLightIndices = other.StaticLightIndices;
+	LightGrid = other.LightGrid;
+	LightGridDirty = other.LightGridDirty;
+
+	FilteredLights.clear();
+	BufferedLights.clear();
+
+	resetLightState();
+}
+
+size_t scene_lights::appendBufferedLights(const scene_lights &other)
+{
+	Assertion(AllLights.size() == other.AllLights.size(), "Buffered lights can only be appended from a scene with the same lights!");
+
+	auto base = BufferedLights.size();
+
+	BufferedLights.insert(BufferedLights.end(), other.BufferedLights.begin(), other.BufferedLights.end());
+
+	return base;
+}
+
 void scene_lights::resetLightState()
 {
 	current_light_index = static_cast<size_t>(-1);
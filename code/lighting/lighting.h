@@ -66,6 +66,8 @@ struct light_indexing_info
 	size_t num_lights;
 };
 
+class light_cluster_grid;
+
 class scene_lights
 {
 	SCP_vector<light> AllLights;
@@ -76,8 +78,15 @@ class scene_lights
 
 	SCP_vector<size_t> BufferedLights;
 
+	// Built from AllLights on the first filter after a change, shared with the scenes copied from this one
+	std::shared_ptr<const light_cluster_grid> LightGrid;
+	bool LightGridDirty = true;
+	SCP_vector<size_t> LightCandidates;
+
 	size_t current_light_index;
 	size_t current_num_lights;
+
+	void filterLights(const vec3d *pos, float rad, const SCP_vector<size_t> *candidates);
 public:
 	scene_lights()
 	{
@@ -85,9 +94,16 @@ public:
 	}
 	void addLight(const light *light_ptr);
 	void setLightFilter(const vec3d *pos, float rad);
+	// Builds what setLightFilter() needs up front, so that copies of this scene can share it
+	void prepareLightFilter();
 	bool setLights(const light_indexing_info *info);
 	void resetLightState();
 	light_indexing_info bufferLights();
+
+	// Starts over with the lights of another scene, but none of its buffered ones
+	void copyLights(const scene_lights &other);
+	// Appends the buffered lights of another scene with the same lights and returns the index they start at
+	size_t appendBufferedLights(const scene_lights &other);
 };
 
 enum class lighting_mode { NORMAL, COCKPIT };
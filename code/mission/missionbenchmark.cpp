@@ -0,0 +1,210 @@
+#include "mission/missionbenchmark.h"
+
+#include "ai/ai.h"
+#include "ai/aigoals.h"
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "io/timer.h"
+#include "libs/jansson.h"
+#include "mission/missionparse.h"
+#include "object/object.h"
+#include "playerman/player.h"
+#include "tracing/tracing.h"
+
+#include <md5.h>
+
+namespace {
+
+bool Benchmark_started = false;
+bool Benchmark_report_written = false;
+int Benchmark_frames = 0;
+uint64_t Benchmark_start_time = 0;
+
+double to_ms(uint64_t ns)
+{
+	return static_cast<double>(ns) / 1000000.0;
+}
+
+double per_frame_ms(uint64_t ns)
+{
+	return (Benchmark_frames > 0) ? to_ms(ns) / Benchmark_frames : 0.0;
+}
+
+double mean_ms(const tracing::category_timing& timing)
+{
+	return (timing.count > 0) ? to_ms(timing.total_ns) / static_cast<double>(timing.count) : 0.0;
+}
+
+void write_csv(const SCP_vector<tracing::category_timing>& timings)
+{
+	CFILE* fp = cfopen("sim_benchmark.csv", "wt", CF_TYPE_DATA);
+	if (fp == nullptr) {
+		mprintf(("Simulation benchmark: unable to write sim_benchmark.csv\n"));
+		return;
+	}
+
+	SCP_string line;
+
+	cfputs("category,count,total_ms,mean_ms,max_ms,ms_per_frame\n", fp);
+
+	for (const auto& timing : timings) {
+		sprintf(line, "\"%s\",%llu,%.3f,%.4f,%.3f,%.4f\n", timing.name, static_cast<unsigned long long>(timing.count),
+			to_ms(timing.total_ns), mean_ms(timing), to_ms(timing.max_ns), per_frame_ms(timing.total_ns));
+		cfputs(line.c_str(), fp);
+	}
+
+	cfclose(fp);
+}
+
+void write_json(const SCP_vector<tracing::category_timing>& timings, const SCP_string& state_hash, double wall_seconds)
+{
+	CFILE* fp = cfopen("sim_benchmark.json", "wt", CF_TYPE_DATA);
+	if (fp == nullptr) {
+		mprintf(("Simulation benchmark: unable to write sim_benchmark.json\n"));
+		return;
+	}
+
+	std::unique_ptr<json_t> root(json_object());
+	json_object_set_new(root.get(), "mission", json_string(The_mission.name.c_str()));
+	json_object_set_new(root.get(), "frames", json_integer(Benchmark_frames));
+	json_object_set_new(root.get(), "frames_requested", json_integer(Cmdline_sim_benchmark));
+	json_object_set_new(root.get(), "fps", json_integer(Cmdline_sim_benchmark_fps));
+	json_object_set_new(root.get(), "autopilot", json_boolean(Cmdline_sim_benchmark_autopilot));
+	json_object_set_new(root.get(), "mission_time", json_real(f2fl(Missiontime)));
+	json_object_set_new(root.get(), "wall_seconds", json_real(wall_seconds));
+	json_object_set_new(root.get(), "state_hash", json_string(state_hash.c_str()));
+
+	auto categories = json_array();
+	for (const auto& timing : timings) {
+		auto obj = json_object();
+		json_object_set_new(obj, "name", json_string(timing.name));
+		json_object_set_new(obj, "count", json_integer(static_cast<json_int_t>(timing.count)));
+		json_object_set_new(obj, "total_ms", json_real(to_ms(timing.total_ns)));
+		json_object_set_new(obj, "mean_ms", json_real(mean_ms(timing)));
+		json_object_set_new(obj, "max_ms", json_real(to_ms(timing.max_ns)));
+		json_object_set_new(obj, "ms_per_frame", json_real(per_frame_ms(timing.total_ns)));
+		json_array_append_new(categories, obj);
+	}
+	json_object_set_new(root.get(), "categories", categories);
+
+	json_dump_cfile(root.get(), fp, JSON_INDENT(4) | JSON_PRESERVE_ORDER);
+	cfclose(fp);
+}
+
+void write_report()
+{
+	double wall_seconds = static_cast<double>(timer_get_nanoseconds() - Benchmark_start_time) / 1000000000.0;
+
+	auto timings = tracing::get_category_timings();
+	auto state_hash = mission_benchmark_state_hash();
+
+	mprintf(("Simulation benchmark: %d of %d frames at %d fps in %.3f seconds, state hash %s\n", Benchmark_frames,
+		Cmdline_sim_benchmark, Cmdline_sim_benchmark_fps, wall_seconds, state_hash.c_str()));
+
+	write_csv(timings);
+	write_json(timings, state_hash, wall_seconds);
+
+	Benchmark_report_written = true;
+}
+
+template <typename T>
+void hash_value(MD5& md5, const T& value)
+{
+	md5.update(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}
+
+bool mission_benchmark_active()
+{
+	return Cmdline_sim_benchmark > 0;
+}
+
+void mission_benchmark_init()
+{
+	if (!mission_benchmark_active()) {
+		return;
+	}
+
+	if (Cmdline_start_mission == nullptr) {
+		ReleaseWarning(LOCATION, "-sim_benchmark needs a mission to run, set one with -start_mission!");
+	}
+
+	timestamp_set_fixed_step(1000000 / Cmdline_sim_benchmark_fps);
+}
+
+fix mission_benchmark_frametime()
+{
+	return F1_0 / Cmdline_sim_benchmark_fps;
+}
+
+void mission_benchmark_start()
+{
+	if (!mission_benchmark_active() || Benchmark_started) {
+		return;
+	}
+
+	Benchmark_started = true;
+	Benchmark_frames = 0;
+
+	// let the AI fly the player ship like the player-use-ai SEXP does, and give it something to do
+	if (Cmdline_sim_benchmark_autopilot && (Player_ai != nullptr)) {
+		Player_use_ai = true;
+		ai_add_ship_goal_scripting(AI_GOAL_CHASE_ANY, SM_ATTACK, 100, nullptr, Player_ai, 0, 0.0f);
+	}
+
+	tracing::reset_category_timings();
+	Benchmark_start_time = timer_get_nanoseconds();
+}
+
+bool mission_benchmark_frame_done()
+{
+	if (!Benchmark_started || Benchmark_report_written) {
+		return false;
+	}
+
+	if (++Benchmark_frames < Cmdline_sim_benchmark) {
+		return false;
+	}
+
+	write_report();
+	return true;
+}
+
+void mission_benchmark_mission_end()
+{
+	if (!Benchmark_started || Benchmark_report_written) {
+		return;
+	}
+
+	mprintf(("Simulation benchmark: the mission ended after %d frames\n", Benchmark_frames));
+	write_report();
+}
+
+SCP_string mission_benchmark_state_hash()
+{
+	MD5 md5;
+
+	hash_value(md5, Missiontime);
+
+	for (auto objp : list_range(&obj_used_list)) {
+		if (objp->flags[Object::Object_Flags::Should_be_dead]) {
+			continue;
+		}
+
+		hash_value(md5, objp->type);
+		hash_value(md5, objp->signature);
+		hash_value(md5, objp->pos);
+		hash_value(md5, objp->orient);
+		hash_value(md5, objp->phys_info.vel);
+		hash_value(md5, objp->phys_info.rotvel);
+		hash_value(md5, objp->hull_strength);
+
+		for (auto quadrant : objp->shield_quadrant) {
+			hash_value(md5, quadrant);
+		}
+	}
+
+	md5.finalize();
+	return md5.hexdigest();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// A simulation benchmark runs the -start_mission mission headless at a fixed timestep for -sim_benchmark frames. It
+// times every tracing category along the way and ends with a hash of the simulation state, so that both the speed and
+// the results of the simulation can be compared between builds.
+
+// Whether the game runs a simulation benchmark, see -sim_benchmark
+bool mission_benchmark_active();
+
+// Switches the timestamps to the fixed timestep of the benchmark, called once at game start
+void mission_benchmark_init();
+
+// The fixed frametime of every simulated frame
+fix mission_benchmark_frametime();
+
+// Called when the player enters the mission, nothing before that is counted
+void mission_benchmark_start();
+
+// Called after every simulated frame, returns true once the last frame was simulated and the report was written
+bool mission_benchmark_frame_done();
+
+// Called when the mission ends while its objects are still around, writes the report if that happened early
+void mission_benchmark_mission_end();
+
+// MD5 of the mission time and of where every object is, where it is going and how much damage it took
+SCP_string mission_benchmark_state_hash();
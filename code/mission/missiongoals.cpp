@@ -32,6 +32,9 @@
 #include "network/stand_gui.h"
 #include "parse/parselo.h"
 #include "parse/sexp.h"
+#include "parse/sexp/sexp_bytecode.h"
+#include "parse/sexp/sexp_dependencies.h"
+#include "parse/sexp/sexp_profiler.h"
 #include "playerman/player.h"
 #include "scripting/global_hooks.h"
 #include "tracing/tracing.h"
@@ -369,6 +372,9 @@ void mission_goals_and_events_init()
 	Mission_goal_timestamp = _timestamp(GOAL_TIMESTAMP);
 	Mission_directive_sound_timestamp = TIMESTAMP::invalid();
 	Mission_directive_special_timestamp = TIMESTAMP::invalid();		// need to make invalid right away
+
+	sexp_dependencies_reset();
+	sexp_profiler_reset();
 }
 
 // called once right before entering the show goals screen to do initializations.
@@ -971,7 +977,15 @@ void mission_process_event( int event )
 			Current_event_log_container_buffer = &Mission_events[event].event_log_container_buffer;
 			Current_event_log_argument_buffer = &Mission_events[event].event_log_argument_buffer;
 		}
-		result = eval_sexp(sindex);
+		if (Sexp_profiling) {
+			sexp_profile_event_begin(event);
+		}
+
+		result = sexp_bytecode_eval_event(event);
+
+		if (Sexp_profiling) {
+			sexp_profile_event_end(event);
+		}
 
 		// if the directive count is a special value, deal with that first.  Mark the event as a special
 		// event, and unmark it when the directive is true again.
@@ -1091,6 +1105,43 @@ void mission_maybe_play_directive_success_sound()
 }
 
 
+// Whether a goal which was evaluated before can be skipped because nothing its formula reads has changed since
+static bool mission_goal_inputs_unchanged(int goal)
+{
+	auto& g = Mission_goals[goal];
+
+	if (Sexp_event_eval == SexpEventEval::POLL || g.dependency_serial == 0) {
+		return false;
+	}
+
+	if (g.dependencies < 0) {
+		g.dependencies = sexp_get_dependencies(g.formula);
+	}
+
+	return !sexp_dependencies_changed_since(g.dependencies, g.dependency_serial);
+}
+
+// Same as above for a non-repeating event.  Events whose evaluation does more than produce a result are never skipped.
+static bool mission_event_inputs_unchanged(int event)
+{
+	auto& e = Mission_events[event];
+
+	if (Sexp_event_eval == SexpEventEval::POLL || e.dependency_serial == 0 || e.result != 0) {
+		return false;
+	}
+
+	// chaining depends on the neighbouring events, logging and directive waves on the evaluation itself
+	if (e.chain_delay >= 0 || e.mission_log_flags != 0 || Snapshot_all_events || (e.flags & (MEF_DIRECTIVE_SPECIAL | MEF_DIRECTIVE_TEMP_TRUE))) {
+		return false;
+	}
+
+	if (e.dependencies < 0) {
+		e.dependencies = sexp_get_dependencies(e.formula);
+	}
+
+	return !sexp_dependencies_changed_since(e.dependencies, e.dependency_serial);
+}
+
 void mission_eval_goals()
 {
 	int i, result;
@@ -1122,6 +1173,12 @@ void mission_eval_goals()
 		}
 
 		if (Mission_goals[i].satisfied == GOAL_INCOMPLETE) {
+			bool skippable = mission_goal_inputs_unchanged(i);
+			if (skippable && Sexp_event_eval == SexpEventEval::DEPENDENCIES) {
+				continue;
+			}
+
+			uint serial = sexp_get_dependency_serial();
 			result = eval_sexp(Mission_goals[i].formula);
 			if ( Sexp_nodes[Mission_goals[i].formula].value == SEXP_KNOWN_FALSE ) {
 				mission_goal_status_change( i, GOAL_FAILED );
@@ -1130,6 +1187,11 @@ void mission_eval_goals()
 				mission_goal_status_change(i, GOAL_COMPLETE );
 			} // end if result
 
+			if (skippable && Mission_goals[i].satisfied != GOAL_INCOMPLETE) {
+				mprintf(("SEXP dependencies: goal '%s' changed although its inputs did not\n", Mission_goals[i].name.c_str()));
+			}
+
+			Mission_goals[i].dependency_serial = (Mission_goals[i].satisfied == GOAL_INCOMPLETE) ? serial : 0;
 		}	// end if goals[i].satsified != GOAL_COMPLETE
 	} // end for
 
@@ -1140,8 +1202,22 @@ void mission_eval_goals()
 			// we will evaluate repeatable events at the top of the file so we can get
 			// the exact interval that the designer asked for.
 			if ( !Mission_events[i].timestamp.isValid() ){
+				bool skippable = mission_event_inputs_unchanged(i);
+				if (skippable && Sexp_event_eval == SexpEventEval::DEPENDENCIES) {
+					continue;
+				}
+
+				int old_count = Mission_events[i].count;
+				uint serial = sexp_get_dependency_serial();
+
 				TRACE_SCOPE(tracing::NonrepeatingEvents);
 				mission_process_event( i );
+
+				if (skippable && (Mission_events[i].result != 0 || Mission_events[i].count != old_count || Mission_events[i].timestamp.isValid())) {
+					mprintf(("SEXP dependencies: event '%s' changed although its inputs did not\n", Mission_events[i].name.c_str()));
+				}
+
+				Mission_events[i].dependency_serial = (Mission_events[i].result == 0 && !Mission_events[i].timestamp.isValid()) ? serial : 0;
 			}
 		}
 	}
@@ -59,6 +59,8 @@ typedef struct mission_goal {
 	int  score = 0;                         // score for this goal
 	int  flags = 0;                         // MGF_
 	int  team = 0;                          // which team is this objective for (defaults to the first team)
+	int  dependencies = -1;                 // SEXP_DEPENDS_* flags of the formula, -1 until first needed
+	uint dependency_serial = 0;             // dependency serial of the last evaluation that left the goal incomplete, 0 if none
 } mission_goal;
 extern SCP_vector<mission_goal> Mission_goals;	// structure for the goals of this mission
 
@@ -124,6 +126,9 @@ typedef struct mission_event {
 	SCP_vector<SCP_string> backup_log_buffer;
 	int	previous_result = 0;                            // result of previous evaluation of event
 
+	int  dependencies = -1;                             // SEXP_DEPENDS_* flags of the formula, -1 until first needed
+	uint dependency_serial = 0;                         // dependency serial of the last evaluation that left the event false, 0 if none
+
 } mission_event;
 extern SCP_vector<mission_event> Mission_events;
 
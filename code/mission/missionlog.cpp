@@ -18,6 +18,7 @@
 #include "network/multimsgs.h"
 #include "network/multiutil.h"
 #include "parse/parselo.h"
+#include "parse/sexp/sexp_dependencies.h"
 #include "playerman/player.h"
 #include "ship/ship.h"
 
@@ -53,6 +54,8 @@ void mission_log_add_entry(LogType type, const char *pname, const char *sname, i
 		return;
 	}
 
+	sexp_mark_dependency_changed(SEXP_DEPENDS_SHIPS);
+
 	Log_entries.emplace_back();
 	auto &entry = Log_entries.back();
 
@@ -303,6 +306,8 @@ void mission_log_add_entry_multi( LogType type, const char *pname, const char *s
 	Assert ( Game_mode & GM_MULTIPLAYER );
 	Assert ( !(Net_player->flags & NETINFO_FLAG_AM_MASTER) );
 
+	sexp_mark_dependency_changed(SEXP_DEPENDS_SHIPS);
+
 	Log_entries.emplace_back();
 	auto &entry = Log_entries.back();
 
@@ -64,6 +64,8 @@
 #include "object/waypoint.h"
 #include "parse/generic_log.h"
 #include "parse/parselo.h"
+#include "parse/sexp/sexp_bytecode.h"
+#include "parse/sexp/sexp_dependencies.h"
 #include "parse/sexp_container.h"
 #include "prop/prop.h"
 #include "scripting/global_hooks.h"
@@ -4162,6 +4164,7 @@ void mission_parse_maybe_create_parse_object(p_object *pobjp)
 				entry->status = ShipStatus::EXITED;
 				entry->objnum = -1;
 				entry->shipnum = -1;
+				sexp_mark_dependency_changed(SEXP_DEPENDS_SHIPS);
 				entry->cleanup_mode = SHIP_DESTROYED;
 
 				// once the ship is exploded, find the debris pieces belonging to this object, mark them
@@ -7281,6 +7284,10 @@ bool post_process_mission(mission *pm)
 		}
 	}
 
+	// needs the ship registry to be complete
+	if (!Fred_running)
+		sexp_bytecode_compile_events();
+
 	// success
 	return true;
 }
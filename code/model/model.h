@@ -1046,6 +1046,12 @@ int model_load(ship_info* sip, bool prefer_tech_model);
 // NOTE: Each time model_load is called with a ship_info pointer, which causes it to load subsystems, the model number is also assigned to the ship_info.
 int model_load(const char *filename, ship_info* sip = nullptr, ErrorType error_type = ErrorType::FATAL_ERROR, bool allow_redundant_load = false);
 
+// Models loaded between these two calls have their collision trees built by the worker threads while the main thread
+// goes on with the next model. model_load_batch_stop() waits for all of them, nothing may collide with a model of the
+// batch before that. Batches may be nested, only the outermost stop waits.
+void model_load_batch_start();
+void model_load_batch_stop();
+
 int model_create_instance(int objnum, int model_num);
 void model_delete_instance(int model_instance_num);
 
@@ -0,0 +1,315 @@
+#include "model/modelcache.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "parse/parselo.h"
+#include "tracing/tracing.h"
+
+#include <md5.h>
+
+// Bump this whenever model_collide_parse_bsp() builds different trees from the same BSP data
+#define MODEL_CACHE_VERSION 1
+
+namespace {
+
+const char Model_cache_magic[4] = { 'F', 'S', 'M', 'C' };
+
+// Every array in a cache file starts at a multiple of this, so a mapped file can be used in place
+constexpr size_t MODEL_CACHE_ALIGNMENT = 16;
+
+struct model_cache_header {
+	char magic[4];
+	int version;
+	char key[32];
+	int n_trees;
+	int reserved;
+};
+
+// Offsets are relative to the start of the file
+struct model_cache_tree {
+	int n_points;
+	int n_nodes;
+	int n_leaves;
+	int n_tmap_verts;
+	int n_poly_centers;
+	uint points_offset;
+	uint nodes_offset;
+	uint leaves_offset;
+	uint tmap_verts_offset;
+	uint poly_centers_offset;
+};
+
+SCP_string model_cache_filename(const polymodel* pm)
+{
+	SCP_string name = pm->filename;
+	drop_extension(name);
+	return "model_cache-" + name + ".bin";
+}
+
+// model_collide_parse_bsp() doesn't keep the length of the vertex list, but every leaf refers to a range of it
+int tmap_vert_count(const bsp_collision_tree* tree)
+{
+	int64_t count = 0;
+	for (int i = 0; i < tree->n_leaves; ++i) {
+		count = std::max(count, static_cast<int64_t>(tree->leaf_list[i].vert_start) + tree->leaf_list[i].num_verts);
+	}
+
+	Assertion(count <= INT_MAX, "Collision tree refers to more vertices than it can have!");
+	return static_cast<int>(count);
+}
+
+uint append_array(SCP_vector<ubyte>& out, const void* data, size_t size)
+{
+	out.resize((out.size() + MODEL_CACHE_ALIGNMENT - 1) & ~(MODEL_CACHE_ALIGNMENT - 1));
+
+	auto offset = static_cast<uint>(out.size());
+	if (size > 0) {
+		out.insert(out.end(), static_cast<const ubyte*>(data), static_cast<const ubyte*>(data) + size);
+	}
+	return offset;
+}
+
+bool array_in_bounds(uint offset, int count, size_t element_size, size_t size)
+{
+	return count >= 0 && offset <= size && static_cast<size_t>(count) <= (size - offset) / element_size;
+}
+
+template <typename T>
+T* copy_array(const ubyte* data, uint offset, int count)
+{
+	if (count <= 0) {
+		return nullptr;
+	}
+
+	auto list = static_cast<T*>(vm_malloc(sizeof(T) * count));
+	memcpy(list, data + offset, sizeof(T) * count);
+	return list;
+}
+
+// model_collide_parse_bsp() always puts children and the next leaf of a list after the ones referring to them
+bool is_forward_link(int link, int from, int count)
+{
+	return link == -1 || (link > from && link < count);
+}
+
+// The trees are trusted by the collision code, so make sure every index in them stays inside its list and that following
+// them can't loop forever
+bool tree_is_valid(const model_cache_tree& entry, const ubyte* data, size_t size)
+{
+	if (!array_in_bounds(entry.points_offset, entry.n_points, sizeof(vec3d), size)
+		|| !array_in_bounds(entry.nodes_offset, entry.n_nodes, sizeof(bsp_collision_node), size)
+		|| !array_in_bounds(entry.leaves_offset, entry.n_leaves, sizeof(bsp_collision_leaf), size)
+		|| !array_in_bounds(entry.tmap_verts_offset, entry.n_tmap_verts, sizeof(model_tmap_vert), size)
+		|| !array_in_bounds(entry.poly_centers_offset, entry.n_poly_centers, sizeof(vec3d), size)) {
+		return false;
+	}
+
+	for (int i = 0; i < entry.n_nodes; ++i) {
+		bsp_collision_node node;
+		memcpy(&node, data + entry.nodes_offset + i * sizeof(node), sizeof(node));
+
+		if (!is_forward_link(node.back, i, entry.n_nodes) || !is_forward_link(node.front, i, entry.n_nodes)
+			|| node.leaf < -1 || node.leaf >= entry.n_leaves) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < entry.n_leaves; ++i) {
+		bsp_collision_leaf leaf;
+		memcpy(&leaf, data + entry.leaves_offset + i * sizeof(leaf), sizeof(leaf));
+
+		// n_tmap_verts isn't negative here, so unlike the sum this can't overflow
+		if (!is_forward_link(leaf.next, i, entry.n_leaves) || leaf.vert_start < 0
+			|| leaf.num_verts > entry.n_tmap_verts - leaf.vert_start) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < entry.n_tmap_verts; ++i) {
+		model_tmap_vert vert;
+		memcpy(&vert, data + entry.tmap_verts_offset + i * sizeof(vert), sizeof(vert));
+
+		if (vert.vertnum >= entry.n_points) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
+
+SCP_string model_cache_key(const polymodel* pm)
+{
+	MD5 md5;
+
+	// the layout of the cached structures and the byte order are part of the key, so a cache file is never read by a
+	// build that would lay the trees out differently
+	const int params[] = { MODEL_CACHE_VERSION, 0x01020304, static_cast<int>(sizeof(bsp_collision_node)),
+		static_cast<int>(sizeof(bsp_collision_leaf)), static_cast<int>(sizeof(model_tmap_vert)),
+		static_cast<int>(sizeof(vec3d)), pm->version, pm->n_models };
+	md5.update(reinterpret_cast<const char*>(params), sizeof(params));
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		const auto& sm = pm->submodel[i];
+		md5.update(reinterpret_cast<const char*>(&sm.bsp_data_size), sizeof(sm.bsp_data_size));
+		if (sm.bsp_data_size > 0) {
+			md5.update(reinterpret_cast<const char*>(sm.bsp_data.get()), static_cast<MD5::size_type>(sm.bsp_data_size));
+		}
+	}
+
+	md5.finalize();
+	return md5.hexdigest();
+}
+
+void model_cache_serialize_collision_trees(const polymodel* pm, const SCP_string& key, SCP_vector<ubyte>& out)
+{
+	Assertion(key.size() == sizeof(model_cache_header::key), "Model cache keys must be MD5 hex digests!");
+
+	model_cache_header header{};
+	memcpy(header.magic, Model_cache_magic, sizeof(header.magic));
+	header.version = MODEL_CACHE_VERSION;
+	memcpy(header.key, key.data(), sizeof(header.key));
+	header.n_trees = pm->n_models;
+
+	SCP_vector<model_cache_tree> entries(pm->n_models);
+
+	out.clear();
+	append_array(out, &header, sizeof(header));
+	auto entries_offset = append_array(out, entries.data(), sizeof(model_cache_tree) * entries.size());
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		const auto tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+		auto& entry = entries[i];
+
+		entry.n_points = tree->n_verts;
+		entry.n_nodes = tree->n_nodes;
+		entry.n_leaves = tree->n_leaves;
+		entry.n_tmap_verts = tmap_vert_count(tree);
+		entry.n_poly_centers = static_cast<int>(tree->poly_centers.size());
+
+		entry.points_offset = append_array(out, tree->point_list, sizeof(vec3d) * entry.n_points);
+		entry.nodes_offset = append_array(out, tree->node_list, sizeof(bsp_collision_node) * entry.n_nodes);
+		entry.leaves_offset = append_array(out, tree->leaf_list, sizeof(bsp_collision_leaf) * entry.n_leaves);
+		entry.tmap_verts_offset = append_array(out, tree->vert_list, sizeof(model_tmap_vert) * entry.n_tmap_verts);
+		entry.poly_centers_offset = append_array(out, tree->poly_centers.data(), sizeof(vec3d) * entry.n_poly_centers);
+	}
+
+	// the table could only be filled in once the arrays were placed
+	if (!entries.empty()) {
+		memcpy(out.data() + entries_offset, entries.data(), sizeof(model_cache_tree) * entries.size());
+	}
+}
+
+bool model_cache_deserialize_collision_trees(polymodel* pm, const SCP_string& key, const ubyte* data, size_t size)
+{
+	model_cache_header header;
+	if (size < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.magic, Model_cache_magic, sizeof(header.magic)) != 0 || header.version != MODEL_CACHE_VERSION
+		|| key.size() != sizeof(header.key) || memcmp(header.key, key.data(), sizeof(header.key)) != 0
+		|| header.n_trees != pm->n_models) {
+		return false;
+	}
+
+	auto entries_offset = static_cast<uint>((sizeof(header) + MODEL_CACHE_ALIGNMENT - 1) & ~(MODEL_CACHE_ALIGNMENT - 1));
+	if (!array_in_bounds(entries_offset, header.n_trees, sizeof(model_cache_tree), size)) {
+		return false;
+	}
+
+	SCP_vector<model_cache_tree> entries(header.n_trees);
+	if (!entries.empty()) {
+		memcpy(entries.data(), data + entries_offset, sizeof(model_cache_tree) * entries.size());
+	}
+
+	// check everything before creating anything, so a damaged file doesn't leave half of the trees behind
+	for (const auto& entry : entries) {
+		if (!tree_is_valid(entry, data, size)) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		const auto& entry = entries[i];
+
+		pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+		auto tree = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+
+		tree->n_verts = entry.n_points;
+		tree->point_list = copy_array<vec3d>(data, entry.points_offset, entry.n_points);
+		tree->n_nodes = entry.n_nodes;
+		tree->node_list = copy_array<bsp_collision_node>(data, entry.nodes_offset, entry.n_nodes);
+		tree->n_leaves = entry.n_leaves;
+		tree->leaf_list = copy_array<bsp_collision_leaf>(data, entry.leaves_offset, entry.n_leaves);
+		tree->vert_list = copy_array<model_tmap_vert>(data, entry.tmap_verts_offset, entry.n_tmap_verts);
+
+		tree->poly_centers.resize(entry.n_poly_centers);
+		if (entry.n_poly_centers > 0) {
+			memcpy(tree->poly_centers.data(), data + entry.poly_centers_offset, sizeof(vec3d) * entry.n_poly_centers);
+		}
+	}
+
+	return true;
+}
+
+bool model_cache_load_collision_trees(polymodel* pm)
+{
+	if (Cmdline_nomodelcache) {
+		return false;
+	}
+
+	TRACE_SCOPE(tracing::ModelCacheLoad);
+
+	auto filename = model_cache_filename(pm);
+	CFILE* fp = cfopen(filename.c_str(), "rb", CF_TYPE_CACHE, false, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+	if (fp == nullptr) {
+		return false;
+	}
+
+	// use the file in place if it is mapped, otherwise read it in one go
+	SCP_vector<ubyte> buffer;
+	size_t size = 0;
+	auto data = static_cast<const ubyte*>(cf_get_data_view(fp, &size));
+	if (data == nullptr) {
+		buffer.resize(static_cast<size_t>(cfilelength(fp)));
+		if (!buffer.empty() && cfread(buffer.data(), 1, static_cast<int>(buffer.size()), fp) != static_cast<int>(buffer.size())) {
+			buffer.clear();
+		}
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	bool loaded = model_cache_deserialize_collision_trees(pm, model_cache_key(pm), data, size);
+	cfclose(fp);
+
+	if (!loaded) {
+		nprintf(("Model", "Ignoring outdated model cache %s\n", filename.c_str()));
+	}
+
+	return loaded;
+}
+
+void model_cache_save_collision_trees(const polymodel* pm)
+{
+	if (Cmdline_nomodelcache) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelCacheSave);
+
+	SCP_vector<ubyte> data;
+	model_cache_serialize_collision_trees(pm, model_cache_key(pm), data);
+
+	auto filename = model_cache_filename(pm);
+	CFILE* fp = cfopen(filename.c_str(), "wb", CF_TYPE_CACHE, false, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+	if (fp == nullptr) {
+		mprintf(("Could not open model cache %s for writing!\n", filename.c_str()));
+		return;
+	}
+
+	cfwrite(data.data(), 1, static_cast<int>(data.size()), fp);
+	cfclose(fp);
+}
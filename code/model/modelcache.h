@@ -0,0 +1,37 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "model/model.h"
+
+/**
+ * @brief On-disk cache of the BSP collision trees built by model_load()
+ *
+ * @details Building the collision tree of every submodel is the most expensive step of loading a model that doesn't
+ * involve the renderer, so the finished trees are written to data/cache/model_cache-<model>.bin. Trees are stored as
+ * flat arrays referring to each other by index, so loading them is a plain copy of each array without any fixups. Each
+ * cache file carries a key hashed from the cache version, the layout of the cached structures and the aligned BSP
+ * data of every submodel, which is everything the trees are built from. A cache file whose key doesn't match is
+ * rebuilt and overwritten.
+ *
+ * The cache can be disabled with -nomodelcache.
+ */
+
+// Hashes everything the collision trees of pm are built from
+SCP_string model_cache_key(const polymodel* pm);
+
+// Writes the collision trees of every submodel of pm to out
+void model_cache_serialize_collision_trees(const polymodel* pm, const SCP_string& key, SCP_vector<ubyte>& out);
+
+/**
+ * @brief Creates the collision trees of every submodel of pm from a serialized cache
+ *
+ * @return false if the data is damaged, doesn't match key or doesn't match the submodels of pm, in which case no trees
+ * have been created
+ */
+bool model_cache_deserialize_collision_trees(polymodel* pm, const SCP_string& key, const ubyte* data, size_t size);
+
+// Creates the collision trees of pm from its cache file, returns false if they have to be built
+bool model_cache_load_collision_trees(polymodel* pm);
+
+// Writes the cache file of pm once its collision trees have been built
+void model_cache_save_collision_trees(const polymodel* pm);
@@ -31,6 +31,7 @@
 #include "math/fvi.h"
 #include "math/vecmat.h"
 #include "model/model.h"
+#include "model/modelcache.h"
 #include "model/modelrender.h"
 #include "model/modelreplace.h"
 #include "model/modelsinc.h"
@@ -41,6 +42,7 @@
 #include "graphics/shadows.h"
 #include "weapon/weapon.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #define MODEL_SDR_FLAG_MODE_CPP
 #include "def_files/data/effects/model_shader_flags.h"
@@ -71,7 +73,27 @@ SCP_vector<polymodel_instance*> Polygon_model_instances;
 
 SCP_vector<bsp_collision_tree> Bsp_collision_tree_list;
 
-const ubyte* Macro_ubyte_bounds = nullptr;
+thread_local const ubyte* Macro_ubyte_bounds = nullptr;
+
+// Slot of every loaded model by filename, so model_load() doesn't have to compare against every slot
+static SCP_unordered_map<SCP_string, int, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Model_filename_index;
+
+/**
+ * Collision trees of a model loaded during a batch, built by a worker thread while the main thread goes on with the
+ * next model. The BSP data is shared with the submodels, so the job never needs the polymodel itself.
+ */
+struct model_deferred_trees {
+	int model_id;
+	int version;
+	SCP_vector<std::shared_ptr<ubyte[]>> bsp_data;
+	SCP_vector<int> bsp_data_size;
+	SCP_vector<bsp_collision_tree> trees;
+
+	threading::JobCounter done;
+};
+
+static int Model_load_batch_depth = 0;
+static SCP_vector<std::unique_ptr<model_deferred_trees>> Model_deferred_trees;
 
 //If true, CPU-side vertex buffers are deleted once the model is on-GPU.
 //This is typically desired for memory reasons, but will prevent certain type of particles.
@@ -312,6 +334,19 @@ void model_unload(int modelnum, int force)
 		}
 	}
 
+	// another copy loaded with allow_redundant_load takes over the filename
+	auto index = Model_filename_index.find(pm->filename);
+	if (index != Model_filename_index.end() && index->second == num) {
+		Model_filename_index.erase(index);
+
+		for (int i = 0; i < MAX_POLYGON_MODELS; i++) {
+			if (i != num && Polygon_models[i] != nullptr && !stricmp(Polygon_models[i]->filename, pm->filename)) {
+				Model_filename_index.emplace(pm->filename, i);
+				break;
+			}
+		}
+	}
+
 	model_free(pm);
 
 	Polygon_models[num] = NULL;	
@@ -392,6 +427,51 @@ void model_page_in_stop()
 	}
 }
 
+void model_load_batch_start()
+{
+	++Model_load_batch_depth;
+}
+
+void model_load_batch_stop()
+{
+	Assertion(Model_load_batch_depth > 0, "model_load_batch_stop() called without model_load_batch_start()!");
+
+	if (--Model_load_batch_depth > 0) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::ModelLoadBatchWait);
+
+	for (auto& deferred : Model_deferred_trees) {
+		threading::wait_for(deferred->done);
+
+		int num = deferred->model_id % MAX_POLYGON_MODELS;
+		polymodel* pm = Polygon_models[num];
+		bool still_loaded = (pm != nullptr && pm->id == deferred->model_id);
+
+		for (int i = 0; i < static_cast<int>(deferred->trees.size()); ++i) {
+			int tree_index = model_create_bsp_collision_tree();
+			auto tree = model_get_bsp_collision_tree(tree_index);
+
+			*tree = std::move(deferred->trees[i]);
+			tree->used = true;
+
+			// the model was unloaded again before its trees were done
+			if (still_loaded) {
+				pm->submodel[i].collision_tree_index = tree_index;
+			} else {
+				model_remove_bsp_collision_tree(tree_index);
+			}
+		}
+
+		if (still_loaded) {
+			model_cache_save_collision_trees(pm);
+		}
+	}
+
+	Model_deferred_trees.clear();
+}
+
 void model_init()
 {
 	int i;
@@ -404,6 +484,7 @@ void model_init()
 	for (i=0;i<MAX_POLYGON_MODELS;i++) {
 		Polygon_models[i] = NULL;
 	}
+	Model_filename_index.clear();
 
 	model_initted = 1;
 }
@@ -3220,6 +3301,35 @@ void model_load_texture(polymodel *pm, int i, const char *file)
 }
 
 //returns the number of the pof tech model if specified, otherwise number of pof model
+static void model_parse_collision_tree(bsp_collision_tree* tree, ubyte* bsp_data, int bsp_data_size, int version)
+{
+	Macro_ubyte_bounds = bsp_data + bsp_data_size;
+	model_collide_parse_bsp(tree, bsp_data, version);
+	Macro_ubyte_bounds = nullptr;
+}
+
+// Hands building the collision trees of pm to the worker threads, model_load_batch_stop() puts them in place
+static void model_defer_collision_trees(const polymodel* pm)
+{
+	auto deferred = new model_deferred_trees();
+	Model_deferred_trees.emplace_back(deferred);
+
+	deferred->model_id = pm->id;
+	deferred->version = pm->version;
+	deferred->trees.resize(pm->n_models);
+
+	for (int i = 0; i < pm->n_models; ++i) {
+		deferred->bsp_data.push_back(pm->submodel[i].bsp_data);
+		deferred->bsp_data_size.push_back(pm->submodel[i].bsp_data_size);
+	}
+
+	threading::submit_job([deferred]() {
+		for (size_t i = 0; i < deferred->trees.size(); ++i) {
+			model_parse_collision_tree(&deferred->trees[i], deferred->bsp_data[i].get(), deferred->bsp_data_size[i], deferred->version);
+		}
+	}, &deferred->done);
+}
+
 int model_load(ship_info* sip, bool prefer_tech_model)
 {
 	if (prefer_tech_model && VALID_FNAME(sip->pof_file_tech)) {
@@ -3248,20 +3358,25 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 		subsystems = sip->subsystems.get();
 	}
 
+	if (!allow_redundant_load) {
+		auto index = Model_filename_index.find(filename);
+		if (index != Model_filename_index.end()) {
+			// Model already loaded; just return.
+			auto loaded = Polygon_models[index->second];
+			loaded->used_this_mission++;
+			if (sip != nullptr)
+				sip->model_num = loaded->id;
+			return loaded->id;
+		}
+	}
+
 	num = -1;
 
 	for (i=0; i< MAX_POLYGON_MODELS; i++)	{
-		if ( Polygon_models[i] )	{
-			if (!stricmp(filename , Polygon_models[i]->filename) && !allow_redundant_load) {
-				// Model already loaded; just return.
-				Polygon_models[i]->used_this_mission++;
-				if (sip != nullptr)
-					sip->model_num = Polygon_models[i]->id;
-				return Polygon_models[i]->id;
-			}
-		} else if ( num == -1 )	{
+		if ( !Polygon_models[i] )	{
 			// This is the first empty slot
 			num = i;
+			break;
 		}
 	}
 
@@ -3328,6 +3443,9 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 
 	pm->used_this_mission++;
 
+	// the first copy of a model stays the one found by filename
+	Model_filename_index.emplace(pm->filename, num);
+
 #ifdef _DEBUG
 	if(Fred_running && Parse_normal_problem_count > 0)
 	{
@@ -3488,13 +3606,19 @@ int model_load(const  char* filename, ship_info* sip, ErrorType error_type, bool
 
 	TRACE_SCOPE(tracing::ModelParseAllBSPTrees);
 
-	for (i = 0; i < pm->n_models; ++i) {
-		pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
-		bsp_collision_tree* tree             = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
+	if (!model_cache_load_collision_trees(pm)) {
+		if (Model_load_batch_depth > 0 && threading::is_threading()) {
+			model_defer_collision_trees(pm);
+		} else {
+			for (i = 0; i < pm->n_models; ++i) {
+				pm->submodel[i].collision_tree_index = model_create_bsp_collision_tree();
+				bsp_collision_tree* tree             = model_get_bsp_collision_tree(pm->submodel[i].collision_tree_index);
 
-		Macro_ubyte_bounds = pm->submodel[i].bsp_data.get() + pm->submodel[i].bsp_data_size;
-		model_collide_parse_bsp(tree, pm->submodel[i].bsp_data.get(), pm->version);
-		Macro_ubyte_bounds = nullptr;
+				model_parse_collision_tree(tree, pm->submodel[i].bsp_data.get(), pm->submodel[i].bsp_data_size, pm->version);
+			}
+
+			model_cache_save_collision_trees(pm);
+		}
 	}
 
 	// Find the core_radius... the minimum of 
@@ -37,6 +37,7 @@
 #include "ship/shipfx.h"
 #include "starfield/starfield.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/weapon.h"
 
 #include <algorithm>
@@ -194,6 +195,11 @@ model_render_params::model_render_params() :
 	gr_init_color(&Color, 0, 0, 0);
 }
 
+std::unique_ptr<model_render_params> model_render_params::clone() const
+{
+	return std::unique_ptr<model_render_params>(new model_render_params(*this));
+}
+
 uint64_t model_render_params::get_model_flags() const
 {
 	return Model_flags; 
@@ -485,6 +491,15 @@ size_t model_batch_buffer::get_buffer_offset() const
 	return Current_offset;
 }
 
+size_t model_batch_buffer::append(const model_batch_buffer &other)
+{
+	auto base = Submodel_matrices.size();
+
+	Submodel_matrices.insert(Submodel_matrices.end(), other.Submodel_matrices.begin(), other.Submodel_matrices.end());
+
+	return base;
+}
+
 void model_batch_buffer::allocate_memory()
 {
 	auto size = Submodel_matrices.size() * sizeof(matrix4);
@@ -512,11 +527,153 @@ void model_batch_buffer::submit_buffer_data()
 	gr_update_transform_buffer(Mem_alloc, Mem_alloc_size);
 }
 
+// Bits of the base map in a draw sort key, enough for the first 64 bmpman blocks
+constexpr int DRAW_SORT_BASE_MAP_BITS = 18;
+
+/**
+ * Turns a bitmap handle into a number which fits in DRAW_SORT_BASE_MAP_BITS. The lower 16 bits of a handle are the
+ * index in its bmpman block, which is never more than 12 bits, and the upper 16 bits are the block number. Both are
+ * kept, so that textures at the same index of different blocks don't get mixed up.
+ */
+static int model_draw_sort_texture(int handle)
+{
+	if (handle < 0) {
+		return 0;
+	}
+
+	int texture = (((handle >> 16) << 12) | (handle & 0xFFF)) + 1;
+	Assertion(texture < (1 << DRAW_SORT_BASE_MAP_BITS), "Bitmap handle %d doesn't fit into a draw sort key!", handle);
+
+	return texture;
+}
+
+/**
+ * Packs the state a model draw should be grouped by into a sort key. From the most significant bits down: shader flags
+ * (17 bits), vertex buffer (13), index buffer (8), base map (18) and an 8 bit hash of all other maps.
+ */
+static uint64_t model_draw_sort_key(const queued_buffer_draw& draw)
+{
+	uint64_t other_maps = 0;
+	for (int type = 0; type < TM_NUM_TYPES; ++type) {
+		if (type != TM_BASE_TYPE) {
+			other_maps = other_maps * 31 + static_cast<uint32_t>(draw.render_material.get_texture_map(type) + 1);
+		}
+	}
+	other_maps = (other_maps * 0x9E3779B97F4A7C15ULL) >> 56;
+
+	return draw_sort_key_field(draw.sdr_flags, 17, 47)
+		| draw_sort_key_field(draw.vert_src->Vbuffer_handle.value() + 1, 13, 34)
+		| draw_sort_key_field(draw.vert_src->Ibuffer_handle.value() + 1, 8, 26)
+		| draw_sort_key_field(model_draw_sort_texture(draw.render_material.get_texture_map(TM_BASE_TYPE)), DRAW_SORT_BASE_MAP_BITS, 8)
+		| other_maps;
+}
+
+static void model_render_queue_buffers(model_draw_list* scene, queued_model_render* model);
+
 model_draw_list::model_draw_list()
 {
 	reset();
 }
 
+model_draw_list::model_draw_list(const model_draw_list* parent)
+{
+	// the shared batch buffer belongs to the parent while the sub-lists are filled
+	_batchBuffer = &_ownBatchBuffer;
+
+	reset();
+
+	_lights.copyLights(parent->_lights);
+	_scale = parent->_scale;
+}
+
+void model_draw_list::merge(model_draw_list& sub_list)
+{
+	auto transform_base = _batchBuffer->append(*sub_list._batchBuffer);
+	auto light_base = _lights.appendBufferedLights(sub_list._lights);
+
+	for (size_t i = 0; i < sub_list._elements.size(); ++i) {
+		auto& draw = sub_list._elements[i];
+
+		if (draw.transform_buffer_offset != INVALID_SIZE) {
+			draw.transform_buffer_offset += transform_base;
+		}
+		if (draw.lights.num_lights > 0) {
+			draw.lights.index_start += light_base;
+		}
+
+		push_element(std::move(draw), sub_list._sort_keys[i]);
+	}
+
+	Arcs.insert(Arcs.end(), sub_list.Arcs.begin(), sub_list.Arcs.end());
+	Insignias.insert(Insignias.end(), sub_list.Insignias.begin(), sub_list.Insignias.end());
+	Outlines.insert(Outlines.end(), sub_list.Outlines.begin(), sub_list.Outlines.end());
+}
+
+void model_draw_list::set_defer_models(bool defer)
+{
+	Assertion(defer || _deferred_models.empty(), "Deferred models have to be queued before deferring is turned off!");
+
+	_defer_models = defer;
+}
+
+bool model_draw_list::is_deferring_models() const
+{
+	return _defer_models;
+}
+
+void model_draw_list::defer_model(queued_model_render&& model)
+{
+	Assertion(_defer_models, "Models may only be deferred after set_defer_models(true)!");
+
+	_deferred_models.push_back(std::move(model));
+}
+
+void model_draw_list::queue_deferred_models()
+{
+	// Below this a sub-list costs more to set up and merge than queuing the models saves
+	constexpr size_t MIN_MODELS_PER_SUB_LIST = 16;
+
+	if (_deferred_models.empty()) {
+		return;
+	}
+
+	TRACE_SCOPE(tracing::QueueDeferredModels);
+
+	auto num_models = _deferred_models.size();
+	auto num_sub_lists = std::min((num_models + MIN_MODELS_PER_SUB_LIST - 1) / MIN_MODELS_PER_SUB_LIST, 2 * (threading::get_num_workers() + 1));
+	auto models_per_list = (num_models + num_sub_lists - 1) / num_sub_lists;
+
+	// the sub-lists share the light grid instead of each building their own
+	_lights.prepareLightFilter();
+
+	SCP_vector<std::unique_ptr<model_draw_list>> sub_lists;
+	for (size_t i = 0; i < num_sub_lists; ++i) {
+		sub_lists.emplace_back(new model_draw_list(this));
+	}
+
+	threading::parallel_for(num_sub_lists, 1, [&](size_t begin, size_t end) {
+		for (size_t list = begin; list < end; ++list) {
+			auto sub_list = sub_lists[list].get();
+			auto last = std::min(num_models, (list + 1) * models_per_list);
+
+			for (size_t i = list * models_per_list; i < last; ++i) {
+				auto& model = _deferred_models[i];
+
+				sub_list->push_transform(model.base_transform);
+				model_render_queue_buffers(sub_list, &model);
+				sub_list->pop_transform();
+			}
+		}
+	});
+
+	// merging in order keeps the deferred models in the order they were deferred in
+	for (auto& sub_list : sub_lists) {
+		merge(*sub_list);
+	}
+
+	_deferred_models.clear();
+}
+
 void model_draw_list::add_arc(const vec3d *v1, const vec3d *v2, const SCP_vector<vec3d> *persistent_arc_points, const color *primary, const color *secondary, float arc_width, ubyte segment_depth)
 {
 	arc_effect new_arc;
@@ -565,7 +722,7 @@ void model_draw_list::add_buffer_draw(const model_material *render_material, con
 		draw_data.scale.xyz.y = 1.0f;
 		draw_data.scale.xyz.z = 1.0f;
 
-		draw_data.transform_buffer_offset = _batchBuffer.get_buffer_offset();
+		draw_data.transform_buffer_offset = _batchBuffer->get_buffer_offset();
 
 		draw_data.render_material.set_batching(true);
 	} else {
@@ -583,7 +740,8 @@ void model_draw_list::add_buffer_draw(const model_material *render_material, con
 	draw_data.flags = tmap_flags;
 	draw_data.lights = Current_lights_set;
 
-	push_element(std::move(draw_data));
+	auto sort_key = model_draw_sort_key(draw_data);
+	push_element(std::move(draw_data), sort_key);
 }
 
 void model_draw_list::render_buffer(const queued_buffer_draw &render_elements)
@@ -748,57 +906,6 @@ void model_draw_list::render_outline(const outline_draw &outline_info)
 	g3_done_instance(true);
 }
 
-bool model_draw_list::sort_draw_pair(int a, int b) const
-{
-	auto draw_call_a = &_elements[a];
-	auto draw_call_b = &_elements[b];
-
-	if ( draw_call_a->sdr_flags != draw_call_b->sdr_flags ) {
-		return draw_call_a->sdr_flags < draw_call_b->sdr_flags;
-	}
-
-	if ( draw_call_a->vert_src->Vbuffer_handle != draw_call_b->vert_src->Vbuffer_handle ) {
-		return draw_call_a->vert_src->Vbuffer_handle.value() < draw_call_b->vert_src->Vbuffer_handle.value();
-	}
-
-	if ( draw_call_a->vert_src->Ibuffer_handle != draw_call_b->vert_src->Ibuffer_handle ) {
-		return draw_call_a->vert_src->Ibuffer_handle.value() < draw_call_b->vert_src->Ibuffer_handle.value();
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) != draw_call_b->render_material.get_texture_map(TM_BASE_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_BASE_TYPE) < draw_call_b->render_material.get_texture_map(TM_BASE_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPECULAR_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPECULAR_TYPE);
-	}
-	
-	if ( draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) != draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE) < draw_call_b->render_material.get_texture_map(TM_SPEC_GLOSS_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) != draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_GLOW_TYPE) < draw_call_b->render_material.get_texture_map(TM_GLOW_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) != draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_NORMAL_TYPE) < draw_call_b->render_material.get_texture_map(TM_NORMAL_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) != draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_HEIGHT_TYPE) < draw_call_b->render_material.get_texture_map(TM_HEIGHT_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) != draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_AMBIENT_TYPE) < draw_call_b->render_material.get_texture_map(TM_AMBIENT_TYPE);
-	}
-
-	if ( draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) != draw_call_b->render_material.get_texture_map(TM_MISC_TYPE) ) {
-		return draw_call_a->render_material.get_texture_map(TM_MISC_TYPE) < draw_call_b->render_material.get_texture_map(TM_MISC_TYPE);
-	}
-
-	return draw_call_a->lights.index_start < draw_call_b->lights.index_start;
-}
 void model_draw_list::build_uniform_buffer() {
 	GR_DEBUG_SCOPE("Build model uniform buffer");
 
@@ -2666,6 +2773,142 @@ void model_render_immediate(const model_render_params* render_info, int model_nu
 	}
 }
 
+/**
+ * Whether model_render_queue_buffers() may run for this model on a worker thread
+ *
+ * Lightning arcs pick their colors with the global random number generator, so models which have any are always
+ * queued right away.
+ */
+static bool model_render_can_defer(const polymodel* pm, const polymodel_instance* pmi)
+{
+	if ( pmi == nullptr ) {
+		return true;
+	}
+
+	for ( int i = 0; i < pm->n_models; i++ ) {
+		if ( !pmi->submodel[i].electrical_arcs.empty() ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Queues the buffers of all submodels of a model, which is the part of model_render_queue() that only reads the model
+ * and writes to the scene. This runs on a worker thread if the model was deferred, see model_draw_list::defer_model().
+ */
+static void model_render_queue_buffers(model_draw_list* scene, queued_model_render* model)
+{
+	int i;
+
+	const model_render_params* interp = model->interp;
+	const polymodel* pm = model->pm;
+	const polymodel_instance* pmi = model->pmi;
+	model_material& rendering_material = model->material;
+	const int detail_level = model->detail_level;
+	uint tmap_flags = model->tmap_flags;
+
+	const uint64_t model_flags = interp->get_model_flags();
+
+	bool is_outlines_only = (model_flags & MR_NO_POLYS) && ((model_flags & MR_SHOW_OUTLINE_PRESET) || (model_flags & MR_SHOW_OUTLINE));
+	bool is_outlines_only_htl = (model_flags & MR_NO_POLYS) && (model_flags & MR_SHOW_OUTLINE_HTL);
+
+	if ( !(model_flags & MR_NO_LIGHTING) ) {
+		scene->set_light_filter(&model->pos, pm->rad);
+	}
+
+	scene->push_transform(&model->pos, &model->orient);
+
+	if ( model->set_autocen ) {
+		scene->push_transform(&model->auto_back, NULL);
+	}
+
+	if ( (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) ) {
+		scene->start_model_batch(pm->n_models);
+		model_render_buffers(scene, &rendering_material, interp, &pm->detail_buffers[detail_level], pm, -1, detail_level, tmap_flags);
+	}
+		
+	// Draw the subobjects
+	bool draw_thrusters = false;
+	bool trans_buffer = false;
+	i = pm->submodel[pm->detail[detail_level]].first_child;
+
+	while( i >= 0 )	{
+		if ( !pm->submodel[i].flags[Model::Submodel_flags::Is_thruster] ) {
+			model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+		} else {
+			draw_thrusters = true;
+		}
+
+		i = pm->submodel[i].next_sibling;
+	}
+
+	//*************************** draw the hull of the ship *********************************************
+	vec3d view_pos = scene->get_view_position();
+
+	if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
+		int detail_model_num = pm->detail[detail_level];
+
+		if ( (is_outlines_only || is_outlines_only_htl) && pm->submodel[detail_model_num].outline_buffer != NULL ) {
+			color outline_color = interp->get_color();
+			scene->add_outline(pm->submodel[detail_model_num].outline_buffer.get(), pm->submodel[detail_model_num].n_verts_outline, &outline_color);
+		} else {
+			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].buffer, pm, detail_model_num, detail_level, tmap_flags);
+
+			if ( pmi != nullptr && !pmi->submodel[detail_model_num].electrical_arcs.empty() ) {
+				model_render_add_lightning( scene, interp, pm, &pmi->submodel[detail_model_num] );
+			}
+		}
+	}
+	
+	// make sure batch rendering is unconditionally off.
+	tmap_flags &= ~TMAP_FLAG_BATCH_TRANSFORMS;
+
+	if ( pm->flags & PM_FLAG_TRANS_BUFFER && !(is_outlines_only || is_outlines_only_htl) ) {
+		trans_buffer = true;
+		i = pm->submodel[pm->detail[detail_level]].first_child;
+
+		while( i >= 0 )	{
+			if ( !pm->submodel[i].flags[Model::Submodel_flags::Is_thruster] ) {
+				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+			}
+
+			i = pm->submodel[i].next_sibling;
+		}
+
+		view_pos = scene->get_view_position();
+
+		if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
+			int detail_model_num = pm->detail[detail_level];
+			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].trans_buffer, pm, detail_model_num, detail_level, tmap_flags);
+		}
+	}
+
+	// Draw the thruster subobjects
+	if ( draw_thrusters && !(is_outlines_only || is_outlines_only_htl) ) {
+		i = pm->submodel[pm->detail[detail_level]].first_child;
+		trans_buffer = false;
+
+		while( i >= 0 ) {
+			if (pm->submodel[i].flags[Model::Submodel_flags::Is_thruster]) {
+				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
+			}
+			i = pm->submodel[i].next_sibling;
+		}
+	}
+
+	if ( model->add_insignia ) {
+		scene->add_insignia(interp, pm, detail_level, interp->get_insignia_bitmap());
+	}
+
+	if ( (model_flags & MR_AUTOCENTER) && (model->set_autocen) ) {
+		scene->pop_transform();
+	}
+
+	scene->pop_transform();
+}
+
 void model_render_queue(const model_render_params* interp, model_draw_list* scene, int model_num, const matrix* orient, const vec3d* pos)
 {
 	model_render_queue(interp, scene, model_num, -1, orient, pos);
@@ -2678,7 +2921,8 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 	const int objnum = interp->get_object_number();
 	const uint64_t model_flags = interp->get_model_flags();
 
-	model_material rendering_material;
+	queued_model_render queued_model;
+	auto& rendering_material = queued_model.material;
 	polymodel *pm = model_get(model_num);
 	polymodel_instance *pmi = NULL;
 		
@@ -2707,10 +2951,6 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 
 	model_render_set_glow_points(pm, objnum);
 
-	if ( !(model_flags & MR_NO_LIGHTING) ) {
-		scene->set_light_filter(pos, pm->rad);
-	}
-
 	ship *shipp = nullptr;
 	object *objp = nullptr;
 
@@ -2788,8 +3028,6 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 		depth = model_render_determine_depth(objnum, model_num, orient, pos, interp->get_detail_level_lock());
 	}
 
-	scene->push_transform(pos, orient);
-
 	int detail_level = model_render_determine_detail(depth, model_num, interp->get_detail_level_lock());
 
 	// Send the detail level to the lab for displaying
@@ -2809,10 +3047,6 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 	
 	vec3d auto_back = ZERO_VECTOR;
 	bool set_autocen = model_render_determine_autocenter(&auto_back, pm, detail_level, model_flags);
-	
-	if ( set_autocen ) {
-		scene->push_transform(&auto_back, NULL);
-	}
 
 	// if we're in nebula mode, fog everything except for the warp holes and other non-fogged models
 	if ( (The_mission.flags[Mission::Mission_Flags::Fullneb]) && (Neb2_render_mode != NEB2_RENDER_NONE) && !(model_flags & MR_NO_FOGGING) ) {
@@ -2894,82 +3128,8 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 		tmap_flags |= TMAP_FLAG_BATCH_TRANSFORMS;
 	}
 
-	if ( (tmap_flags & TMAP_FLAG_BATCH_TRANSFORMS) ) {
-		scene->start_model_batch(pm->n_models);
-		model_render_buffers(scene, &rendering_material, interp, &pm->detail_buffers[detail_level], pm, -1, detail_level, tmap_flags);
-	}
-		
-	// Draw the subobjects
-	bool draw_thrusters = false;
-	bool trans_buffer = false;
-	i = pm->submodel[pm->detail[detail_level]].first_child;
-
-	while( i >= 0 )	{
-		if ( !pm->submodel[i].flags[Model::Submodel_flags::Is_thruster] ) {
-			model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-		} else {
-			draw_thrusters = true;
-		}
-
-		i = pm->submodel[i].next_sibling;
-	}
-
 	model_radius = pm->submodel[pm->detail[detail_level]].rad;
 
-	//*************************** draw the hull of the ship *********************************************
-	vec3d view_pos = scene->get_view_position();
-
-	if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
-		int detail_model_num = pm->detail[detail_level];
-
-		if ( (is_outlines_only || is_outlines_only_htl) && pm->submodel[detail_model_num].outline_buffer != NULL ) {
-			color outline_color = interp->get_color();
-			scene->add_outline(pm->submodel[detail_model_num].outline_buffer.get(), pm->submodel[detail_model_num].n_verts_outline, &outline_color);
-		} else {
-			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].buffer, pm, detail_model_num, detail_level, tmap_flags);
-
-			if ( pmi != nullptr && !pmi->submodel[detail_model_num].electrical_arcs.empty() ) {
-				model_render_add_lightning( scene, interp, pm, &pmi->submodel[detail_model_num] );
-			}
-		}
-	}
-	
-	// make sure batch rendering is unconditionally off.
-	tmap_flags &= ~TMAP_FLAG_BATCH_TRANSFORMS;
-
-	if ( pm->flags & PM_FLAG_TRANS_BUFFER && !(is_outlines_only || is_outlines_only_htl) ) {
-		trans_buffer = true;
-		i = pm->submodel[pm->detail[detail_level]].first_child;
-
-		while( i >= 0 )	{
-			if ( !pm->submodel[i].flags[Model::Submodel_flags::Is_thruster] ) {
-				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-			}
-
-			i = pm->submodel[i].next_sibling;
-		}
-
-		view_pos = scene->get_view_position();
-
-		if ( model_render_check_detail_box(&view_pos, pm, pm->detail[detail_level], model_flags) ) {
-			int detail_model_num = pm->detail[detail_level];
-			model_render_buffers(scene, &rendering_material, interp, &pm->submodel[detail_model_num].trans_buffer, pm, detail_model_num, detail_level, tmap_flags);
-		}
-	}
-
-	// Draw the thruster subobjects
-	if ( draw_thrusters && !(is_outlines_only || is_outlines_only_htl) ) {
-		i = pm->submodel[pm->detail[detail_level]].first_child;
-		trans_buffer = false;
-
-		while( i >= 0 ) {
-			if (pm->submodel[i].flags[Model::Submodel_flags::Is_thruster]) {
-				model_render_children_buffers( scene, &rendering_material, interp, pm, pmi, i, detail_level, tmap_flags, trans_buffer );
-			}
-			i = pm->submodel[i].next_sibling;
-		}
-	}
-
 	// MARKED!
 	if ( !( model_flags & MR_NO_TEXTURING ) && !( model_flags & MR_NO_INSIGNIA) ) {
 		int bitmap_num = interp->get_insignia_bitmap();
@@ -2994,15 +3154,30 @@ void model_render_queue(const model_render_params* interp, model_draw_list* scen
 				decals::addSingleFrameDecal(std::move(decal));
 			}
 		} else {
-			scene->add_insignia(interp, pm, detail_level, bitmap_num);
+			queued_model.add_insignia = true;
 		}
 	}
 
-	if ( (model_flags & MR_AUTOCENTER) && (set_autocen) ) {
-		scene->pop_transform();
-	}
+	queued_model.pm = pm;
+	queued_model.pmi = pmi;
+	queued_model.detail_level = detail_level;
+	queued_model.tmap_flags = tmap_flags;
+	queued_model.pos = *pos;
+	queued_model.orient = (orient != nullptr) ? *orient : vmd_identity_matrix;
+	queued_model.auto_back = auto_back;
+	queued_model.set_autocen = set_autocen;
 
-	scene->pop_transform();
+	if ( scene->is_deferring_models() && model_render_can_defer(pm, pmi) ) {
+		queued_model.interp_copy = interp->clone();
+		queued_model.interp = queued_model.interp_copy.get();
+		queued_model.base_transform = scene->get_transform();
+
+		scene->defer_model(std::move(queued_model));
+	} else {
+		queued_model.interp = interp;
+
+		model_render_queue_buffers(scene, &queued_model);
+	}
 
 	// start rendering glow points -Bobboau
 	if ( (pm->n_glow_point_banks) && !is_outlines_only && !is_outlines_only_htl && !Glowpoint_override ) {
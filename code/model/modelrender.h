@@ -109,11 +109,14 @@ class model_render_params
 	bool Use_alpha_mult;
 	float Alpha_mult;
 
-	model_render_params(const model_render_params&) = delete;
+	// only clone() copies, so that the parameters are not copied around by accident
+	model_render_params(const model_render_params&) = default;
 	model_render_params& operator=(const model_render_params&) = delete;
 public:
 	model_render_params();
 
+	std::unique_ptr<model_render_params> clone() const;
+
 	void set_flags(uint64_t flags);
 	void set_debug_flags(uint flags);
 	void set_object_number(int num);
@@ -252,6 +255,28 @@ struct outline_draw
 	color clr;
 };
 
+// Everything model_render_queue() has worked out about a model before it queues the buffers of its submodels
+struct queued_model_render
+{
+	const model_render_params* interp = nullptr;
+	std::unique_ptr<model_render_params> interp_copy; // owns interp if the model was deferred
+
+	model_material material;
+
+	const polymodel* pm = nullptr;
+	const polymodel_instance* pmi = nullptr;
+	int detail_level = 0;
+	uint tmap_flags = 0;
+
+	matrix4 base_transform; // transform of the draw list when the model was deferred
+	vec3d pos;
+	matrix orient;
+
+	vec3d auto_back;
+	bool set_autocen = false;
+	bool add_insignia = false;
+};
+
 
 
 class model_draw_list : public render_queue<model_draw_list, queued_buffer_draw> {
@@ -269,7 +294,13 @@ class model_draw_list : public render_queue<model_draw_list, queued_buffer_draw>
 
 	void build_uniform_buffer();
 	void render_buffer(const queued_buffer_draw &render_elements);
-	bool sort_draw_pair(int a, int b) const;
+
+	bool _defer_models = false;
+	SCP_vector<queued_model_render> _deferred_models;
+
+	// Creates a list that is filled on a worker thread and later merged into parent
+	explicit model_draw_list(const model_draw_list* parent);
+	void merge(model_draw_list& sub_list);
 
 public:
 	model_draw_list();
@@ -295,6 +326,23 @@ public:
 
 	void set_light_filter(const vec3d *pos, float rad);
 
+	/**
+	 * @brief Lets model_render_queue() hand models to defer_model() instead of queuing their buffers right away
+	 *
+	 * @details All deferred models have to be queued with queue_deferred_models() before the list is sorted.
+	 */
+	void set_defer_models(bool defer);
+	bool is_deferring_models() const;
+	void defer_model(queued_model_render&& model);
+
+	/**
+	 * @brief Queues the buffers of all deferred models, split over the worker threads
+	 *
+	 * @details Every batch of models is queued into its own sub-list, which are then merged back in the order the
+	 * models were deferred.
+	 */
+	void queue_deferred_models();
+
 	void render_all(gr_zbuffer_type depth_mode = ZBUFFER_TYPE_DEFAULT);
 };
 
@@ -1,12 +1,17 @@
 #include "volumetrics.h"
 
 #include "bmpman/bmpman.h"
+#include "cfile/cfile.h"
 #include "mission/missionparse.h"
 #include "model/model.h"
 #include "parse/parselo.h"
 #include "render/3d.h"
+#include "utils/threading.h"
 
 #include <anl.h>
+#include <md5.h>
+
+#include <random>
 
 #define OFFSET_R 2
 #define OFFSET_G 1
@@ -14,6 +19,9 @@
 #define OFFSET_A 3
 #define COLOR_3D_ARRAY_POS(n, color, x, y, z) (z * n * n * 4 + y * n * 4 + x * 4 + OFFSET_##color)
 
+//Bump this whenever the voxelization changes so old cache files are not used anymore
+#define VOLUME_CACHE_VERSION 1
+
 volumetric_nebula::volumetric_nebula() { }
 
 volumetric_nebula& volumetric_nebula::parse_volumetric_nebula() {
@@ -400,10 +408,91 @@ static inline float getNebDistSquared(const ivec3& l, const ivec3& r, const vec3
 	return (dx < 0 ? 0 : dx) * scale.xyz.x * scale.xyz.x + (dy < 0 ? 0 : dy) * scale.xyz.y * scale.xyz.y + (dz < 0 ? 0 : dz) * scale.xyz.z * scale.xyz.z;
 }
 
-void volumetric_nebula::renderVolumeBitmap() {
-	Assertion(!hullPof.empty(), "Volumetric Nebula was not properly configured. Did you call parse_volumetric_nebula()?");
-	Assertion(!isVolumeBitmapValid(), "Volume bitmap was already rendered!");
+SCP_string volumetric_nebula::getVolumeCacheName() const {
+	// The volume only depends on the hull and the voxelization settings, so hash exactly those
+	CFILE* pof = cfopen(hullPof.c_str(), "rb", CF_TYPE_MODELS);
+	if (pof == nullptr)
+		return "";
+
+	MD5 md5;
+
+	size_t pofSize = 0;
+	if (auto pofData = cf_get_data_view(pof, &pofSize)) {
+		md5.update(static_cast<const char*>(pofData), static_cast<MD5::size_type>(pofSize));
+	} else {
+		SCP_vector<char> buffer(static_cast<size_t>(cfilelength(pof)));
+		if (!buffer.empty())
+			cfread(buffer.data(), 1, static_cast<int>(buffer.size()), pof);
+		md5.update(buffer.data(), static_cast<MD5::size_type>(buffer.size()));
+	}
+
+	cfclose(pof);
+
+	const int params[] = { VOLUME_CACHE_VERSION, resolution, oversampling, getVolumeBitmapSmoothingSteps() };
+	md5.update(reinterpret_cast<const char*>(params), sizeof(params));
+	md5.finalize();
+
+	return SCP_string("volumetric_nebula-") + md5.hexdigest() + ".bin";
+}
+
+bool volumetric_nebula::loadVolumeCache(const SCP_string& cacheName) {
+	CFILE* fp = cfopen(cacheName.c_str(), "rb", CF_TYPE_CACHE, false, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+	if (fp == nullptr)
+		return false;
+
+	const int n = 1 << resolution;
+	const int dataSize = n * n * n * 4;
+
+	int version = cfread_int(fp);
+	int cachedN = cfread_int(fp);
+	vec3d cachedSize;
+	cfread_vector(&cachedSize, fp);
+	float cachedUdfScale = cfread_float(fp);
+
+	if (version != VOLUME_CACHE_VERSION || cachedN != n || cfilelength(fp) - cftell(fp) != dataSize) {
+		mprintf(("Ignoring outdated volumetric nebula cache %s\n", cacheName.c_str()));
+		cfclose(fp);
+		return false;
+	}
+
+	volumeBitmapData = make_unique<ubyte[]>(dataSize);
+	bool success = cfread(volumeBitmapData.get(), dataSize, 1, fp) == 1;
+	cfclose(fp);
+
+	if (!success) {
+		volumeBitmapData = nullptr;
+		return false;
+	}
+
+	size = cachedSize;
+	udfScale = cachedUdfScale;
+	bb_min = pos - (size * 0.5f);
+	bb_max = pos + (size * 0.5f);
+
+	return true;
+}
+
+void volumetric_nebula::saveVolumeCache(const SCP_string& cacheName) const {
+	CFILE* fp = cfopen(cacheName.c_str(), "wb", CF_TYPE_CACHE, false, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+	if (fp == nullptr) {
+		mprintf(("Could not open volumetric nebula cache %s for writing!\n", cacheName.c_str()));
+		return;
+	}
+
+	const int n = 1 << resolution;
+
+	cfwrite_int(VOLUME_CACHE_VERSION, fp);
+	cfwrite_int(n, fp);
+	cfwrite_float(size.xyz.x, fp);
+	cfwrite_float(size.xyz.y, fp);
+	cfwrite_float(size.xyz.z, fp);
+	cfwrite_float(udfScale, fp);
+	cfwrite(volumeBitmapData.get(), n * n * n * 4, 1, fp);
 
+	cfclose(fp);
+}
+
+bool volumetric_nebula::voxelizeHull() {
 	int n = 1 << resolution;
 	int nSample = (n << (oversampling - 1)) + 1;
 	auto volumeSampleCache = make_unique<bool[]>(nSample * nSample * nSample);
@@ -411,7 +500,7 @@ void volumetric_nebula::renderVolumeBitmap() {
 	int modelnum = model_load(hullPof.c_str(), nullptr, ErrorType::NONE);
 	if (modelnum < 0) {
 		Warning(LOCATION, "Could not load model '%s'.  Unable to render volume bitmap!", hullPof.c_str());
-		return;
+		return false;
 	}
 
 	const polymodel* pm = model_get(modelnum);
@@ -423,60 +512,70 @@ void volumetric_nebula::renderVolumeBitmap() {
 	bb_min = pos - (size * 0.5f);
 	bb_max = pos + (size * 0.5f);
 
-	mc_info mc;
+	//Calculate minimum "bottom left" corner of scaled size box
+	vec3d bl = pm->mins - (size * ((scaleFactor - 1.0f) / 2.0f / scaleFactor));
+
+	const float sampleSteps = static_cast<float>(n << (oversampling - 1));
 
-	mc.model_num = modelnum;
-	mc.orient = &vmd_identity_matrix;
-	mc.pos = &vmd_zero_vector;
-	mc.p1 = &vmd_zero_vector;
+	//Go through sampling procedure to test where the nebula even is. Each ray only writes its own column, and the collision code keeps its state per thread.
+	threading::parallel_for(static_cast<size_t>(nSample), 1, [&](size_t begin, size_t end) {
+		mc_info mc;
 
-	mc.flags = MC_CHECK_MODEL | MC_COLLIDE_ALL | MC_CHECK_INVISIBLE_FACES;
+		mc.model_num = modelnum;
+		mc.orient = &vmd_identity_matrix;
+		mc.pos = &vmd_zero_vector;
+		mc.p1 = &vmd_zero_vector;
 
-	//Calculate minimum "bottom left" corner of scaled size box
-	vec3d bl = pm->mins - (size * ((scaleFactor - 1.0f) / 2.0f / scaleFactor));
+		mc.flags = MC_CHECK_MODEL | MC_COLLIDE_ALL | MC_CHECK_INVISIBLE_FACES;
 
-	//Go through sampling procedure to test where the nebula even is
-	for (int x = 0; x < nSample; x++) {
-		for (int y = 0; y < nSample; y++) {
-			vec3d start = bl;
-			start += vec3d{ {{static_cast<float>(x) * size.xyz.x / static_cast<float>(n << (oversampling - 1)),
-							 static_cast<float>(y) * size.xyz.y / static_cast<float>(n << (oversampling - 1)),
-							 0.0f }} };
-			vec3d end = start;
-			end.xyz.z += size.xyz.z;
-
-			mc.p0 = &start;
-			mc.p1 = &end;
-			mc.hit_points_all.clear();
-			mc.hit_submodels_all.clear();
-			model_collide(&mc);
-
-			//Annoying hack cause sometimes, if edges of polygons get too close to the ray, the collisions are missed / too many. At least find odd rays and fix those, since these are very visible
-			while (mc.hit_points_all.size() % 2 != 0) {
-				start += vec3d{ {{ size.xyz.x / static_cast<float>(n << (oversampling - 1)) * (Random::INV_F_MAX_VALUE * Random::next() - 0.5f),
-								  size.xyz.y / static_cast<float>(n << (oversampling - 1)) * (Random::INV_F_MAX_VALUE * Random::next() - 0.5f), 0.0f }} };
-				end += vec3d{ {{ size.xyz.x / static_cast<float>(n << (oversampling - 1)) * (Random::INV_F_MAX_VALUE * Random::next() - 0.5f),
-								size.xyz.y / static_cast<float>(n << (oversampling - 1)) * (Random::INV_F_MAX_VALUE * Random::next() - 0.5f), 0.0f }} };
+		SCP_vector<int> collisionZIndices;
+
+		for (int x = static_cast<int>(begin); x < static_cast<int>(end); x++) {
+			//The global RNG is not thread safe. Seeding by row also keeps the result independent of how the rows were split up.
+			std::minstd_rand jitterRng(static_cast<unsigned int>(x) + 1);
+			std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+			for (int y = 0; y < nSample; y++) {
+				vec3d start = bl;
+				start += vec3d{ {{static_cast<float>(x) * size.xyz.x / sampleSteps,
+								 static_cast<float>(y) * size.xyz.y / sampleSteps,
+								 0.0f }} };
+				vec3d end = start;
+				end.xyz.z += size.xyz.z;
+
+				mc.p0 = &start;
+				mc.p1 = &end;
 				mc.hit_points_all.clear();
 				mc.hit_submodels_all.clear();
 				model_collide(&mc);
-			}
 
-			SCP_multiset<int> collisionZIndices;
-			for(const vec3d& hitpnt : mc.hit_points_all)
-				collisionZIndices.emplace(static_cast<int>((hitpnt.xyz.z - bl.xyz.z) / size.xyz.z * static_cast<float>(n << (oversampling - 1))));
+				//Annoying hack cause sometimes, if edges of polygons get too close to the ray, the collisions are missed / too many. At least find odd rays and fix those, since these are very visible
+				while (mc.hit_points_all.size() % 2 != 0) {
+					start += vec3d{ {{ size.xyz.x / sampleSteps * jitter(jitterRng), size.xyz.y / sampleSteps * jitter(jitterRng), 0.0f }} };
+					end += vec3d{ {{ size.xyz.x / sampleSteps * jitter(jitterRng), size.xyz.y / sampleSteps * jitter(jitterRng), 0.0f }} };
+					mc.hit_points_all.clear();
+					mc.hit_submodels_all.clear();
+					model_collide(&mc);
+				}
 
-			size_t hitcnt = 0;
-			auto hitpntit = collisionZIndices.cbegin();
-			for (int z = 0; z < nSample; z++) {
-				while (hitpntit != collisionZIndices.cend() && *hitpntit < z) {
-					++hitpntit;
-					++hitcnt;
+				//Rays rarely hit more than a handful of faces, so sorting a vector beats building a tree
+				collisionZIndices.clear();
+				for (const vec3d& hitpnt : mc.hit_points_all)
+					collisionZIndices.push_back(static_cast<int>((hitpnt.xyz.z - bl.xyz.z) / size.xyz.z * sampleSteps));
+				std::sort(collisionZIndices.begin(), collisionZIndices.end());
+
+				size_t hitcnt = 0;
+				auto hitpntit = collisionZIndices.cbegin();
+				for (int z = 0; z < nSample; z++) {
+					while (hitpntit != collisionZIndices.cend() && *hitpntit < z) {
+						++hitpntit;
+						++hitcnt;
+					}
+					volumeSampleCache[x * nSample * nSample + y * nSample + z] = hitcnt % 2 != 0;
 				}
-				volumeSampleCache[x * nSample * nSample + y * nSample + z] = hitcnt % 2 != 0;
 			}
 		}
-	}
+	});
 
 	model_unload(modelnum);
 
@@ -489,24 +588,26 @@ void volumetric_nebula::renderVolumeBitmap() {
 	int smoothStart = smoothing_steps / 2;
 	int smoothStop = (smoothing_steps / 2 + (1 & smoothing_steps));
 
-	for (int x = 0; x < n; x++) {
-		for (int y = 0; y < n; y++) {
-			for (int z = 0; z < n; z++) {
-				int sum = 0;
-				for (int sx = x * oversamplingCount - smoothStart; sx < (x + 1) * oversamplingCount + smoothStop; sx++) {
-					for (int sy = y * oversamplingCount - smoothStart; sy < (y + 1) * oversamplingCount + smoothStop; sy++) {
-						for (int sz = z * oversamplingCount - smoothStart; sz < (z + 1) * oversamplingCount + smoothStop; sz++) {
-							if (sx >= 0 && sx < nSample && sy >= 0 && sy < nSample && sz >= 0 && sz < nSample &&
-								volumeSampleCache[sx * nSample * nSample + sy * nSample + sz])
-								sum++;
+	threading::parallel_for(static_cast<size_t>(n), 1, [&](size_t begin, size_t end) {
+		for (int x = static_cast<int>(begin); x < static_cast<int>(end); x++) {
+			for (int y = 0; y < n; y++) {
+				for (int z = 0; z < n; z++) {
+					int sum = 0;
+					for (int sx = x * oversamplingCount - smoothStart; sx < (x + 1) * oversamplingCount + smoothStop; sx++) {
+						for (int sy = y * oversamplingCount - smoothStart; sy < (y + 1) * oversamplingCount + smoothStop; sy++) {
+							for (int sz = z * oversamplingCount - smoothStart; sz < (z + 1) * oversamplingCount + smoothStop; sz++) {
+								if (sx >= 0 && sx < nSample && sy >= 0 && sy < nSample && sz >= 0 && sz < nSample &&
+									volumeSampleCache[sx * nSample * nSample + sy * nSample + sz])
+									sum++;
+							}
 						}
 					}
-				}
 
-				volumeBitmapData[COLOR_3D_ARRAY_POS(n, A, x, y, z)] = static_cast<ubyte>(static_cast<float>(sum) * oversamplingDivisor);
+					volumeBitmapData[COLOR_3D_ARRAY_POS(n, A, x, y, z)] = static_cast<ubyte>(static_cast<float>(sum) * oversamplingDivisor);
+				}
 			}
 		}
-	}
+	});
 
 	// Test for edges in the nebula to compute the UDF
 	auto volumeEdgeCache = make_unique<ivec3[]>(n * n * n);
@@ -582,6 +683,24 @@ void volumetric_nebula::renderVolumeBitmap() {
 		}
 	}
 
+	return true;
+}
+
+void volumetric_nebula::renderVolumeBitmap() {
+	Assertion(!hullPof.empty(), "Volumetric Nebula was not properly configured. Did you call parse_volumetric_nebula()?");
+	Assertion(!isVolumeBitmapValid(), "Volume bitmap was already rendered!");
+
+	int n = 1 << resolution;
+
+	SCP_string cacheName = getVolumeCacheName();
+	if (cacheName.empty() || !loadVolumeCache(cacheName)) {
+		if (!voxelizeHull())
+			return;
+
+		if (!cacheName.empty())
+			saveVolumeCache(cacheName);
+	}
+
 	volumeBitmapHandle = bm_create_3d(32, n, n, n, volumeBitmapData.get());
 
 	if (!noiseActive)
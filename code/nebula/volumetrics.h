@@ -85,6 +85,12 @@ class volumetric_nebula {
 
 	bool enabled = true;
 
+	//Volume bitmaps are cached in data/cache, keyed by the hull POF and the settings the volume depends on
+	SCP_string getVolumeCacheName() const;
+	bool loadVolumeCache(const SCP_string& cacheName);
+	void saveVolumeCache(const SCP_string& cacheName) const;
+	bool voxelizeHull();
+
 	//Friend things that are allowed to directly manipulate "current" volumetrics. Only FRED and the Lab. In all other cases, "sensibly constant" values behave properly RAII and stay constant afterwards.
 	friend class LabUi; //Lab
 	friend class Fred_mission_save; //FRED && QtFRED
@@ -1010,6 +1010,8 @@ void multi_process_bigdata(ubyte *data, int len, net_addr *from_addr, int reliab
 			return ;
 		}		
 
+		header_info.bytes_available = len - bytes_processed;
+
 		// perform any special processing checks here		
 		process_packet_normal(buf,&header_info, reliable != 0);
 		 
@@ -76,9 +76,10 @@ class player;
 // Version 60 - 3/27/2023 - Added generic lua data packet
 // Version 61 - 4/17/2023 - Added compatibility for whackable asteroids (added force)
 // Version 62 - 5/26/2025 - Added some modular curve input data to turret firing packets; 5/31/2025 - Added another input
+// Version 63 - 10/17/2026 - Delta encoded object update positions, object update acknowledgements and optional lz4 compression
 // STANDALONE_ONLY
 
-#define MULTI_FS_SERVER_VERSION							62
+#define MULTI_FS_SERVER_VERSION							63
 
 #define MULTI_FS_SERVER_COMPATIBLE_VERSION			MULTI_FS_SERVER_VERSION
 
@@ -394,6 +395,7 @@ constexpr int PLAYER_COLLISION_TIMESTAMP = 200; // how often the server should a
 // definition of header packet used in any protocol
 typedef struct header {
 	int		bytes_processed;											// used to determine how many bytes this packet was
+	int		bytes_available;											// how many received bytes are left, starting with this packet
 	ubyte		addr[sizeof(in6_addr)];														// obtained from network-layer header
 	uint16_t	port;															// obtained from network-layer header
 	short		id;															// will be stuffed with player_id (short)
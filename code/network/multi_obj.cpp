@@ -19,6 +19,7 @@
 #include "network/multimsgs.h"
 #include "network/multiutil.h"
 #include "network/multi_interpolate.h"
+#include "network/multi_oo_delta.h"
 #include "network/multi_options.h"
 #include "network/multi_rate.h"
 #include "network/multi.h"
@@ -31,6 +32,7 @@
 #include "physics/physics.h"
 #include "ship/afterburner.h"
 #include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
 #include "debugconsole/console.h"
 #include "object/waypoint.h"
 #include "weapon/weapon.h"
@@ -40,7 +42,7 @@
 // 
 
 extern const std::uint32_t MAX_TIME;
-constexpr int OO_MAIN_HEADER_SIZE = 9;  // two ints and a ubyte (recall! fix is basically an int)
+constexpr int OO_MAIN_HEADER_SIZE = 13;  // three ints and a ubyte (recall! fix is basically an int)
 
 
 // One frame record per ship with each contained array holding one element for each frame.
@@ -77,10 +79,13 @@ struct oo_info_sent_to_players {
 	SCP_vector<float> subsystem_x;
 	SCP_vector<float> subsystem_y;
 	SCP_vector<float> subsystem_z;
+
+	oo_position_history sent_positions;	// the position sections this player may have, as baselines for delta encoding
 };
 
 struct oo_netplayer_records{
 	SCP_vector<oo_info_sent_to_players> last_sent;			// Subcategory of which player did I send this info to?  Corresponds to net_player index.
+	oo_sent_packets sent_packets;							// the object update packets sent to this player that it may still acknowledge
 	// This is not yet implemented, but may be necessary for autoaim to work in more busy scenes.  Basically, if you're switching targets,
 	// autoaim may succeed on the client but head to the wrong target on the server.
 //	int player_target_record[MAX_FRAMES_RECORDED];			// For rollback, we need to keep track of the player's targets. Uses frame as its index.
@@ -135,6 +140,11 @@ struct oo_general_info {
 	SCP_vector<int>rollback_collide_list;					// the list of ships and weapons that we need to pass to collision detection during rollback.
 														
 	SCP_vector<const ship_registry_entry*> rotation_list;	// subsystem rotation
+
+	// delta encoded positions, client only
+	oo_packet_acks received_packets;						// the object update packets we got, sent back to the server
+	SCP_vector<oo_position_history> received_positions;		// the position sections we got for each ship. Uses net_signature as its index.
+	SCP_vector<ushort> resync_requests;						// ships we couldn't decode a delta for, so the server has to send them in full
 };
 
 oo_general_info Oo_info;
@@ -183,6 +193,7 @@ float multi_oo_calc_pos_time_difference(int player_id, int net_sig_idx);
 #define OO_PRIMARY_LINKED			(1<<9)		// if this is set, banks are linked
 #define OO_TRIGGER_DOWN				(1<<10)		// if this is set, trigger is DOWN
 #define OO_SUPPORT_SHIP				(1<<11)		// Send extra info for the support ship.
+#define OO_POS_AND_ORIENT_DELTA		(1<<12)		// The position section is delta encoded against one the client acknowledged
 
 #define OO_SBUSYS_ROTATION_CUTOFF	0.1f		// if the squared difference between the old and new angles is less than this, don't send.
 
@@ -968,6 +979,7 @@ void multi_oo_respawn_reset_info(object* objp)
 		player_record.last_sent[objp->net_signature].ai_submode = -1;
 		player_record.last_sent[objp->net_signature].target_signature = -1;
 		player_record.last_sent[objp->net_signature].perfect_shields_sent = false;
+		player_record.last_sent[objp->net_signature].sent_positions.clear();
 		for (int i = 0; i < (int)player_record.last_sent[objp->net_signature].subsystem_health.size(); i++) {
 			player_record.last_sent[objp->net_signature].subsystem_health[i] = -1.0f;
 			player_record.last_sent[objp->net_signature].subsystem_1b[i] = -1.0f;
@@ -1117,6 +1129,109 @@ constexpr int OO_MAX_DATA_SIZE = MAX_PACKET_SIZE - OO_MAIN_HEADER_SIZE - OO_SERV
 constexpr int OO_SAFE_BUFFER_SIZE = 10000; 
 constexpr int OO_LOCK_SIZE = 4; // from the 
 
+constexpr int OO_AI_FRAGMENT_SIZE = 6;			// mode, submode, target signature and weapon energy
+constexpr int OO_SUPPORT_FRAGMENT_SIZE = 18;	// ai flags, mode, submode and dock signature
+
+// The state of one subsystem as object updates send it
+struct oo_subsys_fragment {
+	float current_hits;
+	float health;			// current_hits / max_hits
+
+	bool has_angles_1;		// rotating subsystems with a first submodel
+	bool has_angles_2;		// rotating subsystems with a second submodel
+	bool has_offset;		// translating subsystems
+	angles angles_1;
+	angles angles_2;
+	vec3d offset;
+};
+
+// The sections of oo_ship_fragments, each one is encoded the first time a packet needs it
+constexpr uint OO_FRAGMENT_POSITION		= (1<<0);
+constexpr uint OO_FRAGMENT_HULL			= (1<<1);
+constexpr uint OO_FRAGMENT_SHIELDS		= (1<<2);
+constexpr uint OO_FRAGMENT_SUBSYSTEMS	= (1<<3);
+constexpr uint OO_FRAGMENT_AI			= (1<<4);
+constexpr uint OO_FRAGMENT_SUPPORT		= (1<<5);
+
+// Everything in an object update that doesn't depend on the player it is sent to. Each section is encoded the first
+// time a ship is packed with it in a frame, the packets for every other player only pick the sections they need and
+// copy them.
+struct oo_ship_fragments {
+	int generation = -1;		// Oo_fragment_generation this was encoded for
+	int signature = -1;			// object signature, since object slots get reused
+	uint encoded = 0;			// the OO_FRAGMENT_* sections that are encoded for this generation
+
+	ubyte pos_orient[OO_POSITION_SECTION_MAX_SIZE];
+	int pos_orient_size = 0;
+	int pos_bytes = 0;			// datarate tracking of the position section, split up like multi_oo_pack_data() always did
+	int ori_bytes = 0;
+	int fth_bytes = 0;
+	bool full_physics = false;
+
+	ubyte hull = 0;
+	SCP_vector<ubyte> shields;
+	SCP_vector<oo_subsys_fragment> subsystems;
+
+	ubyte ai[OO_AI_FRAGMENT_SIZE];
+
+	bool has_support = false;
+	ubyte support[OO_SUPPORT_FRAGMENT_SIZE];
+};
+
+// Encoded fragments by object number. Bumping the generation invalidates all of them, which happens every time
+// object updates go out, since the ships have moved in between.
+static SCP_vector<oo_ship_fragments> Oo_fragments;
+static int Oo_fragment_generation = 0;
+
+constexpr int OO_MAX_RESYNC_REQUESTS = 8;		// per control packet, the rest wait for the next one
+constexpr int OO_CLIENT_ACK_MAX_SIZE = 9 + (2 * OO_MAX_RESYNC_REQUESTS);	// acknowledged packets, resync count and signatures
+constexpr ubyte OO_COMPRESSED_BLOCK = 0xfe;		// stop byte value announcing an lz4 compressed block of ship updates
+
+// What object updates cost per ship and second for each client, with and without delta encoding and compression
+struct oo_bandwidth_stats {
+	uint64_t position_sections = 0;
+	uint64_t delta_sections = 0;
+	uint64_t absolute_bytes = 0;	// what the position sections would have taken without delta encoding
+	uint64_t position_bytes = 0;	// what they actually took
+	uint64_t resyncs = 0;
+	uint64_t packet_bytes = 0;		// object update packets before lz4 compression
+	uint64_t sent_bytes = 0;		// and after
+	double ship_seconds = 0.0;
+};
+
+static oo_bandwidth_stats Oo_bandwidth_stats;
+
+DCF(oo_bandwidth, "Reports object update bytes per ship per second, with and without compression (Multiplayer)")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: oo_bandwidth [reset]\n");
+		dc_printf("Reports what object updates sent by this server cost per ship, second and client\n");
+		dc_printf("\treset    Starts counting again\n");
+		return;
+	}
+
+	if (dc_optional_string("reset")) {
+		Oo_bandwidth_stats = oo_bandwidth_stats();
+		return;
+	}
+
+	const auto& stats = Oo_bandwidth_stats;
+	if (stats.ship_seconds <= 0.0) {
+		dc_printf("No object updates have been sent yet\n");
+		return;
+	}
+
+	// packets only ever contained delta encoded positions, so add back what the absolute ones would have cost
+	double absolute = static_cast<double>(stats.packet_bytes + stats.absolute_bytes - stats.position_bytes);
+
+	dc_printf("Without delta encoding: %.1f bytes/ship/second\n", absolute / stats.ship_seconds);
+	dc_printf("With delta encoding:    %.1f bytes/ship/second\n", static_cast<double>(stats.packet_bytes) / stats.ship_seconds);
+	dc_printf("As sent:                %.1f bytes/ship/second%s\n", static_cast<double>(stats.sent_bytes) / stats.ship_seconds,
+		Cmdline_compress_objupd ? " (lz4)" : "");
+	dc_printf("%llu of %llu position sections were deltas, %llu had to be sent again in full\n", static_cast<unsigned long long>(stats.delta_sections),
+		static_cast<unsigned long long>(stats.position_sections), static_cast<unsigned long long>(stats.resyncs));
+}
+
 // pack information for a client (myself), return bytes added
 int multi_oo_pack_client_data(ubyte *data, ship* shipp)
 {
@@ -1195,7 +1310,7 @@ int multi_oo_pack_client_data(ubyte *data, ship* shipp)
 	for (auto & lock : shipp->missile_locks) {
 		if (lock.locked) {
 			// Check to see if this lock will force us over the max.
-			if ((packet_size + sizeof(count) + (OO_LOCK_SIZE * (count+1))) >= OO_MAX_CLIENT_DATA_SIZE) {
+			if ((packet_size + sizeof(count) + (OO_LOCK_SIZE * (count+1))) >= OO_MAX_CLIENT_DATA_SIZE - OO_CLIENT_ACK_MAX_SIZE) {
 				break;
 			}
 
@@ -1220,6 +1335,19 @@ int multi_oo_pack_client_data(ubyte *data, ship* shipp)
 		ADD_USHORT(subsystems[i]);
 	}
 
+	// acknowledge the object updates we got, so the server knows which positions it can send deltas against
+	ADD_INT(Oo_info.received_packets.newest);
+	ADD_UINT(Oo_info.received_packets.mask);
+
+	// and ask for full positions of the ships we couldn't decode a delta for
+	auto resync_count = (ubyte)std::min(Oo_info.resync_requests.size(), (size_t)OO_MAX_RESYNC_REQUESTS);
+	ADD_DATA(resync_count);
+
+	for (int i = 0; i < resync_count; i++) {
+		ADD_USHORT(Oo_info.resync_requests[i]);
+	}
+	Oo_info.resync_requests.erase(Oo_info.resync_requests.begin(), Oo_info.resync_requests.begin() + resync_count);
+
 	return packet_size;
 }
 
@@ -1230,13 +1358,209 @@ int multi_oo_pack_client_data(ubyte *data, ship* shipp)
 #define PACK_USHORT(v) { std::uint16_t swap = INTEL_SHORT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint16_t) ); packet_size += sizeof(std::uint16_t); }
 #define PACK_INT(v) { std::int32_t swap = INTEL_INT(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::int32_t) ); packet_size += sizeof(std::int32_t); }
 #define PACK_ULONG(v) { std::uint64_t swap = INTEL_LONG(v); memcpy( data + packet_size + header_bytes, &swap, sizeof(std::uint64_t) ); packet_size += sizeof(std::uint64_t); }
+
+// get the encoded fragments of a ship for this round of object updates, encoding them if this is the first player to get it
+static const oo_ship_fragments& multi_oo_get_fragments(object *objp, uint sections)
+{
+	if (Oo_fragments.size() < MAX_OBJECTS) {
+		Oo_fragments.resize(MAX_OBJECTS);
+	}
+
+	oo_ship_fragments& frag = Oo_fragments[OBJ_INDEX(objp)];
+	if ((frag.generation != Oo_fragment_generation) || (frag.signature != objp->signature)) {
+		frag.generation = Oo_fragment_generation;
+		frag.signature = objp->signature;
+		frag.encoded = 0;
+	}
+
+	// only encode what isn't there yet
+	sections &= ~frag.encoded;
+	if (sections == 0) {
+		return frag;
+	}
+
+	frag.encoded |= sections;
+
+	ship *shipp = &Ships[objp->instance];
+	ship_info *sip = &Ship_info[shipp->ship_info_index];
+	ai_info *aip = &Ai_info[shipp->ai_index];
+
+	// the PACK macros write to data + packet_size + header_bytes
+	ubyte *data;
+	int packet_size;
+	const int header_bytes = 0;
+	float temp_float;
+	int ret;
+
+	// position, orientation, velocity, rotational velocity, desired velocity and desired rotational velocity
+	if (sections & OO_FRAGMENT_POSITION) {
+		data = frag.pos_orient;
+		packet_size = 0;
+
+		ret = multi_pack_unpack_position( 1, data + packet_size, &objp->pos );
+		packet_size += ret;
+		frag.pos_bytes = ret;
+
+		// orientation (now done via angles)
+		angles temp_angles;
+		vm_extract_angles_matrix_alternate(&temp_angles, &objp->orient);
+
+		ret = multi_pack_unpack_orient( 1, data + packet_size, &temp_angles );
+		packet_size += ret;
+		frag.ori_bytes = ret;
+
+		ret = multi_pack_unpack_vel( 1, data + packet_size, &objp->orient, &objp->phys_info );
+		packet_size += ret;
+		frag.pos_bytes += ret;
+
+		ret = multi_pack_unpack_rotvel( 1, data + packet_size, &objp->phys_info );
+		packet_size += ret;
+		frag.ori_bytes += ret;
+
+		// in order to send data by axis we must rotate the global velocity into local coordinates
+		vec3d local_desired_vel;
+		vm_vec_rotate(&local_desired_vel, &objp->phys_info.desired_vel, &objp->orient);
+
+		// is this a ship with full phyiscs? (just player-controled for now)
+		frag.full_physics = objp->flags[Object::Object_Flags::Player_ship];
+
+		ret = multi_pack_unpack_desired_vel_and_desired_rotvel( 1, frag.full_physics, data + packet_size, &objp->phys_info, &local_desired_vel );
+		packet_size += ret;
+		frag.fth_bytes = ret;
+
+		frag.pos_orient_size = packet_size;
+		Assertion(packet_size <= OO_POSITION_SECTION_MAX_SIZE, "The position section of an object update came up to %d bytes, more than the %d it should have. Please report!", packet_size, OO_POSITION_SECTION_MAX_SIZE);
+	}
+
+	// hull
+	if (sections & OO_FRAGMENT_HULL) {
+		data = &frag.hull;
+		packet_size = 0;
+
+		temp_float = get_hull_pct(objp);
+		if ((temp_float < 0.004f) && (temp_float > 0.0f)) {
+			temp_float = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
+		}
+		PACK_PERCENT(temp_float);
+	}
+
+	// shields
+	if (sections & OO_FRAGMENT_SHIELDS) {
+		frag.shields.resize(objp->shield_quadrant.size());
+		data = frag.shields.data();
+		packet_size = 0;
+
+		float quad = shield_get_max_quad(objp);
+		for (float temp_quadrant : objp->shield_quadrant) {
+			temp_float = temp_quadrant / quad;
+			PACK_PERCENT(temp_float);
+		}
+	}
+
+	// subsystems, which are compared against what each player got last before anything is packed
+	if (sections & OO_FRAGMENT_SUBSYSTEMS) {
+		frag.subsystems.clear();
+
+		for (ship_subsys* subsystem = GET_FIRST(&shipp->subsys_list); subsystem != END_OF_LIST(&shipp->subsys_list);
+			subsystem = GET_NEXT(subsystem)) {
+			oo_subsys_fragment subsys_frag{};
+
+			subsys_frag.current_hits = subsystem->current_hits;
+			if (subsystem->current_hits != 0.0f) {
+				subsys_frag.health = subsystem->current_hits / subsystem->max_hits;
+			}
+
+			if (subsystem->system_info->flags[Model::Subsystem_Flags::Rotates]) {
+				if (subsystem->submodel_instance_1) {
+					subsys_frag.has_angles_1 = true;
+					vm_extract_angles_matrix_alternate(&subsys_frag.angles_1, &subsystem->submodel_instance_1->canonical_orient);
+				}
+				if (subsystem->submodel_instance_2) {
+					subsys_frag.has_angles_2 = true;
+					vm_extract_angles_matrix_alternate(&subsys_frag.angles_2, &subsystem->submodel_instance_2->canonical_orient);
+				}
+			}
+
+			if (subsystem->system_info->flags[Model::Subsystem_Flags::Translates] && subsystem->submodel_instance_1) {
+				subsys_frag.has_offset = true;
+				subsys_frag.offset = subsystem->submodel_instance_1->canonical_offset;
+			}
+
+			frag.subsystems.push_back(subsys_frag);
+		}
+	}
+
+	// ai mode info
+	if (sections & OO_FRAGMENT_AI) {
+		data = frag.ai;
+		packet_size = 0;
+
+		auto umode = (ubyte)(aip->mode);
+		auto submode = (short)(aip->submode);
+		ushort target_signature = 0;
+
+		// either send out the waypoint they are trying to get to *or* their current target.
+		if (umode == AIM_WAYPOINTS) {
+			// if it's already started pointing to a waypoint, grab its net_signature and send that instead
+			waypoint* wp;
+			if ((wp = find_waypoint_at_indexes(aip->wp_list_index, aip->wp_index)) != nullptr) {
+				target_signature = Objects[wp->get_objnum()].net_signature;
+			}
+		} else if (aip->target_objnum >= 0) {
+			// prefer live target_objnum so clients can check both ordered goal targets and spontaneous targets
+			target_signature = Objects[aip->target_objnum].net_signature;
+		}  else if ((aip->goals[0].target_name != nullptr) && strlen(aip->goals[0].target_name) != 0) {
+			// send the target signature. 2021 Version!
+			int instance = ship_name_lookup(aip->goals[0].target_name);
+			if (instance > -1) {
+				target_signature = Objects[Ships[instance].objnum].net_signature;
+			}
+		}
+
+		PACK_BYTE( umode );
+		PACK_SHORT( submode );
+		PACK_USHORT( target_signature );
+
+		// primary weapon energy
+		temp_float = shipp->weapon_energy / sip->max_weapon_reserve;
+		PACK_PERCENT(temp_float);
+
+		Assert(packet_size == OO_AI_FRAGMENT_SIZE);
+	}
+
+	// extra info for support ships
+	if (sections & OO_FRAGMENT_SUPPORT) {
+		frag.has_support = (sip->flags[Ship::Info_Flags::Support]) && (shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO);
+		if (frag.has_support) {
+			data = frag.support;
+			packet_size = 0;
+
+			ushort dock_sig;
+
+			PACK_ULONG( aip->ai_flags.to_u64() );
+			PACK_INT( aip->mode );
+			PACK_INT( aip->submode );
+
+			if((aip->support_ship_objnum < 0) || (aip->support_ship_objnum >= MAX_OBJECTS)){
+				dock_sig = 0;
+			} else {
+				dock_sig = Objects[aip->support_ship_objnum].net_signature;
+			}
+
+			PACK_USHORT( dock_sig );
+
+			Assert(packet_size == OO_SUPPORT_FRAGMENT_SIZE);
+		}
+	}
+
+	return frag;
+}
+
 int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *data_out)
 {
 	ubyte data[OO_SAFE_BUFFER_SIZE];
 	ushort data_size = 0;	// now a ushort because of IPv6 size extensions
 	ship *shipp;	
-	ship_info *sip;
-	float temp_float;	
 	int header_bytes;
 	int packet_size = 0, ret = 0;
 
@@ -1244,7 +1568,6 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 	Assert(objp->type == OBJ_SHIP);
 	if((objp->instance >= 0) && (Ships[objp->instance].ship_info_index >= 0)){
 		shipp = &Ships[objp->instance];
-		sip = &Ship_info[shipp->ship_info_index];
 	} else {
 		return 0;
 	}			
@@ -1280,58 +1603,85 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 		packet_size += multi_oo_pack_client_data(data + packet_size + header_bytes, shipp);		
 	}		
 		
+	// everything that doesn't depend on this player is only encoded once per round of updates, and only the sections
+	// that can go out in this packet. Subsystems and support ship info are checked no matter what the flags say.
+	uint sections = 0;
+	if (oo_flags & OO_POS_AND_ORIENT_NEW) {
+		sections |= OO_FRAGMENT_POSITION;
+	}
+	if (oo_flags & OO_HULL_NEW) {
+		sections |= OO_FRAGMENT_HULL;
+	}
+	if (oo_flags & OO_SHIELDS_NEW) {
+		sections |= OO_FRAGMENT_SHIELDS;
+	}
+	if (MULTIPLAYER_MASTER || objp->flags[Object::Object_Flags::Player_ship]) {
+		sections |= OO_FRAGMENT_SUBSYSTEMS;
+	}
+	if (oo_flags & OO_AI_NEW) {
+		sections |= OO_FRAGMENT_AI;
+	}
+	if (MULTIPLAYER_MASTER) {
+		sections |= OO_FRAGMENT_SUPPORT;
+	}
+
+	const oo_ship_fragments& frag = multi_oo_get_fragments(objp, sections);
+	auto& last_sent = Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature];
+
 	// position - Now includes, position, orientation, velocity, rotational velocity, desired velocity and desired rotational velocity.
 	// this should always be sent when it is determined to be needed.
 	if ( oo_flags & OO_POS_AND_ORIENT_NEW ) {	
-		ret = multi_pack_unpack_position( 1, data + packet_size + header_bytes, &objp->pos ); // 10 bytes
-		packet_size += ret;
+		// the server sends the difference to the newest position section this player confirmed, if that's smaller.
+		// Only a section from a packet the player acknowledged will do, it may have missed any other one.
+		const oo_position_baseline* baseline = nullptr;
+		ubyte delta[OO_POSITION_DELTA_MAX_SIZE];
+		int delta_size = 0;
 
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);
-
-		// orientation (now done via angles)
-		angles temp_angles;
-		vm_extract_angles_matrix_alternate(&temp_angles, &objp->orient);	
+		if (MULTIPLAYER_MASTER) {
+			baseline = last_sent.sent_positions.find_newest_confirmed();
+		}
 
-		// actual packing function, 6 bytes
-		ret = multi_pack_unpack_orient( 1, data + packet_size + header_bytes, &temp_angles); 
+		if ((baseline != nullptr) && (baseline->full_physics == frag.full_physics) && (Oo_info.number_of_frames - baseline->frame <= UCHAR_MAX)) {
+			delta_size = multi_oo_delta_encode(baseline->section, frag.pos_orient, frag.full_physics, delta);
+		}
 
-		packet_size += ret;
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);	
+		// one more byte for how many frames back the baseline is
+		if ((delta_size > 0) && (delta_size + 1 < frag.pos_orient_size)) {
+			auto baseline_age = (ubyte)(Oo_info.number_of_frames - baseline->frame);
+			PACK_BYTE(baseline_age);
 
-		// velocity, 4 bytes-- Tried to do this by calculation instead but kept running into issues. 
-		ret = multi_pack_unpack_vel(1, data + packet_size + header_bytes, &objp->orient, &objp->phys_info);
+			memcpy(data + packet_size + header_bytes, delta, delta_size);
+			packet_size += delta_size;
+			oo_flags |= OO_POS_AND_ORIENT_DELTA;
 
-		packet_size += ret;
-		// datarate tracking.
-		multi_rate_add(NET_PLAYER_NUM(pl), "pos", ret);	
+			// datarate tracking, there's no telling which part of the delta is which
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", delta_size + 1);
 
-		// Rotational Velocity, 4 bytes
-		ret = multi_pack_unpack_rotvel( 1, data + packet_size + header_bytes, &objp->phys_info );
+			Oo_bandwidth_stats.delta_sections++;
+			Oo_bandwidth_stats.position_bytes += delta_size + 1;
+		} else {
+			memcpy(data + packet_size + header_bytes, frag.pos_orient, frag.pos_orient_size);
+			packet_size += frag.pos_orient_size;
 
-		packet_size += ret;	
+			// datarate tracking.
+			multi_rate_add(NET_PLAYER_NUM(pl), "pos", frag.pos_bytes);
+			multi_rate_add(NET_PLAYER_NUM(pl), "ori", frag.ori_bytes);
+			ret = frag.fth_bytes;
 
-		// datarate tracking.		
-		multi_rate_add(NET_PLAYER_NUM(pl), "ori", ret);		
-		ret = 0;
+			Oo_bandwidth_stats.position_bytes += frag.pos_orient_size;
+		}
 
-		// in order to send data by axis we must rotate the global velocity into local coordinates
-		vec3d local_desired_vel;
+		Oo_bandwidth_stats.position_sections++;
+		Oo_bandwidth_stats.absolute_bytes += frag.pos_orient_size;
 
-		vm_vec_rotate(&local_desired_vel, &objp->phys_info.desired_vel, &objp->orient);
+		// either way, the client can use this one as a baseline once it acknowledges the packet it goes out in
+		if (MULTIPLAYER_MASTER) {
+			last_sent.sent_positions.add(Oo_info.number_of_frames, frag.full_physics, frag.pos_orient, frag.pos_orient_size);
+		}
 
-		// is this a ship with full phyiscs? (just player-controled for now)
-		bool full_physics = false;
-		if (objp->flags[Object::Object_Flags::Player_ship]) {
-			full_physics = true;
+		if (frag.full_physics) {
 			oo_flags |= OO_FULL_PHYSICS;
 		}
-
-		// actual packing function, 4 bytes if full_physics, 3 bytes if not
-		ret = multi_pack_unpack_desired_vel_and_desired_rotvel(1, full_physics, data + packet_size + header_bytes, &objp->phys_info, &local_desired_vel);
-
-		packet_size += ret;
 	}
 
 	// datarate records	
@@ -1340,34 +1690,24 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 	// hull info -- also should be required, but can never be sent by client, so unless something's really messed up,
 	// at this point it is impossible to overflow the buffer.
 	if (oo_flags & OO_HULL_NEW) {
-		// add the hull value for this guy		
-		temp_float = get_hull_pct(objp);
-		if ((temp_float < 0.004f) && (temp_float > 0.0f)) {
-			temp_float = 0.004f;		// 0.004 is the lowest positive value we can have before we zero out when packing
-		}
-		PACK_PERCENT(temp_float);
+		data[packet_size + header_bytes] = frag.hull;
+		packet_size++;
 		multi_rate_add(NET_PLAYER_NUM(pl), "hul", 1);
 	}
 
 	// add shields, which can have now have a dynamic number of quadrants, we need to start checking for buffer overflow here
 	if (oo_flags & OO_SHIELDS_NEW) {
-		int pre_section_size = packet_size;
-
-		float quad = shield_get_max_quad(objp);
-
-		for (float temp_quadrant: objp->shield_quadrant) {
-			temp_float = temp_quadrant / quad;
-			PACK_PERCENT(temp_float);
-		}
-				
 		// Check that we are not sending too much data, if so, don't actually send.
-		if (packet_size > OO_MAX_DATA_SIZE) {
+		if (packet_size + static_cast<int>(frag.shields.size()) > OO_MAX_DATA_SIZE) {
 			nprintf(("Network","Had to remove shields section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
 			oo_flags &= ~OO_SHIELDS_NEW;
 		}
 		else {
-			multi_rate_add(NET_PLAYER_NUM(pl), "shl", static_cast<int>(objp->shield_quadrant.size()));
+			if (!frag.shields.empty()) {
+				memcpy(data + packet_size + header_bytes, frag.shields.data(), frag.shields.size());
+			}
+			packet_size += static_cast<int>(frag.shields.size());
+			multi_rate_add(NET_PLAYER_NUM(pl), "shl", static_cast<int>(frag.shields.size()));
 		}
 	}	
 
@@ -1380,87 +1720,68 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 		flags.reserve(MAX_MODEL_SUBSYSTEMS);
 		subsys_data.reserve(MAX_MODEL_SUBSYSTEMS); // propbably won't exceed this, and even if it does, it will get cut off.
 
-		for (ship_subsys* subsystem = GET_FIRST(&shipp->subsys_list); subsystem != END_OF_LIST(&shipp->subsys_list);
-			subsystem = GET_NEXT(subsystem)) {
+		for (const auto& subsys_frag : frag.subsystems) {
 			flags.push_back(0);
 			// Don't send destroyed subsystems, (another packet handles that), but check to see if the subsystem changed since the last update. 
-			if (MULTIPLAYER_MASTER && (subsystem->current_hits != 0.0f) && (subsystem->current_hits != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_health[i])) {
+			if (MULTIPLAYER_MASTER && (subsys_frag.current_hits != 0.0f) && (subsys_frag.current_hits != last_sent.subsystem_health[i])) {
 				flags[i] |= OO_SUBSYS_HEALTH;
-				subsys_data.push_back(subsystem->current_hits / subsystem->max_hits);
-				// good thing this cheap because we have to calculate this twice to avoid iterating through the whole system list twice.
-				Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_health[i] = subsystem->current_hits;
+				subsys_data.push_back(subsys_frag.health);
+				last_sent.subsystem_health[i] = subsys_frag.current_hits;
 
 				// this should be safe because we only work with subsystems that have health.
 				// and also track the list of subsystems that we packed by index
 			}
-			
-
-			// retrieve the submodel for rotation info.
-			if (subsystem->system_info->flags[Model::Subsystem_Flags::Rotates]) {
-				angles *angs_1 = nullptr;
-				angles *angs_2 = nullptr;
-				if (subsystem->submodel_instance_1) {
-					angs_1 = new angles;
-					vm_extract_angles_matrix_alternate(angs_1, &subsystem->submodel_instance_1->canonical_orient);
-				}
-				if (subsystem->submodel_instance_2) {
-					angs_2 = new angles;
-					vm_extract_angles_matrix_alternate(angs_2, &subsystem->submodel_instance_2->canonical_orient);
-				}
 
-				// here we're checking to see if the subsystems rotated enough to send.
-				if (angs_1 != nullptr && angs_1->b != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1b[i]) {
+			// here we're checking to see if the subsystems rotated enough to send.
+			if (subsys_frag.has_angles_1) {
+				if (subsys_frag.angles_1.b != last_sent.subsystem_1b[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1b;
-					subsys_data.push_back(angs_1->b / PI2);
+					subsys_data.push_back(subsys_frag.angles_1.b / PI2);
 				}
 
-				if (angs_1 != nullptr && angs_1->h != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1h[i]) {
+				if (subsys_frag.angles_1.h != last_sent.subsystem_1h[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1h;
-					subsys_data.push_back(angs_1->h / PI2);
+					subsys_data.push_back(subsys_frag.angles_1.h / PI2);
 				}
 
-				if (angs_1 != nullptr && angs_1->p != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_1p[i]) {
+				if (subsys_frag.angles_1.p != last_sent.subsystem_1p[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_1p;
-					subsys_data.push_back(angs_1->p / PI2);
+					subsys_data.push_back(subsys_frag.angles_1.p / PI2);
 				}
+			}
 
-				if (angs_2 != nullptr && angs_2->b != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2b[i]) {
+			if (subsys_frag.has_angles_2) {
+				if (subsys_frag.angles_2.b != last_sent.subsystem_2b[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2b;
-					subsys_data.push_back(angs_2->b / PI2);
+					subsys_data.push_back(subsys_frag.angles_2.b / PI2);
 				}
 
-				if (angs_2 != nullptr && angs_2->h != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2h[i]) {
+				if (subsys_frag.angles_2.h != last_sent.subsystem_2h[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2h;
-					subsys_data.push_back(angs_2->h / PI2);
+					subsys_data.push_back(subsys_frag.angles_2.h / PI2);
 				}
 
-				if (angs_2 != nullptr && angs_2->p != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_2p[i]) {
+				if (subsys_frag.angles_2.p != last_sent.subsystem_2p[i]) {
 					flags[i] |= OO_SUBSYS_ROTATION_2p;
-					subsys_data.push_back(angs_2->p / PI2);
+					subsys_data.push_back(subsys_frag.angles_2.p / PI2);
 				}
-
-				// clang says deleting null pointer has no effect
-				delete angs_1;
-				delete angs_2;
 			}
 
 			// ditto for translation
-			if (subsystem->system_info->flags[Model::Subsystem_Flags::Translates]) {
-				auto smi = subsystem->submodel_instance_1;
-
-				if (smi && smi->canonical_offset.xyz.x != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_x[i]) {
+			if (subsys_frag.has_offset) {
+				if (subsys_frag.offset.xyz.x != last_sent.subsystem_x[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_x;
-					subsys_data.push_back(smi->canonical_offset.xyz.x);
+					subsys_data.push_back(subsys_frag.offset.xyz.x);
 				}
 
-				if (smi && smi->canonical_offset.xyz.y != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_y[i]) {
+				if (subsys_frag.offset.xyz.y != last_sent.subsystem_y[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_y;
-					subsys_data.push_back(smi->canonical_offset.xyz.y);
+					subsys_data.push_back(subsys_frag.offset.xyz.y);
 				}
 
-				if (smi && smi->canonical_offset.xyz.z != Oo_info.player_frame_info[pl->player_id].last_sent[objp->net_signature].subsystem_z[i]) {
+				if (subsys_frag.offset.xyz.z != last_sent.subsystem_z[i]) {
 					flags[i] |= OO_SUBSYS_TRANSLATION_z;
-					subsys_data.push_back(smi->canonical_offset.xyz.z);
+					subsys_data.push_back(subsys_frag.offset.xyz.z);
 				}
 			}
 
@@ -1485,74 +1806,27 @@ int multi_oo_pack_data(net_player *pl, object *objp, ushort oo_flags, ubyte *dat
 
 	// Cyborg17 - only server should send this
 	if (oo_flags & OO_AI_NEW){
-		int pre_section_size = packet_size;
-		ai_info *aip = &Ai_info[shipp->ai_index];
-
-		// ai mode info
-		auto umode = (ubyte)(aip->mode);
-		auto submode = (short)(aip->submode);
-		ushort target_signature = 0;
-
-		// either send out the waypoint they are trying to get to *or* their current target.
-		if (umode == AIM_WAYPOINTS) {
-			// if it's already started pointing to a waypoint, grab its net_signature and send that instead
-			waypoint* wp;
-			if ((wp = find_waypoint_at_indexes(aip->wp_list_index, aip->wp_index)) != nullptr) {
-				target_signature = Objects[wp->get_objnum()].net_signature;
-			}
-		} else if (aip->target_objnum >= 0) {
-			// prefer live target_objnum so clients can check both ordered goal targets and spontaneous targets
-			target_signature = Objects[aip->target_objnum].net_signature;
-		}  else if ((aip->goals[0].target_name != nullptr) && strlen(aip->goals[0].target_name) != 0) {
-			// send the target signature. 2021 Version!
-			int instance = ship_name_lookup(aip->goals[0].target_name);
-			if (instance > -1) {
-				target_signature = Objects[Ships[instance].objnum].net_signature;
-			}
-		}
-
-		PACK_BYTE( umode );
-		PACK_SHORT( submode );
-		PACK_USHORT( target_signature );	
-
-		// primary weapon energy
-		temp_float = shipp->weapon_energy / sip->max_weapon_reserve;
-		PACK_PERCENT(temp_float);
-
-		// check for adding too much data, if so don't send what we just wrote.
-		if (packet_size > OO_MAX_DATA_SIZE) {
+		// check for adding too much data, if so don't send it.
+		if (packet_size + OO_AI_FRAGMENT_SIZE > OO_MAX_DATA_SIZE) {
 			nprintf(("Network","Had to remove AI section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
 			oo_flags &= ~OO_AI_NEW;
 		} // otherwise, make sure it gets counted int the rate limiting system.
 		else {
+			memcpy(data + packet_size + header_bytes, frag.ai, OO_AI_FRAGMENT_SIZE);
+			packet_size += OO_AI_FRAGMENT_SIZE;
 			multi_rate_add(NET_PLAYER_NUM(pl), "aim", 5);
 		}
 	}		
 
 	// if this ship is a support ship, send some extra info
-	if(MULTIPLAYER_MASTER && (sip->flags[Ship::Info_Flags::Support]) && (shipp->ai_index >= 0) && (shipp->ai_index < MAX_AI_INFO)){
-		int pre_section_size = packet_size;
-		ushort dock_sig;
-
-		PACK_ULONG( Ai_info[shipp->ai_index].ai_flags.to_u64() );
-		PACK_INT( Ai_info[shipp->ai_index].mode );
-		PACK_INT( Ai_info[shipp->ai_index].submode );
-
-		if((Ai_info[shipp->ai_index].support_ship_objnum < 0) || (Ai_info[shipp->ai_index].support_ship_objnum >= MAX_OBJECTS)){
-			dock_sig = 0;
-		} else {
-			dock_sig = Objects[Ai_info[shipp->ai_index].support_ship_objnum].net_signature;
-		}		
-
-		PACK_USHORT( dock_sig );
-
-		// check for adding too much data, if so don't send what we just wrote.
-		if (packet_size > OO_MAX_DATA_SIZE) {
+	if(MULTIPLAYER_MASTER && frag.has_support){
+		// check for adding too much data, if so don't send it.
+		if (packet_size + OO_SUPPORT_FRAGMENT_SIZE > OO_MAX_DATA_SIZE) {
 			nprintf(("Network","Had to remove support ship section from data packet for %s\n", shipp->ship_name));
-			packet_size = pre_section_size;
 		}
 		else {
+			memcpy(data + packet_size + header_bytes, frag.support, OO_SUPPORT_FRAGMENT_SIZE);
+			packet_size += OO_SUPPORT_FRAGMENT_SIZE;
 			oo_flags |= OO_SUPPORT_SHIP;
 		}
 	}
@@ -1767,6 +2041,37 @@ int multi_oo_unpack_client_data(net_player* pl, ubyte* data, bool keep_data)
 		}
 	}
 
+	// the object update packets the client got, and the ships it needs full positions for
+	int acked_newest;
+	uint acked_mask;
+	ubyte resync_count;
+	ushort resync_signature;
+
+	GET_INT(acked_newest);
+	GET_UINT(acked_mask);
+	GET_DATA(resync_count);
+
+	oo_packet_acks acks;
+	acks.merge(acked_newest, acked_mask);
+
+	// the position sections in those packets can be used as baselines now
+	auto& player_record = Oo_info.player_frame_info[pl->player_id];
+	player_record.sent_packets.acknowledge(acks, [&player_record](ushort net_signature, int frame) {
+		if (net_signature < player_record.last_sent.size()) {
+			player_record.last_sent[net_signature].sent_positions.confirm(frame);
+		}
+	});
+
+	for (int i = 0; i < resync_count; i++) {
+		GET_USHORT(resync_signature);
+
+		if (resync_signature < player_record.last_sent.size()) {
+			player_record.last_sent[resync_signature].sent_positions.clear();
+			player_record.last_sent[resync_signature].timestamp = TIMESTAMP::immediate();
+		}
+		Oo_bandwidth_stats.resyncs++;
+	}
+
 	return offset;
 }
 
@@ -1800,8 +2105,8 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 	GET_USHORT(data_size);
 	if (MULTIPLAYER_MASTER) {
 		// client cannot send these types because the server is in charge of all of these things.
-		Assertion(!(oo_flags & (OO_AI_NEW | OO_SHIELDS_NEW | OO_HULL_NEW | OO_SUPPORT_SHIP)), "Invalid flag from client, please report! oo_flags value: %d\n", oo_flags);
-		if (oo_flags & (OO_AI_NEW | OO_SHIELDS_NEW | OO_HULL_NEW | OO_SUPPORT_SHIP)) {
+		Assertion(!(oo_flags & (OO_AI_NEW | OO_SHIELDS_NEW | OO_HULL_NEW | OO_SUPPORT_SHIP | OO_POS_AND_ORIENT_DELTA)), "Invalid flag from client, please report! oo_flags value: %d\n", oo_flags);
+		if (oo_flags & (OO_AI_NEW | OO_SHIELDS_NEW | OO_HULL_NEW | OO_SUPPORT_SHIP | OO_POS_AND_ORIENT_DELTA)) {
 			offset += data_size;
 			return offset;
 		}
@@ -1870,33 +2175,73 @@ int multi_oo_unpack_data(net_player* pl, ubyte* data, int seq_num, int time_delt
 
 	if ( oo_flags & OO_POS_AND_ORIENT_NEW) {
 
+		bool full_physics = false;
+
+		if (oo_flags & OO_FULL_PHYSICS) {
+			full_physics = true;
+		}
+
+		// delta encoded sections are rebuilt from the baseline they refer to, and then read like any other
+		ubyte decoded_section[OO_POSITION_SECTION_MAX_SIZE];
+		ubyte* section = data + offset;
+		int section_offset = 0;
+
+		if (MULTIPLAYER_CLIENT && (net_sig >= Oo_info.received_positions.size())) {
+			Oo_info.received_positions.resize(net_sig + 1);
+		}
+
+		if (MULTIPLAYER_CLIENT && (oo_flags & OO_POS_AND_ORIENT_DELTA)) {
+			ubyte baseline_age;
+			GET_DATA(baseline_age);
+
+			auto baseline = Oo_info.received_positions[net_sig].find(seq_num - baseline_age);
+
+			// if we never got the update this is based on, skip the ship until the server sends its position in full
+			if ((baseline == nullptr) || (baseline->full_physics != full_physics)) {
+				if (std::find(Oo_info.resync_requests.begin(), Oo_info.resync_requests.end(), net_sig) == Oo_info.resync_requests.end()) {
+					Oo_info.resync_requests.push_back(net_sig);
+				}
+
+				offset = OO_SERVER_HEADER_SIZE + data_size;
+				return offset;
+			}
+
+			int section_size;
+			offset += multi_oo_delta_decode(baseline->section, data + offset, full_physics, decoded_section, &section_size);
+			section = decoded_section;
+		}
+
 		// unpack position
-		int r1 = multi_pack_unpack_position(0, data + offset, &new_pos);
-		offset += r1;
+		int r1 = multi_pack_unpack_position(0, section + section_offset, &new_pos);
+		section_offset += r1;
 
 		// unpack orientation
-		int r2 = multi_pack_unpack_orient( 0, data + offset, &new_angles );
-		offset += r2;
+		int r2 = multi_pack_unpack_orient( 0, section + section_offset, &new_angles );
+		section_offset += r2;
 
 		// new version of the orient packer sends angles instead to save on bandwidth, so we'll need the orienation from that.
 		vm_angles_2_matrix(&new_orient, &new_angles);
 
-		int r3 = multi_pack_unpack_vel(0, data + offset, &new_orient, &new_phys_info);
-		offset += r3;
+		int r3 = multi_pack_unpack_vel(0, section + section_offset, &new_orient, &new_phys_info);
+		section_offset += r3;
 
-		int r4 = multi_pack_unpack_rotvel( 0, data + offset, &new_phys_info );
-		offset += r4;
+		int r4 = multi_pack_unpack_rotvel( 0, section + section_offset, &new_phys_info );
+		section_offset += r4;
 
 		vec3d local_desired_vel = vmd_zero_vector;
-		
-		bool full_physics = false;
 
-		if (oo_flags & OO_FULL_PHYSICS) {
-			full_physics = true;
+		int r5 = multi_pack_unpack_desired_vel_and_desired_rotvel(0, full_physics, section + section_offset, &pobjp->phys_info, &local_desired_vel);
+		section_offset += r5;
+
+		if (!(oo_flags & OO_POS_AND_ORIENT_DELTA)) {
+			offset += section_offset;
+		}
+
+		// keep it around in case the server sends a delta against it later
+		if (MULTIPLAYER_CLIENT) {
+			Oo_info.received_positions[net_sig].add(seq_num, full_physics, section, section_offset);
 		}
 
-		int r5 = multi_pack_unpack_desired_vel_and_desired_rotvel(0, full_physics, data + offset, &pobjp->phys_info, &local_desired_vel);
-		offset += r5;
 		// change it back to global coordinates.
 		vm_vec_unrotate(&new_phys_info.desired_vel, &local_desired_vel, &new_orient);
 
@@ -2471,6 +2816,35 @@ int multi_oo_maybe_update(net_player *pl, object *obj, ubyte *data)
 }
 
 
+// send an object update packet to a client, compressing the ship updates after the shared header if that's enabled and helps
+static void multi_oo_send_update_packet(net_player *pl, ubyte *data, int packet_size)
+{
+	Oo_bandwidth_stats.packet_bytes += packet_size;
+
+	if (Cmdline_compress_objupd && (packet_size > OO_MAIN_HEADER_SIZE)) {
+		ubyte compressed[MAX_PACKET_SIZE];
+		int raw_size = packet_size - OO_MAIN_HEADER_SIZE;
+		int compressed_size = multi_oo_compress(data + OO_MAIN_HEADER_SIZE, raw_size, compressed, MAX_PACKET_SIZE);
+
+		// the marker and the compressed size take up three bytes
+		if ((compressed_size > 0) && (compressed_size + 3 < raw_size)) {
+			packet_size = OO_MAIN_HEADER_SIZE;
+
+			ubyte marker = OO_COMPRESSED_BLOCK;
+			auto block_size = (ushort)compressed_size;
+			ADD_DATA(marker);
+			ADD_USHORT(block_size);
+
+			memcpy(data + packet_size, compressed, compressed_size);
+			packet_size += compressed_size;
+		}
+	}
+
+	multi_io_send(pl, data, packet_size);
+	pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+	Oo_bandwidth_stats.sent_bytes += packet_size;
+}
+
 // process all other objects for this player
 void multi_oo_process_all(net_player *pl)
 {
@@ -2486,6 +2860,9 @@ void multi_oo_process_all(net_player *pl)
 	// build the list of ships to check against
 	multi_oo_build_ship_list(pl);
 
+	extern float flFrametime;
+	Oo_bandwidth_stats.ship_seconds += ship_get_num_ships() * flFrametime;
+
 	// build the header
 	BUILD_HEADER(OBJECT_UPDATE);		
 
@@ -2496,6 +2873,12 @@ void multi_oo_process_all(net_player *pl)
 
 	ADD_INT(time_out);
 
+	// the packets are numbered so the player can acknowledge each one, a frame may need several of them
+	auto& sent_packets = Oo_info.player_frame_info[pl->player_id].sent_packets;
+	int packet_number = sent_packets.begin(Oo_info.number_of_frames);
+
+	ADD_INT(packet_number);
+
 	ubyte stop;
 	int add_size;	
 	ubyte data_add[MAX_PACKET_SIZE * 2]; // we could have up to two maximum sized packets in the array without it overflowing.
@@ -2516,7 +2899,8 @@ void multi_oo_process_all(net_player *pl)
 			ADD_DATA(stop);
 
 			memcpy(data + packet_size, data_add, add_size);
-			packet_size += add_size;		
+			packet_size += add_size;
+			sent_packets.add_ship(targ_obj->net_signature);
 		}
 	}
 	
@@ -2543,15 +2927,17 @@ void multi_oo_process_all(net_player *pl)
 			multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
 			ADD_DATA(stop);
 									
-			multi_io_send(pl, data, packet_size);
+			multi_oo_send_update_packet(pl, data, packet_size);
 			packet_sent = true;
-			pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
 
 			packet_size = 0;
 			BUILD_HEADER(OBJECT_UPDATE);
 			// Cyborg17 - regurgitate shared header
 			ADD_INT(Oo_info.number_of_frames);
 			ADD_INT(time_out);
+
+			packet_number = sent_packets.begin(Oo_info.number_of_frames);
+			ADD_INT(packet_number);
 		}
 
 		if(add_size){
@@ -2562,6 +2948,7 @@ void multi_oo_process_all(net_player *pl)
 			// copy in the data
 			memcpy(data + packet_size,data_add,add_size);
 			packet_size += add_size;
+			sent_packets.add_ship(moveup->net_signature);
 		}
 
 		// next ship
@@ -2574,8 +2961,7 @@ void multi_oo_process_all(net_player *pl)
 		multi_rate_add(NET_PLAYER_NUM(pl), "stp", 1);
 		ADD_DATA(stop);
 
-		multi_io_send(pl, data, packet_size);
-		pl->s_info.rate_bytes += packet_size + UDP_HEADER_SIZE;
+		multi_oo_send_update_packet(pl, data, packet_size);
 	}
 }
 
@@ -2583,6 +2969,9 @@ void multi_oo_process_all(net_player *pl)
 void multi_oo_process()
 {
 	int idx;	
+
+	// the ships have moved since the last round of updates
+	Oo_fragment_generation++;
 	
 	// process each player
 	for(idx=0; idx<MAX_PLAYERS; idx++){
@@ -2594,6 +2983,11 @@ void multi_oo_process()
 			if((Net_players[idx].m_player != nullptr) && (Net_players[idx].m_player->objnum >= 0) && !(Net_players[idx].flags & NETINFO_FLAG_LIMBO) && !(Net_players[idx].flags & NETINFO_FLAG_RESPAWNING)){
 				if((Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Player_ship]) && !(Objects[Net_players[idx].m_player->objnum].flags[Object::Object_Flags::Should_be_dead])){
 					obj_player_fire_stuff( &Objects[Net_players[idx].m_player->objnum], Net_players[idx].m_player->ci );
+
+					// firing takes weapon energy, so the players after this one need a fresh AI section
+					if (Net_players[idx].m_player->objnum < static_cast<int>(Oo_fragments.size())) {
+						Oo_fragments[Net_players[idx].m_player->objnum].encoded &= ~OO_FRAGMENT_AI;
+					}
 				}
 			}
 		}
@@ -2619,12 +3013,56 @@ void multi_oo_process_update(ubyte *data, header *hinfo)
 
 	int seq_num;
 	int timestamp;
+	int packet_number;
 	ubyte stop;	
 
 	// TODO: ADD COMPLICATED TIMESTAMP LOGIC HERE
 	GET_INT(seq_num);
 	GET_INT(timestamp);
+	GET_INT(packet_number);
+
+	// the server delta encodes positions against the packets we tell it we got
+	if (MULTIPLAYER_CLIENT) {
+		Oo_info.received_packets.add(packet_number);
+	}
+
 	GET_DATA(stop);
+
+	// the ship updates may come as one lz4 compressed block
+	if (stop == OO_COMPRESSED_BLOCK) {
+		ushort block_size;
+		GET_USHORT(block_size);
+
+		// the size comes from the network, so don't trust it to stay within what we received
+		if (offset + block_size > hinfo->bytes_available) {
+			nprintf(("Network", "Dropping object update with a compressed block longer than the packet\n"));
+			hinfo->bytes_processed = hinfo->bytes_available;
+			return;
+		}
+
+		ubyte block[MAX_PACKET_SIZE * 2];
+		int size = multi_oo_decompress(data + offset, block_size, block, MAX_PACKET_SIZE * 2);
+		offset += block_size;
+
+		if (size > 0) {
+			int block_offset = 0;
+
+			// a damaged block may end without a stop byte
+			while (block_offset < size) {
+				stop = block[block_offset++];
+				if ((stop != 0xff) || (block_offset >= size)) {
+					break;
+				}
+
+				block_offset += multi_oo_unpack_data(pl, block + block_offset, seq_num, timestamp);
+			}
+		} else {
+			nprintf(("Network", "Dropping damaged compressed object update\n"));
+		}
+
+		PACKET_SET_SIZE();
+		return;
+	}
 	
 	while(stop == 0xff){
 		// process the data
@@ -2650,6 +3088,11 @@ void multi_init_oo_and_ship_tracker()
 	Oo_info.most_recent_frame = 0;
 	Oo_info.number_of_frames = 0;
 	Oo_info.cur_frame_index = 0;
+	Oo_info.received_packets.clear();
+	Oo_info.received_positions.clear();
+	Oo_info.resync_requests.clear();
+
+	Oo_bandwidth_stats = oo_bandwidth_stats();
 
 	for (int i = 0; i < MAX_FRAMES_RECORDED; i++) { // NOLINT
 		Oo_info.timestamps[i] = _timestamp(); // as of Interpolate overhaul 2, this can be something besides infinite
@@ -2780,6 +3223,14 @@ void multi_close_oo_and_ship_tracker()
 	Oo_info.frame_info.shrink_to_fit();
 	Oo_info.player_frame_info.clear();
 	Oo_info.player_frame_info.shrink_to_fit();
+
+	Oo_fragments.clear();
+	Oo_fragments.shrink_to_fit();
+
+	Oo_info.received_packets.clear();
+	Oo_info.received_positions.clear();
+	Oo_info.received_positions.shrink_to_fit();
+	Oo_info.resync_requests.clear();
 }
 
 
@@ -2808,10 +3259,16 @@ void multi_oo_send_control_info()
 
 	ADD_INT(time_out);
 
+	// and the packet number, which the server doesn't acknowledge but expects like in any object update
+	int packet_number = Oo_info.player_frame_info[Net_player->player_id].sent_packets.begin(Oo_info.number_of_frames);
+
+	ADD_INT(packet_number);
+
 	// pos and orient always
 	oo_flags = OO_POS_AND_ORIENT_NEW;		
 
 	// pack the appropriate info into the data
+	Oo_fragment_generation++;
 	add_size = multi_oo_pack_data(Net_player, Player_obj, oo_flags, data_add);
 
 	// copy in any relevant data
@@ -2871,10 +3328,16 @@ void multi_oo_send_changed_object(object *changedobj)
 
 	ADD_INT(time_out);
 
+	auto& sent_packets = Oo_info.player_frame_info[Net_players[idx].player_id].sent_packets;
+	int packet_number = sent_packets.begin(Oo_info.number_of_frames);
+
+	ADD_INT(packet_number);
+
 	// pos and orient always
 	oo_flags = (OO_POS_AND_ORIENT_NEW);
 
 	// pack the appropriate info into the data
+	Oo_fragment_generation++;
 	add_size = multi_oo_pack_data(&Net_players[idx], changedobj, oo_flags, data_add);
 
 	// copy in any relevant data
@@ -2886,6 +3349,7 @@ void multi_oo_send_changed_object(object *changedobj)
 
 		memcpy(data + packet_size, data_add, add_size);
 		packet_size += add_size;		
+		sent_packets.add_ship(changedobj->net_signature);
 	}
 
 	// add the final stop byte
@@ -0,0 +1,400 @@
+#include "network/multi_oo_delta.h"
+
+#include "lz4.h"
+
+#include <algorithm>
+
+namespace {
+
+// Bit widths of the fields in a position section, in the order multi_oo_pack_data() writes them. Every group was
+// written by its own multi_pack_unpack_*() call, so each one starts on a new byte.
+struct oo_field_group {
+	int count;
+	int widths[6];
+};
+
+const oo_field_group Position_groups[] = {
+	{ 3, { 27, 26, 27 } },		// position
+	{ 3, { 16, 16, 16 } },		// orientation angles
+	{ 3, { 13, 13, 14 } },		// velocity
+	{ 3, { 10, 10, 10 } },		// rotational velocity
+};
+
+const oo_field_group Desired_full_physics_group = { 6, { 5, 5, 5, 4, 4, 9 } };
+const oo_field_group Desired_group = { 3, { 4, 4, 16 } };
+
+constexpr int OO_MAX_POSITION_FIELDS = 18;
+
+// The same MSB first bit order as the bitbuffer in multiutil.cpp
+class bit_writer {
+  public:
+	explicit bit_writer(ubyte* data) : m_data(data) {}
+
+	void put(uint value, int bit_count)
+	{
+		for (int i = bit_count - 1; i >= 0; --i) {
+			if (value & (1U << i)) {
+				m_rack |= m_mask;
+			}
+			m_mask >>= 1;
+			if (m_mask == 0) {
+				m_data[m_size++] = m_rack;
+				m_rack = 0;
+				m_mask = 0x80;
+			}
+		}
+	}
+
+	int flush()
+	{
+		if (m_mask != 0x80) {
+			m_data[m_size++] = m_rack;
+			m_rack = 0;
+			m_mask = 0x80;
+		}
+		return m_size;
+	}
+
+  private:
+	ubyte* m_data;
+	int m_size = 0;
+	ubyte m_rack = 0;
+	ubyte m_mask = 0x80;
+};
+
+class bit_reader {
+  public:
+	explicit bit_reader(const ubyte* data) : m_data(data) {}
+
+	uint get(int bit_count)
+	{
+		uint value = 0;
+		for (int i = 0; i < bit_count; ++i) {
+			if (m_mask == 0x80) {
+				m_rack = m_data[m_size++];
+			}
+			value = (value << 1) | ((m_rack & m_mask) ? 1 : 0);
+			m_mask >>= 1;
+			if (m_mask == 0) {
+				m_mask = 0x80;
+			}
+		}
+		return value;
+	}
+
+	int get_signed(int bit_count)
+	{
+		return sign_extend(get(bit_count), bit_count);
+	}
+
+	// moves on to the next byte like bitbuffer_read_flush() callers expect
+	int flush()
+	{
+		m_mask = 0x80;
+		return m_size;
+	}
+
+	static int sign_extend(uint value, int bit_count)
+	{
+		return static_cast<int>(value << (32 - bit_count)) >> (32 - bit_count);
+	}
+
+  private:
+	const ubyte* m_data;
+	int m_size = 0;
+	ubyte m_rack = 0;
+	ubyte m_mask = 0x80;
+};
+
+// Calls func(group) for every group of a position section
+template <typename F>
+void for_each_group(bool full_physics, F func)
+{
+	for (const auto& group : Position_groups) {
+		func(group);
+	}
+	func(full_physics ? Desired_full_physics_group : Desired_group);
+}
+
+int unpack_fields(const ubyte* section, bool full_physics, int* fields)
+{
+	bit_reader reader(section);
+	int count = 0;
+
+	for_each_group(full_physics, [&](const oo_field_group& group) {
+		for (int i = 0; i < group.count; ++i) {
+			fields[count++] = reader.get_signed(group.widths[i]);
+		}
+		reader.flush();
+	});
+
+	return count;
+}
+
+int pack_fields(const int* fields, bool full_physics, ubyte* section)
+{
+	bit_writer writer(section);
+	int count = 0;
+
+	for_each_group(full_physics, [&](const oo_field_group& group) {
+		for (int i = 0; i < group.count; ++i) {
+			writer.put(static_cast<uint>(fields[count++]), group.widths[i]);
+		}
+		writer.flush();
+	});
+
+	return writer.flush();
+}
+
+uint zigzag(int value)
+{
+	return (static_cast<uint>(value) << 1) ^ static_cast<uint>(value >> 31);
+}
+
+int unzigzag(uint value)
+{
+	return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+// How many bits a small or medium difference takes for a field of this width. Differences scale with the range of the
+// field, a fighter easily moves a few thousand position units between two updates but only turns by a few hundred.
+int small_delta_bits(int width)
+{
+	return std::max(width / 4, 1);
+}
+
+int medium_delta_bits(int width)
+{
+	return width / 2 + 1;
+}
+
+}
+
+void oo_packet_acks::add(int packet)
+{
+	merge(packet, 1);
+}
+
+void oo_packet_acks::merge(int other_newest, uint other_mask)
+{
+	if (other_newest < 0) {
+		return;
+	}
+
+	if (other_newest > newest) {
+		std::swap(newest, other_newest);
+		std::swap(mask, other_mask);
+	}
+
+	// both are in terms of the newer frame now, anything that falls off the end is forgotten
+	int shift = newest - other_newest;
+	if (shift < OO_ACKED_PACKETS_TRACKED) {
+		mask |= other_mask << shift;
+	}
+}
+
+bool oo_packet_acks::contains(int packet) const
+{
+	int age = newest - packet;
+
+	return (packet >= 0) && (age >= 0) && (age < OO_ACKED_PACKETS_TRACKED) && (mask & (1u << age));
+}
+
+void oo_packet_acks::clear()
+{
+	newest = -1;
+	mask = 0;
+}
+
+void oo_position_history::add(int frame, bool full_physics, const ubyte* section, int size)
+{
+	Assertion(size <= OO_POSITION_SECTION_MAX_SIZE, "Position section of %d bytes is too long for the baseline history!", size);
+
+	for (auto& entry : entries) {
+		if (entry.frame == frame) {
+			entry.frame = -1;
+			return;
+		}
+	}
+
+	auto& entry = entries[next];
+	next = (next + 1) % OO_POSITION_HISTORY_SIZE;
+
+	entry.frame = frame;
+	entry.confirmed = false;
+	entry.full_physics = full_physics;
+	entry.size = size;
+	memcpy(entry.section, section, size);
+}
+
+void oo_position_history::confirm(int frame)
+{
+	if (frame < 0) {
+		return;
+	}
+
+	for (auto& entry : entries) {
+		if (entry.frame == frame) {
+			entry.confirmed = true;
+		}
+	}
+}
+
+const oo_position_baseline* oo_position_history::find_newest_confirmed() const
+{
+	const oo_position_baseline* newest = nullptr;
+
+	for (const auto& entry : entries) {
+		if ((entry.frame >= 0) && entry.confirmed && ((newest == nullptr) || (entry.frame > newest->frame))) {
+			newest = &entry;
+		}
+	}
+
+	return newest;
+}
+
+const oo_position_baseline* oo_position_history::find(int frame) const
+{
+	if (frame < 0) {
+		return nullptr;
+	}
+
+	for (const auto& entry : entries) {
+		if (entry.frame == frame) {
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+void oo_position_history::clear()
+{
+	for (auto& entry : entries) {
+		entry.frame = -1;
+	}
+	next = 0;
+}
+
+int oo_sent_packets::begin(int frame)
+{
+	auto& packet = packets[next_number % OO_ACKED_PACKETS_TRACKED];
+
+	packet.number = next_number++;
+	packet.frame = frame;
+	packet.net_signatures.clear();
+
+	return packet.number;
+}
+
+void oo_sent_packets::add_ship(ushort net_signature)
+{
+	if (next_number > 0) {
+		packets[(next_number - 1) % OO_ACKED_PACKETS_TRACKED].net_signatures.push_back(net_signature);
+	}
+}
+
+void oo_sent_packets::clear()
+{
+	for (auto& packet : packets) {
+		packet.number = -1;
+		packet.net_signatures.clear();
+	}
+	next_number = 0;
+}
+
+int multi_oo_delta_encode(const ubyte* baseline, const ubyte* section, bool full_physics, ubyte* out)
+{
+	int old_fields[OO_MAX_POSITION_FIELDS];
+	int new_fields[OO_MAX_POSITION_FIELDS];
+
+	unpack_fields(baseline, full_physics, old_fields);
+	unpack_fields(section, full_physics, new_fields);
+
+	bit_writer writer(out);
+	int count = 0;
+
+	for_each_group(full_physics, [&](const oo_field_group& group) {
+		for (int i = 0; i < group.count; ++i, ++count) {
+			uint diff = zigzag(new_fields[count] - old_fields[count]);
+			int width = group.widths[i];
+
+			if (diff == 0) {
+				writer.put(0, 1);
+			} else if (diff < (1U << small_delta_bits(width))) {
+				writer.put(0x2, 2);
+				writer.put(diff, small_delta_bits(width));
+			} else if (diff < (1U << medium_delta_bits(width))) {
+				writer.put(0x6, 3);
+				writer.put(diff, medium_delta_bits(width));
+			} else {
+				writer.put(0x7, 3);
+				writer.put(static_cast<uint>(new_fields[count]) & ((1U << width) - 1), width);
+			}
+		}
+	});
+
+	int size = writer.flush();
+	Assertion(size <= OO_POSITION_DELTA_MAX_SIZE, "Delta encoded position section came up to %d bytes, more than the %d it should have. Please report!", size, OO_POSITION_DELTA_MAX_SIZE);
+
+	return size;
+}
+
+int multi_oo_delta_decode(const ubyte* baseline, const ubyte* delta, bool full_physics, ubyte* section, int* section_size)
+{
+	int fields[OO_MAX_POSITION_FIELDS];
+
+	unpack_fields(baseline, full_physics, fields);
+
+	bit_reader reader(delta);
+	int count = 0;
+
+	for_each_group(full_physics, [&](const oo_field_group& group) {
+		for (int i = 0; i < group.count; ++i, ++count) {
+			if (reader.get(1) == 0) {
+				continue;
+			}
+
+			if (reader.get(1) == 0) {
+				fields[count] += unzigzag(reader.get(small_delta_bits(group.widths[i])));
+			} else if (reader.get(1) == 0) {
+				fields[count] += unzigzag(reader.get(medium_delta_bits(group.widths[i])));
+			} else {
+				fields[count] = reader.get_signed(group.widths[i]);
+			}
+		}
+	});
+
+	*section_size = pack_fields(fields, full_physics, section);
+
+	return reader.flush();
+}
+
+int multi_oo_position_section_size(bool full_physics)
+{
+	int size = 0;
+
+	for_each_group(full_physics, [&](const oo_field_group& group) {
+		int bits = 0;
+		for (int i = 0; i < group.count; ++i) {
+			bits += group.widths[i];
+		}
+		size += (bits + 7) / 8;
+	});
+
+	return size;
+}
+
+int multi_oo_compress(const ubyte* data, int size, ubyte* out, int out_size)
+{
+	int compressed = LZ4_compress_default(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(out), size, out_size);
+
+	return (compressed > 0 && compressed < size) ? compressed : 0;
+}
+
+int multi_oo_decompress(const ubyte* data, int size, ubyte* out, int out_size)
+{
+	int decompressed = LZ4_decompress_safe(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(out), size, out_size);
+
+	return (decompressed >= 0) ? decompressed : -1;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// The position section of an object update is at most this long: 10 position, 6 orientation, 5 velocity,
+// 4 rotational velocity and up to 4 desired velocity bytes
+constexpr int OO_POSITION_SECTION_MAX_SIZE = 29;
+
+// A delta encoded position section is never longer than this, which happens when every field changed a lot
+constexpr int OO_POSITION_DELTA_MAX_SIZE = 40;
+
+// How many sent or received position sections are kept per ship as possible baselines
+constexpr int OO_POSITION_HISTORY_SIZE = 8;
+
+// How many object update packets before the newest acknowledged one are still tracked one by one
+constexpr int OO_ACKED_PACKETS_TRACKED = 32;
+
+// The object update packets one side got, as the newest of them and a bit for each of the packets before it. The
+// server numbers its packets per player, so a frame that had to be split over several packets is acknowledged packet
+// by packet.
+struct oo_packet_acks {
+	int newest = -1;
+	uint mask = 0;		// bit i is set if packet newest - i was received
+
+	// Records that this packet arrived
+	void add(int packet);
+
+	// Adds the packets the other side acknowledged, which may come in out of order
+	void merge(int other_newest, uint other_mask);
+
+	bool contains(int packet) const;
+
+	void clear();
+};
+
+// A position section as it was sent to or received from one player, tagged with the frame of the object update
+struct oo_position_baseline {
+	int frame = -1;
+	bool confirmed = false;		// the other side acknowledged the packet this section was sent in
+	bool full_physics = false;
+	int size = 0;
+	ubyte section[OO_POSITION_SECTION_MAX_SIZE];
+};
+
+// The last few position sections of one ship. Server and client keep the same history of the same ship, so that the
+// server can encode against a section the client confirmed and the client can find the frame of it again.
+struct oo_position_history {
+	oo_position_baseline entries[OO_POSITION_HISTORY_SIZE];
+	int next = 0;
+
+	// Adds a section, replacing the oldest one. A second section for a frame that is already there makes the frame
+	// useless as a baseline, since the other side may have received either of them.
+	void add(int frame, bool full_physics, const ubyte* section, int size);
+
+	// Marks the section of this frame as received by the other side, if it is still there
+	void confirm(int frame);
+
+	// Returns the newest confirmed section, nullptr if there is none
+	const oo_position_baseline* find_newest_confirmed() const;
+
+	// Returns the section of exactly this frame, nullptr if there is none
+	const oo_position_baseline* find(int frame) const;
+
+	void clear();
+};
+
+// The object update packets recently sent to one player, with the ships each of them carried. Only the sections in a
+// packet the player acknowledged are safe as baselines, any other packet of the same frame may have been lost.
+struct oo_sent_packets {
+	struct sent_packet {
+		int number = -1;
+		int frame = -1;
+		SCP_vector<ushort> net_signatures;
+	};
+
+	sent_packet packets[OO_ACKED_PACKETS_TRACKED];
+	int next_number = 0;
+
+	// Starts a packet with updates from this frame, replacing the oldest one, and returns the number to send with it
+	int begin(int frame);
+
+	// Records that the packet begun last carries an update of this ship
+	void add_ship(ushort net_signature);
+
+	// Calls confirm(net_signature, frame) for every ship in a packet of acks, once per packet
+	template <typename F>
+	void acknowledge(const oo_packet_acks& acks, F confirm)
+	{
+		for (auto& packet : packets) {
+			if ((packet.number >= 0) && acks.contains(packet.number)) {
+				for (auto net_signature : packet.net_signatures) {
+					confirm(net_signature, packet.frame);
+				}
+				packet.number = -1;
+			}
+		}
+	}
+
+	void clear();
+};
+
+/**
+ * @brief Encodes a position section as a difference to a baseline
+ *
+ * @details Both sections are split into the quantized fields the multi_pack_unpack_*() functions wrote. Each field is
+ * then written with a 1 to 3 bit prefix: unchanged, a small or medium difference, or the new value at full width.
+ *
+ * @return the number of bytes written to out, at most OO_POSITION_DELTA_MAX_SIZE
+ */
+int multi_oo_delta_encode(const ubyte* baseline, const ubyte* section, bool full_physics, ubyte* out);
+
+/**
+ * @brief Rebuilds a position section from a baseline and the output of multi_oo_delta_encode()
+ *
+ * @return the number of bytes read from delta. The size of the rebuilt section is stored in section_size.
+ */
+int multi_oo_delta_decode(const ubyte* baseline, const ubyte* delta, bool full_physics, ubyte* section, int* section_size);
+
+// Size of a position section written with or without full physics
+int multi_oo_position_section_size(bool full_physics);
+
+/**
+ * @brief Compresses the body of an object update packet with lz4
+ *
+ * @return the compressed size, or 0 if compressing doesn't make it smaller
+ */
+int multi_oo_compress(const ubyte* data, int size, ubyte* out, int out_size);
+
+// Decompresses the output of multi_oo_compress(), returns the decompressed size or -1 if the data is damaged
+int multi_oo_decompress(const ubyte* data, int size, ubyte* out, int out_size);
@@ -73,6 +73,7 @@
 #include "object/objectdock.h"
 #include "cmeasure/cmeasure.h"
 #include "parse/sexp.h"
+#include "parse/sexp/sexp_dependencies.h"
 #include "network/multi_fstracker.h"
 #include "network/multi_sw.h"
 #include "network/multi_sexp.h"
@@ -8580,6 +8581,7 @@ void process_variable_update_packet( ubyte *data, header *hinfo)
 	if ( (variable_index >= 0) && (variable_index < sexp_variable_count()) )
 	{
 		strcpy_s(Sexp_variables[variable_index].text, value); 
+		sexp_mark_dependency_changed(SEXP_DEPENDS_VARIABLES);
 	}	
 
 	// send the packet on to all clients. 
@@ -12,6 +12,7 @@
 #include "asteroid/asteroid.h"
 #include "debris/debris.h"
 #include "math/fvi.h"
+#include "model/model.h"
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "scripting/scripting.h"
@@ -21,14 +22,17 @@
 
 
 
-/**
- * Checks debris-weapon collisions.  
- * @param pair obj_pair pointer to the two objects. pair->a is debris and pair->b is weapon.
- * @return 1 if all future collisions between these can be ignored
- */
-int collide_debris_weapon( obj_pair * pair )
+struct debris_weapon_collision_data {
+	bool hit = false;
+	vec3d hitpos = vmd_zero_vector;
+	vec3d hitnormal = vmd_zero_vector;
+	mc_info collision_info;
+};
+
+//returns do_postproc, never_hits, collision_data
+static std::tuple<bool, bool, debris_weapon_collision_data> debris_weapon_check_collision(obj_pair* pair)
 {
-	vec3d	hitpos, hitnormal;
+	debris_weapon_collision_data cd;
 	object *pdebris = pair->a;
 	object *weapon_obj = pair->b;
 
@@ -36,92 +40,130 @@ int collide_debris_weapon( obj_pair * pair )
 	Assert( weapon_obj->type == OBJ_WEAPON );
 
 	if (reject_due_collision_groups(pdebris, weapon_obj))
-		return 0;
+		return {false, false, cd};
 
 	// first check the bounding spheres of the two objects.
-	int hit = fvi_segment_sphere(&hitpos, &weapon_obj->last_pos, &weapon_obj->pos, &pdebris->pos, pdebris->radius);
-	if (hit) {
-		hit = debris_check_collision(pdebris, weapon_obj, &hitpos, nullptr, &hitnormal );
-
-		if ( !hit )
-			return 0;
-
-		bool weapon_override = false, debris_override = false;
-
-		if (scripting::hooks::OnDebrisCollision->isActive()) {
-			weapon_override = scripting::hooks::OnDebrisCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
-					scripting::hook_param("Object", 'o', pdebris),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Debris", 'o', pdebris),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-		if (scripting::hooks::OnWeaponCollision->isActive()) {
-			debris_override = scripting::hooks::OnWeaponCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', pdebris),
-					scripting::hook_param("Object", 'o', weapon_obj),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Debris", 'o', pdebris),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		if(!weapon_override && !debris_override)
-		{
-			vec3d force = weapon_obj->phys_info.vel * Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].mass;
-			bool armed = weapon_hit( weapon_obj, pdebris, &hitpos, -1 );
-			float damage = Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].damage;
-			std::array<std::optional<ConditionData>, NumHitTypes> impact_data = {};
-			impact_data[static_cast<std::underlying_type_t<HitType>>(HitType::HULL)] = ConditionData {
-				SpecialImpactCondition::DEBRIS,
-				HitType::HULL,
-				damage,
-				pdebris->hull_strength,
-				Debris[pdebris->instance].max_hull,
-			};
-			maybe_play_conditional_impacts(impact_data, weapon_obj, pdebris, armed, -1, &hitpos, nullptr, &hitnormal);
-			debris_hit( pdebris, weapon_obj, &hitpos, damage , &force);
-		}
-
-		if (scripting::hooks::OnDebrisCollision->isActive() && !(debris_override && !weapon_override))
-		{
-			scripting::hooks::OnDebrisCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
-					scripting::hook_param("Object", 'o', pdebris),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Debris", 'o', pdebris),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		if (scripting::hooks::OnWeaponCollision->isActive() && ((debris_override && !weapon_override) || (!debris_override && !weapon_override)))
-		{
-			scripting::hooks::OnWeaponCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', pdebris),
-					scripting::hook_param("Object", 'o', weapon_obj),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Debris", 'o', pdebris),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		return 0;
-
-	} else {
-		return weapon_will_never_hit( weapon_obj, pdebris, pair );
+	if ( !fvi_segment_sphere(&cd.hitpos, &weapon_obj->last_pos, &weapon_obj->pos, &pdebris->pos, pdebris->radius) )
+		return {false, weapon_will_never_hit( weapon_obj, pdebris, pair ) != 0, cd};
+
+	// the weapon keeps the collision info even if the model was missed, so this always needs post-processing
+	cd.hit = debris_check_collision(pdebris, weapon_obj, &cd.hitpos, nullptr, &cd.hitnormal, &cd.collision_info) != 0;
+
+	return {true, false, cd};
+}
+
+static void debris_weapon_process_collision(obj_pair* pair, const debris_weapon_collision_data& cd)
+{
+	object *pdebris = pair->a;
+	object *weapon_obj = pair->b;
+	vec3d hitpos = cd.hitpos;
+	vec3d hitnormal = cd.hitnormal;
+
+	weapon *wp = &Weapons[weapon_obj->instance];
+	wp->collisionInfo = new mc_info(cd.collision_info);	// The weapon will free this memory later
+
+	if ( !cd.hit )
+		return;
+
+	bool weapon_override = false, debris_override = false;
+
+	if (scripting::hooks::OnDebrisCollision->isActive()) {
+		weapon_override = scripting::hooks::OnDebrisCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
+				scripting::hook_param("Object", 'o', pdebris),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Debris", 'o', pdebris),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+	if (scripting::hooks::OnWeaponCollision->isActive()) {
+		debris_override = scripting::hooks::OnWeaponCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', pdebris),
+				scripting::hook_param("Object", 'o', weapon_obj),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Debris", 'o', pdebris),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+
+	if(!weapon_override && !debris_override)
+	{
+		vec3d force = weapon_obj->phys_info.vel * Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].mass;
+		bool armed = weapon_hit( weapon_obj, pdebris, &hitpos, -1 );
+		float damage = Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].damage;
+		std::array<std::optional<ConditionData>, NumHitTypes> impact_data = {};
+		impact_data[static_cast<std::underlying_type_t<HitType>>(HitType::HULL)] = ConditionData {
+			SpecialImpactCondition::DEBRIS,
+			HitType::HULL,
+			damage,
+			pdebris->hull_strength,
+			Debris[pdebris->instance].max_hull,
+		};
+		maybe_play_conditional_impacts(impact_data, weapon_obj, pdebris, armed, -1, &hitpos, nullptr, &hitnormal);
+		debris_hit( pdebris, weapon_obj, &hitpos, damage , &force);
+	}
+
+	if (scripting::hooks::OnDebrisCollision->isActive() && !(debris_override && !weapon_override))
+	{
+		scripting::hooks::OnDebrisCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
+				scripting::hook_param("Object", 'o', pdebris),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Debris", 'o', pdebris),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
 	}
-}				
 
+	if (scripting::hooks::OnWeaponCollision->isActive() && ((debris_override && !weapon_override) || (!debris_override && !weapon_override)))
+	{
+		scripting::hooks::OnWeaponCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pdebris} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', pdebris),
+				scripting::hook_param("Object", 'o', weapon_obj),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Debris", 'o', pdebris),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+}
 
+static void debris_weapon_process_collision(obj_pair* pair, const std::any& collision_data)
+{
+	debris_weapon_process_collision(pair, std::any_cast<const debris_weapon_collision_data&>(collision_data));
+}
 
 /**
  * Checks debris-weapon collisions.  
  * @param pair obj_pair pointer to the two objects. pair->a is debris and pair->b is weapon.
  * @return 1 if all future collisions between these can be ignored
  */
-int collide_asteroid_weapon( obj_pair * pair )
+int collide_debris_weapon( obj_pair * pair )
+{
+	const auto& [do_postproc, never_hits, collision_data] = debris_weapon_check_collision(pair);
+	if (do_postproc)
+		debris_weapon_process_collision(pair, collision_data);
+
+	return never_hits ? 1 : 0;
+}
+
+//returns never_hits, process_data
+collision_result collide_debris_weapon_check( obj_pair * pair )
+{
+	const auto& [do_postproc, never_hits, collision_data] = debris_weapon_check_collision(pair);
+
+	return {never_hits, do_postproc ? std::any(collision_data) : std::any(), &debris_weapon_process_collision};
+}
+
+
+
+struct asteroid_weapon_collision_data {
+	vec3d hitpos;
+	vec3d hitnormal;
+};
+
+//returns do_postproc, never_hits, collision_data
+static std::tuple<bool, bool, asteroid_weapon_collision_data> asteroid_weapon_check_collision(obj_pair* pair)
 {
+	asteroid_weapon_collision_data cd{vmd_zero_vector, vmd_zero_vector};
+
 	if (!Asteroids_enabled)
-		return 0;
+		return {false, false, cd};
 
-	vec3d	hitpos, hitnormal;
 	object	*pasteroid = pair->a;
 	object	*weapon_obj = pair->b;
 
@@ -129,71 +171,101 @@ int collide_asteroid_weapon( obj_pair * pair )
 	Assert( weapon_obj->type == OBJ_WEAPON );
 
 	// first check the bounding spheres of the two objects.
-	int hit = fvi_segment_sphere(&hitpos, &weapon_obj->last_pos, &weapon_obj->pos, &pasteroid->pos, pasteroid->radius);
-	if (hit) {
-		hit = asteroid_check_collision(pasteroid, weapon_obj, &hitpos, nullptr, &hitnormal);
-		if ( !hit )
-			return 0;
-
-		bool weapon_override = false, asteroid_override = false;
-
-		if (scripting::hooks::OnAsteroidCollision->isActive()) {
-			weapon_override = scripting::hooks::OnAsteroidCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
-					scripting::hook_param("Object", 'o', pasteroid),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Asteroid", 'o', pasteroid),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-		if (scripting::hooks::OnWeaponCollision->isActive()) {
-			asteroid_override = scripting::hooks::OnWeaponCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', pasteroid),
-					scripting::hook_param("Object", 'o', weapon_obj),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Asteroid", 'o', pasteroid),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		if(!weapon_override && !asteroid_override)
-		{
-			vec3d force = weapon_obj->phys_info.vel * Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].mass;
-			bool armed = weapon_hit( weapon_obj, pasteroid, &hitpos, -1);
-			float damage = Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].damage;
-			std::array<std::optional<ConditionData>, NumHitTypes> impact_data = {};
-			impact_data[static_cast<std::underlying_type_t<HitType>>(HitType::HULL)] = ConditionData {
-				SpecialImpactCondition::DEBRIS,
-				HitType::HULL,
-				damage,
-				pasteroid->hull_strength,
-				Asteroid_info[Asteroids[pasteroid->instance].asteroid_type].initial_asteroid_strength,
-			};
-			maybe_play_conditional_impacts(impact_data, weapon_obj, pasteroid, armed, -1, &hitpos, nullptr, &hitnormal);
-			asteroid_hit( pasteroid, weapon_obj, &hitpos, damage, &force );
-		}
-
-		if (scripting::hooks::OnAsteroidCollision->isActive() && !(asteroid_override && !weapon_override))
-		{
-			scripting::hooks::OnAsteroidCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
-					scripting::hook_param("Object", 'o', pasteroid),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Asteroid", 'o', pasteroid),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		if (scripting::hooks::OnWeaponCollision->isActive() && ((asteroid_override && !weapon_override) || (!asteroid_override && !weapon_override)))
-		{
-			scripting::hooks::OnWeaponCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
-				scripting::hook_param_list(scripting::hook_param("Self", 'o', pasteroid),
-					scripting::hook_param("Object", 'o', weapon_obj),
-					scripting::hook_param("Weapon", 'o', weapon_obj),
-					scripting::hook_param("Asteroid", 'o', pasteroid),
-					scripting::hook_param("Hitpos", 'o', hitpos)));
-		}
-
-		return 0;
-
-	} else {
-		return weapon_will_never_hit( weapon_obj, pasteroid, pair );
+	if ( !fvi_segment_sphere(&cd.hitpos, &weapon_obj->last_pos, &weapon_obj->pos, &pasteroid->pos, pasteroid->radius) )
+		return {false, weapon_will_never_hit( weapon_obj, pasteroid, pair ) != 0, cd};
+
+	bool hit = asteroid_check_collision(pasteroid, weapon_obj, &cd.hitpos, nullptr, &cd.hitnormal) != 0;
+
+	return {hit, false, cd};
+}
+
+static void asteroid_weapon_process_collision(obj_pair* pair, const asteroid_weapon_collision_data& cd)
+{
+	object	*pasteroid = pair->a;
+	object	*weapon_obj = pair->b;
+	vec3d hitpos = cd.hitpos;
+	vec3d hitnormal = cd.hitnormal;
+
+	bool weapon_override = false, asteroid_override = false;
+
+	if (scripting::hooks::OnAsteroidCollision->isActive()) {
+		weapon_override = scripting::hooks::OnAsteroidCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
+				scripting::hook_param("Object", 'o', pasteroid),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Asteroid", 'o', pasteroid),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+	if (scripting::hooks::OnWeaponCollision->isActive()) {
+		asteroid_override = scripting::hooks::OnWeaponCollision->isOverride(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', pasteroid),
+				scripting::hook_param("Object", 'o', weapon_obj),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Asteroid", 'o', pasteroid),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+
+	if(!weapon_override && !asteroid_override)
+	{
+		vec3d force = weapon_obj->phys_info.vel * Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].mass;
+		bool armed = weapon_hit( weapon_obj, pasteroid, &hitpos, -1);
+		float damage = Weapon_info[Weapons[weapon_obj->instance].weapon_info_index].damage;
+		std::array<std::optional<ConditionData>, NumHitTypes> impact_data = {};
+		impact_data[static_cast<std::underlying_type_t<HitType>>(HitType::HULL)] = ConditionData {
+			SpecialImpactCondition::DEBRIS,
+			HitType::HULL,
+			damage,
+			pasteroid->hull_strength,
+			Asteroid_info[Asteroids[pasteroid->instance].asteroid_type].initial_asteroid_strength,
+		};
+		maybe_play_conditional_impacts(impact_data, weapon_obj, pasteroid, armed, -1, &hitpos, nullptr, &hitnormal);
+		asteroid_hit( pasteroid, weapon_obj, &hitpos, damage, &force );
 	}
+
+	if (scripting::hooks::OnAsteroidCollision->isActive() && !(asteroid_override && !weapon_override))
+	{
+		scripting::hooks::OnAsteroidCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', weapon_obj),
+				scripting::hook_param("Object", 'o', pasteroid),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Asteroid", 'o', pasteroid),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+
+	if (scripting::hooks::OnWeaponCollision->isActive() && ((asteroid_override && !weapon_override) || (!asteroid_override && !weapon_override)))
+	{
+		scripting::hooks::OnWeaponCollision->run(scripting::hooks::CollisionConditions{ {weapon_obj, pasteroid} },
+			scripting::hook_param_list(scripting::hook_param("Self", 'o', pasteroid),
+				scripting::hook_param("Object", 'o', weapon_obj),
+				scripting::hook_param("Weapon", 'o', weapon_obj),
+				scripting::hook_param("Asteroid", 'o', pasteroid),
+				scripting::hook_param("Hitpos", 'o', hitpos)));
+	}
+}
+
+static void asteroid_weapon_process_collision(obj_pair* pair, const std::any& collision_data)
+{
+	asteroid_weapon_process_collision(pair, std::any_cast<const asteroid_weapon_collision_data&>(collision_data));
+}
+
+/**
+ * Checks asteroid-weapon collisions.  
+ * @param pair obj_pair pointer to the two objects. pair->a is asteroid and pair->b is weapon.
+ * @return 1 if all future collisions between these can be ignored
+ */
+int collide_asteroid_weapon( obj_pair * pair )
+{
+	const auto& [do_postproc, never_hits, collision_data] = asteroid_weapon_check_collision(pair);
+	if (do_postproc)
+		asteroid_weapon_process_collision(pair, collision_data);
+
+	return never_hits ? 1 : 0;
+}
+
+//returns never_hits, process_data
+collision_result collide_asteroid_weapon_check( obj_pair * pair )
+{
+	const auto& [do_postproc, never_hits, collision_data] = asteroid_weapon_check_collision(pair);
+
+	return {never_hits, do_postproc ? std::any(collision_data) : std::any(), &asteroid_weapon_process_collision};
 }				
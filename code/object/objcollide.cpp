@@ -8,6 +8,8 @@
 */ 
 
 
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
 #include "globalincs/linklist.h"
 #include "io/timer.h"
 #include "object/objcollide.h"
@@ -18,9 +20,12 @@
 #include "weapon/beam.h"
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
+#include "utils/spsc_ring.h"
 #include "utils/threading.h"
 
+#include <array>
 #include <limits>
+#include <thread>
 
 
 // the next 2 variables are used for pair statistics
@@ -30,27 +35,199 @@ int Num_pairs_checked = 0;
 
 SCP_vector<int> Collision_sort_list;
 
+CollisionBroadphase Collision_broadphase = CollisionBroadphase::SORT;
+
 static_assert(1 << collision_cache_bitshift > MAX_OBJECTS, "Collision pair caching currently relies on the highest possible objnum being less than 2^collision_cache_bitshift.");
 
+// Bumped whenever an object leaves the collision lists, which invalidates all cached pairs containing it at once
+static uint Collision_generation[MAX_OBJECTS];
+
 class collider_pair
 {
 public:
 	object *a;
 	object *b;
-	int signature_a;
-	int signature_b;
+	uint generation_a;
+	uint generation_b;
 	int next_check_time;
 	bool initialized;
 
-	// we need to define a constructor because the hash map can
-	// implicitly insert an object when we use the [] operator
 	collider_pair()
-		: a(nullptr), b(nullptr), signature_a(-1), signature_b(-1), next_check_time(-1), initialized(false)
+		: a(nullptr), b(nullptr), generation_a(0), generation_b(0), next_check_time(-1), initialized(false)
 	{}
+
+	// true if one of the objects left the collision lists since this pair was set up
+	bool is_stale() const
+	{
+		return !initialized || generation_a != Collision_generation[OBJ_INDEX(a)] || generation_b != Collision_generation[OBJ_INDEX(b)];
+	}
+};
+
+// Flat open addressing hash map from (objnum_a << collision_cache_bitshift) + objnum_b to the cached pair, using linear probing.
+// Pairs are never erased one by one. Stale pairs work as tombstones: lookups probe past them and the next insertion that
+// comes across one reuses its slot. Growing the table drops all of them.
+class collider_pair_cache
+{
+	static constexpr uint EMPTY_KEY = std::numeric_limits<uint>::max();
+	static constexpr size_t INITIAL_CAPACITY = 4096;
+
+	struct slot {
+		uint key = EMPTY_KEY;
+		collider_pair pair;
+	};
+
+	SCP_vector<slot> m_slots;
+	uint m_hash_shift = 0;			// 32 - log2(capacity)
+	size_t m_used = 0;				// slots holding a key, stale ones included
+
+	// statistics since the last reset_stats() call
+	size_t m_lookups = 0;
+	size_t m_probes = 0;
+	size_t m_max_probe_length = 0;
+
+	size_t home_slot(uint key) const
+	{
+		// Fibonacci hashing, the low bits of the keys are far from uniformly distributed
+		return (size_t)((key * 2654435769u) >> m_hash_shift);
+	}
+
+	void reset_slots(size_t capacity)
+	{
+		Assertion((capacity & (capacity - 1)) == 0, "Collision pair cache capacity must be a power of two!");
+
+		m_slots.assign(capacity, slot());
+		m_used = 0;
+
+		m_hash_shift = 32;
+		for (size_t c = capacity; c > 1; c >>= 1)
+			--m_hash_shift;
+	}
+
+	void rehash(size_t capacity)
+	{
+		SCP_vector<slot> old_slots;
+		old_slots.swap(m_slots);
+		reset_slots(capacity);
+
+		for (auto& old : old_slots) {
+			if (old.key == EMPTY_KEY || old.pair.is_stale())
+				continue;
+
+			size_t idx = home_slot(old.key);
+			while (m_slots[idx].key != EMPTY_KEY)
+				idx = (idx + 1) & (m_slots.size() - 1);
+
+			m_slots[idx] = old;
+			++m_used;
+		}
+	}
+
+  public:
+	collider_pair_cache() { reset_slots(INITIAL_CAPACITY); }
+
+	// Returns the pair stored for key, or claims a slot for it. A claimed slot holds an uninitialized pair.
+	collider_pair* find_or_insert(uint key)
+	{
+		Assertion(key != EMPTY_KEY, "Invalid collision pair key!");
+
+		if ((m_used + 1) * 2 > m_slots.size()) {
+			// only grow if compacting the stale pairs away does not make enough room
+			size_t live = 0;
+			for (const auto& s : m_slots) {
+				if (s.key != EMPTY_KEY && !s.pair.is_stale())
+					++live;
+			}
+			rehash((live + 1) * 4 > m_slots.size() ? m_slots.size() * 2 : m_slots.size());
+		}
+
+		const size_t mask = m_slots.size() - 1;
+		size_t idx = home_slot(key);
+		size_t reusable = std::numeric_limits<size_t>::max();
+		size_t probe_length = 1;
+
+		for (;; idx = (idx + 1) & mask, ++probe_length) {
+			auto& s = m_slots[idx];
+
+			if (s.key == key)
+				break;
+
+			if (s.key == EMPTY_KEY) {
+				if (reusable != std::numeric_limits<size_t>::max()) {
+					idx = reusable;
+				} else {
+					++m_used;
+				}
+				m_slots[idx].key = key;
+				m_slots[idx].pair = collider_pair();
+				break;
+			}
+
+			if (reusable == std::numeric_limits<size_t>::max() && s.pair.is_stale())
+				reusable = idx;
+		}
+
+		++m_lookups;
+		m_probes += probe_length;
+		m_max_probe_length = std::max(m_max_probe_length, probe_length);
+
+		return &m_slots[idx].pair;
+	}
+
+	// Returns the pair stored for key or nullptr if there is none
+	collider_pair* find(uint key)
+	{
+		const size_t mask = m_slots.size() - 1;
+		for (size_t idx = home_slot(key);; idx = (idx + 1) & mask) {
+			auto& s = m_slots[idx];
+			if (s.key == key)
+				return &s.pair;
+			if (s.key == EMPTY_KEY)
+				return nullptr;
+		}
+	}
+
+	// Calls func for every pair which is still valid
+	template <typename Func>
+	void for_each_valid(Func func)
+	{
+		for (auto& s : m_slots) {
+			if (s.key != EMPTY_KEY && !s.pair.is_stale())
+				func(s.pair);
+		}
+	}
+
+	void clear() { reset_slots(INITIAL_CAPACITY); }
+
+	size_t capacity() const { return m_slots.size(); }
+	size_t used() const { return m_used; }
+	size_t lookups() const { return m_lookups; }
+	size_t probes() const { return m_probes; }
+	size_t max_probe_length() const { return m_max_probe_length; }
+
+	void reset_stats()
+	{
+		m_lookups = 0;
+		m_probes = 0;
+		m_max_probe_length = 0;
+	}
 };
 
 static SCP_set<object*> Collision_cache_stale_objects;
-static SCP_unordered_map<uint, collider_pair> Collision_cached_pairs;
+static collider_pair_cache Collision_cached_pairs;
+
+// Entry of the persistent sweep-and-prune list.  The list stays sorted along x by min[0] between frames,
+// so once objects have moved a little it only takes an almost linear insertion sort to restore the order.
+struct sap_collider {
+	int objnum;		// -1 if the object was removed since the last update
+	float min[3];
+	float max[3];
+};
+
+static SCP_vector<sap_collider> Sap_colliders;
+static int Sap_collider_index[MAX_OBJECTS];	// position of each object in Sap_colliders, -1 if not in it
+static size_t Sap_num_sorted = 0;			// entries before this index were sorted during the last update
+static size_t Sap_num_removed = 0;			// number of holes left in the list by obj_remove_collider()
+static bool Sap_list_stale = true;			// set when a frame went by without updating the list
 
 class checkobject;
 extern checkobject CheckObjects[MAX_OBJECTS];
@@ -98,6 +275,9 @@ bool reject_due_collision_groups(object *A, object *B)
 
 MONITOR(NumPairs)
 MONITOR(NumPairsChecked)
+MONITOR(CollisionCacheOccupancy)		// percentage of cache slots in use, stale pairs included
+MONITOR(CollisionCacheMaxProbeLength)	// longest probe sequence of the last frame
+MONITOR(CollisionCacheAvgProbeLength)	// average probe sequence length of the last frame, times 100
 
 //	See if two lines intersect by doing recursive subdivision.
 //	Bails out if larger distance traveled is less than sum of radii + 1.0f.
@@ -510,29 +690,24 @@ int collide_remove_weapons( )
 	}
 
 	// first pass is to see if any of the weapons don't have collision pairs.
-	for (auto& pair : Collision_cached_pairs) {
-        collider_pair* pair_obj = &pair.second;
-
-		if (!pair_obj->initialized) {
-			continue;
-		}
+	Collision_cached_pairs.for_each_valid([](collider_pair& pair) {
+		if (pair.a->type == OBJ_WEAPON) {
+			crw_check_weapon(pair.a->instance, pair.next_check_time);
 
-		if (pair_obj->a->type == OBJ_WEAPON && pair_obj->signature_a == pair_obj->a->signature) {
-			crw_check_weapon(pair_obj->a->instance, pair_obj->next_check_time);
-
-			if (crw_status[pair_obj->a->instance] == CRW_CAN_DELETE) {
-				pair_obj->initialized = false;
+			if (crw_status[pair.a->instance] == CRW_CAN_DELETE) {
+				pair.initialized = false;
 			}
 		}
 
-		if (pair_obj->b->type == OBJ_WEAPON && pair_obj->signature_b == pair_obj->b->signature) {
-			crw_check_weapon(pair_obj->b->instance, pair_obj->next_check_time);
+		// the pair may have just been invalidated because of a, but b still needs to be checked
+		if (pair.b->type == OBJ_WEAPON) {
+			crw_check_weapon(pair.b->instance, pair.next_check_time);
 
-			if (crw_status[pair_obj->b->instance] == CRW_CAN_DELETE) {
-				pair_obj->initialized = false;
+			if (crw_status[pair.b->instance] == CRW_CAN_DELETE) {
+				pair.initialized = false;
 			}
 		}
-	}
+	});
 
 	// for each weapon which could be removed, delete the object
 	int num_deleted = 0;
@@ -586,6 +761,10 @@ void obj_add_collider(int obj_index)
 
 	Collision_sort_list.push_back(obj_index);
 
+	// the bounds are filled in and the entry is sorted into place during the next update
+	Sap_collider_index[obj_index] = (int)Sap_colliders.size();
+	Sap_colliders.push_back(sap_collider{obj_index, {}, {}});
+
 	objp->flags.remove(Object::Object_Flags::Not_in_coll);
 }
 
@@ -603,6 +782,16 @@ void obj_remove_collider(int obj_index)
 		}
 	}
 
+	// drop all cached pairs of this object
+	++Collision_generation[obj_index];
+
+	// leave a hole so the sweep-and-prune list stays sorted; it is compacted during the next update
+	if (Sap_collider_index[obj_index] >= 0) {
+		Sap_colliders[Sap_collider_index[obj_index]].objnum = -1;
+		Sap_collider_index[obj_index] = -1;
+		++Sap_num_removed;
+	}
+
 	Objects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
 }
 
@@ -610,23 +799,22 @@ void obj_reset_colliders()
 {
 	Collision_sort_list.clear();
 	Collision_cached_pairs.clear();
+
+	Sap_colliders.clear();
+	std::fill(std::begin(Sap_collider_index), std::end(Sap_collider_index), -1);
+	Sap_num_sorted = 0;
+	Sap_num_removed = 0;
+	Sap_list_stale = true;
 }
 
 void obj_collide_retime_stale_pairs()
 {
 	TRACE_SCOPE(tracing::RetimeCollisionCache);
 
-	auto it = Collision_cached_pairs.begin();
-	while (it != Collision_cached_pairs.end()) {
-		auto &pair = it->second;
-		if (pair.signature_a != pair.a->signature || pair.signature_b != pair.b->signature) {
-			it = Collision_cached_pairs.erase(it);
-		} else {
-			if (pair.a->flags[Object::Object_Flags::Collision_cache_stale] || pair.b->flags[Object::Object_Flags::Collision_cache_stale])
-				pair.next_check_time = timestamp(0);
-			it++;
-		}
-	}
+	Collision_cached_pairs.for_each_valid([](collider_pair& pair) {
+		if (pair.a->flags[Object::Object_Flags::Collision_cache_stale] || pair.b->flags[Object::Object_Flags::Collision_cache_stale])
+			pair.next_check_time = timestamp(0);
+	});
 
 	for (auto objp : Collision_cache_stale_objects)
 		objp->flags.remove(Object::Object_Flags::Collision_cache_stale);
@@ -725,35 +913,50 @@ void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axi
     }
 }
 
-struct collision_thread_data {
-	struct collision_queue_item {
-		obj_pair objs;
-		uint ctype;
-	};
-	struct collision_queue_result {
+// Pairs are handed to the collision workers in blocks, so the main thread and a worker only synchronize once per block
+constexpr size_t COLLISION_BLOCK_SIZE = 64;
+// Number of blocks that can be waiting on (and coming back from) a single worker
+constexpr size_t COLLISION_RING_SIZE = 256;
+
+struct collision_block {
+	struct item {
 		obj_pair objs;
+		collision_result (*check_collision)( obj_pair *pair );
 		bool never_recheck;
 		std::any collision_data;
-		void (*process_collision)( obj_pair *pair,  const std::any& collision_data );
+		void (*process_collision)( obj_pair *pair, const std::any& collision_data );
 	};
 
-	std::atomic_size_t queue_length, result_length;
-	std::mutex queue_mutex, result_mutex;
-	std::unique_ptr<SCP_vector<collision_queue_item>> queue_load, queue_process;
-	std::unique_ptr<SCP_vector<collision_queue_result>> queue_results, queue_send;
-
-	collision_thread_data() :
-		queue_length(0),
-		result_length(0),
-		queue_load(std::make_unique<SCP_vector<collision_queue_item>>()),
-		queue_process(std::make_unique<SCP_vector<collision_queue_item>>()),
-		queue_results(std::make_unique<SCP_vector<collision_queue_result>>()),
-		queue_send(std::make_unique<SCP_vector<collision_queue_result>>()) {}
+	std::array<item, COLLISION_BLOCK_SIZE> items;
+	size_t count = 0;
+
+	void check_all() {
+		for (size_t i = 0; i < count; i++) {
+			auto& check = items[i];
+			auto&& [never_check_again, collision_data_maybe, collision_fnc] = check.check_collision(&check.objs);
+			check.never_recheck = never_check_again;
+			check.collision_data = std::move(collision_data_maybe);
+			check.process_collision = collision_fnc;
+		}
+	}
+};
+
+struct collision_thread_data {
+	util::spsc_ring<collision_block*, COLLISION_RING_SIZE> submitted;	// main thread -> worker
+	util::spsc_ring<collision_block*, COLLISION_RING_SIZE> finished;	// worker -> main thread
 };
 
 std::unique_ptr<collision_thread_data[]> collision_thread_data_buffer;
 std::atomic_bool collision_processing_done = false;
 
+// All of these are only touched by the main thread
+static SCP_vector<std::unique_ptr<collision_block>> Collision_blocks;
+static SCP_vector<collision_block*> Collision_free_blocks;
+static SCP_vector<collision_block*> Collision_inline_blocks;	// blocks the main thread checked itself since all workers were backed up
+static collision_block* Collision_current_block = nullptr;
+static size_t Collision_blocks_in_flight = 0;
+static size_t Collision_next_worker = 0;
+
 void spin_up_mp_collision() {
 	collision_processing_done.store(false);
 	threading::spin_up_threaded_task(threading::WorkerThreadTask::COLLISION);
@@ -761,74 +964,105 @@ void spin_up_mp_collision() {
 
 void spin_down_mp_collision() {
 	threading::spin_down_threaded_task();
-	collision_processing_done.store(true);
-	threading::spin_down_wait_complete();
+	collision_processing_done.store(true, std::memory_order_release);
 }
 
-void queue_mp_collision(uint ctype, const obj_pair& colliding) {
-	size_t min_queue_length = std::numeric_limits<size_t>::max();
-	size_t target_thread = 0;
-	for (size_t i = 0; i < threading::get_num_workers(); i++) {
-		size_t queue_length = collision_thread_data_buffer[i].queue_length.load(std::memory_order_acquire);
-		if (queue_length == 0) {
-			target_thread = i;
-			break;
-		}
-		else if (queue_length < min_queue_length) {
-			target_thread = i;
-			min_queue_length = queue_length;
+static collision_block* get_free_collision_block() {
+	if (Collision_free_blocks.empty()) {
+		Collision_blocks.emplace_back(std::make_unique<collision_block>());
+		return Collision_blocks.back().get();
+	}
+
+	collision_block* block = Collision_free_blocks.back();
+	Collision_free_blocks.pop_back();
+	return block;
+}
+
+static void submit_collision_block() {
+	collision_block* block = Collision_current_block;
+	Collision_current_block = nullptr;
+
+	size_t num_workers = threading::get_num_workers();
+	for (size_t i = 0; i < num_workers; i++) {
+		size_t worker = (Collision_next_worker + i) % num_workers;
+		if (collision_thread_data_buffer[worker].submitted.try_push(block)) {
+			Collision_next_worker = (worker + 1) % num_workers;
+			++Collision_blocks_in_flight;
+			return;
 		}
 	}
-	{
-		auto& thread = collision_thread_data_buffer[target_thread];
-		std::scoped_lock lock(thread.queue_mutex);
-		thread.queue_load->emplace_back( collision_thread_data::collision_queue_item{colliding, ctype} );
-		thread.queue_length.fetch_add(1, std::memory_order_release);
+
+	// every worker is backed up, so make ourselves useful instead of waiting
+	block->check_all();
+	Collision_inline_blocks.push_back(block);
+}
+
+void queue_mp_collision(collision_result (*check_collision)( obj_pair *pair ), const obj_pair& colliding) {
+	if (Collision_current_block == nullptr) {
+		Collision_current_block = get_free_collision_block();
+		Collision_current_block->count = 0;
 	}
+
+	auto& item = Collision_current_block->items[Collision_current_block->count++];
+	item.objs = colliding;
+	item.check_collision = check_collision;
+
+	if (Collision_current_block->count == COLLISION_BLOCK_SIZE)
+		submit_collision_block();
+}
+
+static void process_collision_block(collision_block* block) {
+	for (size_t i = 0; i < block->count; i++) {
+		auto& collision = block->items[i];
+		uint key = (OBJ_INDEX(collision.objs.a) << collision_cache_bitshift) + OBJ_INDEX(collision.objs.b);
+		collider_pair *collision_info = Collision_cached_pairs.find(key);
+
+		if (collision.collision_data.has_value())
+			collision.process_collision(&collision.objs, collision.collision_data);
+
+		if (collision_info == nullptr) {
+			// the pair was dropped while the worker was busy with it
+		} else if (collision.never_recheck) {
+			collision_info->next_check_time = -1;
+		} else {
+			collision_info->next_check_time = collision.objs.next_check_time;
+		}
+
+		collision.collision_data.reset();
+	}
+
+	block->count = 0;
+	Collision_free_blocks.push_back(block);
 }
 
 void post_process_threaded_collisions() {
-	SCP_map<size_t, size_t> workerThreads;
-	for (size_t i = 0; i < threading::get_num_workers(); i++)
-		workerThreads.emplace(i, 0);
+	if (Collision_current_block != nullptr) {
+		if (Collision_current_block->count > 0)
+			submit_collision_block();
+		else {
+			Collision_free_blocks.push_back(Collision_current_block);
+			Collision_current_block = nullptr;
+		}
+	}
 
-	while (!workerThreads.empty()) {
-		for(auto& [i, processed] : workerThreads) {
-			auto& thread = collision_thread_data_buffer[i];
+	// nothing else will be submitted, so the workers can leave as soon as their rings run dry
+	spin_down_mp_collision();
 
-			size_t queue_length = thread.queue_length.load(std::memory_order_acquire);
-			size_t result_length = thread.result_length.load(std::memory_order_acquire);
+	for (auto block : Collision_inline_blocks)
+		process_collision_block(block);
+	Collision_inline_blocks.clear();
 
-			if (result_length > processed) {
-				{
-					std::scoped_lock lock(thread.result_mutex);
-					thread.queue_results.swap(thread.queue_send);
-				}
-				for (auto& collision : *thread.queue_send) {
-					uint key = (OBJ_INDEX(collision.objs.a) << collision_cache_bitshift) + OBJ_INDEX(collision.objs.b);
-					collider_pair *collision_info = &Collision_cached_pairs[key];
-
-					if (collision.collision_data.has_value())
-						collision.process_collision(&collision.objs, collision.collision_data);
-
-					if (collision.never_recheck) {
-						collision_info->next_check_time = -1;
-					} else {
-						collision_info->next_check_time = collision.objs.next_check_time;
-					}
-				}
-				processed += thread.queue_send->size();
-				thread.queue_send->clear();
-			}
-			else if (queue_length == 0) {
-				thread.queue_results->clear();
-				workerThreads.erase(i);
-				break;
+	while (Collision_blocks_in_flight > 0) {
+		for (size_t i = 0; i < threading::get_num_workers(); i++) {
+			collision_block* block;
+			while (collision_thread_data_buffer[i].finished.try_pop(block)) {
+				process_collision_block(block);
+				--Collision_blocks_in_flight;
 			}
 		}
 	}
 
-	spin_down_mp_collision();
+	threading::spin_down_wait_complete();
 }
 
 void obj_collide_pair(object *A, object *B)
@@ -836,8 +1070,8 @@ void obj_collide_pair(object *A, object *B)
     TRACE_SCOPE(tracing::CollidePair);
 
     int (*check_collision)( obj_pair *pair ) = nullptr;
+	collision_result (*check_collision_mp)( obj_pair *pair ) = nullptr;
     int swapped = 0;
-	bool support_mp = false;
 
     if ( A==B ) return;		// Don't check collisions with yourself
 
@@ -862,24 +1096,28 @@ void obj_collide_pair(object *A, object *B)
         case COLLISION_OF(OBJ_WEAPON,OBJ_SHIP):
             swapped = 1;
             check_collision = collide_ship_weapon;
-			support_mp = true;
+			check_collision_mp = collide_ship_weapon_check;
             break;
         case COLLISION_OF(OBJ_SHIP, OBJ_WEAPON):
             check_collision = collide_ship_weapon;
-			support_mp = true;
+			check_collision_mp = collide_ship_weapon_check;
             break;
         case COLLISION_OF(OBJ_DEBRIS, OBJ_WEAPON):
             check_collision = collide_debris_weapon;
+			check_collision_mp = collide_debris_weapon_check;
             break;
         case COLLISION_OF(OBJ_WEAPON, OBJ_DEBRIS):
             swapped = 1;
             check_collision = collide_debris_weapon;
+			check_collision_mp = collide_debris_weapon_check;
             break;
         case COLLISION_OF(OBJ_DEBRIS, OBJ_SHIP):
             check_collision = collide_debris_ship;
+			check_collision_mp = collide_debris_ship_check;
             break;
         case COLLISION_OF(OBJ_SHIP, OBJ_DEBRIS):
             check_collision = collide_debris_ship;
+			check_collision_mp = collide_debris_ship_check;
             swapped = 1;
             break;
 		case COLLISION_OF(OBJ_DEBRIS, OBJ_PROP):
@@ -891,16 +1129,20 @@ void obj_collide_pair(object *A, object *B)
 			break;
         case COLLISION_OF(OBJ_ASTEROID, OBJ_WEAPON):
             check_collision = collide_asteroid_weapon;
+			check_collision_mp = collide_asteroid_weapon_check;
             break;
         case COLLISION_OF(OBJ_WEAPON, OBJ_ASTEROID):
             swapped = 1;
             check_collision = collide_asteroid_weapon;
+			check_collision_mp = collide_asteroid_weapon_check;
             break;
         case COLLISION_OF(OBJ_ASTEROID, OBJ_SHIP):
             check_collision = collide_asteroid_ship;
+			check_collision_mp = collide_asteroid_ship_check;
             break;
         case COLLISION_OF(OBJ_SHIP, OBJ_ASTEROID):
             check_collision = collide_asteroid_ship;
+			check_collision_mp = collide_asteroid_ship_check;
             swapped = 1;
             break;
 		case COLLISION_OF(OBJ_ASTEROID, OBJ_PROP):
@@ -914,7 +1156,7 @@ void obj_collide_pair(object *A, object *B)
             check_collision = collide_ship_ship;
 #ifdef NDEBUG
 			//This is, due to debug prints, unfortunately only safe in release builds...
-			support_mp = true;
+			check_collision_mp = collide_ship_ship_check;
 #endif
             break;
 		case COLLISION_OF(OBJ_PROP, OBJ_SHIP):
@@ -1013,6 +1255,7 @@ void obj_collide_pair(object *A, object *B)
                 } else {
                     check_collision = collide_weapon_weapon;
                 }
+				check_collision_mp = collide_weapon_weapon_check;
             }
 
             break;
@@ -1032,25 +1275,16 @@ void obj_collide_pair(object *A, object *B)
     bool valid = false;
     uint key = (OBJ_INDEX(A) << collision_cache_bitshift) + OBJ_INDEX(B);
 
-    collider_pair* collision_info = &Collision_cached_pairs[key];
+    collider_pair* collision_info = Collision_cached_pairs.find_or_insert(key);
 
-    if ( collision_info->initialized ) {
-        // make sure we're referring to the correct objects in case the original pair was deleted
-        if ( collision_info->signature_a == collision_info->a->signature &&
-             collision_info->signature_b == collision_info->b->signature ) {
-            valid = true;
-        } else {
-            collision_info->a = A;
-            collision_info->b = B;
-            collision_info->signature_a = A->signature;
-            collision_info->signature_b = B->signature;
-            collision_info->next_check_time = timestamp(0);
-        }
+    // make sure we're referring to the correct objects in case the original pair was deleted
+    if ( !collision_info->is_stale() ) {
+        valid = true;
     } else {
         collision_info->a = A;
         collision_info->b = B;
-        collision_info->signature_a = A->signature;
-        collision_info->signature_b = B->signature;
+        collision_info->generation_a = Collision_generation[OBJ_INDEX(A)];
+        collision_info->generation_b = Collision_generation[OBJ_INDEX(B)];
         collision_info->initialized = true;
         collision_info->next_check_time = timestamp(0);
     }
@@ -1128,8 +1362,8 @@ void obj_collide_pair(object *A, object *B)
     new_pair.b = B;
     new_pair.next_check_time = collision_info->next_check_time;
 
-	if (threading::is_threading() && support_mp) {
-		queue_mp_collision(ctype, new_pair);
+	if (threading::is_threading() && check_collision_mp != nullptr) {
+		queue_mp_collision(check_collision_mp, new_pair);
 	}
 	else {
 		if (check_collision(&new_pair)) {
@@ -1141,6 +1375,9 @@ void obj_collide_pair(object *A, object *B)
 	}
 }
 
+// when set, every pair handed to the narrow phase by a broadphase is also recorded here (used by CollisionBroadphase::VERIFY)
+SCP_vector<std::pair<int, int>>* Broadphase_pair_log = nullptr;
+
 void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<int> &list, int axis, bool collide)
 {
     TRACE_SCOPE(tracing::FindOverlapColliders);
@@ -1164,6 +1401,9 @@ void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<in
                 }
 
                 if ( collide ) {
+                    if (Broadphase_pair_log != nullptr)
+                        Broadphase_pair_log->emplace_back(in_index, overlappers[j]);
+
                     obj_collide_pair(&Objects[in_index], &Objects[overlappers[j]]);
                 }
             } else {
@@ -1187,82 +1427,250 @@ void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<in
     }
 }
 
+// Drops the holes left by removed colliders while keeping the order of the remaining entries
+void obj_sap_compact()
+{
+	size_t num_sorted = 0;
+	size_t out = 0;
+	for (size_t i = 0; i < Sap_colliders.size(); ++i) {
+		if (Sap_colliders[i].objnum < 0)
+			continue;
+
+		if (i < Sap_num_sorted)
+			++num_sorted;
+
+		Sap_collider_index[Sap_colliders[i].objnum] = (int)out;
+		Sap_colliders[out++] = Sap_colliders[i];
+	}
+	Sap_colliders.resize(out);
+
+	Sap_num_sorted = num_sorted;
+	Sap_num_removed = 0;
+}
+
+void obj_sap_update()
+{
+	TRACE_SCOPE(tracing::SortColliders);
+
+	obj_sap_compact();
+	const size_t num_sorted = Sap_num_sorted;
+
+	for (auto& collider : Sap_colliders) {
+		for (int axis = 0; axis < 3; ++axis) {
+			collider.min[axis] = obj_get_collider_endpoint(collider.objnum, axis, true);
+			collider.max[axis] = obj_get_collider_endpoint(collider.objnum, axis, false);
+		}
+	}
+
+	const auto by_min_x = [](const sap_collider& a, const sap_collider& b) { return a.min[0] < b.min[0]; };
+
+	if (Sap_list_stale) {
+		// nothing to gain from the old order, so just sort everything
+		std::sort(Sap_colliders.begin(), Sap_colliders.end(), by_min_x);
+	} else {
+		// objects only moved a bit since the last frame, so insertion sort is close to linear for the old entries
+		for (size_t i = 1; i < num_sorted; ++i) {
+			sap_collider moving = Sap_colliders[i];
+			size_t j = i;
+			while (j > 0 && by_min_x(moving, Sap_colliders[j - 1])) {
+				Sap_colliders[j] = Sap_colliders[j - 1];
+				--j;
+			}
+			Sap_colliders[j] = moving;
+		}
+
+		// colliders added since the last frame are sorted on their own and then merged in
+		const auto first_new = Sap_colliders.begin() + num_sorted;
+		std::sort(first_new, Sap_colliders.end(), by_min_x);
+		std::inplace_merge(Sap_colliders.begin(), first_new, Sap_colliders.end(), by_min_x);
+	}
+
+	for (size_t i = 0; i < Sap_colliders.size(); ++i)
+		Sap_collider_index[Sap_colliders[i].objnum] = (int)i;
+
+	Sap_num_sorted = Sap_colliders.size();
+	Sap_list_stale = false;
+}
+
+// Sweeps the sorted list along x and hands every pair whose bounds overlap on all three axes to the narrow phase.
+void obj_sap_find_pairs(bool collide)
+{
+	TRACE_SCOPE(tracing::FindOverlapColliders);
+
+	// colliders added by a collision response are only picked up next frame, just like with the sorted lists
+	const size_t num_colliders = Sap_colliders.size();
+
+	for (size_t i = 0; i < num_colliders; ++i) {
+		// copy the entry, a collision response may add colliders and reallocate the list
+		const sap_collider a = Sap_colliders[i];
+		if (a.objnum < 0)
+			continue;
+
+		for (size_t j = i + 1; j < num_colliders; ++j) {
+			const sap_collider& b = Sap_colliders[j];
+
+			if (b.min[0] > a.max[0])
+				break;
+
+			if (b.objnum < 0)
+				continue;
+
+			if (a.min[1] > b.max[1] || b.min[1] > a.max[1] || a.min[2] > b.max[2] || b.min[2] > a.max[2])
+				continue;
+
+			const int objnum_b = b.objnum;
+
+			if (Broadphase_pair_log != nullptr)
+				Broadphase_pair_log->emplace_back(objnum_b, a.objnum);
+
+			// same argument order as the sorted lists use, the later collider goes first
+			if (collide)
+				obj_collide_pair(&Objects[objnum_b], &Objects[a.objnum]);
+		}
+	}
+}
+
+bool obj_sap_bounds_overlap(int objnum_a, int objnum_b)
+{
+	if (Sap_collider_index[objnum_a] < 0 || Sap_collider_index[objnum_b] < 0)
+		return false;
+
+	const sap_collider& a = Sap_colliders[Sap_collider_index[objnum_a]];
+	const sap_collider& b = Sap_colliders[Sap_collider_index[objnum_b]];
+
+	for (int axis = 0; axis < 3; ++axis) {
+		if (a.min[axis] > b.max[axis] || b.min[axis] > a.max[axis])
+			return false;
+	}
+
+	return true;
+}
+
+// Compares the pairs found by the sweep-and-prune list against the ones the sorted lists collided.
+// The sorted lists also emit pairs which only overlap on the last axis, those are ignored here.
+void obj_sap_verify_pairs(SCP_vector<std::pair<int, int>>& sap_pairs, SCP_vector<std::pair<int, int>>& sort_pairs)
+{
+	const auto normalize = [](SCP_vector<std::pair<int, int>>& pairs) {
+		for (auto& pair : pairs) {
+			if (pair.first > pair.second)
+				std::swap(pair.first, pair.second);
+		}
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+	};
+
+	sort_pairs.erase(std::remove_if(sort_pairs.begin(), sort_pairs.end(), [](const std::pair<int, int>& pair) {
+		return !obj_sap_bounds_overlap(pair.first, pair.second);
+	}), sort_pairs.end());
+
+	normalize(sap_pairs);
+	normalize(sort_pairs);
+
+	SCP_vector<std::pair<int, int>> missing, extra;
+	std::set_difference(sort_pairs.begin(), sort_pairs.end(), sap_pairs.begin(), sap_pairs.end(), std::back_inserter(missing));
+	std::set_difference(sap_pairs.begin(), sap_pairs.end(), sort_pairs.begin(), sort_pairs.end(), std::back_inserter(extra));
+
+	if (missing.empty() && extra.empty())
+		return;
+
+	mprintf(("Collision broadphase mismatch: sweep-and-prune is missing %d and has %d extra of %d pairs\n",
+		(int)missing.size(), (int)extra.size(), (int)sort_pairs.size()));
+	for (const auto& pair : missing)
+		mprintf(("  missing pair %d (%s) - %d (%s)\n", pair.first, Object_type_names[Objects[pair.first].type], pair.second, Object_type_names[Objects[pair.second].type]));
+	for (const auto& pair : extra)
+		mprintf(("  extra pair %d (%s) - %d (%s)\n", pair.first, Object_type_names[Objects[pair.first].type], pair.second, Object_type_names[Objects[pair.second].type]));
+}
+
 } //anon namespace
 
 void collide_mp_worker_thread(size_t threadIdx) {
 	auto& thread = collision_thread_data_buffer[threadIdx];
-	thread.result_length.store(0);
-
-	while (!thread.queue_process->empty() || thread.queue_length.load(std::memory_order_acquire) > 0 || !collision_processing_done.load(std::memory_order_acquire)) {
-		if (!thread.queue_process->empty()) {
-
-			for (auto& collision_check : *thread.queue_process) {
-				collision_result (*check_collision)( obj_pair *pair ) = nullptr;
-
-				switch( collision_check.ctype )	{
-					case COLLISION_OF(OBJ_WEAPON, OBJ_SHIP):
-					case COLLISION_OF(OBJ_SHIP, OBJ_WEAPON):
-						check_collision = collide_ship_weapon_check;
-						break;
-					case COLLISION_OF(OBJ_SHIP, OBJ_SHIP):
-						check_collision = collide_ship_ship_check;
-						break;
-					default:
-						UNREACHABLE("Got non MP-compatible collision type %d!", collision_check.ctype);
-						thread.queue_length.fetch_sub(1, std::memory_order_release); // keep the counter balanced
-						continue;                                                    // skip the bad pair
-				}
 
-				auto&& [never_check_again, collision_data_maybe, collision_fnc] = check_collision(&collision_check.objs);
+	while (true) {
+		// the main thread only signals done after its last submission, so an empty ring after that means we're finished
+		bool done = collision_processing_done.load(std::memory_order_acquire);
 
-				{
-					std::scoped_lock lock{thread.result_mutex};
-					thread.queue_results->emplace_back(collision_thread_data::collision_queue_result{collision_check.objs, never_check_again, collision_data_maybe, collision_fnc});
-				}
-				thread.result_length.fetch_add(1, std::memory_order_release);
-				thread.queue_length.fetch_sub(1, std::memory_order_release);
-			}
-			thread.queue_process->clear();
+		collision_block* block;
+		if (thread.submitted.try_pop(block)) {
+			block->check_all();
+
+			while (!thread.finished.try_push(block))
+				std::this_thread::yield();
 		}
-		else if (thread.queue_length.load(std::memory_order_acquire) > 0) {
-			//We must have data in the load queue then.
-			std::scoped_lock lock(thread.queue_mutex);
-			thread.queue_load.swap(thread.queue_process);
-			thread.queue_load->clear();
+		else if (done) {
+			break;
 		}
 	}
 }
 
-void collide_init() {
-	if (threading::is_threading())
-		collision_thread_data_buffer = std::make_unique<collision_thread_data[]>(threading::get_num_workers());
+static const char* collide_broadphase_name(CollisionBroadphase broadphase)
+{
+	switch (broadphase) {
+		case CollisionBroadphase::SORT:
+			return "sort";
+		case CollisionBroadphase::SWEEP_AND_PRUNE:
+			return "sap";
+		case CollisionBroadphase::VERIFY:
+			return "verify";
+		default:
+			UNREACHABLE("Unhandled collision broadphase %d!", static_cast<int>(broadphase));
+			return "";
+	}
 }
 
-// used only in obj_sort_and_collide()
-static SCP_vector<int> sort_list_y;
-static SCP_vector<int> sort_list_z;
+static bool collide_parse_broadphase(const char* name, CollisionBroadphase* broadphase)
+{
+	for (auto candidate : {CollisionBroadphase::SORT, CollisionBroadphase::SWEEP_AND_PRUNE, CollisionBroadphase::VERIFY}) {
+		if (!stricmp(name, collide_broadphase_name(candidate))) {
+			*broadphase = candidate;
+			return true;
+		}
+	}
 
-void obj_sort_and_collide(SCP_vector<int>* Collision_list)
+	return false;
+}
+
+DCF(collision_broadphase, "Selects how object pairs are found for collision detection")
 {
-	if (Cmdline_dis_collisions)
+	SCP_string arg;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: collision_broadphase [sort|sap|verify]\n");
+		dc_printf("\tsort    Re-sorts all colliders along each axis every frame\n");
+		dc_printf("\tsap     Uses the persistent sweep-and-prune list\n");
+		dc_printf("\tverify  Runs both and logs the pairs they disagree on\n");
 		return;
+	}
 
-	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("Collision broadphase is '%s'\n", collide_broadphase_name(Collision_broadphase));
 		return;
+	}
+
+	dc_stuff_string_white(arg);
+	if (!collide_parse_broadphase(arg.c_str(), &Collision_broadphase)) {
+		dc_printf("Error: Unknown broadphase '%s'\n", arg.c_str());
+	}
+}
 
+void collide_init() {
 	if (threading::is_threading())
-		spin_up_mp_collision();
+		collision_thread_data_buffer = std::make_unique<collision_thread_data[]>(threading::get_num_workers());
 
-	if (!Collision_cache_stale_objects.empty()) {
-		obj_collide_retime_stale_pairs();
+	if (Cmdline_collision_broadphase != nullptr && !collide_parse_broadphase(Cmdline_collision_broadphase, &Collision_broadphase)) {
+		Warning(LOCATION, "Unknown collision broadphase '%s' given to -collision_broadphase! Valid values are 'sort', 'sap' and 'verify'.", Cmdline_collision_broadphase);
 	}
+}
 
-	// the main use case is to go through the main Collision detection list, so use that if
-	// nothing is defined.
-	if (Collision_list == nullptr) {
-		Collision_list = &Collision_sort_list;
-	}
+// used only in obj_sort_and_collide()
+static SCP_vector<int> sort_list_y;
+static SCP_vector<int> sort_list_z;
+static SCP_vector<std::pair<int, int>> verify_sap_pairs;
+static SCP_vector<std::pair<int, int>> verify_sort_pairs;
 
+// Finds the overlapping pairs by sorting the given colliders along each axis in turn
+static void obj_sort_and_find_pairs(SCP_vector<int>* Collision_list)
+{
 	sort_list_y.clear();
 	{
 		TRACE_SCOPE(tracing::SortColliders);
@@ -1283,9 +1691,63 @@ void obj_sort_and_collide(SCP_vector<int>* Collision_list)
 		obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
 	}
 	obj_find_overlap_colliders(sort_list_y, sort_list_z, 2, true);
+}
+
+void obj_sort_and_collide(SCP_vector<int>* Collision_list)
+{
+	if (Cmdline_dis_collisions)
+		return;
+
+	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
+		return;
+
+	if (threading::is_threading())
+		spin_up_mp_collision();
+
+	if (!Collision_cache_stale_objects.empty()) {
+		obj_collide_retime_stale_pairs();
+	}
+
+	// the sweep-and-prune list always covers all colliders, custom lists (like multi rollback) are sorted from scratch
+	if (Collision_list == nullptr && Collision_broadphase != CollisionBroadphase::SORT) {
+		obj_sap_update();
+
+		if (Collision_broadphase == CollisionBroadphase::SWEEP_AND_PRUNE) {
+			obj_sap_find_pairs(true);
+		} else {
+			verify_sap_pairs.clear();
+			Broadphase_pair_log = &verify_sap_pairs;
+			obj_sap_find_pairs(false);
+
+			verify_sort_pairs.clear();
+			Broadphase_pair_log = &verify_sort_pairs;
+			obj_sort_and_find_pairs(&Collision_sort_list);
+
+			Broadphase_pair_log = nullptr;
+			obj_sap_verify_pairs(verify_sap_pairs, verify_sort_pairs);
+		}
+	} else {
+		// the main use case is to go through the main Collision detection list, so use that if
+		// nothing is defined.
+		if (Collision_list == nullptr) {
+			Collision_list = &Collision_sort_list;
+
+			// keep the unused list from filling up with holes so switching over later stays cheap
+			Sap_list_stale = true;
+			if (Sap_num_removed > Sap_colliders.size() / 2)
+				obj_sap_compact();
+		}
+
+		obj_sort_and_find_pairs(Collision_list);
+	}
 
 	if (threading::is_threading())
 		post_process_threaded_collisions();
+
+	mon_CollisionCacheOccupancy = (int)(Collision_cached_pairs.used() * 100 / Collision_cached_pairs.capacity());
+	mon_CollisionCacheMaxProbeLength = (int)Collision_cached_pairs.max_probe_length();
+	mon_CollisionCacheAvgProbeLength = Collision_cached_pairs.lookups() > 0 ? (int)(Collision_cached_pairs.probes() * 100 / Collision_cached_pairs.lookups()) : 0;
+	Collision_cached_pairs.reset_stats();
 }
 
 void collide_apply_gravity_flags_weapons() {
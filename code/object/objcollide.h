@@ -67,6 +67,15 @@ using collision_result = std::tuple<bool, std::any, void (*)(obj_pair *, const s
 
 extern SCP_vector<int> Collision_sort_list;
 
+// How obj_sort_and_collide() finds the object pairs that need a narrow phase check
+enum class CollisionBroadphase : uint8_t {
+	SORT,				// re-sort all colliders along each axis every frame
+	SWEEP_AND_PRUNE,	// persistent sweep-and-prune list, kept sorted between frames
+	VERIFY				// run both and log any pairs on which they disagree (debugging only)
+};
+
+extern CollisionBroadphase Collision_broadphase;
+
 #define COLLISION_OF(a,b) (((a)<<8)|(b))
 
 void set_hit_struct_info(collision_info_struct *hit, mc_info *mc, bool submodel_move_hit);
@@ -101,6 +110,8 @@ void collide_init();
 // Returns 1 if all future collisions between these can be ignored
 // CODE is locatated in CollideWeaponWeapon.cpp
 int collide_weapon_weapon( obj_pair * pair );
+//Same as above, but for deferred collision processing / usage in multithreading
+collision_result collide_weapon_weapon_check( obj_pair * pair );
 
 // Checks ship-weapon collisions.  pair->a is ship and pair->b is weapon.
 // Returns 1 if all future collisions between these can be ignored
@@ -114,11 +125,15 @@ collision_result collide_ship_weapon_check( obj_pair * pair );
 // Returns 1 if all future collisions between these can be ignored
 // CODE is locatated in CollideDebrisWeapon.cpp
 int collide_debris_weapon( obj_pair * pair );
+//Same as above, but for deferred collision processing / usage in multithreading
+collision_result collide_debris_weapon_check( obj_pair * pair );
 
 // Checks debris-ship collisions.  pair->a is debris and pair->b is ship.
 // Returns 1 if all future collisions between these can be ignored
 // CODE is locatated in CollideDebrisShip.cpp
 int collide_debris_ship( obj_pair * pair );
+//Same as above, but for deferred collision processing / usage in multithreading
+collision_result collide_debris_ship_check( obj_pair * pair );
 
 // Checks debris-prop collisions.  pair->a is debris and pair->b is prop.
 // Returns 1 if all future collisions between these can be ignored
@@ -128,6 +143,9 @@ int collide_debris_prop(obj_pair* pair);
 int collide_asteroid_prop(obj_pair* pair);
 int collide_asteroid_ship(obj_pair *pair);
 int collide_asteroid_weapon(obj_pair *pair);
+//Same as above, but for deferred collision processing / usage in multithreading
+collision_result collide_asteroid_ship_check(obj_pair *pair);
+collision_result collide_asteroid_weapon_check(obj_pair *pair);
 
 // Checks ship-ship collisions.  pair->a and pair->b are ships.
 // Returns 1 if all future collisions between these can be ignored
@@ -10,7 +10,9 @@
 
 
 
+#include "ai/aitargetgrid.h"
 #include "asteroid/asteroid.h"
+#include "cmdline/cmdline.h"
 #include "cmeasure/cmeasure.h"
 #include "debris/debris.h"
 #include "debugconsole/console.h"
@@ -52,6 +54,7 @@
 #include "weapon/swarm.h"
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
+#include "utils/threading.h"
 #include "graphics/light.h"
 #include "graphics/color.h"
 #include "math/curve.h"
@@ -430,6 +433,35 @@ static void on_script_state_destroy(lua_State*) {
 	}
 }
 
+ObjectMoveMode Object_move_mode = ObjectMoveMode::SERIAL;
+
+static const char* obj_move_mode_name(ObjectMoveMode mode)
+{
+	switch (mode) {
+		case ObjectMoveMode::SERIAL:
+			return "serial";
+		case ObjectMoveMode::PARALLEL:
+			return "parallel";
+		case ObjectMoveMode::VERIFY:
+			return "verify";
+		default:
+			UNREACHABLE("Unhandled object move mode %d!", static_cast<int>(mode));
+			return "";
+	}
+}
+
+static bool obj_move_parse_mode(const char* name, ObjectMoveMode* mode)
+{
+	for (auto candidate : {ObjectMoveMode::SERIAL, ObjectMoveMode::PARALLEL, ObjectMoveMode::VERIFY}) {
+		if (!stricmp(name, obj_move_mode_name(candidate))) {
+			*mode = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /**
  * Sets up the free list & init player & whatever else
  */
@@ -460,6 +492,10 @@ void obj_init()
 
 	obj_reset_colliders();
 
+	if (Cmdline_object_move != nullptr && !obj_move_parse_mode(Cmdline_object_move, &Object_move_mode)) {
+		Warning(LOCATION, "Unknown object move mode '%s' given to -object_move! Valid values are 'serial', 'parallel' and 'verify'.", Cmdline_object_move);
+	}
+
 	Script_system.OnStateDestroy.add(on_script_state_destroy);
 }
 
@@ -1563,6 +1599,260 @@ DCF_BOOL( collisions, Collisions_enabled )
 
 MONITOR( NumObjects )
 
+// Physics of independent objects is handed to the worker threads in batches of this size
+constexpr size_t OBJ_MOVE_PHYSICS_GRAIN_SIZE = 64;
+
+// used only in obj_move_all()
+static SCP_vector<object*> Obj_move_list;
+static SCP_vector<object*> Obj_move_physics_batch;
+
+// Everything obj_move_call_physics() may change about an object, used by ObjectMoveMode::VERIFY
+struct obj_move_physics_state {
+	vec3d pos;
+	matrix orient;
+	physics_info phys_info;
+};
+static SCP_vector<obj_move_physics_state> Obj_move_verify_before;
+static SCP_vector<obj_move_physics_state> Obj_move_verify_parallel;
+
+DCF(object_move, "Selects whether object physics runs on the worker threads")
+{
+	SCP_string arg;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: object_move [serial|parallel|verify]\n");
+		dc_printf("\tserial    Moves one object after the other\n");
+		dc_printf("\tparallel  Runs the physics of independent objects on the worker threads\n");
+		dc_printf("\tverify    Like parallel, but redoes the physics serially and logs any difference\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("Object movement is '%s'%s\n", obj_move_mode_name(Object_move_mode), threading::is_threading() ? "" : " (no worker threads, always serial)");
+		return;
+	}
+
+	dc_stuff_string_white(arg);
+	if (!obj_move_parse_mode(arg.c_str(), &Object_move_mode)) {
+		dc_printf("Error: Unknown object move mode '%s'\n", arg.c_str());
+	}
+}
+
+/**
+ * Does everything for one object that has to happen before its physics.
+ * @return false if the object does not move at all this frame
+ */
+static bool obj_move_one_pre(object* objp, float frametime, bool global_cmeasure_timer, SCP_vector<object*>& cmeasure_list)
+{
+	// skip objects which should be dead
+	if (objp->flags[Object::Object_Flags::Should_be_dead]) {
+		return false;
+	}
+
+	// if this is an observer object, skip it
+	if (objp->type == OBJ_OBSERVER) {
+		return false;
+	}
+
+	// Compile a list of active countermeasures during an existing traversal of obj_used_list
+	if (objp->type == OBJ_WEAPON) {
+		weapon *wp = &Weapons[objp->instance];
+		weapon_info *wip = &Weapon_info[wp->weapon_info_index];
+
+		if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
+			if ((wip->cmeasure_timer_interval > 0 && timestamp_elapsed(wp->cmeasure_timer))	// If it's timer-based and ready to pulse...
+				|| (wip->cmeasure_timer_interval <= 0 && global_cmeasure_timer)) {	// ...or it's not and the global counter is active...
+				// ...then it's actively pulsing and we need to add objp to cmeasure_list.
+				cmeasure_list.push_back(objp);
+				if (wip->cmeasure_timer_interval > 0) {
+					// Reset the timer
+					wp->cmeasure_timer = timestamp(wip->cmeasure_timer_interval);
+				}
+			}
+		}
+	}
+
+	vec3d cur_pos = objp->pos;			// Save the current position
+
+#ifdef OBJECT_CHECK 
+		obj_check_object( objp );
+#endif
+
+	// pre-move
+	obj_move_all_pre(objp, frametime);
+
+	// store last pos and orient, but only for non-interpolation objects
+	// interpolation objects will need to to work backwards from the last good position
+	// to prevent collision issues
+	if (!multi_oo_is_interp_object(objp)){
+		objp->last_pos = cur_pos;
+		objp->last_orient = objp->orient;
+	}
+
+	return true;
+}
+
+/**
+ * Whether the physics of this object only touches the object itself and can therefore run on any thread
+ */
+static bool obj_move_physics_is_independent(object* objp)
+{
+	// the player fires weapons from within the physics step
+	if (objp == Player_obj || objp->flags[Object::Object_Flags::Player_ship])
+		return false;
+
+	// docked objects are moved together afterwards
+	if (object_is_docked(objp))
+		return false;
+
+	return !multi_oo_is_interp_object(objp);
+}
+
+/**
+ * Moves one object according to its physics, unless it is not supposed to move
+ */
+static void obj_move_one_physics(object* objp, float frametime)
+{
+	bool interpolation_object = multi_oo_is_interp_object(objp);
+
+	// Goober5000 - accommodate objects that aren't supposed to move in some way (at least until they're destroyed)
+	bool dont_change_position = objp->flags[Object::Object_Flags::Dont_change_position, Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f;
+	bool dont_change_orientation = objp->flags[Object::Object_Flags::Dont_change_orientation, Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f;
+
+	// skip the physics if we're totally immobile
+	if (!dont_change_position || !dont_change_orientation) {
+		// if this is an object which should be interpolated in multiplayer, do so
+		if (interpolation_object) {
+			extern void interpolate_main_helper(int objnum, vec3d* pos, matrix* ori, physics_info* pip, vec3d* last_pos, matrix* last_orient, vec3d* gravity, bool player_ship);
+
+			interpolate_main_helper(OBJ_INDEX(objp), &objp->pos, &objp->orient, &objp->phys_info, &objp->last_pos, &objp->last_orient, &The_mission.gravity, objp->flags[Object::Object_Flags::Player_ship]);
+		} else {
+			// physics
+			obj_move_call_physics(objp, frametime);
+		}
+	}
+
+	// If the object isn't supposed to move, roll back any movement that occurred.  Most of the movement should already have been skipped, but this ensures complete immobility.
+	if (dont_change_position) {
+		objp->pos = objp->last_pos;
+
+		// make sure velocity is always 0
+		vm_vec_zero(&objp->phys_info.vel);
+		vm_vec_zero(&objp->phys_info.desired_vel);
+		objp->phys_info.speed = 0.0f;
+		objp->phys_info.fspeed = 0.0f;
+	}
+	if (dont_change_orientation) {
+		objp->orient = objp->last_orient;
+
+		// make sure velocity is always 0
+		vm_vec_zero(&objp->phys_info.rotvel);
+		vm_vec_zero(&objp->phys_info.desired_rotvel);
+	}
+}
+
+/**
+ * Does everything for one object that has to happen after its physics
+ */
+static void obj_move_one_post(object* objp, float frametime)
+{
+	// Submodel movement now happens here, right after physics movement.  It's not excluded by the "immobile", "don't-change-position", or "don't-change-orientation" flags.
+	
+	// this flag only affects ship subsystems, not any other type of submodel movement
+	if (objp->type == OBJ_SHIP && !Ships[objp->instance].flags[Ship::Ship_Flags::Subsystem_movement_locked])
+		ship_move_subsystems(objp);
+
+	// do animation on this object
+	int model_instance_num = object_get_model_instance_num(objp);
+	if (model_instance_num >= 0) {
+		polymodel_instance* pmi = model_get_instance(model_instance_num);
+		animation::ModelAnimation::stepAnimations(frametime, pmi);
+	}
+
+	// finally, do intrinsic motion on this object
+	// (this happens last because look_at is a type of intrinsic rotation,
+	// and look_at needs to happen last or the angle may be off by a frame)
+	model_do_intrinsic_motions(objp);
+
+	// Future TODO: Props will need a version of this when submodel animation support is added.
+	// For ships, we now have to make sure that all the submodel detail levels remain consistent.
+	if (objp->type == OBJ_SHIP)
+		ship_model_replicate_submodels(objp);
+
+	// move post
+	obj_move_all_post(objp, frametime);
+
+	// Equipment script processing
+	if (objp->type == OBJ_SHIP) {
+		ship* shipp = &Ships[objp->instance];
+		object* target;
+
+		if (Ai_info[shipp->ai_index].target_objnum != -1)
+			target = &Objects[Ai_info[shipp->ai_index].target_objnum];
+		else
+			target = NULL;
+		if (objp == Player_obj && Player_ai->target_objnum != -1)
+			target = &Objects[Player_ai->target_objnum];
+
+		if (scripting::hooks::OnWeaponEquipped->isActive()) {
+			scripting::hooks::OnWeaponEquipped->run(scripting::hooks::WeaponEquippedConditions{ shipp, target },
+				scripting::hook_param_list(
+					scripting::hook_param("User", 'o', objp),
+					scripting::hook_param("Target", 'o', target)
+				));
+		}
+	}
+}
+
+static bool obj_move_physics_state_same(const obj_move_physics_state& a, const obj_move_physics_state& b)
+{
+	return !memcmp(&a.pos, &b.pos, sizeof(vec3d))
+		&& !memcmp(&a.orient, &b.orient, sizeof(matrix))
+		&& !memcmp(&a.phys_info.vel, &b.phys_info.vel, sizeof(vec3d))
+		&& !memcmp(&a.phys_info.rotvel, &b.phys_info.rotvel, sizeof(vec3d))
+		&& !memcmp(&a.phys_info.desired_vel, &b.phys_info.desired_vel, sizeof(vec3d))
+		&& !memcmp(&a.phys_info.desired_rotvel, &b.phys_info.desired_rotvel, sizeof(vec3d))
+		&& !memcmp(&a.phys_info.speed, &b.phys_info.speed, sizeof(float))
+		&& !memcmp(&a.phys_info.fspeed, &b.phys_info.fspeed, sizeof(float))
+		&& a.phys_info.flags == b.phys_info.flags;
+}
+
+/**
+ * Redoes the physics of the batch on this thread, starting from the given state, and logs each object for which the
+ * result differs from what the worker threads came up with. The serial results are the ones that are kept.
+ */
+static void obj_move_verify_physics_batch(float frametime)
+{
+	int mismatches = 0;
+
+	for (size_t i = 0; i < Obj_move_physics_batch.size(); ++i) {
+		object* objp = Obj_move_physics_batch[i];
+
+		Obj_move_verify_parallel[i] = {objp->pos, objp->orient, objp->phys_info};
+
+		const auto& before = Obj_move_verify_before[i];
+		objp->pos = before.pos;
+		objp->orient = before.orient;
+		objp->phys_info = before.phys_info;
+
+		obj_move_one_physics(objp, frametime);
+
+		if (!obj_move_physics_state_same(Obj_move_verify_parallel[i], {objp->pos, objp->orient, objp->phys_info})) {
+			if (mismatches < 10) {
+				mprintf(("Object move mismatch for object %d (%s): parallel pos (%f, %f, %f), serial pos (%f, %f, %f)\n",
+					OBJ_INDEX(objp), Object_type_names[objp->type],
+					Obj_move_verify_parallel[i].pos.xyz.x, Obj_move_verify_parallel[i].pos.xyz.y, Obj_move_verify_parallel[i].pos.xyz.z,
+					objp->pos.xyz.x, objp->pos.xyz.y, objp->pos.xyz.z));
+			}
+			++mismatches;
+		}
+	}
+
+	if (mismatches > 0) {
+		mprintf(("Object move mismatch: %d of %d objects moved differently on the worker threads\n", mismatches, (int)Obj_move_physics_batch.size()));
+	}
+}
+
 /**
  * Move all objects for the current frame
  */
@@ -1593,137 +1883,65 @@ void obj_move_all(float frametime)
 
 	MONITOR_INC( NumObjects, Num_objects );	
 
-	for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
-		// skip objects which should be dead
-		if (objp->flags[Object::Object_Flags::Should_be_dead]) {
-			continue;
-		}
-
-		// if this is an observer object, skip it
-		if (objp->type == OBJ_OBSERVER) {
-			continue;
-		}
-
-		// Compile a list of active countermeasures during an existing traversal of obj_used_list
-		if (objp->type == OBJ_WEAPON) {
-			weapon *wp = &Weapons[objp->instance];
-			weapon_info *wip = &Weapon_info[wp->weapon_info_index];
-
-			if (wip->wi_flags[Weapon::Info_Flags::Cmeasure]) {
-				if ((wip->cmeasure_timer_interval > 0 && timestamp_elapsed(wp->cmeasure_timer))	// If it's timer-based and ready to pulse...
-					|| (wip->cmeasure_timer_interval <= 0 && global_cmeasure_timer)) {	// ...or it's not and the global counter is active...
-					// ...then it's actively pulsing and we need to add objp to cmeasure_list.
-					cmeasure_list.push_back(objp);
-					if (wip->cmeasure_timer_interval > 0) {
-						// Reset the timer
-						wp->cmeasure_timer = timestamp(wip->cmeasure_timer_interval);
-					}
-				}
-			}
-		}
-
-		vec3d cur_pos = objp->pos;			// Save the current position
-
-#ifdef OBJECT_CHECK 
-			obj_check_object( objp );
-#endif
+	// snapshot the ships for the target queries the AI makes from the post-moves below
+	ai_target_grid_build(frametime);
 
-		// pre-move
-		obj_move_all_pre(objp, frametime);
-
-		bool interpolation_object = multi_oo_is_interp_object(objp);
+	if (Object_move_mode == ObjectMoveMode::SERIAL || !threading::is_threading()) {
+		for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			if (!obj_move_one_pre(objp, frametime, global_cmeasure_timer, cmeasure_list))
+				continue;
 
-		// store last pos and orient, but only for non-interpolation objects
-		// interpolation objects will need to to work backwards from the last good position
-		// to prevent collision issues
-		if (!interpolation_object){
-			objp->last_pos = cur_pos;
-			objp->last_orient = objp->orient;
+			obj_move_one_physics(objp, frametime);
+			obj_move_one_post(objp, frametime);
 		}
+	} else {
+		// All objects get their pre-move first, then the physics of the independent ones runs on the worker threads
+		// while the rest is moved here in list order, and finally everything gets its post-move in list order.
+		Obj_move_list.clear();
+		Obj_move_physics_batch.clear();
 
-		// Goober5000 - accommodate objects that aren't supposed to move in some way (at least until they're destroyed)
-		bool dont_change_position = objp->flags[Object::Object_Flags::Dont_change_position, Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f;
-		bool dont_change_orientation = objp->flags[Object::Object_Flags::Dont_change_orientation, Object::Object_Flags::Immobile] && objp->hull_strength > 0.0f;
-
-		// skip the physics if we're totally immobile
-		if (!dont_change_position || !dont_change_orientation) {
-			// if this is an object which should be interpolated in multiplayer, do so
-			if (interpolation_object) {
-				extern void interpolate_main_helper(int objnum, vec3d* pos, matrix* ori, physics_info* pip, vec3d* last_pos, matrix* last_orient, vec3d* gravity, bool player_ship);
-
-				interpolate_main_helper(OBJ_INDEX(objp), &objp->pos, &objp->orient, &objp->phys_info, &objp->last_pos, &objp->last_orient, &The_mission.gravity, objp->flags[Object::Object_Flags::Player_ship]);
-			} else {
-				// physics
-				obj_move_call_physics(objp, frametime);
-			}
-		}
+		for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
+			if (!obj_move_one_pre(objp, frametime, global_cmeasure_timer, cmeasure_list))
+				continue;
 
-		// If the object isn't supposed to move, roll back any movement that occurred.  Most of the movement should already have been skipped, but this ensures complete immobility.
-		if (dont_change_position) {
-			objp->pos = objp->last_pos;
+			Obj_move_list.push_back(objp);
 
-			// make sure velocity is always 0
-			vm_vec_zero(&objp->phys_info.vel);
-			vm_vec_zero(&objp->phys_info.desired_vel);
-			objp->phys_info.speed = 0.0f;
-			objp->phys_info.fspeed = 0.0f;
+			if (obj_move_physics_is_independent(objp))
+				Obj_move_physics_batch.push_back(objp);
+			else
+				obj_move_one_physics(objp, frametime);
 		}
-		if (dont_change_orientation) {
-			objp->orient = objp->last_orient;
 
-			// make sure velocity is always 0
-			vm_vec_zero(&objp->phys_info.rotvel);
-			vm_vec_zero(&objp->phys_info.desired_rotvel);
+		const bool verify = Object_move_mode == ObjectMoveMode::VERIFY;
+		if (verify) {
+			Obj_move_verify_before.clear();
+			for (auto batch_objp : Obj_move_physics_batch)
+				Obj_move_verify_before.push_back({batch_objp->pos, batch_objp->orient, batch_objp->phys_info});
+			Obj_move_verify_parallel.resize(Obj_move_physics_batch.size());
 		}
 
-		// Submodel movement now happens here, right after physics movement.  It's not excluded by the "immobile", "don't-change-position", or "don't-change-orientation" flags.
-		
-		// this flag only affects ship subsystems, not any other type of submodel movement
-		if (objp->type == OBJ_SHIP && !Ships[objp->instance].flags[Ship::Ship_Flags::Subsystem_movement_locked])
-			ship_move_subsystems(objp);
-
-		// do animation on this object
-		int model_instance_num = object_get_model_instance_num(objp);
-		if (model_instance_num >= 0) {
-			polymodel_instance* pmi = model_get_instance(model_instance_num);
-			animation::ModelAnimation::stepAnimations(frametime, pmi);
+		{
+			TRACE_SCOPE(tracing::ParallelPhysics);
+			threading::parallel_for(Obj_move_physics_batch.size(), OBJ_MOVE_PHYSICS_GRAIN_SIZE, [frametime](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+					obj_move_one_physics(Obj_move_physics_batch[i], frametime);
+			});
 		}
 
-		// finally, do intrinsic motion on this object
-		// (this happens last because look_at is a type of intrinsic rotation,
-		// and look_at needs to happen last or the angle may be off by a frame)
-		model_do_intrinsic_motions(objp);
-
-		// Future TODO: Props will need a version of this when submodel animation support is added.
-		// For ships, we now have to make sure that all the submodel detail levels remain consistent.
-		if (objp->type == OBJ_SHIP)
-			ship_model_replicate_submodels(objp);
+		if (verify)
+			obj_move_verify_physics_batch(frametime);
 
-		// move post
-		obj_move_all_post(objp, frametime);
-
-		// Equipment script processing
-		if (objp->type == OBJ_SHIP) {
-			ship* shipp = &Ships[objp->instance];
-			object* target;
+		for (auto list_objp : Obj_move_list) {
+			// an earlier post-move may have killed this one
+			if (list_objp->flags[Object::Object_Flags::Should_be_dead])
+				continue;
 
-			if (Ai_info[shipp->ai_index].target_objnum != -1)
-				target = &Objects[Ai_info[shipp->ai_index].target_objnum];
-			else
-				target = NULL;
-			if (objp == Player_obj && Player_ai->target_objnum != -1)
-				target = &Objects[Player_ai->target_objnum];
-
-			if (scripting::hooks::OnWeaponEquipped->isActive()) {
-				scripting::hooks::OnWeaponEquipped->run(scripting::hooks::WeaponEquippedConditions{ shipp, target },
-					scripting::hook_param_list(
-						scripting::hook_param("User", 'o', objp),
-						scripting::hook_param("Target", 'o', target)
-					));
-			}
+			obj_move_one_post(list_objp, frametime);
 		}
 	}
 
+	ai_target_grid_invalidate();
+
 	// Now apply intrinsic motion to things that aren't objects (like skyboxes).  This technically doesn't belong in the object code,
 	// but there isn't really a good place to put this, it doesn't hurt to have this here, and it's conceptually related to what's here.
 	model_do_intrinsic_motions(nullptr);
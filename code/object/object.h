@@ -246,6 +246,15 @@ extern int render_order[MAX_OBJECTS];
 extern object *Viewer_obj;	// Which object is the viewer. Can be NULL.
 extern object *Player_obj;	// Which object is the player. Has to be valid.
 
+// How obj_move_all() runs the physics of the objects
+enum class ObjectMoveMode : uint8_t {
+	SERIAL,		// move every object completely before starting on the next one
+	PARALLEL,	// run the physics of independent (not docked, not player) objects on the worker threads
+	VERIFY		// like PARALLEL, but redo that physics serially and log any difference (debugging only)
+};
+
+extern ObjectMoveMode Object_move_mode;
+
 // Use this instead of "objp - Objects" to get an object number
 // given it's pointer.  This way, we can replace it with a macro
 // to check that the pointer is valid for debugging.
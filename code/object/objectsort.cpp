@@ -30,6 +30,7 @@
 #include "render/batching.h"
 #include "ship/ship.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 #include "weapon/weapon.h"
 #include "decals/decals.h"
 #include "freespace.h"
@@ -339,6 +340,9 @@ void obj_render_queue_all()
 
 	bool full_neb = is_full_nebula();
 
+	// the submodel buffers of most models are queued on the worker threads after the loop
+	scene.set_defer_models(threading::is_threading());
+
 	for ( i = 0; i <= Highest_object_index; i++,objp++ ) {
 		if ( (objp->type != OBJ_NONE) && ( objp->flags [Object::Object_Flags::Renders] ) )	{
             objp->flags.remove(Object::Object_Flags::Was_rendered);
@@ -368,6 +372,9 @@ void obj_render_queue_all()
 		}
 	}
 
+	scene.queue_deferred_models();
+	scene.set_defer_models(false);
+
 	scene.init_render();
 
 	if (Shadow_quality != ShadowQuality::Disabled) {
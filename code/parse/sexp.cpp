@@ -110,6 +110,9 @@
 #include "weapon/shockwave.h"
 #include "weapon/weapon.h"
 
+#include "parse/sexp/sexp_bytecode.h"
+#include "parse/sexp/sexp_dependencies.h"
+#include "parse/sexp/sexp_profiler.h"
 #include "parse/sexp/sexp_lookup.h"
 
 #ifndef NDEBUG
@@ -1421,6 +1424,10 @@ void sexp_startup()
 			const auto &op_b = Operators[index_b];
 			return lcase_lessthan(op_a.text, op_b.text);
 		});
+
+	sexp_bytecode_init();
+	sexp_dependencies_init();
+	sexp_profiler_init();
 }
 
 void sexp_shutdown()
@@ -19205,6 +19212,7 @@ void sexp_reset_event(int node)
 			eventp->satisfied_time = TIMESTAMP::invalid();
 			eventp->born_on_date = TIMESTAMP::invalid();
 			eventp->previous_result = 0;
+			eventp->dependency_serial = 0;
 
 			flush_sexp_tree(eventp->formula);
 		}
@@ -28194,6 +28202,10 @@ int eval_sexp(int cur_node, int referenced_node)
 			add_to_event_log_buffer(cur_node, op_index, Sexp_nodes[cur_node].value);
 		}
 
+		if (Sexp_profiling && ((Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) || (Sexp_nodes[cur_node].value == SEXP_KNOWN_FALSE) || (Sexp_nodes[cur_node].value == SEXP_NAN_FOREVER))) {
+			sexp_profile_short_circuit(cur_node);
+		}
+
 		// now do a quick return whether or not we log, per the comment above about trapping known sexpressions
 		if (Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) {
 			return SEXP_TRUE;
@@ -28222,6 +28234,10 @@ int eval_sexp(int cur_node, int referenced_node)
 		// add the op_num to the stack if it is an actual operator rather than a number
 		if (op_num) {
 			Current_sexp_operator.push_back(op_num); 
+
+			if (Sexp_profiling) {
+				sexp_profile_operator_begin();
+			}
 		}
 		switch ( op_num ) {
 		// arithmetic operators will always return just their value
@@ -30734,6 +30750,10 @@ int eval_sexp(int cur_node, int referenced_node)
 			add_to_event_log_buffer(cur_node, get_operator_index(cur_node), sexp_val);
 		}
 
+		if (Sexp_profiling) {
+			sexp_profile_operator_end();
+		}
+
 		Assert(!Current_sexp_operator.empty()); 
 		Current_sexp_operator.pop_back();
 
@@ -35877,6 +35897,7 @@ int sexp_add_variable(const char *text, const char *var_name, int type, int inde
 		strcpy_s(Sexp_variables[index].variable_name, var_name);
 		Sexp_variables[index].type &= ~SEXP_VARIABLE_NOT_USED;
 		Sexp_variables[index].type = (type | SEXP_VARIABLE_SET);
+		sexp_mark_dependency_changed(SEXP_DEPENDS_VARIABLES);
 	}
 
 	return index;
@@ -35933,6 +35954,7 @@ void sexp_modify_variable(const char *text, int index, bool sexp_callback)
 		Sexp_variables[index].text[maxCopyLen] = 0;
 	}
 	Sexp_variables[index].type |= SEXP_VARIABLE_MODIFIED;
+	sexp_mark_dependency_changed(SEXP_DEPENDS_VARIABLES);
 
 	// do multi_callback_here
 	// if we're called from the sexp code send a SEXP packet (more efficient) 
@@ -35968,6 +35990,7 @@ void multi_sexp_modify_variable()
 		}
 
 		strcpy_s(Sexp_variables[variable_index].text, value);
+		sexp_mark_dependency_changed(SEXP_DEPENDS_VARIABLES);
 	}	
 }
 
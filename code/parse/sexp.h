@@ -1517,6 +1517,9 @@ extern bool is_when_argument_op(int op_const);
 extern bool is_argument_provider_op(int op_const);
 extern bool is_implicit_argument_provider_op(int op_const); // jg18
 extern int find_argument_provider(int node);
+extern bool special_argument_appears_in_sexp_tree(int node);
+extern void eval_when_do_one_exp(int exp);
+extern bool is_node_value_dynamic(int node);
 
 // functions to change the attributes of an sexpression tree to persistent or not persistent
 extern void sexp_unmark_persistent( int n );
@@ -0,0 +1,761 @@
+#include "parse/sexp/sexp_bytecode.h"
+
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "globalincs/systemvars.h"
+#include "mission/missiongoals.h"
+#include "mission/missionlog.h"
+#include "mod_table/mod_table.h"
+#include "parse/sexp.h"
+#include "parse/sexp/sexp_profiler.h"
+#include "ship/ship.h"
+
+bool Sexp_bytecode_enabled = false;
+
+namespace {
+
+enum class sexp_opcode : uint8_t {
+	ENTER,			// if node already has a known value push it and jump to arg, like the start of eval_sexp()
+	COPY_VALUE,		// node takes the value of node arg, like a list node takes the value of its operator
+	PUSH_NUMBER,	// push the literal arg
+	EVAL_TREE,		// push eval_sexp(node), for everything which isn't compiled
+	BEGIN,			// start evaluating the operator at node, arg is its operator const
+	END,			// finish the operator at node and push its result, like the end of eval_sexp()
+	SET_RESULT,		// the operator's sexp value is arg
+	AND_ARG,		// pop an argument of and/or, node holds its value, jump to arg once the result is known
+	AND_DONE,
+	OR_ARG,
+	OR_DONE,
+	NOT_ARG,		// pop the argument of not, node holds its value
+	NAN_CHECK,		// the comparison fails if node is NaN, jump to arg
+	COMPARE,		// pop a number and compare the first number against it with operator extra, jump to arg on failure
+	WHEN_COND,		// pop the condition of a when, jump to arg unless it is true
+	ACTION,			// perform the action at node
+	WHEN_DONE,		// node is the condition of the when
+	IS_DESTROYED,	// objectives with a delay of arg seconds, over the ships of the next extra instructions
+	HAS_ARRIVED,
+	HAS_DEPARTED,
+	SHIP,			// arg is a ship registry index
+	HALT			// the result is on top of the stack
+};
+
+struct sexp_instruction {
+	sexp_opcode op;
+	int node;
+	int arg;
+	int extra;
+};
+
+// formula is kept to make sure a program is never run for anything other than what it was compiled from
+struct event_program {
+	int formula = -1;
+	int entry = -1;
+};
+
+struct sexp_frame {
+	int sexp_val;
+	size_t stack_height;
+	bool any;		// and: an argument was false, or: an argument was true
+	bool all_known;	// and: every argument was known true, or: every argument was known false
+};
+
+// every program lives in the same instruction stream
+SCP_vector<sexp_instruction> Sexp_code;
+SCP_vector<event_program> Event_programs;
+
+int Num_compiled_events = 0;
+int Num_tree_calls = 0;
+
+// kept between runs so evaluating doesn't allocate
+SCP_vector<int> Value_stack;
+SCP_vector<sexp_frame> Frame_stack;
+
+size_t emit(sexp_opcode op, int node = -1, int arg = 0, int extra = 0)
+{
+	Sexp_code.push_back({op, node, arg, extra});
+	return Sexp_code.size() - 1;
+}
+
+// makes the instruction at jump continue with the next instruction to be emitted
+void patch(size_t jump)
+{
+	Sexp_code[jump].arg = static_cast<int>(Sexp_code.size());
+}
+
+bool is_literal_number(int node)
+{
+	return node >= 0 && Sexp_nodes[node].first == -1 && Sexp_nodes[node].subtype == SEXP_ATOM_NUMBER && !is_node_value_dynamic(node);
+}
+
+// and, or and not only look at the values of arguments which are operators
+bool are_all_operators(int args)
+{
+	if (args < 0) {
+		return false;
+	}
+
+	for (int n = args; n >= 0; n = CDR(n)) {
+		if (CAR(n) < 0 || Sexp_nodes[n].subtype == SEXP_ATOM_CONTAINER_DATA) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool resolve_ships(int args, SCP_vector<int>& registry_indices)
+{
+	for (int n = args; n >= 0; n = CDR(n)) {
+		if (Sexp_nodes[n].first != -1 || is_node_value_dynamic(n)) {
+			return false;
+		}
+
+		// a wing, or a ship that doesn't exist yet
+		auto ship_it = Ship_registry_map.find(CTEXT(n));
+		if (ship_it == Ship_registry_map.end()) {
+			return false;
+		}
+
+		registry_indices.push_back(ship_it->second);
+	}
+
+	return !registry_indices.empty();
+}
+
+bool compile_operator(int op_node);
+
+// Emits code which pushes what eval_sexp(node) returns
+void compile_node(int node)
+{
+	int first = Sexp_nodes[node].first;
+
+	if (first != -1 && Sexp_nodes[node].subtype != SEXP_ATOM_CONTAINER_DATA) {
+		size_t enter = emit(sexp_opcode::ENTER, node);
+		compile_node(first);
+		emit(sexp_opcode::COPY_VALUE, node, first);
+		patch(enter);
+		return;
+	}
+
+	if (Sexp_nodes[node].subtype == SEXP_ATOM_OPERATOR && compile_operator(node)) {
+		return;
+	}
+
+	if (is_literal_number(node)) {
+		emit(sexp_opcode::PUSH_NUMBER, node, sexp_atoi(node));
+		return;
+	}
+
+	emit(sexp_opcode::EVAL_TREE, node);
+	++Num_tree_calls;
+}
+
+// Emits code for an operator the way eval_sexp() evaluates it, returns false without emitting anything if unsupported
+bool compile_operator(int op_node)
+{
+	int op = get_operator_const(op_node);
+	int args = CDR(op_node);
+	SCP_vector<int> ships;
+
+	switch (op) {
+		case OP_TRUE:
+		case OP_FALSE:
+			break;
+
+		case OP_AND:
+		case OP_OR:
+			if (!are_all_operators(args)) {
+				return false;
+			}
+			break;
+
+		case OP_NOT:
+			if (args < 0 || CAR(args) < 0 || Sexp_nodes[args].subtype == SEXP_ATOM_CONTAINER_DATA) {
+				return false;
+			}
+			break;
+
+		case OP_EQUALS:
+		case OP_NOT_EQUAL:
+		case OP_GREATER_THAN:
+		case OP_GREATER_OR_EQUAL:
+		case OP_LESS_THAN:
+		case OP_LESS_OR_EQUAL:
+			if (args < 0) {
+				return false;
+			}
+			break;
+
+		case OP_WHEN:
+			// eval_when_do_all_exp() is left to the tree
+			if (args < 0 || CAR(args) < 0 || (True_loop_argument_sexps && special_argument_appears_in_sexp_tree(CDR(args)))) {
+				return false;
+			}
+			break;
+
+		case OP_IS_DESTROYED_DELAY:
+		case OP_HAS_ARRIVED_DELAY:
+		case OP_HAS_DEPARTED_DELAY:
+			if (!is_literal_number(args) || !resolve_ships(CDR(args), ships)) {
+				return false;
+			}
+			break;
+
+		default:
+			return false;
+	}
+
+	size_t enter = emit(sexp_opcode::ENTER, op_node);
+	emit(sexp_opcode::BEGIN, op_node, op);
+
+	// instructions which jump straight to END
+	SCP_vector<size_t> exits;
+	auto nan_check = [&exits](int node) {
+		if (node >= 0) {
+			exits.push_back(emit(sexp_opcode::NAN_CHECK, node));
+		}
+	};
+
+	switch (op) {
+		case OP_TRUE:
+		case OP_FALSE:
+			emit(sexp_opcode::SET_RESULT, op_node, (op == OP_TRUE) ? SEXP_KNOWN_TRUE : SEXP_KNOWN_FALSE);
+			break;
+
+		case OP_AND:
+		case OP_OR: {
+			auto arg_op = (op == OP_AND) ? sexp_opcode::AND_ARG : sexp_opcode::OR_ARG;
+
+			// like sexp_and() and sexp_or(), the first argument is evaluated through its operator and the rest through their list nodes
+			compile_node(CAR(args));
+			exits.push_back(emit(arg_op, CAR(args)));
+
+			for (int n = CDR(args); n >= 0; n = CDR(n)) {
+				compile_node(n);
+				exits.push_back(emit(arg_op, n));
+			}
+
+			emit((op == OP_AND) ? sexp_opcode::AND_DONE : sexp_opcode::OR_DONE, op_node);
+			break;
+		}
+
+		case OP_NOT:
+			compile_node(CAR(args));
+			emit(sexp_opcode::NOT_ARG, CAR(args));
+			break;
+
+		case OP_EQUALS:
+		case OP_NOT_EQUAL:
+		case OP_GREATER_THAN:
+		case OP_GREATER_OR_EQUAL:
+		case OP_LESS_THAN:
+		case OP_LESS_OR_EQUAL:
+			// sexp_number_compare() checks for NaNs in the order it does, including values from the previous evaluation
+			compile_node(args);
+			nan_check(CAR(args));
+			nan_check(CDR(args));
+
+			for (int n = CDR(args); n >= 0; n = CDR(n)) {
+				nan_check(CAR(n));
+				nan_check(CDR(n));
+				compile_node(n);
+				exits.push_back(emit(sexp_opcode::COMPARE, n, 0, op));
+			}
+
+			emit(sexp_opcode::SET_RESULT, op_node, SEXP_TRUE);
+			break;
+
+		case OP_WHEN: {
+			compile_node(CAR(args));
+			size_t cond = emit(sexp_opcode::WHEN_COND, CAR(args));
+
+			for (int n = CDR(args); n >= 0; n = CDR(n)) {
+				if (CAR(n) >= 0) {
+					emit(sexp_opcode::ACTION, CAR(n));
+				}
+			}
+
+			patch(cond);
+			emit(sexp_opcode::WHEN_DONE, CAR(args));
+			break;
+		}
+
+		case OP_IS_DESTROYED_DELAY:
+		case OP_HAS_ARRIVED_DELAY:
+		case OP_HAS_DEPARTED_DELAY: {
+			auto objective_op = (op == OP_IS_DESTROYED_DELAY) ? sexp_opcode::IS_DESTROYED : (op == OP_HAS_ARRIVED_DELAY) ? sexp_opcode::HAS_ARRIVED : sexp_opcode::HAS_DEPARTED;
+
+			emit(objective_op, op_node, sexp_atoi(args), static_cast<int>(ships.size()));
+			for (int registry_index : ships) {
+				emit(sexp_opcode::SHIP, -1, registry_index);
+			}
+			break;
+		}
+
+		default:
+			UNREACHABLE("Operator %d was accepted but not compiled!", op);
+	}
+
+	for (auto exit : exits) {
+		patch(exit);
+	}
+
+	emit(sexp_opcode::END, op_node);
+	patch(enter);
+
+	return true;
+}
+
+int compile_formula(int formula)
+{
+	if (formula < 0 || Sexp_nodes[formula].first != -1 || Sexp_nodes[formula].subtype != SEXP_ATOM_OPERATOR) {
+		return -1;
+	}
+
+	auto entry = static_cast<int>(Sexp_code.size());
+	if (!compile_operator(formula)) {
+		return -1;
+	}
+
+	emit(sexp_opcode::HALT);
+	return entry;
+}
+
+bool is_true(int sexp_val)
+{
+	return (sexp_val == SEXP_TRUE) || (sexp_val == SEXP_KNOWN_TRUE);
+}
+
+// What eval_sexp() does with the value of an operator it has just evaluated
+int finish_operator(int op_node, int sexp_val)
+{
+	Assertion(sexp_val != UNINITIALIZED, "SEXP %s didn't return a value!", CTEXT(op_node));
+
+	auto& value = Sexp_nodes[op_node].value;
+
+	switch (sexp_val) {
+		case SEXP_KNOWN_TRUE:
+			value = SEXP_KNOWN_TRUE;
+			return SEXP_TRUE;
+
+		case SEXP_KNOWN_FALSE:
+		case SEXP_NAN:
+		case SEXP_NAN_FOREVER:
+			value = sexp_val;
+			return SEXP_FALSE;
+
+		case SEXP_CANT_EVAL:
+			value = SEXP_CANT_EVAL;
+			Assume_event_is_current = false;
+			return SEXP_FALSE;
+
+		default:
+			break;
+	}
+
+	if (value == SEXP_NAN) {
+		value = SEXP_UNKNOWN;
+		return sexp_val;
+	}
+
+	value = sexp_val ? SEXP_TRUE : SEXP_FALSE;
+	return sexp_val;
+}
+
+bool compare_numbers(int op, int first, int current)
+{
+	switch (op) {
+		case OP_EQUALS:
+			return first == current;
+		case OP_NOT_EQUAL:
+			return first != current;
+		case OP_GREATER_THAN:
+			return first > current;
+		case OP_GREATER_OR_EQUAL:
+			return first >= current;
+		case OP_LESS_THAN:
+			return first < current;
+		case OP_LESS_OR_EQUAL:
+			return first <= current;
+		default:
+			UNREACHABLE("Unhandled comparison operator %d!", op);
+			return false;
+	}
+}
+
+// The following are sexp_is_destroyed(), sexp_has_arrived() and sexp_has_departed() for ships that are known up front
+
+int ships_destroyed(const sexp_instruction* ships, int count, fix* latest_time)
+{
+	int num_destroyed = 0;
+	fix time = 0;
+
+	for (int i = 0; i < count; ++i) {
+		auto& ship_entry = Ship_registry[ships[i].arg];
+
+		if (ship_entry.status == ShipStatus::NOT_YET_PRESENT) {
+			return SEXP_CANT_EVAL;
+		}
+
+		if (ship_entry.status == ShipStatus::DEATH_ROLL || ship_entry.status == ShipStatus::EXITED) {
+			if (!mission_log_get_time(LOG_SHIP_DESTROYED, ship_entry.name, nullptr, &time) && !mission_log_get_time(LOG_SELF_DESTRUCTED, ship_entry.name, nullptr, &time)) {
+				// exited without being destroyed
+				return SEXP_KNOWN_FALSE;
+			}
+
+			++num_destroyed;
+			if (time > *latest_time) {
+				*latest_time = time;
+			}
+		} else {
+			if (Directive_count == DIRECTIVE_WING_ZERO) {
+				Directive_count = 0;
+			}
+			++Directive_count;
+		}
+	}
+
+	return (num_destroyed == count) ? SEXP_KNOWN_TRUE : SEXP_FALSE;
+}
+
+int ships_arrived(const sexp_instruction* ships, int count, fix* latest_time)
+{
+	int num_arrived = 0;
+	fix time = 0;
+
+	for (int i = 0; i < count; ++i) {
+		auto& ship_entry = Ship_registry[ships[i].arg];
+
+		if (ship_entry.status != ShipStatus::NOT_YET_PRESENT && mission_log_get_time(LOG_SHIP_ARRIVED, ship_entry.name, nullptr, &time)) {
+			++num_arrived;
+			if (time > *latest_time) {
+				*latest_time = time;
+			}
+		}
+	}
+
+	return (num_arrived == count) ? SEXP_KNOWN_TRUE : SEXP_FALSE;
+}
+
+int ships_departed(const sexp_instruction* ships, int count, fix* latest_time)
+{
+	int num_departed = 0;
+	fix time = 0;
+
+	for (int i = 0; i < count; ++i) {
+		auto& ship_entry = Ship_registry[ships[i].arg];
+
+		if (ship_entry.status == ShipStatus::NOT_YET_PRESENT) {
+			return SEXP_CANT_EVAL;
+		}
+
+		if (ship_entry.status == ShipStatus::EXITED) {
+			if (!mission_log_get_time(LOG_SHIP_DEPARTED, ship_entry.name, nullptr, &time)) {
+				// exited without departing
+				return SEXP_KNOWN_FALSE;
+			}
+
+			++num_departed;
+			if (time > *latest_time) {
+				*latest_time = time;
+			}
+		}
+	}
+
+	return (num_departed == count) ? SEXP_KNOWN_TRUE : SEXP_FALSE;
+}
+
+// see sexp_check_objective_delay()
+int objective_with_delay(const sexp_instruction& ins)
+{
+	fix time = 0;
+	int val;
+
+	switch (ins.op) {
+		case sexp_opcode::IS_DESTROYED:
+			val = ships_destroyed(&ins + 1, ins.extra, &time);
+			break;
+		case sexp_opcode::HAS_ARRIVED:
+			val = ships_arrived(&ins + 1, ins.extra, &time);
+			break;
+		default:
+			val = ships_departed(&ins + 1, ins.extra, &time);
+			break;
+	}
+
+	if (is_true(val) && (Missiontime - time) < i2f(ins.arg)) {
+		return SEXP_FALSE;
+	}
+
+	return val;
+}
+
+// Runs a program without recursing, only operators which weren't compiled go through eval_sexp()
+int run_program(int entry)
+{
+	// a tree evaluation from within this program may end up running another program, which works on top of this one
+	const size_t value_base = Value_stack.size();
+	const size_t frame_base = Frame_stack.size();
+
+	int pc = entry;
+
+	for (;;) {
+		const auto& ins = Sexp_code[pc++];
+
+		switch (ins.op) {
+			case sexp_opcode::ENTER: {
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_KNOWN_TRUE || value == SEXP_KNOWN_FALSE || value == SEXP_NAN_FOREVER) {
+					if (Sexp_profiling) {
+						sexp_profile_short_circuit(ins.node);
+					}
+
+					Value_stack.push_back((value == SEXP_KNOWN_TRUE) ? SEXP_TRUE : SEXP_FALSE);
+					pc = ins.arg;
+				}
+				break;
+			}
+
+			case sexp_opcode::COPY_VALUE:
+				Sexp_nodes[ins.node].value = Sexp_nodes[ins.arg].value;
+				break;
+
+			case sexp_opcode::PUSH_NUMBER:
+				Value_stack.push_back(ins.arg);
+				break;
+
+			case sexp_opcode::EVAL_TREE: {
+				int val = eval_sexp(ins.node);
+				Value_stack.push_back(val);
+				break;
+			}
+
+			case sexp_opcode::BEGIN:
+				Current_sexp_operator.push_back(ins.arg);
+				if (Sexp_profiling) {
+					sexp_profile_operator_begin();
+				}
+
+				Frame_stack.push_back({UNINITIALIZED, Value_stack.size(), false, true});
+				break;
+
+			case sexp_opcode::END: {
+				auto frame = Frame_stack.back();
+				Frame_stack.pop_back();
+				Value_stack.resize(frame.stack_height);
+
+				if (Sexp_profiling) {
+					sexp_profile_operator_end();
+				}
+
+				Assert(!Current_sexp_operator.empty());
+				Current_sexp_operator.pop_back();
+
+				Value_stack.push_back(finish_operator(ins.node, frame.sexp_val));
+				break;
+			}
+
+			case sexp_opcode::SET_RESULT:
+				Frame_stack.back().sexp_val = ins.arg;
+				break;
+
+			case sexp_opcode::AND_ARG: {
+				auto& frame = Frame_stack.back();
+				bool arg_true = is_true(Value_stack.back());
+				Value_stack.pop_back();
+
+				frame.any = frame.any || !arg_true;
+
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_KNOWN_FALSE || value == SEXP_NAN_FOREVER) {
+					frame.sexp_val = SEXP_KNOWN_FALSE;
+					pc = ins.arg;
+				} else if (value != SEXP_KNOWN_TRUE) {
+					frame.all_known = false;
+				}
+				break;
+			}
+
+			case sexp_opcode::AND_DONE: {
+				auto& frame = Frame_stack.back();
+				frame.sexp_val = frame.all_known ? SEXP_KNOWN_TRUE : (frame.any ? SEXP_FALSE : SEXP_TRUE);
+				break;
+			}
+
+			case sexp_opcode::OR_ARG: {
+				auto& frame = Frame_stack.back();
+				bool arg_true = is_true(Value_stack.back());
+				Value_stack.pop_back();
+
+				frame.any = frame.any || arg_true;
+
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_KNOWN_TRUE) {
+					frame.sexp_val = SEXP_KNOWN_TRUE;
+					pc = ins.arg;
+				} else if (value != SEXP_KNOWN_FALSE) {
+					frame.all_known = false;
+				}
+				break;
+			}
+
+			case sexp_opcode::OR_DONE: {
+				auto& frame = Frame_stack.back();
+				frame.sexp_val = frame.all_known ? SEXP_KNOWN_FALSE : (frame.any ? SEXP_TRUE : SEXP_FALSE);
+				break;
+			}
+
+			case sexp_opcode::NOT_ARG: {
+				auto& frame = Frame_stack.back();
+				bool arg_true = is_true(Value_stack.back());
+				Value_stack.pop_back();
+
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_KNOWN_FALSE || value == SEXP_NAN_FOREVER) {
+					frame.sexp_val = SEXP_KNOWN_TRUE;
+				} else if (value == SEXP_KNOWN_TRUE) {
+					frame.sexp_val = SEXP_KNOWN_FALSE;
+				} else if (value == SEXP_NAN) {
+					frame.sexp_val = SEXP_TRUE;
+				} else {
+					frame.sexp_val = arg_true ? SEXP_FALSE : SEXP_TRUE;
+				}
+				break;
+			}
+
+			case sexp_opcode::NAN_CHECK: {
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_NAN) {
+					Frame_stack.back().sexp_val = SEXP_FALSE;
+					pc = ins.arg;
+				} else if (value == SEXP_NAN_FOREVER) {
+					Frame_stack.back().sexp_val = SEXP_KNOWN_FALSE;
+					pc = ins.arg;
+				}
+				break;
+			}
+
+			case sexp_opcode::COMPARE: {
+				int current = Value_stack.back();
+				Value_stack.pop_back();
+
+				if (!compare_numbers(ins.extra, Value_stack.back(), current)) {
+					Frame_stack.back().sexp_val = SEXP_FALSE;
+					pc = ins.arg;
+				}
+				break;
+			}
+
+			case sexp_opcode::WHEN_COND: {
+				int val = Value_stack.back();
+				Value_stack.pop_back();
+
+				Frame_stack.back().sexp_val = val;
+				if (val != SEXP_TRUE) {
+					pc = ins.arg;
+				}
+				break;
+			}
+
+			case sexp_opcode::ACTION:
+				eval_when_do_one_exp(ins.node);
+				break;
+
+			case sexp_opcode::WHEN_DONE: {
+				int value = Sexp_nodes[ins.node].value;
+				if (value == SEXP_KNOWN_FALSE || value == SEXP_NAN_FOREVER) {
+					Frame_stack.back().sexp_val = SEXP_KNOWN_FALSE;
+				}
+				break;
+			}
+
+			case sexp_opcode::IS_DESTROYED:
+			case sexp_opcode::HAS_ARRIVED:
+			case sexp_opcode::HAS_DEPARTED:
+				Frame_stack.back().sexp_val = objective_with_delay(ins);
+				pc += ins.extra;
+				break;
+
+			case sexp_opcode::HALT: {
+				int result = Value_stack.back();
+				Assertion(Value_stack.size() == value_base + 1 && Frame_stack.size() == frame_base, "SEXP program at %d left its stacks unbalanced!", entry);
+
+				Value_stack.resize(value_base);
+				return result;
+			}
+
+			default:
+				UNREACHABLE("Unhandled SEXP opcode %d!", static_cast<int>(ins.op));
+				return SEXP_FALSE;
+		}
+	}
+}
+
+}
+
+DCF(sexp_bytecode, "Enables or disables evaluating mission events through their compiled programs")
+{
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: sexp_bytecode [bool]\n");
+		dc_printf("\tEvaluates mission events through the programs compiled at mission load instead of walking their trees\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("SEXP bytecode is %s\n", Sexp_bytecode_enabled ? "enabled" : "disabled");
+		dc_printf("%d of %d events compiled into " SIZE_T_ARG " instructions, %d subexpressions left to the tree\n",
+			Num_compiled_events, static_cast<int>(Mission_events.size()), Sexp_code.size(), Num_tree_calls);
+		return;
+	}
+
+	dc_stuff_boolean(&Sexp_bytecode_enabled);
+}
+
+void sexp_bytecode_init()
+{
+	Sexp_bytecode_enabled = Cmdline_sexp_bytecode;
+}
+
+void sexp_bytecode_compile_events()
+{
+	sexp_bytecode_clear();
+
+	Event_programs.resize(Mission_events.size());
+
+	for (size_t i = 0; i < Mission_events.size(); ++i) {
+		int formula = Mission_events[i].formula;
+
+		Event_programs[i].formula = formula;
+		Event_programs[i].entry = compile_formula(formula);
+
+		if (Event_programs[i].entry >= 0) {
+			++Num_compiled_events;
+		}
+	}
+
+	mprintf(("SEXP bytecode: compiled %d of %d events into " SIZE_T_ARG " instructions, %d subexpressions left to the tree\n",
+		Num_compiled_events, static_cast<int>(Mission_events.size()), Sexp_code.size(), Num_tree_calls));
+}
+
+void sexp_bytecode_clear()
+{
+	Sexp_code.clear();
+	Event_programs.clear();
+	Num_compiled_events = 0;
+	Num_tree_calls = 0;
+}
+
+int sexp_bytecode_eval_event(int event)
+{
+	int formula = Mission_events[event].formula;
+
+	// the event log wants to see every node the tree would evaluate
+	if (Sexp_bytecode_enabled && !Log_event && event < static_cast<int>(Event_programs.size())) {
+		const auto& program = Event_programs[event];
+		if (program.formula == formula && program.entry >= 0) {
+			return run_program(program.entry);
+		}
+	}
+
+	return eval_sexp(formula);
+}
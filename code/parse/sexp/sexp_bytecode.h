@@ -0,0 +1,29 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// Whether mission events are evaluated through their compiled programs, see -sexp_bytecode
+extern bool Sexp_bytecode_enabled;
+
+void sexp_bytecode_init();
+
+/**
+ * @brief Compiles the formula of every mission event into a flat instruction stream
+ *
+ * @details Called once the mission is loaded and the ship registry is complete. Logical operators, number comparisons,
+ * when and the is-destroyed/has-arrived/has-departed objectives are compiled with their operators, literal numbers
+ * and ship registry indices resolved up front. Any other operator is left to eval_sexp() from within the program.
+ * Events whose top level operator can't be compiled are always evaluated through the tree.
+ */
+void sexp_bytecode_compile_events();
+
+// Drops all compiled programs
+void sexp_bytecode_clear();
+
+/**
+ * @brief Evaluates the formula of a mission event
+ *
+ * @details Runs the compiled program of the event if there is one, otherwise (or when an event log is being written)
+ * this is the same as eval_sexp() on the formula. Either way the sexp nodes end up with the same values.
+ */
+int sexp_bytecode_eval_event(int event);
@@ -0,0 +1,223 @@
+#include "parse/sexp/sexp_dependencies.h"
+
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "parse/sexp.h"
+
+SexpEventEval Sexp_event_eval = SexpEventEval::POLL;
+
+namespace {
+
+constexpr int NUM_DEPENDENCY_CHANNELS = 4;
+
+// Sexp_dependency_serial is bumped on every change, the channel serials record the last change of each channel
+uint Sexp_dependency_serial = 1;
+uint Sexp_channel_serials[NUM_DEPENDENCY_CHANNELS];
+
+const char* sexp_event_eval_name(SexpEventEval mode)
+{
+	switch (mode) {
+		case SexpEventEval::POLL:
+			return "poll";
+		case SexpEventEval::DEPENDENCIES:
+			return "dependencies";
+		case SexpEventEval::VERIFY:
+			return "verify";
+		default:
+			UNREACHABLE("Unhandled SEXP event evaluation mode %d!", static_cast<int>(mode));
+			return "";
+	}
+}
+
+bool sexp_event_eval_parse(const char* name, SexpEventEval* mode)
+{
+	for (auto candidate : {SexpEventEval::POLL, SexpEventEval::DEPENDENCIES, SexpEventEval::VERIFY}) {
+		if (!stricmp(name, sexp_event_eval_name(candidate))) {
+			*mode = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int sexp_delay_dependencies(int node)
+{
+	if (node < 0) {
+		return 0;
+	}
+
+	// a delay of zero makes no difference once the objective is done, anything else needs the mission time
+	if (Sexp_nodes[node].first == -1 && Sexp_nodes[node].subtype == SEXP_ATOM_NUMBER && !(Sexp_nodes[node].type & SEXP_FLAG_VARIABLE)
+		&& atoi(Sexp_nodes[node].text) == 0) {
+		return 0;
+	}
+
+	return SEXP_DEPENDS_TIME | sexp_get_dependencies(node);
+}
+
+int sexp_operator_dependencies(int op_node)
+{
+	int args = CDR(op_node);
+	int dependencies = 0;
+	int delay_arg = -1;
+
+	switch (get_operator_const(op_node)) {
+		case OP_WHEN:
+			return sexp_get_dependencies(args);
+
+		case OP_TRUE:
+		case OP_FALSE:
+		case OP_AND:
+		case OP_OR:
+		case OP_NOT:
+		case OP_XOR:
+		case OP_EQUALS:
+		case OP_NOT_EQUAL:
+		case OP_GREATER_THAN:
+		case OP_LESS_THAN:
+		case OP_GREATER_OR_EQUAL:
+		case OP_LESS_OR_EQUAL:
+		case OP_STRING_EQUALS:
+		case OP_STRING_GREATER_THAN:
+		case OP_STRING_LESS_THAN:
+		case OP_PLUS:
+		case OP_MINUS:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+			break;
+
+		case OP_IS_DESTROYED:
+		case OP_IS_SUBSYSTEM_DESTROYED:
+		case OP_IS_DISABLED:
+		case OP_IS_DISARMED:
+		case OP_HAS_ARRIVED:
+		case OP_HAS_DEPARTED:
+			dependencies = SEXP_DEPENDS_SHIPS;
+			break;
+
+		case OP_IS_DESTROYED_DELAY:
+		case OP_IS_DISABLED_DELAY:
+		case OP_IS_DISARMED_DELAY:
+		case OP_HAS_ARRIVED_DELAY:
+		case OP_HAS_DEPARTED_DELAY:
+			dependencies = SEXP_DEPENDS_SHIPS;
+			delay_arg = args;
+			break;
+
+		case OP_IS_SUBSYSTEM_DESTROYED_DELAY:
+			dependencies = SEXP_DEPENDS_SHIPS;
+			delay_arg = CDDR(args);
+			break;
+
+		case OP_MISSION_TIME:
+		case OP_HAS_TIME_ELAPSED:
+			return SEXP_DEPENDS_TIME;
+
+		default:
+			return SEXP_DEPENDS_UNKNOWN;
+	}
+
+	for (int n = args; n != -1; n = CDR(n)) {
+		dependencies |= (n == delay_arg) ? sexp_delay_dependencies(n) : sexp_get_dependencies(n);
+	}
+
+	return dependencies;
+}
+
+}
+
+DCF(sexp_event_eval, "Selects how mission events are re-evaluated")
+{
+	SCP_string arg;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: sexp_event_eval [poll|dependencies|verify]\n");
+		dc_printf("\tpoll          Evaluates every incomplete event whenever goals are checked\n");
+		dc_printf("\tdependencies  Only evaluates events whose inputs have changed since they were last false\n");
+		dc_printf("\tverify        Evaluates every event and logs any event that changed although it would have been skipped\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("SEXP event evaluation is '%s'\n", sexp_event_eval_name(Sexp_event_eval));
+		return;
+	}
+
+	dc_stuff_string_white(arg);
+	if (!sexp_event_eval_parse(arg.c_str(), &Sexp_event_eval)) {
+		dc_printf("Error: Unknown SEXP event evaluation mode '%s'\n", arg.c_str());
+	}
+}
+
+void sexp_dependencies_init()
+{
+	if (Cmdline_sexp_event_eval != nullptr && !sexp_event_eval_parse(Cmdline_sexp_event_eval, &Sexp_event_eval)) {
+		Warning(LOCATION, "Unknown SEXP event evaluation mode '%s' given to -sexp_event_eval! Valid values are 'poll', 'dependencies' and 'verify'.", Cmdline_sexp_event_eval);
+	}
+}
+
+void sexp_dependencies_reset()
+{
+	Sexp_dependency_serial = 1;
+	for (auto& serial : Sexp_channel_serials) {
+		serial = 0;
+	}
+}
+
+int sexp_get_dependencies(int node)
+{
+	if (node < 0) {
+		return 0;
+	}
+
+	const auto& n = Sexp_nodes[node];
+
+	if (n.subtype == SEXP_ATOM_CONTAINER_NAME || n.subtype == SEXP_ATOM_CONTAINER_DATA) {
+		return SEXP_DEPENDS_UNKNOWN;
+	}
+
+	// a nested expression
+	if (n.first != -1) {
+		return sexp_get_dependencies(n.first);
+	}
+
+	if (n.subtype == SEXP_ATOM_OPERATOR) {
+		return sexp_operator_dependencies(node);
+	}
+
+	return (n.type & SEXP_FLAG_VARIABLE) ? SEXP_DEPENDS_VARIABLES : 0;
+}
+
+void sexp_mark_dependency_changed(int dependencies)
+{
+	++Sexp_dependency_serial;
+
+	for (int i = 0; i < NUM_DEPENDENCY_CHANNELS; ++i) {
+		if (dependencies & (1 << i)) {
+			Sexp_channel_serials[i] = Sexp_dependency_serial;
+		}
+	}
+}
+
+uint sexp_get_dependency_serial()
+{
+	return Sexp_dependency_serial;
+}
+
+bool sexp_dependencies_changed_since(int dependencies, uint serial)
+{
+	// time changes all the time and unknown inputs may have
+	if (dependencies & (SEXP_DEPENDS_TIME | SEXP_DEPENDS_UNKNOWN)) {
+		return true;
+	}
+
+	for (int i = 0; i < NUM_DEPENDENCY_CHANNELS; ++i) {
+		if ((dependencies & (1 << i)) && Sexp_channel_serials[i] > serial) {
+			return true;
+		}
+	}
+
+	return false;
+}
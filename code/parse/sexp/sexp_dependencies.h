@@ -0,0 +1,42 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// Game state an expression reads, see sexp_get_dependencies()
+#define SEXP_DEPENDS_SHIPS		(1<<0)	// the ship registry and the mission log
+#define SEXP_DEPENDS_VARIABLES	(1<<1)	// sexp variables
+#define SEXP_DEPENDS_TIME		(1<<2)	// mission time, the expression can change without any other input changing
+#define SEXP_DEPENDS_UNKNOWN	(1<<3)	// an operator that hasn't declared what it reads
+
+// How mission_eval_goals() decides which non-repeating events to evaluate
+enum class SexpEventEval : uint8_t {
+	POLL,			// evaluate every incomplete event each time the goal timestamp elapses
+	DEPENDENCIES,	// skip events which were false and whose inputs haven't changed since
+	VERIFY			// evaluate every event and log any skippable event that changed anyway (debugging only)
+};
+
+extern SexpEventEval Sexp_event_eval;
+
+void sexp_dependencies_init();
+
+// Called at mission start, every event has to be evaluated once before it can be skipped
+void sexp_dependencies_reset();
+
+/**
+ * @brief Works out which game state the expression at node reads
+ *
+ * @details For a when only the condition counts, since its actions only run once the event is true. Delays that are
+ * not a literal zero make an operator depend on time.
+ *
+ * @return SEXP_DEPENDS_* flags
+ */
+int sexp_get_dependencies(int node);
+
+// Called whenever the given game state changes
+void sexp_mark_dependency_changed(int dependencies);
+
+// The serial to remember when evaluating an expression, for sexp_dependencies_changed_since()
+uint sexp_get_dependency_serial();
+
+// Whether any of the given game state has changed since serial was taken
+bool sexp_dependencies_changed_since(int dependencies, uint serial);
@@ -0,0 +1,341 @@
+#include "parse/sexp/sexp_profiler.h"
+
+#include "cfile/cfile.h"
+#include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
+#include "io/timer.h"
+#include "libs/jansson.h"
+#include "mission/missiongoals.h"
+#include "mission/missionparse.h"
+#include "parse/parselo.h"
+#include "parse/sexp.h"
+
+#include <algorithm>
+
+bool Sexp_profiling = false;
+
+namespace {
+
+struct sexp_profile_stats {
+	uint64_t calls = 0;
+	uint64_t short_circuits = 0;	// known values returned without evaluating anything
+	uint64_t operator_calls = 0;	// events only, operators evaluated while the event was
+	uint64_t inclusive_ns = 0;
+	uint64_t exclusive_ns = 0;
+	uint64_t max_ns = 0;
+};
+
+struct operator_timing {
+	size_t depth;			// size of Current_sexp_operator once the operator was pushed
+	uint64_t start;
+	uint64_t children_ns;
+};
+
+SCP_unordered_map<int, sexp_profile_stats> Operator_stats;
+SCP_vector<sexp_profile_stats> Event_stats;
+
+SCP_vector<operator_timing> Operator_timings;
+
+int Current_event = -1;
+uint64_t Current_event_start = 0;
+
+sexp_profile_stats& event_stats(int event)
+{
+	if (event >= static_cast<int>(Event_stats.size())) {
+		Event_stats.resize(event + 1);
+	}
+	return Event_stats[event];
+}
+
+const char* operator_name(int op)
+{
+	int index = find_operator_index(op);
+	return (index >= 0) ? Operators[index].text.c_str() : "<unknown>";
+}
+
+const char* event_name(size_t event)
+{
+	return (event < Mission_events.size()) ? Mission_events[event].name.c_str() : "<unknown>";
+}
+
+double to_ms(uint64_t ns)
+{
+	return static_cast<double>(ns) / 1000000.0;
+}
+
+double short_circuit_rate(const sexp_profile_stats& stats, uint64_t evaluated)
+{
+	uint64_t total = stats.short_circuits + evaluated;
+	return (total > 0) ? static_cast<double>(stats.short_circuits) / static_cast<double>(total) : 0.0;
+}
+
+// Both lists sorted by how much time they took, most expensive first
+SCP_vector<std::pair<int, const sexp_profile_stats*>> sorted_operators()
+{
+	SCP_vector<std::pair<int, const sexp_profile_stats*>> sorted;
+	for (const auto& entry : Operator_stats) {
+		sorted.emplace_back(entry.first, &entry.second);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<int, const sexp_profile_stats*>& a, const std::pair<int, const sexp_profile_stats*>& b) {
+		return a.second->exclusive_ns > b.second->exclusive_ns;
+	});
+	return sorted;
+}
+
+SCP_vector<std::pair<int, const sexp_profile_stats*>> sorted_events()
+{
+	SCP_vector<std::pair<int, const sexp_profile_stats*>> sorted;
+	for (size_t i = 0; i < Event_stats.size(); ++i) {
+		if (Event_stats[i].calls > 0) {
+			sorted.emplace_back(static_cast<int>(i), &Event_stats[i]);
+		}
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<int, const sexp_profile_stats*>& a, const std::pair<int, const sexp_profile_stats*>& b) {
+		return a.second->inclusive_ns > b.second->inclusive_ns;
+	});
+	return sorted;
+}
+
+void write_csv()
+{
+	CFILE* fp = cfopen("sexp_profile.csv", "wt", CF_TYPE_DATA);
+	if (fp == nullptr) {
+		mprintf(("SEXP profiler: unable to write sexp_profile.csv\n"));
+		return;
+	}
+
+	SCP_string line;
+
+	cfputs("kind,name,calls,inclusive_ms,exclusive_ms,max_ms,short_circuits,short_circuit_rate\n", fp);
+
+	for (const auto& entry : sorted_events()) {
+		const auto& stats = *entry.second;
+		sprintf(line, "event,\"%s\",%llu,%.3f,,%.3f,%llu,%.3f\n", event_name(entry.first), static_cast<unsigned long long>(stats.calls),
+			to_ms(stats.inclusive_ns), to_ms(stats.max_ns), static_cast<unsigned long long>(stats.short_circuits),
+			short_circuit_rate(stats, stats.operator_calls));
+		cfputs(line.c_str(), fp);
+	}
+
+	for (const auto& entry : sorted_operators()) {
+		const auto& stats = *entry.second;
+		sprintf(line, "operator,\"%s\",%llu,%.3f,%.3f,%.3f,%llu,%.3f\n", operator_name(entry.first), static_cast<unsigned long long>(stats.calls),
+			to_ms(stats.inclusive_ns), to_ms(stats.exclusive_ns), to_ms(stats.max_ns), static_cast<unsigned long long>(stats.short_circuits),
+			short_circuit_rate(stats, stats.calls));
+		cfputs(line.c_str(), fp);
+	}
+
+	cfclose(fp);
+}
+
+json_t* stats_to_json(const char* name, const sexp_profile_stats& stats, uint64_t evaluated, bool with_exclusive)
+{
+	auto obj = json_object();
+	json_object_set_new(obj, "name", json_string(name));
+	json_object_set_new(obj, "calls", json_integer(static_cast<json_int_t>(stats.calls)));
+	json_object_set_new(obj, "inclusive_ms", json_real(to_ms(stats.inclusive_ns)));
+	if (with_exclusive) {
+		json_object_set_new(obj, "exclusive_ms", json_real(to_ms(stats.exclusive_ns)));
+	}
+	json_object_set_new(obj, "max_ms", json_real(to_ms(stats.max_ns)));
+	json_object_set_new(obj, "short_circuits", json_integer(static_cast<json_int_t>(stats.short_circuits)));
+	json_object_set_new(obj, "short_circuit_rate", json_real(short_circuit_rate(stats, evaluated)));
+	return obj;
+}
+
+void write_json()
+{
+	CFILE* fp = cfopen("sexp_profile.json", "wt", CF_TYPE_DATA);
+	if (fp == nullptr) {
+		mprintf(("SEXP profiler: unable to write sexp_profile.json\n"));
+		return;
+	}
+
+	std::unique_ptr<json_t> root(json_object());
+	json_object_set_new(root.get(), "mission", json_string(The_mission.name.c_str()));
+
+	auto events = json_array();
+	for (const auto& entry : sorted_events()) {
+		json_array_append_new(events, stats_to_json(event_name(entry.first), *entry.second, entry.second->operator_calls, false));
+	}
+	json_object_set_new(root.get(), "events", events);
+
+	auto operators = json_array();
+	for (const auto& entry : sorted_operators()) {
+		json_array_append_new(operators, stats_to_json(operator_name(entry.first), *entry.second, entry.second->calls, true));
+	}
+	json_object_set_new(root.get(), "operators", operators);
+
+	json_dump_cfile(root.get(), fp, JSON_INDENT(4) | JSON_PRESERVE_ORDER);
+	cfclose(fp);
+}
+
+void print_events(int count)
+{
+	dc_printf("%-32s %10s %12s %10s %8s\n", "Event", "Calls", "Incl. ms", "Max ms", "Short %");
+	for (const auto& entry : sorted_events()) {
+		if (count-- <= 0) {
+			break;
+		}
+		const auto& stats = *entry.second;
+		dc_printf("%-32.32s %10llu %12.3f %10.3f %7.1f%%\n", event_name(entry.first), static_cast<unsigned long long>(stats.calls),
+			to_ms(stats.inclusive_ns), to_ms(stats.max_ns), 100.0 * short_circuit_rate(stats, stats.operator_calls));
+	}
+}
+
+void print_operators(int count)
+{
+	dc_printf("%-32s %10s %12s %12s %8s\n", "Operator", "Calls", "Incl. ms", "Excl. ms", "Short %");
+	for (const auto& entry : sorted_operators()) {
+		if (count-- <= 0) {
+			break;
+		}
+		const auto& stats = *entry.second;
+		dc_printf("%-32.32s %10llu %12.3f %12.3f %7.1f%%\n", operator_name(entry.first), static_cast<unsigned long long>(stats.calls),
+			to_ms(stats.inclusive_ns), to_ms(stats.exclusive_ns), 100.0 * short_circuit_rate(stats, stats.calls));
+	}
+}
+
+}
+
+DCF(sexp_profile, "Profiles mission events and SEXP operators")
+{
+	int count = 20;
+
+	if (dc_optional_string_either("help", "--help")) {
+		dc_printf("Usage: sexp_profile [bool|reset|events [count]|operators [count]|save]\n");
+		dc_printf("\t[bool]      Enables or disables profiling\n");
+		dc_printf("\treset       Drops everything recorded so far\n");
+		dc_printf("\tevents      Lists the events that took the most time\n");
+		dc_printf("\toperators   Lists the operators that took the most time, not counting nested operators\n");
+		dc_printf("\tsave        Writes sexp_profile.csv and sexp_profile.json, which also happens at the end of a mission\n");
+		return;
+	}
+
+	if (dc_optional_string_either("status", "--status") || dc_optional_string_either("?", "--?")) {
+		dc_printf("SEXP profiling is %s\n", Sexp_profiling ? "enabled" : "disabled");
+		return;
+	}
+
+	if (dc_optional_string("reset")) {
+		sexp_profiler_reset();
+		return;
+	}
+
+	if (dc_optional_string("events")) {
+		dc_maybe_stuff_int(&count);
+		print_events(count);
+		return;
+	}
+
+	if (dc_optional_string("operators")) {
+		dc_maybe_stuff_int(&count);
+		print_operators(count);
+		return;
+	}
+
+	if (dc_optional_string("save")) {
+		write_csv();
+		write_json();
+		return;
+	}
+
+	dc_stuff_boolean(&Sexp_profiling);
+}
+
+void sexp_profiler_init()
+{
+	Sexp_profiling = Cmdline_sexp_profile;
+}
+
+void sexp_profiler_reset()
+{
+	Operator_stats.clear();
+	Event_stats.clear();
+	Operator_timings.clear();
+	Current_event = -1;
+}
+
+void sexp_profiler_mission_end()
+{
+	if (!Sexp_profiling || (Operator_stats.empty() && Event_stats.empty())) {
+		return;
+	}
+
+	write_csv();
+	write_json();
+}
+
+void sexp_profile_event_begin(int event)
+{
+	Current_event = event;
+	Current_event_start = timer_get_nanoseconds();
+}
+
+void sexp_profile_event_end(int event)
+{
+	// profiling was switched on in the middle of the event
+	if (Current_event != event) {
+		return;
+	}
+
+	uint64_t elapsed = timer_get_nanoseconds() - Current_event_start;
+
+	auto& stats = event_stats(event);
+	++stats.calls;
+	stats.inclusive_ns += elapsed;
+	stats.max_ns = std::max(stats.max_ns, elapsed);
+
+	Current_event = -1;
+}
+
+void sexp_profile_operator_begin()
+{
+	Operator_timings.push_back({Current_sexp_operator.size(), timer_get_nanoseconds(), 0});
+}
+
+void sexp_profile_operator_end()
+{
+	// profiling was switched on while this operator was being evaluated
+	if (Operator_timings.empty() || Operator_timings.back().depth != Current_sexp_operator.size()) {
+		return;
+	}
+
+	auto timing = Operator_timings.back();
+	Operator_timings.pop_back();
+
+	uint64_t elapsed = timer_get_nanoseconds() - timing.start;
+
+	auto& stats = Operator_stats[Current_sexp_operator.back()];
+	++stats.calls;
+	stats.inclusive_ns += elapsed;
+	stats.exclusive_ns += elapsed - std::min(elapsed, timing.children_ns);
+	stats.max_ns = std::max(stats.max_ns, elapsed);
+
+	if (!Operator_timings.empty()) {
+		Operator_timings.back().children_ns += elapsed;
+	}
+
+	if (Current_event >= 0) {
+		++event_stats(Current_event).operator_calls;
+	}
+}
+
+void sexp_profile_short_circuit(int node)
+{
+	// the value may have been stored on the list node around the operator
+	int op_node = node;
+	if (Sexp_nodes[op_node].subtype != SEXP_ATOM_OPERATOR && Sexp_nodes[op_node].first >= 0) {
+		op_node = Sexp_nodes[op_node].first;
+	}
+
+	if (Sexp_nodes[op_node].subtype == SEXP_ATOM_OPERATOR) {
+		int op = get_operator_const(op_node);
+		if (op != OP_NOT_AN_OP) {
+			++Operator_stats[op].short_circuits;
+		}
+	}
+
+	if (Current_event >= 0) {
+		++event_stats(Current_event).short_circuits;
+	}
+}
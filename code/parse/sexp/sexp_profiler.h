@@ -0,0 +1,31 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// Whether SEXP evaluation is being profiled, see -sexp_profile and the sexp_profile console command
+extern bool Sexp_profiling;
+
+void sexp_profiler_init();
+
+// Called when a mission is loaded, drops the numbers of the previous mission
+void sexp_profiler_reset();
+
+// Writes the numbers gathered over the mission to sexp_profile.csv and sexp_profile.json in the data directory
+void sexp_profiler_mission_end();
+
+// Brackets the evaluation of a mission event, short circuits and operators in between are counted for the event too
+void sexp_profile_event_begin(int event);
+void sexp_profile_event_end(int event);
+
+/**
+ * @brief Brackets the evaluation of an operator
+ *
+ * @details Must be called right after the operator has been pushed onto Current_sexp_operator and right before it is
+ * popped again. The stack depth is what ties the two together, so time spent in operators nested in this one is
+ * counted as inclusive but not as exclusive time of this one.
+ */
+void sexp_profile_operator_begin();
+void sexp_profile_operator_end();
+
+// Called when eval_sexp() returns the known value of node without evaluating it
+void sexp_profile_short_circuit(int node);
@@ -5,12 +5,32 @@
 #include "globalincs/utility.h"
 #include "math/vecmat.h"
 
+#include <limits>
 #include <optional>
 #include <variant>
 
 namespace particle {
 	struct particle;
-	typedef std::weak_ptr<particle> WeakParticlePtr;
+
+	/**
+	 * @brief A weak reference to a persistent particle
+	 *
+	 * Persistent particles live in reused slots. The reference stores the slot and the generation the slot had when the
+	 * particle was created, so it expires once the particle is removed even if the slot is in use again.
+	 */
+	class WeakParticlePtr {
+		uint32_t m_slot = std::numeric_limits<uint32_t>::max();
+		uint32_t m_generation = 0;
+
+	  public:
+		WeakParticlePtr() = default;
+		WeakParticlePtr(uint32_t slot, uint32_t generation) : m_slot(slot), m_generation(generation) {}
+
+		// Returns the particle or nullptr if it has been removed. The pointer is only valid until the particle is moved again.
+		particle* lock() const;
+
+		bool expired() const { return lock() == nullptr; }
+	};
 }
 
 namespace effects {
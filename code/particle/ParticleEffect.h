@@ -135,6 +135,9 @@ public:
 	friend int ::parse_weapon(int, bool, const char*);
 	friend ParticleEffectHandle scripting::api::getLegacyScriptingParticleEffect(int bitmap, bool reversed);
 	friend bool move_particle(float frametime, particle* part);
+	friend void move_particle_arrays(float frametime);
+	friend void spawn_death_effect(const particle& part);
+	friend void add_particle_light(const particle& part, const vec3d& prev_pos, float vel_scalar);
 	friend bool render_particle(particle* part);
 
 	SCP_string m_name; //!< The name of this effect
@@ -35,8 +35,148 @@ using namespace particle;
 
 namespace
 {
-	SCP_vector<::particle::particle> Particles;
-	SCP_vector<ParticlePtr> Persistent_particles;
+	// The parts of a particle move_all() does not need for most particles
+	struct particle_cold {
+		float	radius;
+		int		bitmap;
+		int		nframes;
+		effects::EffectAttachment attachment;
+		bool	reverse;
+		float   length;
+		float	angle;
+		bool	use_angle;
+		ParticleSubeffectHandle parent_effect;
+	};
+
+	/**
+	 * Non-persistent particles, stored as one array per field. The age, expiry and integration loops in move_all() only
+	 * read and write the hot arrays and are simple enough for the compiler to vectorize.
+	 */
+	struct particle_arrays {
+		SCP_vector<float> pos_x, pos_y, pos_z;
+		SCP_vector<float> vel_x, vel_y, vel_z;
+		SCP_vector<float> age;
+		SCP_vector<float> max_life;
+		SCP_vector<ubyte> looping;
+
+		SCP_vector<particle_cold> cold;
+
+		size_t size() const { return age.size(); }
+		bool empty() const { return age.empty(); }
+
+		void push_back(const ::particle::particle& part)
+		{
+			pos_x.push_back(part.pos.xyz.x);
+			pos_y.push_back(part.pos.xyz.y);
+			pos_z.push_back(part.pos.xyz.z);
+			vel_x.push_back(part.velocity.xyz.x);
+			vel_y.push_back(part.velocity.xyz.y);
+			vel_z.push_back(part.velocity.xyz.z);
+			age.push_back(part.age);
+			max_life.push_back(part.max_life);
+			looping.push_back(part.looping ? 1 : 0);
+			cold.push_back({part.radius, part.bitmap, part.nframes, part.attachment, part.reverse, part.length, part.angle, part.use_angle, part.parent_effect});
+		}
+
+		// Assembles a complete particle, for everything that works on whole particles (curves, rendering, effects)
+		::particle::particle get(size_t i) const
+		{
+			const auto& c = cold[i];
+
+			::particle::particle part;
+			part.pos = vec3d{{{pos_x[i], pos_y[i], pos_z[i]}}};
+			part.velocity = vec3d{{{vel_x[i], vel_y[i], vel_z[i]}}};
+			part.age = age[i];
+			part.max_life = max_life[i];
+			part.looping = looping[i] != 0;
+			part.radius = c.radius;
+			part.bitmap = c.bitmap;
+			part.nframes = c.nframes;
+			part.attachment = c.attachment;
+			part.reverse = c.reverse;
+			part.length = c.length;
+			part.angle = c.angle;
+			part.use_angle = c.use_angle;
+			part.parent_effect = c.parent_effect;
+
+			return part;
+		}
+
+		/**
+		 * Removes the first count particles for which dead is set in a single pass, keeping the order of the rest.
+		 * Particles added after count (while the dead flags were computed) are always kept.
+		 */
+		void compact(const SCP_vector<ubyte>& dead, size_t count)
+		{
+			size_t write = 0;
+			for (size_t read = 0; read < size(); ++read) {
+				if (read < count && dead[read])
+					continue;
+
+				if (write != read) {
+					pos_x[write] = pos_x[read];
+					pos_y[write] = pos_y[read];
+					pos_z[write] = pos_z[read];
+					vel_x[write] = vel_x[read];
+					vel_y[write] = vel_y[read];
+					vel_z[write] = vel_z[read];
+					age[write] = age[read];
+					max_life[write] = max_life[read];
+					looping[write] = looping[read];
+					cold[write] = cold[read];
+				}
+				++write;
+			}
+
+			resize(write);
+		}
+
+		void resize(size_t new_size)
+		{
+			pos_x.resize(new_size);
+			pos_y.resize(new_size);
+			pos_z.resize(new_size);
+			vel_x.resize(new_size);
+			vel_y.resize(new_size);
+			vel_z.resize(new_size);
+			age.resize(new_size);
+			max_life.resize(new_size);
+			looping.resize(new_size);
+			cold.resize(new_size);
+		}
+
+		void clear() { resize(0); }
+	};
+
+	particle_arrays Particles;
+
+	// Per frame scratch data of move_all()
+	SCP_vector<ubyte> Particle_dead;
+	SCP_vector<float> Particle_vel_scale;
+	SCP_vector<size_t> Particle_lit;
+
+	// Persistent particles never move in memory. A slot's generation is increased whenever its particle is removed,
+	// which expires all WeakParticlePtrs to it.
+	SCP_deque<::particle::particle> Persistent_slots;
+	SCP_vector<uint32_t> Persistent_generations;
+	SCP_vector<bool> Persistent_slot_used;
+	SCP_vector<uint32_t> Persistent_free_slots;
+	SCP_vector<uint32_t> Persistent_alive;	// used slots, oldest first
+
+	void free_persistent_slot(uint32_t slot)
+	{
+		Persistent_slot_used[slot] = false;
+		++Persistent_generations[slot];
+		Persistent_free_slots.push_back(slot);
+	}
+
+	void kill_persistent_particles()
+	{
+		for (auto slot : Persistent_alive)
+			free_persistent_slot(slot);
+
+		Persistent_alive.clear();
+	}
 
 	static int Particles_enabled = 1;
 
@@ -126,12 +266,12 @@ namespace particle
 	// only call from game_shutdown()!!!
 	void close()
 	{
-		Persistent_particles.clear();
+		kill_persistent_particles();
 		Particles.clear();
 	}
 
 	size_t get_particle_count() {
-		return Particles.size() + Persistent_particles.size();
+		return Particles.size() + Persistent_alive.size();
 	}
 
 	void page_in()
@@ -189,11 +329,32 @@ namespace particle
 		if (maybe_cull_particle(new_particle))
 			return {};
 
-		ParticlePtr new_particle_ptr = std::make_shared<particle>(new_particle);
+		uint32_t slot;
+		if (!Persistent_free_slots.empty()) {
+			slot = Persistent_free_slots.back();
+			Persistent_free_slots.pop_back();
 
-		Persistent_particles.push_back(new_particle_ptr);
+			Persistent_slots[slot] = new_particle;
+		} else {
+			slot = static_cast<uint32_t>(Persistent_slots.size());
+
+			Persistent_slots.push_back(new_particle);
+			Persistent_generations.push_back(0);
+			Persistent_slot_used.push_back(false);
+		}
 
-		return {new_particle_ptr};
+		Persistent_slot_used[slot] = true;
+		Persistent_alive.push_back(slot);
+
+		return {slot, Persistent_generations[slot]};
+	}
+
+	particle* WeakParticlePtr::lock() const
+	{
+		if (m_slot >= Persistent_slots.size() || !Persistent_slot_used[m_slot] || Persistent_generations[m_slot] != m_generation)
+			return nullptr;
+
+		return &Persistent_slots[m_slot];
 	}
 
 	float getPixelSize(const particle& subject_particle) {
@@ -208,8 +369,94 @@ namespace particle
 			gr_screen.max_w);
 	}
 
+	// Whether a particle whose age has just been advanced has reached the end of its life
+	static inline bool particle_expired(float frametime, float age, float max_life, bool looping)
+	{
+		// If the particle is looping then it will never be removed due to age.
+		// Special case, if max_life is 0 then we want it to render at least once.
+		return (age > max_life) & !looping & ((age > frametime) | (max_life > 0.0f));
+	}
+
+	void spawn_death_effect(const particle& part)
+	{
+		const auto& source_effect = part.parent_effect.getParticleEffect();
+
+		if (source_effect.m_deathEffect.isValid()) {
+			vec3d world_pos = part.attachment.local_pos_to_global(part.pos);
+			vec3d world_vel = part.attachment.local_vel_to_global(part.velocity);
+
+			matrix orient = vmd_identity_matrix;
+			if (vm_vec_mag_squared(&world_vel) > 0.0f) {
+				vm_vector_2_matrix(&orient, &world_vel);
+			}
+
+			auto deathSource = ParticleManager::get()->createSource(source_effect.m_deathEffect);
+			deathSource->setHost(std::make_unique<EffectHostVector>(world_pos, orient, world_vel));
+			deathSource->finishCreation();
+		}
+	}
+
+	/**
+	 * @brief Adds the light of a particle which has already been moved this frame
+	 * @param part The particle
+	 * @param prev_pos Where the particle was before it moved
+	 * @param vel_scalar The velocity multiplier the particle was moved with
+	 */
+	void add_particle_light(const particle& part, const vec3d& prev_pos, float vel_scalar)
+	{
+		const auto& source_effect = part.parent_effect.getParticleEffect();
+		const auto& light_source = *source_effect.m_light_source;
+
+		const auto& curve_input = std::forward_as_tuple(part, vm_vec_mag_quick(&part.velocity) * vel_scalar);
+
+		vec3d p_pos = part.attachment.local_pos_to_global(part.pos);
+
+		float light_radius = light_source.light_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_RADIUS_MULT, curve_input);
+		float source_radius = light_source.source_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_SOURCE_RADIUS_MULT, curve_input);
+		float intensity = light_source.intensity * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_INTENSITY_MULT, curve_input);
+		float r = light_source.r * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_R_MULT, curve_input);
+		float g = light_source.g * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_G_MULT, curve_input);
+		float b = light_source.b * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_B_MULT, curve_input);
+
+		if (light_radius <= 0.0f || intensity <= 0.0f) {
+			return;
+		}
+
+		switch (light_source.light_source_mode) {
+		case ParticleEffect::LightInformation::LightSourceMode::POINT:
+			light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+			break;
+		case ParticleEffect::LightInformation::LightSourceMode::TO_LAST_POS: {
+			vec3d p_prev_pos = part.attachment.local_last_pos_to_global(prev_pos);
+			light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+		}
+		break;
+		case ParticleEffect::LightInformation::LightSourceMode::AS_PARTICLE:
+			if (part.length != 0.0f) {
+				vec3d p1 = part.attachment.local_vel_to_global(part.velocity);
+				vm_vec_normalize_safe(&p1);
+				p1 *= part.length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
+				p1 += p_pos;
+				light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius);
+			}
+			else {
+				light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+			}
+			break;
+		case ParticleEffect::LightInformation::LightSourceMode::CONE: {
+			float cone_angle = light_source.cone_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_ANGLE_MULT, curve_input);
+			float cone_inner_angle = light_source.cone_inner_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_INNER_ANGLE_MULT, curve_input);
+			vec3d p1 = part.attachment.local_vel_to_global(part.velocity);
+			vm_vec_normalize_safe(&p1);
+
+			light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius);
+		}
+		break;
+		}
+	}
+
 	/**
-	 * @brief Moves a single particle
+	 * @brief Moves a single persistent particle
 	 * @param frametime The length of the current frame
 	 * @param part The particle to process for movement
 	 * @return @c true if the particle has expired and should be removed, @c false otherwise
@@ -224,45 +471,15 @@ namespace particle
 			part->age += frametime;
 		}
 
-		bool remove_particle = false;
-
-		// if its time expired, remove it. If the particle is looping then it will never be removed due to age
-		if (part->age > part->max_life && !part->looping)
+		// if its time expired, remove it. If the particle is attached to an object which has become invalid, kill it
+		if (particle_expired(frametime, part->age, part->max_life, part->looping) || !part->attachment.is_valid())
 		{
-			// special case, if max_life is 0 then we want it to render at least once
-			if ((part->age > frametime) || (part->max_life > 0.0f))
-			{
-				remove_particle = true;
-			}
-		}
-
-		// if the particle is attached to an object which has become invalid, kill it
-		if (!part->attachment.is_valid())
-		{
-			remove_particle = true;
+			spawn_death_effect(*part);
+			return true;
 		}
 
 		const auto& source_effect = part->parent_effect.getParticleEffect();
 
-		if (remove_particle)
-		{
-			if (source_effect.m_deathEffect.isValid()) {
-				vec3d world_pos = part->attachment.local_pos_to_global(part->pos);
-				vec3d world_vel = part->attachment.local_vel_to_global(part->velocity);
-
-				matrix orient = vmd_identity_matrix;
-				if (vm_vec_mag_squared(&world_vel) > 0.0f) {
-					vm_vector_2_matrix(&orient, &world_vel);
-				}
-
-				auto deathSource = ParticleManager::get()->createSource(source_effect.m_deathEffect);
-				deathSource->setHost(std::make_unique<EffectHostVector>(world_pos, orient, world_vel));
-				deathSource->finishCreation();
-			}
-
-			return true;
-		}
-
 		float part_velocity =  vm_vec_mag_quick(&part->velocity);
 		float vel_scalar = source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT, std::forward_as_tuple(*part, part_velocity) );
 
@@ -270,59 +487,82 @@ namespace particle
 		vec3d prev_pos = part->pos;
 		part->pos += (part->velocity * vel_scalar) * frametime;
 
-		const auto& curve_input = std::forward_as_tuple(*part, part_velocity * vel_scalar);
-
 		if (Detail.lighting > 3 && source_effect.m_light_source) {
-			const auto& light_source = *source_effect.m_light_source;
-
-			vec3d p_pos = part->attachment.local_pos_to_global(part->pos);
-			
-			float light_radius = light_source.light_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_RADIUS_MULT, curve_input);
-			float source_radius = light_source.source_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_SOURCE_RADIUS_MULT, curve_input);
-			float intensity = light_source.intensity * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_INTENSITY_MULT, curve_input);
-			float r = light_source.r * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_R_MULT, curve_input);
-			float g = light_source.g * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_G_MULT, curve_input);
-			float b = light_source.b * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_B_MULT, curve_input);
-
-			// after this point it is only lighting code, so we can early return
-			if (light_radius <= 0.0f || intensity <= 0.0f) {
-				return false;
-			}
+			add_particle_light(*part, prev_pos, vel_scalar);
+		}
 
-			switch (light_source.light_source_mode) {
-			case ParticleEffect::LightInformation::LightSourceMode::POINT:
-				light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-				break;
-			case ParticleEffect::LightInformation::LightSourceMode::TO_LAST_POS: {
-			vec3d p_prev_pos = part->attachment.local_last_pos_to_global(prev_pos);
-				light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-			}
-			break;
-			case ParticleEffect::LightInformation::LightSourceMode::AS_PARTICLE:
-				if (part->length != 0.0f) {
-					vec3d p1 = part->attachment.local_vel_to_global(part->velocity);
-					vm_vec_normalize_safe(&p1);
-					p1 *= part->length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
-					p1 += p_pos;
-					light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius);
-				}
-				else {
-					light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-				}
-				break;
-			case ParticleEffect::LightInformation::LightSourceMode::CONE: {
-				float cone_angle = light_source.cone_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_ANGLE_MULT, curve_input);
-				float cone_inner_angle = light_source.cone_inner_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_INNER_ANGLE_MULT, curve_input);
-				vec3d p1 = part->attachment.local_vel_to_global(part->velocity);
-				vm_vec_normalize_safe(&p1);
+		return false;
+	}
+
+	// Moves all non-persistent particles, does the same as move_particle() does for a single one
+	void move_particle_arrays(float frametime)
+	{
+		const size_t count = Particles.size();
+
+		Particle_dead.resize(count);
+		Particle_vel_scale.resize(count);
+		Particle_lit.clear();
+
+		ubyte* dead = Particle_dead.data();
+		float* vel_scale = Particle_vel_scale.data();
+		float* age = Particles.age.data();
+		const float* max_life = Particles.max_life.data();
+		const ubyte* looping = Particles.looping.data();
+
+		for (size_t i = 0; i < count; ++i) {
+			float new_age = age[i] == 0.0f ? 0.00001f : age[i] + frametime;
+			age[i] = new_age;
+			dead[i] = particle_expired(frametime, new_age, max_life[i], looping[i] != 0) ? 1 : 0;
+		}
 
-				light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius);
+		// Only particles with a velocity curve or a light need to be looked at as a whole
+		const bool lights = Detail.lighting > 3;
+		for (size_t i = 0; i < count; ++i) {
+			const auto& cold = Particles.cold[i];
+
+			if (dead[i] || !cold.attachment.is_valid()) {
+				dead[i] = 1;
+				vel_scale[i] = 0.0f;
+				spawn_death_effect(Particles.get(i));
+				continue;
 			}
-			break;
+
+			const auto& source_effect = cold.parent_effect.getParticleEffect();
+			const bool has_light = lights && source_effect.m_light_source;
+
+			if (source_effect.m_lifetime_curves.has_curve(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT)) {
+				auto part = Particles.get(i);
+				vel_scale[i] = source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT, std::forward_as_tuple(part, vm_vec_mag_quick(&part.velocity)));
+			} else {
+				vel_scale[i] = 1.0f;
 			}
+
+			if (has_light)
+				Particle_lit.push_back(i);
 		}
 
-		return false;
+		float* pos_x = Particles.pos_x.data();
+		float* pos_y = Particles.pos_y.data();
+		float* pos_z = Particles.pos_z.data();
+		const float* vel_x = Particles.vel_x.data();
+		const float* vel_y = Particles.vel_y.data();
+		const float* vel_z = Particles.vel_z.data();
+
+		for (size_t i = 0; i < count; ++i) {
+			const float step = vel_scale[i] * frametime;
+			pos_x[i] += vel_x[i] * step;
+			pos_y[i] += vel_y[i] * step;
+			pos_z[i] += vel_z[i] * step;
+		}
+
+		for (auto i : Particle_lit) {
+			auto part = Particles.get(i);
+			vec3d prev_pos = part.pos - (part.velocity * vel_scale[i]) * frametime;
+
+			add_particle_light(part, prev_pos, vel_scale[i]);
+		}
+
+		Particles.compact(Particle_dead, count);
 	}
 
 	void move_all(float frametime)
@@ -332,49 +572,26 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		if (Persistent_particles.empty() && Particles.empty())
+		if (Persistent_alive.empty() && Particles.empty())
 			return;
 
-		for (auto p = Persistent_particles.begin(); p != Persistent_particles.end();)
+		const size_t num_persistent = Persistent_alive.size();
+		size_t write = 0;
+		for (size_t read = 0; read < Persistent_alive.size(); ++read)
 		{
-			ParticlePtr part = *p;
-			if (move_particle(frametime, part.get()))
-			{
-				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
-				if (p + 1 == Persistent_particles.end())
-				{
-					Persistent_particles.pop_back();
-					break;
-				}
-
-				*p = Persistent_particles.back();
-				Persistent_particles.pop_back();
-				continue;
-			}
-
-			// next particle
-			++p;
-		}
+			uint32_t slot = Persistent_alive[read];
 
-		for (auto p = Particles.begin(); p != Particles.end();)
-		{
-			if (move_particle(frametime, &(*p)))
+			if (read < num_persistent && move_particle(frametime, &Persistent_slots[slot]))
 			{
-				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
-				if (p + 1 == Particles.end())
-				{
-					Particles.pop_back();
-					break;
-				}
-
-				*p = Particles.back();
-				Particles.pop_back();
+				free_persistent_slot(slot);
 				continue;
 			}
 
-			// next particle
-			++p;
+			Persistent_alive[write++] = slot;
 		}
+		Persistent_alive.resize(write);
+
+		move_particle_arrays(frametime);
 	}
 
 	// kill all active particles
@@ -382,7 +599,7 @@ namespace particle
 	{
 		// kill all active particles
 		Particles.clear();
-		Persistent_particles.clear();
+		kill_persistent_particles();
 	}
 
 	/**
@@ -537,14 +754,15 @@ namespace particle
 		if (!Particles_enabled)
 			return;
 
-		if (Persistent_particles.empty() && Particles.empty())
+		if (Persistent_alive.empty() && Particles.empty())
 			return;
 
-		for (auto& part : Persistent_particles) {
-			render_particle(part.get());
+		for (auto slot : Persistent_alive) {
+			render_particle(&Persistent_slots[slot]);
 		}
 
-		for (auto& part : Particles) {
+		for (size_t i = 0; i < Particles.size(); ++i) {
+			auto part = Particles.get(i);
 			render_particle(&part);
 		}
 
@@ -25,17 +25,17 @@ ADE_INDEXER(l_HookVar,
 	const auto scriptSystem = script_state::GetScriptState(L);
 
 	const auto& hookVars = scriptSystem->GetHookVariableReferences();
-	const auto iter = hookVars.find(name);
-	if (iter == hookVars.end()) {
+	const auto id = script_state::FindHookVariableId(name);
+	if (id < 0 || static_cast<size_t>(id) >= hookVars.size()) {
 		return ADE_RETURN_NIL;
 	}
-	if (iter->second.empty()) {
+	if (hookVars[id].empty()) {
 		// Hook variable existed at some point but was removed again
 		return ADE_RETURN_NIL;
 	}
 
 	// Use the value on top of the stack
-	iter->second.back()->pushValue(L);
+	hookVars[id].back()->pushValue(L);
 	return 1;
 }
 
@@ -63,14 +63,14 @@ ADE_INDEXER(l_HookVar_Globals,
 
 	// List 'em
 	int count = 1;
-	for (const auto& pair : hookVars) {
-		if (pair.second.empty()) {
+	for (size_t id = 0; id < hookVars.size(); ++id) {
+		if (hookVars[id].empty()) {
 			// Skip empty value stacks
 			continue;
 		}
 
 		if (count == idx) {
-			return ade_set_args(L, "s", pair.first);
+			return ade_set_args(L, "s", script_state::GetHookVariableName(static_cast<int>(id)));
 		}
 		count++;
 	}
@@ -84,10 +84,10 @@ ADE_FUNC(__len, l_HookVar_Globals, NULL, "Number of HookVariables", "number", "N
 
 	const auto& hookVars = scriptSystem->GetHookVariableReferences();
 
-	// Since the values are on a stack, it is possible to have entries in the map that have no values at the moment
+	// Since the values are on a stack, it is possible to have entries that have no values at the moment
 	auto validHookVars = std::count_if(hookVars.cbegin(),
 		hookVars.cend(),
-		[](const std::pair<SCP_string, SCP_vector<luacpp::LuaReference>>& values) { return !values.second.empty(); });
+		[](const SCP_vector<luacpp::LuaReference>& values) { return !values.empty(); });
 
 	return ade_set_args(L, "i", validHookVars);
 }
@@ -75,6 +75,11 @@ HookBase::HookBase(SCP_string hookName,
 				   int32_t hookId)
 	: _conditions(conditions), _hookName(std::move(hookName)), _description(std::move(description)), _parameters(std::move(parameters)), _deprecation(std::move(deprecation))
 {
+	_parameterIds.reserve(_parameters.size());
+	for (const auto& param : _parameters) {
+		_parameterIds.push_back(script_state::GetHookVariableId(param.name));
+	}
+
 	// If we specify a forced id then use that. This is for special hooks that need a guaranteed id
 	if (hookId >= 0) {
 		_hookId = hookId;
@@ -89,6 +94,17 @@ const SCP_string& HookBase::getDescription() const { return _description; }
 const SCP_vector<HookVariableDocumentation>& HookBase::getParameters() const { return _parameters; }
 const std::optional<HookDeprecationOptions>& HookBase::getDeprecation() const { return _deprecation; }
 int32_t HookBase::getHookId() const { return _hookId; }
+int HookBase::getParameterVariableId(const char* param) const
+{
+	for (size_t i = 0; i < _parameters.size(); ++i) {
+		if (strcmp(_parameters[i].name, param) == 0) {
+			return _parameterIds[i];
+		}
+	}
+
+	Assertion(false, "Hook '%s' does not accept parameter '%s'.", _hookName.c_str(), param);
+	return script_state::GetHookVariableId(param);
+}
 HookBase::~HookBase() = default;
 
 const SCP_vector<HookBase*>& getHooks() { return getHookManager().getHooks(); }
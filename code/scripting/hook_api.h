@@ -25,38 +25,17 @@ T&& convert_arg_type(T&& arg)
 
 template <typename T>
 struct HookParameterInstance {
-	SCP_string name;
+	const char* name = nullptr;
 	char type = '\0';
 	T value;
 	bool enabled = true;
 
-	HookParameterInstance(SCP_string name_, char type_, T&& value_, bool enabled_)
-		: name(std::move(name_)), type(type_), value(std::forward<T>(value_)), enabled(enabled_)
+	HookParameterInstance(const char* name_, char type_, T&& value_, bool enabled_)
+		: name(name_), type(type_), value(std::forward<T>(value_)), enabled(enabled_)
 	{
 	}
 };
 
-struct SetSingleHookVarHelper {
-	SCP_vector<SCP_string>& paramNames;
-
-	SetSingleHookVarHelper(SCP_vector<SCP_string>& paramNames_) : paramNames(paramNames_) {}
-
-	template <typename T>
-	void operator()(HookParameterInstance<T>&& instance)
-	{
-		// If a parameter is not enabled, skip it
-		if (!instance.enabled) {
-			return;
-		}
-
-		paramNames.push_back(instance.name);
-
-		Script_system.SetHookVar(instance.name.c_str(),
-								 instance.type,
-								 detail::convert_arg_type(std::move(instance.value)));
-	}
-};
-
 template <typename... Args>
 struct HookParameterInstanceList {
 	std::tuple<HookParameterInstance<Args>...> params;
@@ -65,21 +44,14 @@ struct HookParameterInstanceList {
 		: params(std::forward<HookParameterInstance<Args>>(params_)...)
 	{
 	}
-
-	void setHookVars(SCP_vector<SCP_string>& paramNames)
-	{
-		util::tuples::for_each<0, SetSingleHookVarHelper, HookParameterInstance<Args>...>(
-			std::move(params),
-			SetSingleHookVarHelper(paramNames));
-	}
 };
 
 } // namespace detail
 
 template <typename T>
-detail::HookParameterInstance<T> hook_param(SCP_string name_, char type_, T&& value_, bool enabled = true)
+detail::HookParameterInstance<T> hook_param(const char* name_, char type_, T&& value_, bool enabled = true)
 {
-	return detail::HookParameterInstance<T>(std::move(name_), type_, std::forward<T>(value_), enabled);
+	return detail::HookParameterInstance<T>(name_, type_, std::forward<T>(value_), enabled);
 }
 
 template <typename... Args>
@@ -126,23 +98,94 @@ class HookBase {
 	virtual bool isActive() const = 0;
 	virtual bool isOverridable() const = 0;
 
+	// Returns the hook variable id of one of the parameters of this hook
+	int getParameterVariableId(const char* param) const;
+
 	const SCP_unordered_map<SCP_string, const std::unique_ptr<const ParseableCondition>>& _conditions;
 
   protected:
 	SCP_string _hookName;
 	SCP_string _description;
 	SCP_vector<HookVariableDocumentation> _parameters;
+	// The interned hook variable ids of _parameters, so that running the hook doesn't have to look up any names
+	SCP_vector<int> _parameterIds;
 	std::optional<HookDeprecationOptions> _deprecation;
 	int32_t _hookId = 0;
-	
-	bool hasParameter(const SCP_string& param) const
+};
+
+namespace detail {
+
+struct SetSingleHookVarHelper {
+	script_state& state;
+	const HookBase& hook;
+	int* setIds;
+	size_t& numSet;
+
+	SetSingleHookVarHelper(script_state& state_, const HookBase& hook_, int* setIds_, size_t& numSet_)
+		: state(state_), hook(hook_), setIds(setIds_), numSet(numSet_)
+	{
+	}
+
+	template <typename T>
+	void operator()(HookParameterInstance<T>&& instance)
+	{
+		// If a parameter is not enabled, skip it
+		if (!instance.enabled) {
+			return;
+		}
+
+		auto id = hook.getParameterVariableId(instance.name);
+		setIds[numSet++] = id;
+
+		state.SetHookVar(id, instance.type, detail::convert_arg_type(std::move(instance.value)));
+	}
+};
+
+/**
+ * @brief The hook variables of one run of a hook
+ *
+ * Lives on the stack of the hook run and only remembers which variables it set, so nothing is allocated unless a script
+ * of the hook actually runs.
+ */
+template <typename... Args>
+class HookParameterFrame : public HookVariableFrame {
+	const HookBase& _hook;
+	HookParameterInstanceList<Args...>& _args;
+	int _setIds[sizeof...(Args) + 1];
+	size_t _numSet = 0;
+
+  public:
+	HookParameterFrame(const HookBase& hook, HookParameterInstanceList<Args...>& args) : _hook(hook), _args(args)
 	{
-		return std::find_if(_parameters.begin(), _parameters.end(), [&param](const HookVariableDocumentation& test) {
-				   return test.name == param;
-			   }) != _parameters.end();
+#ifndef NDEBUG
+		// The variables are only set if a script matches, so check the names on every run to catch typos early
+		util::tuples::for_each(_args.params, [this](const auto& instance) {
+			if (instance.enabled) {
+				_hook.getParameterVariableId(instance.name);
+			}
+		});
+#endif
+	}
+
+	void set(script_state& state) override
+	{
+		Assertion(_numSet == 0, "Hook variables of '%s' were set twice in one run!", _hook.getHookName().c_str());
+
+		// The values are moved into Lua, which is fine since the script state sets the variables only once per run
+		util::tuples::for_each<0, SetSingleHookVarHelper, HookParameterInstance<Args>...>(std::move(_args.params),
+			SetSingleHookVarHelper(state, _hook, _setIds, _numSet));
+	}
+
+	void remove(script_state& state) override
+	{
+		while (_numSet > 0) {
+			state.RemHookVar(_setIds[--_numSet]);
+		}
 	}
 };
 
+} // namespace detail
+
 template<typename condition_t>
 class HookImpl : public HookBase {
   protected:
@@ -150,30 +193,13 @@ class HookImpl : public HookBase {
 		: HookBase(std::move(hookName), std::move(description), std::move(parameters), condition_t::conditions, std::move(deprecation), hookId) { };
 
 	template <typename... Args>
-	int run(condition_t condition, detail::HookParameterInstanceList<Args...> argsList = hook_param_list<Args...>()) const
+	int run(const condition_t& condition, detail::HookParameterInstanceList<Args...> argsList = hook_param_list<Args...>()) const
 	{
 		if (!Scripting_game_init_run)
 			return 0;
 
-		SCP_vector<SCP_string> paramNames;
-		argsList.setHookVars(paramNames);
-
-#ifndef NDEBUG
-		std::for_each(paramNames.begin(), paramNames.end(), [this](const SCP_string& param) {
-			Assertion(this->hasParameter(param),
-				"Hook '%s' does not accept parameter '%s'.",
-				this->_hookName.c_str(),
-				param.c_str());
-			});
-#endif
-
-		const auto num_run = Script_system.RunCondition(this->_hookId, std::any(std::move(condition)));
-
-		for (const auto& param : paramNames) {
-			Script_system.RemHookVar(param.c_str());
-		}
-
-		return num_run;
+		detail::HookParameterFrame<Args...> frame(*this, argsList);
+		return Script_system.RunCondition(this->_hookId, HookConditionContext(condition), &frame);
 	}
 };
 template<>
@@ -189,25 +215,8 @@ class HookImpl<void> : public HookBase {
 		if (!Scripting_game_init_run)
 			return 0;
 
-		SCP_vector<SCP_string> paramNames;
-		argsList.setHookVars(paramNames);
-
-#ifndef NDEBUG
-		std::for_each(paramNames.begin(), paramNames.end(), [this](const SCP_string& param) {
-			Assertion(this->hasParameter(param),
-				"Hook '%s' does not accept parameter '%s'.",
-				this->_hookName.c_str(),
-				param.c_str());
-			});
-#endif
-
-		const auto num_run = Script_system.RunCondition(this->_hookId, std::any{});
-
-		for (const auto& param : paramNames) {
-			Script_system.RemHookVar(param.c_str());
-		}
-
-		return num_run;
+		detail::HookParameterFrame<Args...> frame(*this, argsList);
+		return Script_system.RunCondition(this->_hookId, HookConditionContext(), &frame);
 	}
 };
 
@@ -243,30 +252,13 @@ class OverridableHookImpl : public Hook<condition_t> {
 		: Hook<condition_t>(std::move(hookName), std::move(description), std::move(parameters), std::move(deprecation), hookId) { }
 
 	template <typename... Args>
-	bool isOverride(condition_t condition, detail::HookParameterInstanceList<Args...> argsList = hook_param_list<Args...>()) const
+	bool isOverride(const condition_t& condition, detail::HookParameterInstanceList<Args...> argsList = hook_param_list<Args...>()) const
 	{
 		if (!Scripting_game_init_run)
 			return false;
 
-		SCP_vector<SCP_string> paramNames;
-		argsList.setHookVars(paramNames);
-
-#ifndef NDEBUG
-		std::for_each(paramNames.begin(), paramNames.end(), [this](const SCP_string& param) {
-			Assertion(this->hasParameter(param),
-				"Hook '%s' does not accept parameter '%s'.",
-				this->_hookName.c_str(),
-				param.c_str());
-			});
-#endif
-
-		const auto ret_val = Script_system.IsConditionOverride(this->_hookId, std::any(std::move(condition)));
-
-		for (const auto& param : paramNames) {
-			Script_system.RemHookVar(param.c_str());
-		}
-
-		return ret_val;
+		detail::HookParameterFrame<Args...> frame(*this, argsList);
+		return Script_system.IsConditionOverride(this->_hookId, HookConditionContext(condition), &frame);
 	}
 };
 
@@ -282,25 +274,8 @@ protected:
 		if (!Scripting_game_init_run)
 			return false;
 
-		SCP_vector<SCP_string> paramNames;
-		argsList.setHookVars(paramNames);
-
-#ifndef NDEBUG
-		std::for_each(paramNames.begin(), paramNames.end(), [this](const SCP_string& param) {
-			Assertion(this->hasParameter(param),
-				"Hook '%s' does not accept parameter '%s'.",
-				this->_hookName.c_str(),
-				param.c_str());
-			});
-#endif
-
-		const auto ret_val = Script_system.IsConditionOverride(this->_hookId, std::any{});
-
-		for (const auto& param : paramNames) {
-			Script_system.RemHookVar(param.c_str());
-		}
-
-		return ret_val;
+		detail::HookParameterFrame<Args...> frame(*this, argsList);
+		return Script_system.IsConditionOverride(this->_hookId, HookConditionContext(), &frame);
 	}
 };
 
@@ -51,8 +51,8 @@ class EvaluatableConditionImpl : public EvaluatableCondition {
 public:
 	EvaluatableConditionImpl(const ParseableConditionImpl<conditions_t, operating_t, cache_t>& _condition, const SCP_string& input) : condition(_condition), cached(condition.cache(input)) { }
 
-	bool evaluate(const std::any& conditionContext) const override {
-		const conditions_t& conditions = std::any_cast<conditions_t>(conditionContext);
+	bool evaluate(const HookConditionContext& conditionContext) const override {
+		const conditions_t& conditions = conditionContext.get<conditions_t>();
 		return condition.evaluate(conditions.*(condition.object), cached);
 	}
 };
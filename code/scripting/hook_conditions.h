@@ -1,6 +1,6 @@
 #pragma once
 
-#include <any>
+#include <typeinfo>
 
 class object;
 class ship;
@@ -13,9 +13,36 @@ enum class ArrivalLocation;
 
 namespace scripting {
 
+/**
+ * @brief Refers to the conditions struct of a hook run
+ *
+ * Unlike std::any this never copies the struct, so passing it to the conditions of a hook doesn't need any memory.
+ * The struct has to outlive the context.
+ */
+class HookConditionContext {
+	const void* _conditions = nullptr;
+	const std::type_info* _type = nullptr;
+
+public:
+	HookConditionContext() = default;
+
+	template <typename conditions_t>
+	explicit HookConditionContext(const conditions_t& conditions) : _conditions(&conditions), _type(&typeid(conditions_t))
+	{
+	}
+
+	template <typename conditions_t>
+	const conditions_t& get() const
+	{
+		Assertion(_type != nullptr && *_type == typeid(conditions_t),
+			"Hook condition was evaluated with the conditions of a different hook!");
+		return *static_cast<const conditions_t*>(_conditions);
+	}
+};
+
 class EvaluatableCondition {
 public:
-	virtual bool evaluate(const std::any& /*conditionContext*/) const {
+	virtual bool evaluate(const HookConditionContext& /*conditionContext*/) const {
 		return false;
 	};
 
@@ -407,6 +407,53 @@ int cache_condition(ConditionalType type, const SCP_string& value){
 //*************************CLASS: script_state*************************
 //Most of the icky stuff is here. Lots of #ifdefs
 
+namespace {
+// Every hook variable name that was ever used, the index is the id of the name
+struct hook_variable_names {
+	SCP_vector<SCP_string> names;
+	SCP_unordered_map<SCP_string, int> ids;
+};
+
+// Hooks intern the names of their variables while they are constructed during static initialization, so this can't
+// be a plain global
+hook_variable_names& get_hook_variable_names()
+{
+	static hook_variable_names names;
+	return names;
+}
+}
+
+int script_state::GetHookVariableId(const char* name)
+{
+	auto& table = get_hook_variable_names();
+
+	auto iter = table.ids.find(name);
+	if (iter != table.ids.end()) {
+		return iter->second;
+	}
+
+	auto id = static_cast<int>(table.names.size());
+	table.names.emplace_back(name);
+	table.ids.emplace(name, id);
+	return id;
+}
+
+int script_state::FindHookVariableId(const char* name)
+{
+	const auto& table = get_hook_variable_names();
+
+	auto iter = table.ids.find(name);
+	return iter != table.ids.end() ? iter->second : -1;
+}
+
+const SCP_string& script_state::GetHookVariableName(int id)
+{
+	const auto& table = get_hook_variable_names();
+
+	Assertion(id >= 0 && static_cast<size_t>(id) < table.names.size(), "Invalid hook variable id %d!", id);
+	return table.names[id];
+}
+
 //WMC - defined in parse/scripting.h
 void script_state::SetHookObject(const char *name, object *objp)
 {
@@ -430,30 +477,39 @@ void script_state::SetHookObjects(int num, ...)
 		auto reference = luacpp::UniqueLuaReference::create(LuaState);
 		lua_pop(LuaState, 1); // Remove object value from the stack
 
-		HookVariableValues[name].push_back(std::move(reference));
+		auto id = GetHookVariableId(name);
+		if (static_cast<size_t>(id) >= HookVariableValues.size()) {
+			HookVariableValues.resize(id + 1);
+		}
+		HookVariableValues[id].push_back(std::move(reference));
 	}
 
 	va_end(vl);
 }
 
+void script_state::RemHookVar(int id)
+{
+	if (LuaState != nullptr) {
+		if (id < 0 || static_cast<size_t>(id) >= HookVariableValues.size() || HookVariableValues[id].empty()) {
+			// Nothing to do
+			return;
+		}
+		HookVariableValues[id].pop_back();
+	}
+}
+
 void script_state::RemHookVar(const char* name)
 {
-	this->RemHookVars({name});
+	RemHookVar(FindHookVariableId(name));
 }
 
-void script_state::RemHookVars(std::initializer_list<SCP_string> names)
+void script_state::RemHookVars(std::initializer_list<const char*> names)
 {
-	if (LuaState != nullptr) {
-		for (const auto& hookVar : names) {
-			if (HookVariableValues[hookVar].empty()) {
-				// Nothing to do
-				continue;
-			}
-			HookVariableValues[hookVar].pop_back();
-		}
+	for (auto hookVar : names) {
+		RemHookVar(hookVar);
 	}
 }
-const SCP_unordered_map<SCP_string, SCP_vector<luacpp::LuaReference>>& script_state::GetHookVariableReferences()
+const SCP_vector<SCP_vector<luacpp::LuaReference>>& script_state::GetHookVariableReferences()
 {
 	return HookVariableValues;
 }
@@ -488,7 +544,7 @@ void script_state::UnloadImages()
 	ScriptImages.clear();
 }
 
-int script_state::RunCondition(int action_type, const std::any& local_condition_data)
+int script_state::RunCondition(int action_type, const HookConditionContext& local_condition_data, HookVariableFrame* variables)
 {
 	TRACE_SCOPE(tracing::LuaHooks);
 	int num = 0;
@@ -505,30 +561,55 @@ int script_state::RunCondition(int action_type, const std::any& local_condition_
 	{
 		if (action.ConditionsValid(local_condition_data))
 		{
+			// The variables are only needed once a script actually runs
+			if (variables != nullptr && num == 0) {
+				variables->set(*this);
+			}
+
 			RunBytecode(action.hook.hook_function);
 			num++;
 		}
 	}
 
-	ProcessAddedHooks();
+	if (variables != nullptr && num > 0) {
+		variables->remove(*this);
+	}
+
+	if (!AddedHooks.empty()) {
+		ProcessAddedHooks();
+	}
 	return num;
 }
 
-bool script_state::IsConditionOverride(int action_type, const std::any& local_condition_data)
+bool script_state::IsConditionOverride(int action_type, const HookConditionContext& local_condition_data, HookVariableFrame* variables)
 {
 	auto action_it = ConditionalHooks.find(action_type);
 	if (action_it == ConditionalHooks.end())
 		return false;
 
+	bool variables_set = false;
+	bool is_override = false;
+
 	for (const auto& action : action_it->second)
 	{
 		if (action.ConditionsValid(local_condition_data))
 		{
-			if (IsOverride(action.hook))
-				return true;
+			if (variables != nullptr && !variables_set) {
+				variables->set(*this);
+				variables_set = true;
+			}
+
+			if (IsOverride(action.hook)) {
+				is_override = true;
+				break;
+			}
 		}
 	}
-	return false;
+
+	if (variables_set) {
+		variables->remove(*this);
+	}
+	return is_override;
 }
 
 void script_state::Clear()
@@ -839,7 +920,7 @@ ConditionalType scripting_string_to_condition(const char* condition)
 	return CHC_NONE;
 }
 
-bool script_action::ConditionsValid(const std::any& local_condition_data) const {
+bool script_action::ConditionsValid(const HookConditionContext& local_condition_data) const {
 	for (const auto& global_condition : global_conditions) {
 		if (!global_condition_valid(global_condition))
 			return false;
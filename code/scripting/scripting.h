@@ -113,9 +113,27 @@ public:
 
 	script_hook hook;
 
-	bool ConditionsValid(const std::any& local_condition_data) const;
+	bool ConditionsValid(const scripting::HookConditionContext& local_condition_data) const;
 };
 
+class script_state;
+
+namespace scripting {
+/**
+ * @brief The hook variables of one hook run
+ *
+ * The script state only sets them right before the first script of the hook runs, and removes them again afterwards.
+ * That way running a hook that has no matching script never creates any Lua values.
+ */
+class HookVariableFrame {
+  public:
+	virtual ~HookVariableFrame() = default;
+
+	virtual void set(script_state& state) = 0;
+	virtual void remove(script_state& state) = 0;
+};
+}
+
 //**********Main script_state function
 class script_state
 {
@@ -135,11 +153,11 @@ class script_state
 
 	SCP_vector<script_function> GameInitFunctions;
 
-	// Stores references to the Lua values for the hook variables. Uses a raw reference since we do not need the more
-	// advanced features of LuaValue
+	// Stores references to the Lua values for the hook variables, indexed by the id from GetHookVariableId(). Uses a raw
+	// reference since we do not need the more advanced features of LuaValue
 	// values are a vector to provide a stack of values. This is necessary to ensure consistent behavior if a scripting
 	// hook is called from within another script (e.g. calls to createShip)
-	SCP_unordered_map<SCP_string, SCP_vector<luacpp::LuaReference>> HookVariableValues;
+	SCP_vector<SCP_vector<luacpp::LuaReference>> HookVariableValues;
 
 	// ActiveActions lets code that might run scripting hooks know whether any scripts are even registered for it.
 	// AssayActions is responsible for keeping it up to date.
@@ -181,14 +199,24 @@ public:
 	//***Moves data
 	//void MoveData(script_state &in);
 
+	// Hook variable names are interned, the ids are the same for every script state and never change
+	static int GetHookVariableId(const char* name);
+	// Returns -1 if there never was a hook variable with that name
+	static int FindHookVariableId(const char* name);
+	static const SCP_string& GetHookVariableName(int id);
+
+	template<typename T>
+	void SetHookVar(int id, char format, T&& value);
 	template<typename T>
 	void SetHookVar(const char *name, char format, T&& value);
 	void SetHookObject(const char *name, object *objp);
 	void SetHookObjects(int num, ...);
+	void RemHookVar(int id);
 	void RemHookVar(const char *name);
-	void RemHookVars(std::initializer_list<SCP_string> names);
+	void RemHookVars(std::initializer_list<const char*> names);
 
-	const SCP_unordered_map<SCP_string, SCP_vector<luacpp::LuaReference>>& GetHookVariableReferences();
+	// Indexed by the hook variable id
+	const SCP_vector<SCP_vector<luacpp::LuaReference>>& GetHookVariableReferences();
 
 	//***Hook creation functions
 	template <typename T>
@@ -209,8 +237,10 @@ public:
 	int RunBytecode(const script_function& hd, char format = '\0', T* data = nullptr);
 	int RunBytecode(const script_function& hd);
 	bool IsOverride(const script_hook &hd);
-	int RunCondition(int action_type, const std::any& local_condition_data);
-	bool IsConditionOverride(int action_type, const std::any& local_condition_data);
+	int RunCondition(int action_type, const scripting::HookConditionContext& local_condition_data,
+		scripting::HookVariableFrame* variables = nullptr);
+	bool IsConditionOverride(int action_type, const scripting::HookConditionContext& local_condition_data,
+		scripting::HookVariableFrame* variables = nullptr);
 
 	void RunInitFunctions();
 
@@ -222,7 +252,7 @@ public:
 };
 
 template<typename T>
-void script_state::SetHookVar(const char *name, char format, T&& value)
+void script_state::SetHookVar(int id, char format, T&& value)
 {
 	if(format == '\0')
 		return;
@@ -234,10 +264,19 @@ void script_state::SetHookVar(const char *name, char format, T&& value)
 		auto reference = luacpp::UniqueLuaReference::create(LuaState);
 		lua_pop(LuaState, 1); // Remove object value from the stack
 
-		HookVariableValues[name].push_back(std::move(reference));
+		if (static_cast<size_t>(id) >= HookVariableValues.size()) {
+			HookVariableValues.resize(id + 1);
+		}
+		HookVariableValues[id].push_back(std::move(reference));
 	}
 }
 
+template<typename T>
+void script_state::SetHookVar(const char *name, char format, T&& value)
+{
+	SetHookVar(GetHookVariableId(name), format, std::forward<T>(value));
+}
+
 template <typename T>
 bool script_state::EvalStringWithReturn(const char* string, const char* format, T* rtn, const char* debug_str)
 {
@@ -68,6 +68,7 @@
 #include "object/objectsnd.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
+#include "parse/sexp/sexp_dependencies.h"
 #include "particle/ParticleEffect.h"
 #include "particle/volumes/LegacyAACuboidVolume.h"
 #include "scripting/hook_api.h"
@@ -8913,6 +8914,7 @@ void ship_cleanup(int shipnum, int cleanup_mode)
 	auto entry = &Ship_registry[entry_index];
 	entry->status = ShipStatus::EXITED;
 	entry->cleanup_mode = cleanup_mode;
+	sexp_mark_dependency_changed(SEXP_DEPENDS_SHIPS);
 
 	// add the information to the exited ship list
 	switch (cleanup_mode) {
@@ -11444,6 +11446,7 @@ int ship_create(matrix* orient, vec3d* pos, int ship_type, const char* ship_name
 		entry->objnum = objnum;
 		entry->shipnum = shipnum;
 	}
+	sexp_mark_dependency_changed(SEXP_DEPENDS_SHIPS);
 	
 	// Start up stracking for this ship in multi.
 	if (Game_mode & (GM_MULTIPLAYER)) {
@@ -19079,6 +19082,8 @@ void ship_page_in()
 	for (auto& fi : Fireball_info)
 		fi.fireball_used = false;
 
+	model_load_batch_start();
+
 	i = 0;
 	for (auto sip = Ship_info.begin(); sip != Ship_info.end(); i++, ++sip) {
 		if ( !ship_class_used[i] )
@@ -19182,6 +19187,8 @@ void ship_page_in()
 		}
 	}
 
+	model_load_batch_stop();
+
 	nprintf(( "Paging", "There are %d ship classes used in this mission.\n", num_ship_types_used ));
 
 
@@ -81,6 +81,8 @@ add_file_folder("AI"
 	ai/aiinternal.h
 	ai/ailua.cpp
 	ai/ailua.h
+	ai/aitargetgrid.cpp
+	ai/aitargetgrid.h
 	ai/aiturret.cpp
 )
 
@@ -473,6 +475,7 @@ add_file_folder("Graphics"
 	graphics/post_processing.h
 	graphics/render.cpp
 	graphics/render.h
+	graphics/render_queue.cpp
 	graphics/render_queue.h
 	graphics/shadows.cpp
 	graphics/shadows.h
@@ -759,6 +762,8 @@ add_file_folder("Libs\\\\RenderDoc"
 
 # Lighting files
 add_file_folder("Lighting"
+	lighting/light_clusters.cpp
+	lighting/light_clusters.h
 	lighting/lighting.cpp
 	lighting/lighting.h
 	lighting/lighting_profiles.cpp
@@ -822,6 +827,8 @@ add_file_folder("MenuUI"
 
 # Mission files
 add_file_folder("Mission"
+	mission/missionbenchmark.cpp
+	mission/missionbenchmark.h
 	mission/missionbriefcommon.cpp
 	mission/missionbriefcommon.h
 	mission/missioncampaign.cpp
@@ -900,6 +907,8 @@ add_file_folder("mod_table"
 # Model files
 add_file_folder("Model"
 	model/model.h
+	model/modelcache.cpp
+	model/modelcache.h
 	model/modelcollide.cpp
 	model/modelinterp.cpp
 	model/modelread.cpp
@@ -965,6 +974,8 @@ add_file_folder("Network"
 	network/multi_mdns.h
 	network/multi_obj.cpp
 	network/multi_obj.h
+	network/multi_oo_delta.cpp
+	network/multi_oo_delta.h
 	network/multi_observer.cpp
 	network/multi_observer.h
 	network/multi_options.cpp
@@ -1129,8 +1140,14 @@ add_file_folder("Parse\\\\SEXP"
 	parse/sexp/LuaSEXP.h
 	parse/sexp/LuaAISEXP.cpp
 	parse/sexp/LuaAISEXP.h
+	parse/sexp/sexp_bytecode.cpp
+	parse/sexp/sexp_bytecode.h
+	parse/sexp/sexp_dependencies.cpp
+	parse/sexp/sexp_dependencies.h
 	parse/sexp/sexp_lookup.cpp
 	parse/sexp/sexp_lookup.h
+	parse/sexp/sexp_profiler.cpp
+	parse/sexp/sexp_profiler.h
 	parse/sexp/SEXPParameterExtractor.cpp
 	parse/sexp/SEXPParameterExtractor.h
 )
@@ -1714,8 +1731,14 @@ add_file_folder("TgaUtils"
 
 # Tracing files
 add_file_folder("Tracing"
+	tracing/BinaryTraceFormat.cpp
+	tracing/BinaryTraceFormat.h
+	tracing/BinaryTraceWriter.cpp
+	tracing/BinaryTraceWriter.h
 	tracing/categories.cpp
 	tracing/categories.h
+	tracing/CategoryTimer.h
+	tracing/CategoryTimer.cpp
 	tracing/FrameProfiler.h
 	tracing/FrameProfiler.cpp
 	tracing/MainFrameTimer.h
@@ -1767,6 +1790,7 @@ add_file_folder("Utils"
 	utils/Random.h
 	utils/RandomRange.h
 	utils/reset_on_move.h
+	utils/spsc_ring.h
 	utils/string_utils.cpp
 	utils/string_utils.h
 	utils/table_viewer.cpp
@@ -0,0 +1,347 @@
+
+#include "tracing/BinaryTraceFormat.h"
+
+#include <cstring>
+#include <iomanip>
+
+namespace {
+using namespace tracing::binary;
+
+std::uint64_t zigzag(std::int64_t value) {
+	return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) {
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+const char* getTypeStr(EventKind kind) {
+	switch (kind) {
+		case EventKind::Complete:
+			return "X";
+		case EventKind::Begin:
+			return "B";
+		case EventKind::End:
+			return "E";
+		case EventKind::AsyncBegin:
+			return "b";
+		case EventKind::AsyncStep:
+			return "n";
+		case EventKind::AsyncEnd:
+			return "e";
+		case EventKind::Counter:
+			return "C";
+		default:
+			return nullptr;
+	}
+}
+
+void writeTime(std::ostream& out, std::uint64_t time) {
+	// Save stream state
+	auto flags = out.flags();
+	out << std::fixed << std::setprecision(3);
+
+	out << (time / 1000.);
+
+	// and now restore it
+	out.flags(flags);
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+	out << '"';
+	for (auto c : text) {
+		if (c == '"' || c == '\\') {
+			out << '\\';
+		}
+		out << c;
+	}
+	out << '"';
+}
+}
+
+namespace tracing {
+namespace binary {
+
+Encoder::Encoder(std::vector<std::uint8_t>& out) : _out(out) {
+}
+
+void Encoder::putByte(std::uint8_t value) {
+	_out.push_back(value);
+}
+
+void Encoder::putVarint(std::uint64_t value) {
+	while (value >= 0x80) {
+		putByte(static_cast<std::uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	putByte(static_cast<std::uint8_t>(value));
+}
+
+void Encoder::putSigned(std::int64_t value) {
+	putVarint(zigzag(value));
+}
+
+void Encoder::writeHeader(std::int64_t pid) {
+	_out.insert(_out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+
+	for (int i = 0; i < 4; ++i) {
+		putByte(static_cast<std::uint8_t>(VERSION >> (i * 8)));
+	}
+	for (int i = 0; i < 8; ++i) {
+		putByte(static_cast<std::uint8_t>(static_cast<std::uint64_t>(pid) >> (i * 8)));
+	}
+}
+
+void Encoder::writeString(std::uint32_t id, const char* text) {
+	auto length = strlen(text);
+
+	putByte(static_cast<std::uint8_t>(RecordType::String));
+	putVarint(id);
+	putVarint(length);
+	_out.insert(_out.end(), text, text + length);
+}
+
+void Encoder::writeEvent(const event_record& evt) {
+	putByte(static_cast<std::uint8_t>(RecordType::Event));
+	putByte(static_cast<std::uint8_t>(evt.kind));
+	putByte(evt.flags);
+	putVarint(evt.name);
+	putVarint(evt.scope);
+	putSigned(evt.tid);
+
+	// events of different threads arrive out of order, so the difference may be negative
+	putSigned(static_cast<std::int64_t>(evt.timestamp - _last_timestamp));
+	_last_timestamp = evt.timestamp;
+
+	if (evt.kind == EventKind::Complete) {
+		putVarint(evt.duration);
+	} else if (evt.kind == EventKind::Counter) {
+		std::uint32_t bits;
+		memcpy(&bits, &evt.value, sizeof(bits));
+		for (int i = 0; i < 4; ++i) {
+			putByte(static_cast<std::uint8_t>(bits >> (i * 8)));
+		}
+	}
+}
+
+Decoder::Decoder(const std::uint8_t* data, size_t size) : _data(data), _size(size) {
+}
+
+bool Decoder::getByte(std::uint8_t& value) {
+	if (_pos >= _size) {
+		_damaged = true;
+		return false;
+	}
+
+	value = _data[_pos++];
+	return true;
+}
+
+bool Decoder::getVarint(std::uint64_t& value) {
+	value = 0;
+
+	for (int shift = 0; shift < 64; shift += 7) {
+		std::uint8_t byte;
+		if (!getByte(byte)) {
+			return false;
+		}
+
+		value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+
+	// more than ten bytes can't come from putVarint()
+	_damaged = true;
+	return false;
+}
+
+bool Decoder::getSigned(std::int64_t& value) {
+	std::uint64_t raw;
+	if (!getVarint(raw)) {
+		return false;
+	}
+
+	value = unzigzag(raw);
+	return true;
+}
+
+bool Decoder::readHeader(std::int64_t& pid) {
+	if (_size < sizeof(MAGIC) + 12 || memcmp(_data, MAGIC, sizeof(MAGIC)) != 0) {
+		_damaged = true;
+		return false;
+	}
+	_pos = sizeof(MAGIC);
+
+	std::uint32_t version = 0;
+	for (int i = 0; i < 4; ++i) {
+		version |= static_cast<std::uint32_t>(_data[_pos++]) << (i * 8);
+	}
+
+	std::uint64_t raw_pid = 0;
+	for (int i = 0; i < 8; ++i) {
+		raw_pid |= static_cast<std::uint64_t>(_data[_pos++]) << (i * 8);
+	}
+	pid = static_cast<std::int64_t>(raw_pid);
+
+	if (version != VERSION) {
+		_damaged = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool Decoder::next(RecordType& type, std::uint32_t& string_id, std::string& text, event_record& evt) {
+	// a clean end is only possible between two records
+	if (_pos == _size) {
+		return false;
+	}
+
+	std::uint8_t byte;
+	getByte(byte);
+	type = static_cast<RecordType>(byte);
+
+	std::uint64_t value;
+
+	switch (type) {
+		case RecordType::String: {
+			std::uint64_t length;
+			if (!getVarint(value) || !getVarint(length)) {
+				return false;
+			}
+			if (value > UINT32_MAX || length > _size - _pos) {
+				_damaged = true;
+				return false;
+			}
+
+			string_id = static_cast<std::uint32_t>(value);
+			text.assign(reinterpret_cast<const char*>(_data + _pos), static_cast<size_t>(length));
+			_pos += static_cast<size_t>(length);
+			return true;
+		}
+		case RecordType::Event: {
+			std::uint64_t name;
+			std::uint64_t scope;
+			std::int64_t delta;
+
+			if (!getByte(byte) || !getByte(evt.flags) || !getVarint(name) || !getVarint(scope) || !getSigned(evt.tid)
+				|| !getSigned(delta)) {
+				return false;
+			}
+			if (getTypeStr(static_cast<EventKind>(byte)) == nullptr || name > UINT32_MAX || scope > UINT32_MAX) {
+				_damaged = true;
+				return false;
+			}
+
+			evt.kind = static_cast<EventKind>(byte);
+			evt.name = static_cast<std::uint32_t>(name);
+			evt.scope = static_cast<std::uint32_t>(scope);
+			evt.timestamp = _last_timestamp + static_cast<std::uint64_t>(delta);
+			_last_timestamp = evt.timestamp;
+			evt.duration = 0;
+			evt.value = 0.f;
+
+			if (evt.kind == EventKind::Complete) {
+				if (!getVarint(evt.duration)) {
+					return false;
+				}
+			} else if (evt.kind == EventKind::Counter) {
+				std::uint32_t bits = 0;
+				for (int i = 0; i < 4; ++i) {
+					if (!getByte(byte)) {
+						return false;
+					}
+					bits |= static_cast<std::uint32_t>(byte) << (i * 8);
+				}
+				memcpy(&evt.value, &bits, sizeof(bits));
+			}
+			return true;
+		}
+		default:
+			_damaged = true;
+			return false;
+	}
+}
+
+bool Decoder::damaged() const {
+	return _damaged;
+}
+
+bool convert_to_json(const std::uint8_t* data, size_t size, std::ostream& out) {
+	Decoder decoder(data, size);
+
+	std::int64_t pid;
+	if (!decoder.readHeader(pid)) {
+		return false;
+	}
+
+	std::vector<std::string> strings(1);
+
+	RecordType type;
+	std::uint32_t string_id;
+	std::string text;
+	event_record evt;
+	bool first_line = true;
+
+	out << "[";
+
+	while (decoder.next(type, string_id, text, evt)) {
+		if (type == RecordType::String) {
+			if (string_id >= strings.size()) {
+				strings.resize(string_id + 1);
+			}
+			strings[string_id] = text;
+			continue;
+		}
+
+		if (!first_line) {
+			out << ",";
+		}
+		out << "\n{\"tid\": " << evt.tid << ",\"ts\":";
+
+		writeTime(out, evt.timestamp);
+
+		out << ",\"pid\":";
+		if (evt.flags & EVENT_FLAG_GPU) {
+			out << "\"GPU\"";
+		} else {
+			out << pid;
+		}
+
+		if (evt.scope != 0) {
+			out << ",\"cat\":";
+			writeString(out, evt.scope < strings.size() ? strings[evt.scope] : std::string());
+			out << ",\"id\":\"" << evt.scope << "\"";
+		}
+
+		out << ",\"name\":";
+		writeString(out, evt.name < strings.size() ? strings[evt.name] : std::string());
+		out << ",\"ph\":\"" << getTypeStr(evt.kind) << "\"";
+
+		if (evt.kind == EventKind::Complete) {
+			out << ",\"dur\":";
+			writeTime(out, evt.duration);
+		} else if (evt.kind == EventKind::Counter) {
+			auto flags = out.flags();
+			out << std::fixed;
+
+			out << ",\"args\": {\"value\": " << evt.value << "}";
+
+			// and now restore it
+			out.flags(flags);
+		}
+
+		out << "}";
+
+		first_line = false;
+	}
+
+	out << "]\n";
+
+	return !decoder.damaged();
+}
+
+}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+// Only the standard library is used here, so that tools/trace_converter can be built from this without the engine
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** @file
+ *  @ingroup tracing
+ *
+ *  The binary trace format written by -binary_profiling
+ *
+ *  A file starts with the magic "FSTR", the version and the process id as little endian 32 and 64 bit integers. Then
+ *  a list of records follows, each one starting with its RecordType:
+ *  - String: the id and the text of a category or scope name. Every name is written once, before the first event
+ *    that uses it. Id 0 means no name.
+ *  - Event: the EventKind, the flags, the name and scope ids, the thread id, the timestamp as the difference to the
+ *    previous event, the duration of complete events and the value of counter events.
+ *
+ *  All integers in records are LEB128 varints, signed ones are zigzag encoded first. Counter values are little endian
+ *  32 bit floats.
+ */
+
+namespace tracing {
+namespace binary {
+
+const char MAGIC[4] = { 'F', 'S', 'T', 'R' };
+const std::uint32_t VERSION = 1;
+
+enum class RecordType : std::uint8_t {
+	String = 1,
+	Event = 2,
+};
+
+// Stored separately from tracing::EventType, so that the file format doesn't change with the enum
+enum class EventKind : std::uint8_t {
+	Complete = 1,
+	Begin,
+	End,
+	AsyncBegin,
+	AsyncStep,
+	AsyncEnd,
+	Counter,
+};
+
+// The event was measured on the GPU
+const std::uint8_t EVENT_FLAG_GPU = 1 << 0;
+
+struct event_record {
+	EventKind kind = EventKind::Complete;
+	std::uint8_t flags = 0;
+	std::uint32_t name = 0;
+	std::uint32_t scope = 0;
+	std::int64_t tid = 0;
+	std::uint64_t timestamp = 0;	// in nanoseconds
+	std::uint64_t duration = 0;		// in nanoseconds, complete events only
+	float value = 0.f;				// counter events only
+};
+
+/**
+ * @brief Appends records to a buffer
+ */
+class Encoder {
+	std::vector<std::uint8_t>& _out;
+	std::uint64_t _last_timestamp = 0;
+
+	void putByte(std::uint8_t value);
+	void putVarint(std::uint64_t value);
+	void putSigned(std::int64_t value);
+
+ public:
+	explicit Encoder(std::vector<std::uint8_t>& out);
+
+	void writeHeader(std::int64_t pid);
+
+	void writeString(std::uint32_t id, const char* text);
+
+	void writeEvent(const event_record& evt);
+};
+
+/**
+ * @brief Reads records from a buffer
+ */
+class Decoder {
+	const std::uint8_t* _data;
+	size_t _size;
+	size_t _pos = 0;
+	bool _damaged = false;
+	std::uint64_t _last_timestamp = 0;
+
+	bool getByte(std::uint8_t& value);
+	bool getVarint(std::uint64_t& value);
+	bool getSigned(std::int64_t& value);
+
+ public:
+	Decoder(const std::uint8_t* data, size_t size);
+
+	/**
+	 * @brief Reads the file header
+	 * @return false if this is not a trace file of a version this decoder knows
+	 */
+	bool readHeader(std::int64_t& pid);
+
+	/**
+	 * @brief Reads the next record
+	 *
+	 * @param type Receives the type of the record
+	 * @param string_id Receives the id of a string record
+	 * @param text Receives the text of a string record
+	 * @param evt Receives the contents of an event record
+	 * @return false at the end of the data or if the data is damaged, see damaged()
+	 */
+	bool next(RecordType& type, std::uint32_t& string_id, std::string& text, event_record& evt);
+
+	bool damaged() const;
+};
+
+/**
+ * @brief Converts a binary trace into the Chrome trace event JSON format, which chrome://tracing and Perfetto read
+ * @return false if the trace is damaged, everything before the damage is still written
+ */
+bool convert_to_json(const std::uint8_t* data, size_t size, std::ostream& out);
+
+}
+}
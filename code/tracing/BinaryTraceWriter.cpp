@@ -0,0 +1,92 @@
+
+#include "tracing/BinaryTraceWriter.h"
+
+namespace
+{
+using namespace tracing;
+
+// The buffer is written out once it gets this large
+const size_t FLUSH_SIZE = 64 * 1024;
+
+binary::EventKind getKind(EventType type) {
+	switch(type) {
+		case EventType::Complete:
+			return binary::EventKind::Complete;
+		case EventType::Begin:
+			return binary::EventKind::Begin;
+		case EventType::End:
+			return binary::EventKind::End;
+		case EventType::AsyncBegin:
+			return binary::EventKind::AsyncBegin;
+		case EventType::AsyncStep:
+			return binary::EventKind::AsyncStep;
+		case EventType::AsyncEnd:
+			return binary::EventKind::AsyncEnd;
+		case EventType::Counter:
+			return binary::EventKind::Counter;
+		default:
+			UNREACHABLE("Invalid enum value %d!", static_cast<int>(type));
+			return binary::EventKind::Complete;
+	}
+}
+}
+
+namespace tracing
+{
+
+BinaryTraceWriter::BinaryTraceWriter(std::int64_t pid) : _out("tracing/trace.fstrace", std::ios::binary), _encoder(_buffer) {
+	_buffer.reserve(FLUSH_SIZE * 2);
+	_encoder.writeHeader(pid);
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+	flush();
+	_out.close();
+}
+
+std::uint32_t BinaryTraceWriter::getStringId(const void* key, const char* name) {
+	auto iter = _string_ids.find(key);
+	if (iter != _string_ids.end()) {
+		return iter->second;
+	}
+
+	// 0 is reserved for no name at all
+	auto id = static_cast<std::uint32_t>(_string_ids.size() + 1);
+	_string_ids.emplace(key, id);
+	_encoder.writeString(id, name);
+
+	return id;
+}
+
+void BinaryTraceWriter::flush() {
+	if (!_buffer.empty()) {
+		_out.write(reinterpret_cast<const char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+		_buffer.clear();
+	}
+}
+
+void BinaryTraceWriter::processEvent(const trace_event* event) {
+	if (event->type == EventType::Complete) {
+		if (event->duration < 1000) {
+			// Discard events that are less than a microsecond long, like the JSON writer does
+			return;
+		}
+	}
+
+	binary::event_record record;
+	record.kind = getKind(event->type);
+	record.flags = (event->pid == GPU_PID) ? binary::EVENT_FLAG_GPU : 0;
+	record.name = getStringId(event->category, event->category->getName());
+	record.scope = (event->scope != nullptr) ? getStringId(event->scope, event->scope->getName()) : 0;
+	record.tid = event->tid;
+	record.timestamp = event->timestamp;
+	record.duration = event->duration;
+	record.value = event->value;
+
+	_encoder.writeEvent(record);
+
+	if (_buffer.size() >= FLUSH_SIZE) {
+		flush();
+	}
+}
+}
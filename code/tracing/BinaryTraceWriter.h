@@ -0,0 +1,44 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/tracing.h"
+
+#include "tracing/BinaryTraceFormat.h"
+#include "tracing/ThreadedEventProcessor.h"
+
+#include <fstream>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing
+{
+/**
+ * @brief Writes events to tracing/trace.fstrace in the format described in BinaryTraceFormat.h
+ *
+ * Use tools/trace_converter to turn the file into JSON for chrome://tracing or Perfetto.
+ */
+class BinaryTraceWriter
+{
+	std::ofstream _out;
+
+	std::vector<std::uint8_t> _buffer;
+	binary::Encoder _encoder;
+
+	// Categories and scopes both get their names from the same table
+	SCP_unordered_map<const void*, std::uint32_t> _string_ids;
+
+	std::uint32_t getStringId(const void* key, const char* name);
+
+	void flush();
+
+public:
+	explicit BinaryTraceWriter(std::int64_t pid);
+	~BinaryTraceWriter();
+
+	void processEvent(const trace_event* event);
+};
+
+typedef ThreadedEventProcessor<BinaryTraceWriter> ThreadedBinaryTraceWriter;
+}
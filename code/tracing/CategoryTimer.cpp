@@ -0,0 +1,45 @@
+
+#include "tracing/CategoryTimer.h"
+
+#include <algorithm>
+
+namespace tracing {
+
+void CategoryTimer::processEvent(const trace_event* event) {
+	if (event->type != EventType::Complete || event->pid == GPU_PID) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(_timingsMutex);
+
+	auto& timing = _timings[event->category];
+	++timing.count;
+	timing.total += event->duration;
+	timing.max = std::max(timing.max, event->duration);
+}
+
+SCP_vector<category_timing> CategoryTimer::getTimings() {
+	SCP_vector<category_timing> timings;
+
+	{
+		std::lock_guard<std::mutex> guard(_timingsMutex);
+
+		for (const auto& entry : _timings) {
+			timings.push_back({ entry.first->getName(), entry.second.count, entry.second.total, entry.second.max });
+		}
+	}
+
+	std::sort(timings.begin(), timings.end(), [](const category_timing& left, const category_timing& right) {
+		return left.total_ns > right.total_ns;
+	});
+
+	return timings;
+}
+
+void CategoryTimer::reset() {
+	std::lock_guard<std::mutex> guard(_timingsMutex);
+
+	_timings.clear();
+}
+
+}
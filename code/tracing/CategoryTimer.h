@@ -0,0 +1,39 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/tracing.h"
+
+#include <mutex>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+/**
+ * @brief Sums up the time spent in every category
+ *
+ * Only complete events of the CPU are counted. Nested scopes count towards every category they are in, so the time of
+ * a category includes the time of the categories below it.
+ */
+class CategoryTimer {
+	struct timing {
+		std::uint64_t count = 0;
+		std::uint64_t total = 0;
+		std::uint64_t max = 0;
+	};
+
+	// Complete events may be submitted from worker threads as well
+	std::mutex _timingsMutex;
+	SCP_unordered_map<const Category*, timing> _timings;
+
+ public:
+	void processEvent(const trace_event* event);
+
+	SCP_vector<category_timing> getTimings();
+
+	void reset();
+};
+
+}
@@ -3,8 +3,11 @@
 #include "globalincs/pstypes.h"
 #include "tracing/tracing.h"
 
-#include "utils/boost/syncboundedqueue.h"
+#include "utils/spsc_ring.h"
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
 
 
@@ -14,6 +17,14 @@
 
 namespace tracing {
 
+/**
+ * @brief Gives every event processor an id that is never used again
+ */
+inline std::uint64_t next_event_processor_id() {
+	static std::atomic<std::uint64_t> last_id{0};
+	return ++last_id;
+}
+
 /**
  * @brief A multi-threaded event processor
  *
@@ -26,50 +37,125 @@ namespace tracing {
  *
  * This function will be called in a background-thread whenever a new event arrives.
  *
+ * Every thread that submits events gets a ring buffer of its own, which the background thread drains. Submitting an
+ * event never waits for the background thread, if it falls behind and the buffer of a thread is full the event is
+ * dropped. Events of one thread arrive in the order they were submitted, events of different threads may not.
+ * Events that arrive while the processor is being destroyed are dropped as well.
+ *
  * @tparam Processor Your processor implementation
- * @tparam QUEUE_SIZE The maximum size of the internal event buffer
+ * @tparam RING_SIZE The number of events each thread can have waiting, must be a power of two
  */
-template<class Processor, size_t QUEUE_SIZE = 200>
+template<class Processor, size_t RING_SIZE = 4096>
 class ThreadedEventProcessor {
-	sync_bounded_queue<trace_event> _event_queue;
+	typedef util::spsc_ring<trace_event, RING_SIZE> ring;
 
-	std::thread _worker_thread;
+	static const size_t MAX_THREADS = 64;
+
+	const std::uint64_t _id;
+
+	// Rings are only ever added. The pointer is written before the count is increased, so the background thread can
+	// use every ring below the count without taking the lock.
+	std::mutex _ringsMutex;
+	std::unique_ptr<ring> _rings[MAX_THREADS];
+	std::atomic<size_t> _ringCount{0};
+
+	// Events that didn't fit into their ring, whose thread came after all rings were handed out, or that came in while
+	// stopping
+	std::atomic<std::uint64_t> _dropped{0};
+
+	std::atomic<bool> _stop{false};
 
 	Processor _processor;
 
+	std::thread _worker_thread;
+
+	ring* threadRing() {
+		// Every thread remembers the ring it got from each processor. Processor ids are never reused, so the entries
+		// of processors that are gone never match again.
+		thread_local SCP_vector<std::pair<std::uint64_t, void*>> thread_rings;
+
+		for (const auto& entry : thread_rings) {
+			if (entry.first == _id) {
+				return static_cast<ring*>(entry.second);
+			}
+		}
+
+		ring* new_ring = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(_ringsMutex);
+
+			auto count = _ringCount.load(std::memory_order_relaxed);
+			if (count < MAX_THREADS) {
+				_rings[count].reset(new ring());
+				new_ring = _rings[count].get();
+				_ringCount.store(count + 1, std::memory_order_release);
+			}
+		}
+
+		thread_rings.emplace_back(_id, new_ring);
+		return new_ring;
+	}
+
 	void workerThread() {
-		while (!_event_queue.closed()) {
-			try {
-				trace_event evt;
-				auto status = _event_queue.wait_pull_front(evt);
+		trace_event evt;
 
-				if (status != success) {
-					break;
-				}
+		while (true) {
+			// check this before draining, so that everything submitted before the processor was stopped gets processed
+			auto stopping = _stop.load(std::memory_order_acquire);
+			auto processed = false;
 
-				_processor.processEvent(&evt);
+			auto count = _ringCount.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; ++i) {
+				while (_rings[i]->try_pop(evt)) {
+					_processor.processEvent(&evt);
+					processed = true;
+				}
 			}
-			catch (const sync_queue_is_closed&) {
-				// We are done here
+
+			if (stopping) {
 				break;
 			}
+
+			if (!processed) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
 		}
 	}
  public:
 	template<typename... Params>
 	explicit ThreadedEventProcessor(Params&& ... params)
-		: _event_queue(QUEUE_SIZE), _worker_thread(&ThreadedEventProcessor<Processor>::workerThread, this),
-		  _processor(std::forward<Params>(params)...) {}
+		: _id(next_event_processor_id()), _processor(std::forward<Params>(params)...),
+		  _worker_thread(&ThreadedEventProcessor<Processor, RING_SIZE>::workerThread, this) {}
 	~ThreadedEventProcessor() {
-		_event_queue.close();
+		_stop.store(true, std::memory_order_release);
 		_worker_thread.join();
+
+		// Other threads may have gotten an event in after the final drain of the background thread
+		trace_event evt;
+		auto count = _ringCount.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; ++i) {
+			while (_rings[i]->try_pop(evt)) {
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		auto dropped = _dropped.load(std::memory_order_relaxed);
+		if (dropped > 0) {
+			mprintf(("Tracing: dropped " SIZE_T_ARG " events which the event processor could not take\n", static_cast<size_t>(dropped)));
+		}
 	}
 
 	void processEvent(const trace_event* event) {
-		try {
-			_event_queue.wait_push_back(*event);
-		} catch (const sync_queue_is_closed&) {
-			mprintf(("Stream queue was closed in processEvent! This should not be possible...\n"));
+		// Once stopping the background thread may already be past its final drain
+		if (_stop.load(std::memory_order_acquire)) {
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		auto event_ring = threadRing();
+
+		if (event_ring == nullptr || !event_ring->try_push(*event)) {
+			_dropped.fetch_add(1, std::memory_order_relaxed);
 		}
 	}
 };
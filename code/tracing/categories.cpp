@@ -50,12 +50,14 @@ Category DebrisPostMove("Debris post move", false);
 Category AsteroidPostMove("Asteroid post move", false);
 Category PreMove("Pre Move", false);
 Category Physics("Physics", false);
+Category ParallelPhysics("Parallel Physics", false);
 Category PostMove("Post Move", false);
 Category CollisionDetection("Collision Detection", false);
 
 Category RenderBuffer("Render Buffer", true);
 
 Category QueueRender("Queue Render", false);
+Category QueueDeferredModels("Queue deferred models", false);
 Category BuildModelUniforms("Build Model Uniforms", false);
 Category UploadModelUniforms("Upload Model Uniforms", true);
 Category SubmitDraws("Submit Draws", true);
@@ -128,6 +130,9 @@ Category ReadModelFile("Read model file", false);
 Category ModelCreateVertexBuffers("Create model vertex buffers", false);
 Category ModelParseAllBSPTrees("Parse all BSP trees", false);
 Category ModelParseBSPTree("Parse BSP tree", false);
+Category ModelCacheLoad("Load model cache", false);
+Category ModelCacheSave("Save model cache", false);
+Category ModelLoadBatchWait("Wait for model batch", false);
 Category ModelConfigureVertexBuffers("Model configure vertex buffers", false);
 Category ModelCreateTransparencyIndexBuffer("Model create transparency buffer", false);
 Category ModelCreateDetailIndexBuffers("Model create detail index buffers", false);
@@ -138,6 +143,8 @@ Category LoadSound("Load Sound", false);
 Category LevelPageIn("Level page in", false);
 Category PageInStop("Finish page in", false);
 Category PageInSingleBitmap("Page in single bitmap", false);
+Category PageInDecode("Page in decode bitmap", false);
+Category PageInUpload("Page in upload bitmap", false);
 Category ShipPageIn("Ship page in", false);
 Category WeaponPageIn("Weapon page in", false);
 
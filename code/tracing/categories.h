@@ -63,12 +63,14 @@ extern Category DebrisPostMove;
 extern Category AsteroidPostMove;
 extern Category PreMove;
 extern Category Physics;
+extern Category ParallelPhysics;
 extern Category PostMove;
 extern Category CollisionDetection;
 
 extern Category RenderBuffer;
 
 extern Category QueueRender;
+extern Category QueueDeferredModels;
 extern Category BuildModelUniforms;
 extern Category UploadModelUniforms;
 extern Category SubmitDraws;
@@ -142,6 +144,9 @@ extern Category ReadModelFile;
 extern Category ModelCreateVertexBuffers;
 extern Category ModelParseAllBSPTrees;
 extern Category ModelParseBSPTree;
+extern Category ModelCacheLoad;
+extern Category ModelCacheSave;
+extern Category ModelLoadBatchWait;
 extern Category ModelConfigureVertexBuffers;
 extern Category ModelCreateTransparencyIndexBuffer;
 extern Category ModelCreateDetailIndexBuffers;
@@ -152,6 +157,8 @@ extern Category LoadSound;
 extern Category LevelPageIn;
 extern Category PageInStop;
 extern Category PageInSingleBitmap;
+extern Category PageInDecode;
+extern Category PageInUpload;
 extern Category ShipPageIn;
 extern Category WeaponPageIn;
 
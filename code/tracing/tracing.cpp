@@ -5,9 +5,12 @@
 #include "io/timer.h"
 
 #include "TraceEventWriter.h"
+#include "BinaryTraceWriter.h"
 #include "MainFrameTimer.h"
 #include "FrameProfiler.h"
+#include "CategoryTimer.h"
 
+#include <atomic>
 #include <cinttypes>
 #include <fstream>
 #include <future>
@@ -53,8 +56,10 @@ namespace {
 using namespace tracing;
 
 std::unique_ptr<ThreadedTraceEventWriter> traceEventWriter;
+std::unique_ptr<ThreadedBinaryTraceWriter> binaryTraceWriter;
 std::unique_ptr<ThreadedMainFrameTimer> mainFrameTimer;
 std::unique_ptr<FrameProfiler> frameProfiler;
+std::unique_ptr<CategoryTimer> categoryTimer;
 
 SCP_vector<int> query_objects;
 // The GPU timestamp queries use an internal free list to reduce the number of graphics API calls
@@ -106,7 +111,7 @@ int gpu_start_query = -1;
 std::uint64_t gpu_start_time = 0;
 std::uint64_t cpu_start_time = 0;
 
-std::uint64_t current_id = 0;
+std::atomic<std::uint64_t> current_id{0};
 
 void submit_event(trace_event* evt) {
 	if (evt->pid == GPU_PID) {
@@ -120,6 +125,10 @@ void submit_event(trace_event* evt) {
 		traceEventWriter->processEvent(evt);
 	}
 
+	if (binaryTraceWriter) {
+		binaryTraceWriter->processEvent(evt);
+	}
+
 	if (mainFrameTimer) {
 		mainFrameTimer->processEvent(evt);
 	}
@@ -127,6 +136,10 @@ void submit_event(trace_event* evt) {
 	if (frameProfiler) {
 		frameProfiler->processEvent(evt);
 	}
+
+	if (categoryTimer) {
+		categoryTimer->processEvent(evt);
+	}
 }
 
 void process_gpu_events() {
@@ -221,6 +234,12 @@ void init() {
 		do_async_events = true;
 		do_counter_events = true;
 	}
+	if (Cmdline_binary_profiling) {
+		binaryTraceWriter.reset(new ThreadedBinaryTraceWriter(get_pid()));
+		do_trace_events = true;
+		do_async_events = true;
+		do_counter_events = true;
+	}
 	if (Cmdline_profile_write_file) {
 		mainFrameTimer.reset(new ThreadedMainFrameTimer());
 		do_async_events = true;
@@ -229,6 +248,10 @@ void init() {
 		frameProfiler.reset(new FrameProfiler());
 		do_trace_events = true;
 	}
+	if (Cmdline_sim_benchmark > 0) {
+		categoryTimer.reset(new CategoryTimer());
+		do_trace_events = true;
+	}
 
 	do_gpu_queries = gr_is_capable(gr_capability::CAPABILITY_TIMESTAMP_QUERY);
 
@@ -260,6 +283,18 @@ SCP_string get_frame_profile_output() {
 	return frameProfiler->getContent();
 }
 
+SCP_vector<category_timing> get_category_timings() {
+	Assertion(categoryTimer, "Category timing must be enabled for this function!");
+
+	return categoryTimer->getTimings();
+}
+
+void reset_category_timings() {
+	Assertion(categoryTimer, "Category timing must be enabled for this function!");
+
+	categoryTimer->reset();
+}
+
 void shutdown() {
 	while (!gpu_events.empty()) {
 		process_events();
@@ -275,6 +310,8 @@ void shutdown() {
 
 	mainFrameTimer = nullptr;
 	traceEventWriter = nullptr;
+	binaryTraceWriter = nullptr;
+	categoryTimer = nullptr;
 
 	initialized = false;
 }
@@ -74,6 +74,28 @@ void frame_profile_process_frame();
  */
 SCP_string get_frame_profile_output();
 
+/**
+ * @brief Time spent in one category, in nanoseconds
+ */
+struct category_timing {
+	const char* name;
+	std::uint64_t count;
+	std::uint64_t total_ns;
+	std::uint64_t max_ns;
+};
+
+/**
+ * @brief Gets the time spent in every category since the last reset, most expensive first
+ *
+ * @note Category timing is enabled by -sim_benchmark
+ */
+SCP_vector<category_timing> get_category_timings();
+
+/**
+ * @brief Drops the category timings gathered so far
+ */
+void reset_category_timings();
+
 /**
  * @brief Deinitializes the tracing subsystem
  */
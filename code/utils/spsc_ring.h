@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace util {
+
+/**
+ * @brief A fixed capacity lock-free queue for exactly one producer thread and one consumer thread
+ *
+ * Only the producer may call try_push and only the consumer may call try_pop. Neither call ever blocks, they just
+ * fail if the ring is full or empty.
+ *
+ * @tparam T The element type. Should be cheap to copy, usually a pointer to a larger block of data.
+ * @tparam Capacity The number of slots, must be a power of two
+ */
+template<typename T, size_t Capacity>
+class spsc_ring {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two!");
+	static_assert(std::is_trivially_copyable<T>::value, "spsc_ring only supports trivially copyable types!");
+
+	static constexpr size_t MASK = Capacity - 1;
+
+	// Keep the indices on separate cache lines so producer and consumer do not invalidate each other's line
+	alignas(64) std::atomic<size_t> m_head{0};	// next slot to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_tail{0};	// next slot to push, written by the producer
+	alignas(64) std::array<T, Capacity> m_slots;
+
+  public:
+	spsc_ring() = default;
+
+	spsc_ring(const spsc_ring&) = delete;
+	spsc_ring& operator=(const spsc_ring&) = delete;
+
+	// Producer only. Returns false if the ring is full.
+	bool try_push(const T& value)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) >= Capacity)
+			return false;
+
+		m_slots[tail & MASK] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Returns false if the ring is empty.
+	bool try_pop(T& value_out)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+
+		value_out = m_slots[head & MASK];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Only exact if neither side is running concurrently
+	size_t size() const
+	{
+		const size_t head = m_head.load(std::memory_order_acquire);
+		return m_tail.load(std::memory_order_acquire) - head;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	static constexpr size_t capacity() { return Capacity; }
+};
+
+}
@@ -16,54 +16,275 @@
 #endif
 
 namespace threading {
+	struct Job {
+		std::function<void()> func;
+		JobCounter* counter;
+	};
+
+	// Chase-Lev work stealing deque. Only the owning thread pushes and pops at the bottom, all other threads steal from the top.
+	class WorkStealingDeque {
+		static constexpr int64_t CAPACITY = 4096;
+
+		std::atomic<int64_t> m_top{0};
+		std::atomic<int64_t> m_bottom{0};
+		std::unique_ptr<std::atomic<Job*>[]> m_buffer;
+
+	  public:
+		WorkStealingDeque() : m_buffer(new std::atomic<Job*>[CAPACITY]) {}
+
+		//Returns false if the deque is full
+		bool push(Job* job) {
+			const int64_t b = m_bottom.load(std::memory_order_relaxed);
+			const int64_t t = m_top.load(std::memory_order_acquire);
+			if (b - t >= CAPACITY)
+				return false;
+
+			m_buffer[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		Job* pop() {
+			const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = m_top.load(std::memory_order_relaxed);
+
+			if (t > b) {
+				//Empty
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* job = m_buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+			if (t == b) {
+				//Last element, race against the thieves for it
+				if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					job = nullptr;
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job* steal() {
+			int64_t t = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t b = m_bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+				return nullptr;
+
+			Job* job = m_buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr; //Lost against another thief or the owner, the caller will just look elsewhere
+			return job;
+		}
+	};
+
 	static size_t num_threads = 1;
 
-	static std::condition_variable wait_for_task;
-	static std::mutex wait_for_task_mutex;
-	static bool wait_for_task_condition;
+	static SCP_vector<std::thread> worker_threads;
 
-	static std::condition_variable wait_for_spindown_tasks;
-	static std::mutex wait_for_spindown_task_mutex;
-	static size_t wait_for_spindown_tasks_counter;
+	//One deque per worker, plus one for the thread that called init_task_pool (the main thread) at the end.
+	//Zero queues means there are no workers and jobs run right away.
+	static std::unique_ptr<WorkStealingDeque[]> job_queues;
+	static size_t num_job_queues = 0;
+	static thread_local size_t job_queue_index = std::numeric_limits<size_t>::max();
 
-	static std::condition_variable wait_for_spinup_tasks;
-	static std::mutex wait_for_spinup_task_mutex;
-	static size_t wait_for_spinup_tasks_counter;
+	//Jobs submitted from threads without a deque of their own
+	static std::mutex injected_jobs_mutex;
+	static SCP_deque<Job*> injected_jobs;
 
+	//Number of jobs waiting in any queue, used to decide whether a worker can go to sleep
+	static std::atomic<size_t> num_queued_jobs{0};
+
+	static std::mutex wake_workers_mutex;
+	static std::condition_variable wake_workers;
+	static std::atomic<size_t> num_sleeping_workers{0};
+
+	//State of the pool-wide tasks started with spin_up_threaded_task. Every worker runs the task once.
 	static std::atomic<WorkerThreadTask> worker_task;
+	static std::unique_ptr<std::atomic_bool[]> worker_task_pending;
+	static std::mutex worker_task_mutex;
+	static std::condition_variable worker_task_changed;
+	static size_t worker_task_started = 0;
+	static size_t worker_task_running = 0;
+
+	class JobSystem {
+	  public:
+		static void push(Job* job) {
+			//Count the job first, a thief may take it as soon as it is in the queue
+			num_queued_jobs.fetch_add(1);
+
+			if (job_queue_index < num_job_queues) {
+				if (!job_queues[job_queue_index].push(job)) {
+					//Our queue is full, so we might as well do the work right here
+					num_queued_jobs.fetch_sub(1);
+					run(job);
+					return;
+				}
+			}
+			else {
+				std::scoped_lock lock(injected_jobs_mutex);
+				injected_jobs.push_back(job);
+			}
 
-	static SCP_vector<std::thread> worker_threads;
+			if (num_sleeping_workers.load() > 0) {
+				//Taking the mutex makes sure a worker that just decided to sleep is already waiting
+				std::scoped_lock lock(wake_workers_mutex);
+				wake_workers.notify_one();
+			}
+		}
 
-	//Internal Functions
-	static void mp_worker_thread_main(size_t threadIdx) {
-		while(true) {
-			{
-				std::scoped_lock lock {wait_for_spindown_task_mutex};
-				++wait_for_spindown_tasks_counter;
-				wait_for_spindown_tasks.notify_all();
+		static void schedule(Job* job) {
+			if (num_job_queues == 0)
+				run(job);
+			else
+				push(job);
+		}
+
+		static Job* take() {
+			const size_t num_queues = num_job_queues;
+			Job* job = nullptr;
+
+			if (job_queue_index < num_queues)
+				job = job_queues[job_queue_index].pop();
+
+			if (job == nullptr && num_queued_jobs.load(std::memory_order_relaxed) > 0) {
+				{
+					std::scoped_lock lock(injected_jobs_mutex);
+					if (!injected_jobs.empty()) {
+						job = injected_jobs.front();
+						injected_jobs.pop_front();
+					}
+				}
+
+				//Start looking at the neighbor so that not every thread hammers the same victim
+				const size_t first_victim = job_queue_index < num_queues ? job_queue_index + 1 : 0;
+				for (size_t i = 0; job == nullptr && i < num_queues; ++i) {
+					const size_t victim = (first_victim + i) % num_queues;
+					if (victim != job_queue_index)
+						job = job_queues[victim].steal();
+				}
 			}
-			//We're waiting for a new task, so spindown was successful
-			{
-				std::unique_lock<std::mutex> lk(wait_for_task_mutex);
-				wait_for_task.wait(lk, []() { return wait_for_task_condition; });
+
+			if (job != nullptr)
+				num_queued_jobs.fetch_sub(1);
+
+			return job;
+		}
+
+		static void run(Job* job) {
+			job->func();
+
+			JobCounter* counter = job->counter;
+			delete job;
+
+			if (counter != nullptr)
+				finish(counter);
+		}
+
+		static void finish(JobCounter* counter) {
+			//As long as other jobs are pending, nobody can be done waiting for the counter, so no lock is needed
+			size_t pending = counter->m_pending.load(std::memory_order_relaxed);
+			while (pending > 1) {
+				if (counter->m_pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+					return;
 			}
-			//Notify that we passed the wait and can now start processing. This is necessary, as slow thread wakeups in very low workloads could cause the wait_for_task_condition to be false, never waking up the thread, locking on spindown wait
+
+			//This is probably the last job. The counter may be destroyed once it is done, so finish up under the lock
+			//which wait() takes before returning and don't touch the counter afterwards.
+			SCP_vector<Job*> continuations;
 			{
-				std::scoped_lock lock {wait_for_spinup_task_mutex};
-				++wait_for_spinup_tasks_counter;
-				wait_for_spinup_tasks.notify_all();
+				std::scoped_lock lock(counter->m_continuation_mutex);
+				if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					continuations.swap(counter->m_continuations);
+			}
+			for (Job* continuation : continuations)
+				schedule(continuation);
+		}
+
+		static void wait(JobCounter& counter) {
+			while (!counter.is_done()) {
+				Job* job = take();
+				if (job != nullptr)
+					run(job);
+				else
+					std::this_thread::yield();
+			}
+
+			//Make sure the job that finished the counter is done with it
+			std::scoped_lock lock(counter.m_continuation_mutex);
+		}
+
+		static void submit(std::function<void()> func, JobCounter* counter, JobCounter* dependency) {
+			if (counter != nullptr)
+				counter->m_pending.fetch_add(1, std::memory_order_acq_rel);
+
+			Job* job = new Job{std::move(func), counter};
+
+			if (dependency != nullptr) {
+				std::scoped_lock lock(dependency->m_continuation_mutex);
+				if (!dependency->is_done()) {
+					dependency->m_continuations.push_back(job);
+					return;
+				}
 			}
 
-			switch (worker_task.load(std::memory_order_acquire)) {
-				case WorkerThreadTask::EXIT:
-					//We're done and will quit, so ensure we report this.
+			schedule(job);
+		}
+	};
+
+	//Internal Functions
+	static void run_worker_task(size_t threadIdx) {
+		{
+			std::scoped_lock lock {worker_task_mutex};
+			++worker_task_started;
+			worker_task_changed.notify_all();
+		}
+
+		switch (worker_task.load(std::memory_order_acquire)) {
+			case WorkerThreadTask::EXIT:
+				//Handled by the caller
+				break;
+			case WorkerThreadTask::COLLISION:
+				collide_mp_worker_thread(threadIdx);
+				break;
+			default:
+				UNREACHABLE("Invalid threaded worker task!");
+		}
+
+		{
+			std::scoped_lock lock {worker_task_mutex};
+			--worker_task_running;
+			worker_task_changed.notify_all();
+		}
+	}
+
+	static void mp_worker_thread_main(size_t threadIdx) {
+		job_queue_index = threadIdx;
+
+		while(true) {
+			if (worker_task_pending[threadIdx].exchange(false)) {
+				const bool exit = worker_task.load(std::memory_order_acquire) == WorkerThreadTask::EXIT;
+				run_worker_task(threadIdx);
+				if (exit)
 					return;
-				case WorkerThreadTask::COLLISION:
-					collide_mp_worker_thread(threadIdx);
-					break;
-				default:
-					UNREACHABLE("Invalid threaded worker task!");
+				continue;
 			}
+
+			Job* job = JobSystem::take();
+			if (job != nullptr) {
+				JobSystem::run(job);
+				continue;
+			}
+
+			//Nothing to do, so sleep until a job or a task comes in
+			std::unique_lock<std::mutex> lk(wake_workers_mutex);
+			num_sleeping_workers.fetch_add(1);
+			wake_workers.wait(lk, [threadIdx]() { return num_queued_jobs.load() > 0 || worker_task_pending[threadIdx].load(); });
+			num_sleeping_workers.fetch_sub(1);
 		}
 	}
 
@@ -168,37 +389,29 @@ namespace threading {
 
 	void spin_up_threaded_task(WorkerThreadTask task) {
 		{
-			std::scoped_lock lock {wait_for_spindown_task_mutex};
-			wait_for_spindown_tasks_counter = 0;
-			//No notify here cause we only ever lock, never unlock the wait here.
+			std::scoped_lock lock {worker_task_mutex};
+			worker_task_started = 0;
+			worker_task_running = get_num_workers();
 		}
 		worker_task.store(task);
+		for (size_t i = 0; i < get_num_workers(); i++)
+			worker_task_pending[i].store(true);
 		{
-			std::scoped_lock lock {wait_for_task_mutex};
-			wait_for_task_condition = true;
-			wait_for_task.notify_all();
+			std::scoped_lock lock {wake_workers_mutex};
+			wake_workers.notify_all();
 		}
 	}
 
 	void spin_down_threaded_task() {
 		//Make sure all threads are actually running before stopping the pool again
-		{
-			std::unique_lock<std::mutex> lk(wait_for_spinup_task_mutex);
-			wait_for_spinup_tasks.wait(lk, []() { return wait_for_spinup_tasks_counter >= num_threads; });
-			wait_for_spinup_tasks_counter = 0;
-		}
-		{
-			std::scoped_lock lock {wait_for_task_mutex};
-			wait_for_task_condition = false;
-		}
+		std::unique_lock<std::mutex> lk(worker_task_mutex);
+		worker_task_changed.wait(lk, []() { return worker_task_started >= get_num_workers(); });
 	}
 
 	void spin_down_wait_complete() {
 		//Technically, spindowns should only occur when the actual code is confirmed to be complete. So we shouldn't be waiting for long here
-		{
-			std::unique_lock<std::mutex> lk(wait_for_spindown_task_mutex);
-			wait_for_spindown_tasks.wait(lk, []() { return wait_for_spindown_tasks_counter >= num_threads; });
-		};
+		std::unique_lock<std::mutex> lk(worker_task_mutex);
+		worker_task_changed.wait(lk, []() { return worker_task_running == 0; });
 	}
 
 	void init_task_pool() {
@@ -217,6 +430,14 @@ namespace threading {
 
 		mprintf(("Spinning up threadpool with %d threads...\n", static_cast<int>(num_threads)));
 
+		job_queues = std::make_unique<WorkStealingDeque[]>(num_threads + 1);
+		num_job_queues = num_threads + 1;
+		job_queue_index = num_threads;
+
+		worker_task_pending = std::make_unique<std::atomic_bool[]>(num_threads);
+		for (size_t i = 0; i < num_threads; i++)
+			worker_task_pending[i].store(false);
+
 		for (size_t i = 0; i < num_threads; i++) {
 			worker_threads.emplace_back([i](){ mp_worker_thread_main(i); });
 		}
@@ -230,6 +451,22 @@ namespace threading {
 		for(auto& thread : worker_threads) {
 			thread.join();
 		}
+		worker_threads.clear();
+
+		//Jobs nobody waited for anymore are dropped
+		Job* job;
+		while ((job = JobSystem::take()) != nullptr)
+			delete job;
+		{
+			std::scoped_lock lock(injected_jobs_mutex);
+			for (Job* injected : injected_jobs)
+				delete injected;
+			injected_jobs.clear();
+		}
+		num_job_queues = 0;
+		job_queues.reset();
+		job_queue_index = std::numeric_limits<size_t>::max();
+		num_queued_jobs.store(0);
 	}
 
 	bool is_threading() {
@@ -239,4 +476,34 @@ namespace threading {
 	size_t get_num_workers() {
 		return worker_threads.size();
 	}
+
+	void submit_job(std::function<void()> func, JobCounter* counter, JobCounter* dependency) {
+		JobSystem::submit(std::move(func), counter, dependency);
+	}
+
+	void wait_for(JobCounter& counter) {
+		JobSystem::wait(counter);
+	}
+
+	void parallel_for(size_t count, size_t grain_size, const std::function<void(size_t begin, size_t end)>& func) {
+		if (count == 0)
+			return;
+
+		grain_size = std::max(grain_size, static_cast<size_t>(1));
+
+		if (num_job_queues == 0 || count <= grain_size) {
+			func(0, count);
+			return;
+		}
+
+		JobCounter counter;
+		//Keep the first range for ourselves, no need to go through the queue for it
+		for (size_t begin = grain_size; begin < count; begin += grain_size) {
+			const size_t end = std::min(begin + grain_size, count);
+			submit_job([&func, begin, end]() { func(begin, end); }, &counter);
+		}
+		func(0, grain_size);
+
+		wait_for(counter);
+	}
 }
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "globalincs/vmallocator.h"
+
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 
 namespace threading {
 	enum class WorkerThreadTask : uint8_t { EXIT, COLLISION };
@@ -19,4 +24,61 @@ namespace threading {
 
 	bool is_threading();
 	size_t get_num_workers();
-}
\ No newline at end of file
+
+	struct Job;
+	class JobSystem;
+
+	/**
+	 * @brief Keeps track of a group of submitted jobs
+	 *
+	 * @details Every job submitted with a counter increments it and decrements it again once it has run, so the
+	 * counter is done once all of its jobs have finished. Jobs can also be submitted with a counter as dependency,
+	 * these only start once that counter is done. A counter must outlive all jobs using it.
+	 */
+	class JobCounter {
+		std::atomic<size_t> m_pending{0};
+
+		std::mutex m_continuation_mutex;
+		SCP_vector<Job*> m_continuations;
+
+		friend class JobSystem;
+
+	  public:
+		JobCounter() = default;
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool is_done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	/**
+	 * @brief Queues a function to be run by the job system
+	 *
+	 * @details The job goes into the queue of the calling thread, idle workers steal from there. Without any worker
+	 * threads the job is run right away (or once its dependency is done).
+	 *
+	 * @param func The function to run
+	 * @param counter If not nullptr, this counter is not done until the job has run
+	 * @param dependency If not nullptr, the job is only started once this counter is done
+	 */
+	void submit_job(std::function<void()> func, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	/**
+	 * @brief Blocks until the counter is done
+	 *
+	 * The calling thread runs queued jobs while waiting, so this may be called from inside a job.
+	 */
+	void wait_for(JobCounter& counter);
+
+	/**
+	 * @brief Runs func over [0, count) split into ranges of at most grain_size elements
+	 *
+	 * The ranges are run by the workers and the calling thread. This returns once all of them are done.
+	 *
+	 * @param count Number of elements
+	 * @param grain_size Largest number of elements handed to a single call of func
+	 * @param func Called with the begin and end index of each range
+	 */
+	void parallel_for(size_t count, size_t grain_size, const std::function<void(size_t begin, size_t end)>& func);
+}
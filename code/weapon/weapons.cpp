@@ -8912,6 +8912,8 @@ void weapons_page_in()
 		weapon_release_bitmaps();
 
 	// Page in bitmaps for all used weapons
+	model_load_batch_start();
+
 	for (i = 0; i < weapon_info_size(); i++) {
 		if ( !Cmdline_load_all_weapons ) {
 			if ( !used_weapons[i] ) {
@@ -8924,6 +8926,8 @@ void weapons_page_in()
 
 		weapon_page_in_one(&Weapon_info[i], true);
 	}
+
+	model_load_batch_stop();
 }
 
 /**
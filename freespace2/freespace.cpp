@@ -88,6 +88,7 @@
 #include "lab/labv2.h"
 #include "libs/discord/discord.h"
 #include "libs/ffmpeg/FFmpeg.h"
+#include "lighting/light_clusters.h"
 #include "lighting/lighting.h"
 #include "lighting/lighting_profiles.h"
 #include "localization/localize.h"
@@ -102,6 +103,7 @@
 #include "menuui/snazzyui.h"
 #include "menuui/techmenu.h"
 #include "menuui/trainingmenu.h"
+#include "mission/missionbenchmark.h"
 #include "mission/missionbriefcommon.h"
 #include "mission/missioncampaign.h"
 #include "mission/missiongoals.h"
@@ -160,6 +162,7 @@
 #include "parse/parselo.h"
 #include "parse/sexp.h"
 #include "parse/sexp/sexp_lookup.h"
+#include "parse/sexp/sexp_profiler.h"
 #include "particle/ParticleManager.h"
 #include "particle/particle.h"
 #include "pilotfile/pilotfile.h"
@@ -952,6 +955,10 @@ void game_level_close()
 		mission_campaign_store_variables(SEXP_VARIABLE_SAVE_ON_MISSION_CLOSE, false);	// Goober5000
 		mission_campaign_store_containers(ContainerType::SAVE_ON_MISSION_CLOSE, false);	// jg18
 
+		// write out the SEXP profile while the mission's events are still around
+		sexp_profiler_mission_end();
+		mission_benchmark_mission_end();
+
 		// De-Initialize the game subsystems
 		obj_delete_all();
 		obj_reset_colliders();
@@ -1928,6 +1935,8 @@ void game_init()
 	// This needs to happen after graphics initialization
 	tracing::init();
 
+	mission_benchmark_init();
+
 // Karajorma - Moved here from the sound init code cause otherwise windows complains
 #ifdef FS2_VOICER
 	if(Cmdline_voice_recognition)
@@ -2089,12 +2098,13 @@ void game_init()
 	cheat_table_init();
 
 	lighting_profiles::load_profiles();
+	light_cluster_init();
 
 	// load the list of pilot pic filenames (for barracks and pilot select popup quick reference)
 	pilot_load_pic_list();	
 	pilot_load_squad_pic_list();
 
-	if (!Is_standalone) {
+	if (gr_screen.mode != GR_STUB) {
 		// Load the default cursor and enable it
 		io::mouse::Cursor* cursor = io::mouse::CursorManager::get()->loadCursor("cursor", true);
 		if (cursor) {
@@ -4471,12 +4481,15 @@ void game_set_frametime(int state)
 	if ((Pre_player_entry) && (state == GS_STATE_GAME_PLAY)) {
 		Frametime = F1_0/4;
 		do_pre_player_skip = true;
+	} else if (mission_benchmark_active()) {
+		// the simulation benchmark steps through the mission at a fixed rate, as fast as it can
+		Frametime = mission_benchmark_frametime();
 	}
 
 	Assertion( Framerate_cap > 0, "Framerate cap %d is too low. Needs to be a positive, non-zero number", Framerate_cap );
 
 	// Cap the framerate so it doesn't get too high.
-	if (!Cmdline_NoFPSCap)
+	if (!Cmdline_NoFPSCap && !mission_benchmark_active())
 	{
 		fix cap;
 
@@ -4600,6 +4613,10 @@ void game_do_frame(bool set_frametime)
 	last_single_step = game_single_step;
 
 	game_frame();
+
+	if (mission_benchmark_active() && mission_benchmark_frame_done()) {
+		gameseq_post_event(GS_EVENT_QUIT_GAME);
+	}
 }
 
 void multi_maybe_do_frame()
@@ -4644,6 +4661,11 @@ int game_check_key()
 
 bool pause_if_unfocused()
 {
+	// there is no window to focus during the simulation benchmark
+	if (mission_benchmark_active()) {
+		return false;
+	}
+
 	if (Using_in_game_options) {
 		return UnfocusedPauseOption->getValue();
 	} else {
@@ -5528,7 +5550,7 @@ void game_leave_state( int old_state, int new_state )
 					gr_flip();
 				}
 
-				if (Cmdline_benchmark_mode) {
+				if (Cmdline_benchmark_mode || (mission_benchmark_active() && (new_state != GS_STATE_QUIT_GAME))) {
 					gameseq_post_event( GS_EVENT_QUIT_GAME );
 				}
 			}
@@ -5890,6 +5912,12 @@ void game_enter_state( int old_state, int new_state )
 					break;
 			}
 
+			// the simulation benchmark goes straight into the mission
+			if (mission_benchmark_active()) {
+				gameseq_post_event(GS_EVENT_ENTER_GAME);
+				break;
+			}
+
 			// maybe play a movie before the mission
 			mission_campaign_maybe_play_movie(CAMPAIGN_MOVIE_PRE_MISSION);
 
@@ -6092,6 +6120,10 @@ void game_enter_state( int old_state, int new_state )
 			}
 			player_restore_target_and_weapon_link_prefs();
 
+			if (old_state == GS_STATE_START_GAME) {
+				mission_benchmark_start();
+			}
+
 			Game_mode |= GM_IN_MISSION;
 
 #ifndef NDEBUG
@@ -0,0 +1,112 @@
+
+#include "scripting/global_hooks.h"
+#include "scripting/HookTestUtil.h"
+
+// after the engine headers, its namespace test::scripting would make their scripting namespace ambiguous
+#include "scripting/ScriptingTestFixture.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// This binary replaces the global allocation functions to count the allocations of the hook runs below, which is why
+// these tests don't live in the unittests binary. Lua allocates through realloc and isn't counted, but a run without a
+// matching script never gets to call into Lua.
+
+namespace {
+std::atomic<bool> Count_allocations{false};
+std::atomic<size_t> Num_allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+	if (Count_allocations.load(std::memory_order_relaxed)) {
+		Num_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (size == 0) {
+		size = 1;
+	}
+	if (auto ptr = std::malloc(size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+namespace {
+
+using ::scripting::hooks::KeyPressConditions;
+using test::hooks::add_action;
+using test::hooks::get_global_string;
+using test::hooks::has_hook_variable;
+using test::hooks::key_params;
+
+// Hooks always run on the global script state, so these tests set that one up instead of using their own
+class HookRunTest : public test::scripting::ScriptingTestFixture {
+  public:
+	HookRunTest() : test::scripting::ScriptingTestFixture(INIT_CFILE) {}
+
+	void SetUp() override
+	{
+		test::scripting::ScriptingTestFixture::SetUp();
+
+		Script_system.CreateLuaState();
+		Scripting_game_init_run = true;
+	}
+
+	void TearDown() override
+	{
+		Scripting_game_init_run = false;
+		Script_system.Clear();
+
+		test::scripting::ScriptingTestFixture::TearDown();
+	}
+};
+
+} // namespace
+
+TEST_F(HookRunTest, runWithoutMatchingScriptDoesNotAllocate)
+{
+	const auto& hook = ::scripting::hooks::OnKeyPressed;
+	add_action(Script_system, hook->getHookId(), &KeyPressConditions::keycode, 1, "SeenKey = hv.Key");
+
+	Num_allocations = 0;
+	Count_allocations = true;
+	auto num_run = hook->run(KeyPressConditions{2}, key_params());
+	Count_allocations = false;
+
+	ASSERT_EQ(0, num_run);
+	ASSERT_EQ(0u, Num_allocations.load());
+
+	// and the matching case still sees the variables
+	ASSERT_EQ(1, hook->run(KeyPressConditions{1}, key_params()));
+	ASSERT_EQ("A", get_global_string(Script_system, "SeenKey"));
+	ASSERT_FALSE(has_hook_variable(Script_system, "Key"));
+}
+
+TEST_F(HookRunTest, isOverrideWithoutMatchingScriptDoesNotAllocate)
+{
+	const auto& hook = ::scripting::hooks::OnKeyPressed;
+	add_action(Script_system, hook->getHookId(), &KeyPressConditions::keycode, 1, "", "return hv.Key == 'A'");
+
+	Num_allocations = 0;
+	Count_allocations = true;
+	auto is_override = hook->isOverride(KeyPressConditions{2}, key_params());
+	Count_allocations = false;
+
+	ASSERT_FALSE(is_override);
+	ASSERT_EQ(0u, Num_allocations.load());
+
+	ASSERT_TRUE(hook->isOverride(KeyPressConditions{1}, key_params()));
+	ASSERT_FALSE(has_hook_variable(Script_system, "Key"));
+}
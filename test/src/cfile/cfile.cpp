@@ -1,5 +1,6 @@
 
 #include <cfile/cfilesystem.h>
+#include <cmdline/cmdline.h>
 #include <graphics/font.h>
 #include <gtest/gtest.h>
 
@@ -90,6 +91,54 @@ TEST_F(CFileTest, list_files_in_vps_and_dirs) {
 	ASSERT_STREQ("dir2", table_files[1].c_str());
 }
 
+class CFileMmapTest : public CFileTest {
+ protected:
+	void SetUp() override {
+		_vp_mmap = Cmdline_vp_mmap;
+
+		CFileTest::SetUp();
+	}
+	void TearDown() override {
+		CFileTest::TearDown();
+
+		Cmdline_vp_mmap = _vp_mmap;
+	}
+
+	bool _vp_mmap = false;
+};
+
+TEST_F(CFileMmapTest, vp_mmap_reads_same_data) {
+	Cmdline_vp_mmap = false;
+
+	auto fp = cfopen("test.tbl", "rb", CF_TYPE_TABLES);
+	ASSERT_TRUE(fp != nullptr);
+	ASSERT_EQ(nullptr, cf_get_data_view(fp));
+
+	SCP_string buffered(static_cast<size_t>(cfilelength(fp)), '\0');
+	ASSERT_EQ(1, cfread(&buffered[0], static_cast<int>(buffered.size()), 1, fp));
+	cfclose(fp);
+
+	Cmdline_vp_mmap = true;
+
+	fp = cfopen("test.tbl", "rb", CF_TYPE_TABLES);
+	ASSERT_TRUE(fp != nullptr);
+
+	size_t view_size = 0;
+	auto view = static_cast<const char*>(cf_get_data_view(fp, &view_size));
+	ASSERT_TRUE(view != nullptr);
+	ASSERT_EQ(buffered, SCP_string(view, view_size));
+
+	SCP_string mapped(buffered.size(), '\0');
+	ASSERT_EQ(1, cfread(&mapped[0], static_cast<int>(mapped.size()), 1, fp));
+	ASSERT_EQ(buffered, mapped);
+
+	// The pack file has to stay mapped while the file is open, even if the file list goes away
+	cf_free_secondary_filelist();
+	ASSERT_EQ(buffered, SCP_string(view, view_size));
+
+	cfclose(fp);
+}
+
 TEST_F(CFileTest, access_default_file) {
 	// We use the controlconfig file since that should stay relatively stable
 	ASSERT_TRUE(cf_exists("controlconfigdefaults.tbl", CF_TYPE_TABLES));
@@ -182,6 +231,21 @@ TEST_F(CFileTest, subfolders)
 	ASSERT_TRUE(loc.found);
 }
 
+TEST_F(CFileTest, file_index_ignores_case)
+{
+	// the file name index has to ignore case just like the list search did
+	auto loc = cf_find_file_location("SUB/File2.TBL", CF_TYPE_TABLES);
+	ASSERT_TRUE(loc.found);
+	ASSERT_STREQ("file2.tbl", loc.name_ext.c_str());
+
+	const char *exts[] = { ".tbl", ".cfg" };
+	auto loc_ext = cf_find_file_location_ext("FILE3", 2, exts, CF_TYPE_TABLES);
+	ASSERT_TRUE(loc_ext.found);
+	ASSERT_EQ(0, loc_ext.extension_index);
+
+	ASSERT_FALSE(cf_find_file_location("file4.tbl", CF_TYPE_TABLES).found);
+}
+
 TEST_F(CFileTest, subfolder_list)
 {
 	SCP_vector<SCP_string> table_files;
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "lighting/light_clusters.h"
+#include "lighting/lighting.h"
+#include "render/3d.h"
+
+#include "util/FSTestFixture.h"
+#include "util/test_util.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+class LightClustersTest : public test::FSTestFixture {
+  public:
+	LightClustersTest() : test::FSTestFixture() {
+	}
+
+  protected:
+	LightFilterMode _oldMode = LightFilterMode::CLUSTERED;
+
+	void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		_oldMode = Light_filter_mode;
+
+		Eye_position = vmd_zero_vector;
+		Eye_matrix = vmd_identity_matrix;
+		Eye_fov = 0.75f;
+	}
+	void TearDown() override {
+		Light_filter_mode = _oldMode;
+
+		test::FSTestFixture::TearDown();
+	}
+
+	// Weapon and explosion lights spread over a battle in front of the view, plus a sun and a few beams
+	static void fill_lights(scene_lights& lights, SCP_vector<light>& all, size_t num_lights) {
+		std::mt19937 rng(4321);
+		std::uniform_real_distribution<float> lateral(-6000.0f, 6000.0f);
+		std::uniform_real_distribution<float> depth(-1000.0f, 12000.0f);
+		std::uniform_real_distribution<float> radius(20.0f, 400.0f);
+
+		light sun = {};
+		sun.type = Light_Type::Directional;
+		sun.vec = vmd_z_vector;
+		all.push_back(sun);
+
+		for (size_t i = 0; i < num_lights; ++i) {
+			light l = {};
+			l.type = (i % 50 == 49) ? Light_Type::Tube : Light_Type::Point;
+			l.vec = vec3d{{{lateral(rng), lateral(rng), depth(rng)}}};
+			l.vec2 = vec3d{{{l.vec.xyz.x + 500.0f, l.vec.xyz.y, l.vec.xyz.z + 500.0f}}};
+			l.radb = radius(rng);
+			l.radb_squared = l.radb * l.radb;
+			all.push_back(l);
+		}
+
+		for (auto& l : all) {
+			lights.addLight(&l);
+		}
+	}
+
+	static SCP_vector<std::pair<vec3d, float>> make_objects(size_t num_objects) {
+		std::mt19937 rng(8765);
+		std::uniform_real_distribution<float> lateral(-6000.0f, 6000.0f);
+		std::uniform_real_distribution<float> depth(-1000.0f, 12000.0f);
+		std::uniform_real_distribution<float> radius(10.0f, 300.0f);
+
+		SCP_vector<std::pair<vec3d, float>> objects;
+		for (size_t i = 0; i < num_objects; ++i) {
+			objects.emplace_back(vec3d{{{lateral(rng), lateral(rng), depth(rng)}}}, radius(rng));
+		}
+		return objects;
+	}
+
+	// Filters the lights for every object and returns how many each of them got
+	static SCP_vector<size_t> filter_all(scene_lights& lights, const SCP_vector<std::pair<vec3d, float>>& objects) {
+		SCP_vector<size_t> counts;
+		for (auto& object : objects) {
+			lights.setLightFilter(&object.first, object.second);
+			counts.push_back(lights.bufferLights().num_lights);
+		}
+		return counts;
+	}
+};
+
+TEST_F(LightClustersTest, query_is_conservative) {
+	scene_lights lights;
+	SCP_vector<light> all;
+	fill_lights(lights, all, 1000);
+
+	light_cluster_grid grid;
+	grid.build(all, Eye_position, Eye_matrix, 1.0f, 0.6f);
+
+	SCP_vector<size_t> candidates;
+	for (auto& object : make_objects(2000)) {
+		if (!grid.query(&object.first, object.second, candidates)) {
+			continue;
+		}
+
+		for (size_t i = 0; i < all.size(); ++i) {
+			if (all[i].type != Light_Type::Point) {
+				continue;
+			}
+
+			if (vm_vec_dist(&all[i].vec, &object.first) < all[i].radb + object.second) {
+				ASSERT_TRUE(std::binary_search(candidates.begin(), candidates.end(), i));
+			}
+		}
+	}
+}
+
+TEST_F(LightClustersTest, clustered_matches_linear) {
+	scene_lights lights;
+	SCP_vector<light> all;
+	fill_lights(lights, all, 1000);
+
+	auto objects = make_objects(2000);
+
+	Light_filter_mode = LightFilterMode::LINEAR;
+	auto linear = filter_all(lights, objects);
+
+	Light_filter_mode = LightFilterMode::CLUSTERED;
+	auto clustered = filter_all(lights, objects);
+
+	ASSERT_EQ(linear, clustered);
+}
+
+TEST_F(LightClustersTest, DISABLED_filter_benchmark) {
+	constexpr size_t NUM_OBJECTS = 1000;
+	auto objects = make_objects(NUM_OBJECTS);
+
+	for (size_t num_lights : {64, 256, 1024, 4096}) {
+		double times[2];
+		for (auto mode : {LightFilterMode::LINEAR, LightFilterMode::CLUSTERED}) {
+			Light_filter_mode = mode;
+
+			scene_lights lights;
+			SCP_vector<light> all;
+			fill_lights(lights, all, num_lights);
+
+			// includes building the grid, which happens on the first filter of a frame
+			auto start = std::chrono::steady_clock::now();
+			filter_all(lights, objects);
+			times[mode == LightFilterMode::LINEAR ? 0 : 1] = test::elapsed_ms(start);
+		}
+
+		std::cout << "Filtered " << num_lights << " lights for " << NUM_OBJECTS << " objects: linear took " << times[0]
+		          << " ms, clustered took " << times[1] << " ms" << std::endl;
+	}
+}
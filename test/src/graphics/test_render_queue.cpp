@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include "graphics/2d.h"
+#include "model/modelrender.h"
+
+#include "util/FSTestFixture.h"
+#include "util/test_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+class RenderQueueTest : public test::FSTestFixture {
+  public:
+	RenderQueueTest() : test::FSTestFixture(INIT_CFILE | INIT_GRAPHICS) {
+		pushModDir("graphics");
+	}
+
+  protected:
+	static constexpr size_t NUM_DRAWS = 20000;
+	static constexpr int NUM_VERTEX_SOURCES = 64;
+	static constexpr int NUM_TEXTURES = 400;
+
+	SCP_vector<indexed_vertex_source> _vertexSources;
+	vertex_buffer _buffer;
+
+	void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		_vertexSources.resize(NUM_VERTEX_SOURCES);
+		for (int i = 0; i < NUM_VERTEX_SOURCES; ++i) {
+			_vertexSources[i].Vbuffer_handle = gr_buffer_handle(i);
+			_vertexSources[i].Ibuffer_handle = gr_buffer_handle(i);
+		}
+	}
+	void TearDown() override {
+		test::FSTestFixture::TearDown();
+	}
+
+	// Adds draws which look like a scene of many ships sharing a few models and texture sets
+	void fill_list(model_draw_list& list) {
+		std::mt19937 rng(1234);
+		std::uniform_int_distribution<int> source_dist(0, NUM_VERTEX_SOURCES - 1);
+		std::uniform_int_distribution<int> texture_dist(0, NUM_TEXTURES - 1);
+		std::uniform_int_distribution<int> coin(0, 1);
+
+		model_material material;
+
+		for (size_t i = 0; i < NUM_DRAWS; ++i) {
+			auto texture = texture_dist(rng);
+
+			material.set_texture_map(TM_BASE_TYPE, texture);
+			material.set_texture_map(TM_GLOW_TYPE, coin(rng) ? texture + NUM_TEXTURES : -1);
+			material.set_texture_map(TM_NORMAL_TYPE, coin(rng) ? texture + 2 * NUM_TEXTURES : -1);
+			material.set_lighting(coin(rng) != 0);
+
+			list.add_buffer_draw(&material, &_vertexSources[source_dist(rng)], &_buffer, 0, 0);
+		}
+	}
+};
+
+namespace {
+bool draw_state_less(const queued_buffer_draw* a, const queued_buffer_draw* b)
+{
+	if (a->sdr_flags != b->sdr_flags) {
+		return a->sdr_flags < b->sdr_flags;
+	}
+	if (a->vert_src->Vbuffer_handle != b->vert_src->Vbuffer_handle) {
+		return a->vert_src->Vbuffer_handle.value() < b->vert_src->Vbuffer_handle.value();
+	}
+	for (int type = 0; type < TM_NUM_TYPES; ++type) {
+		if (a->render_material.get_texture_map(type) != b->render_material.get_texture_map(type)) {
+			return a->render_material.get_texture_map(type) < b->render_material.get_texture_map(type);
+		}
+	}
+	return false;
+}
+
+bool entry_key_less(const draw_sort_entry& a, const draw_sort_entry& b)
+{
+	return a.key < b.key;
+}
+}
+
+TEST(DrawSortTest, radix_matches_stable_sort) {
+	std::mt19937 rng(4321);
+	// few distinct values per field, so that many keys are equal and stability matters
+	std::uniform_int_distribution<int> field_dist(0, 7);
+	std::uniform_int_distribution<int> shift_dist(0, 7);
+
+	SCP_vector<draw_sort_entry> entries(5000);
+	for (size_t i = 0; i < entries.size(); ++i) {
+		entries[i].key =
+			draw_sort_key_field(field_dist(rng), 3, 60) | draw_sort_key_field(field_dist(rng), 3, 8 * shift_dist(rng));
+		entries[i].index = static_cast<int>(i);
+	}
+
+	auto expected = entries;
+	std::stable_sort(expected.begin(), expected.end(), entry_key_less);
+
+	SCP_vector<draw_sort_entry> scratch;
+	radix_sort_draws(entries, scratch);
+
+	ASSERT_EQ(expected.size(), entries.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		ASSERT_EQ(expected[i].key, entries[i].key);
+		ASSERT_EQ(expected[i].index, entries[i].index);
+	}
+}
+
+TEST_F(RenderQueueTest, sort_orders_draws_by_key) {
+	model_draw_list list;
+	list.init();
+	fill_list(list);
+
+	ASSERT_EQ(NUM_DRAWS, list.num_draws());
+
+	SCP_vector<const queued_buffer_draw*> before;
+	for (size_t i = 0; i < list.num_draws(); ++i) {
+		before.push_back(&list.get_draw(i));
+	}
+
+	list.sort_draws();
+
+	// Draws which end up with the same key are only grouped as well as the key allows, so the sort can only promise to
+	// order by the key. Draws are stored in the order they were added, so equal keys have to keep increasing addresses.
+	SCP_vector<const queued_buffer_draw*> after;
+	for (size_t i = 0; i < list.num_draws(); ++i) {
+		after.push_back(&list.get_draw(i));
+
+		if (i > 0) {
+			ASSERT_LE(list.get_sort_key(i - 1), list.get_sort_key(i));
+			if (list.get_sort_key(i - 1) == list.get_sort_key(i)) {
+				ASSERT_LT(after[i - 1], after[i]);
+			}
+		}
+	}
+
+	std::sort(before.begin(), before.end());
+	std::sort(after.begin(), after.end());
+	ASSERT_EQ(before, after);
+}
+
+TEST_F(RenderQueueTest, DISABLED_sort_benchmark) {
+	model_draw_list list;
+	list.init();
+
+	auto start = std::chrono::steady_clock::now();
+	fill_list(list);
+	auto fill_time = test::elapsed_ms(start);
+
+	// what sorting used to cost: a comparison sort through the state of each draw
+	SCP_vector<const queued_buffer_draw*> draws;
+	for (size_t i = 0; i < list.num_draws(); ++i) {
+		draws.push_back(&list.get_draw(i));
+	}
+	start = std::chrono::steady_clock::now();
+	std::sort(draws.begin(), draws.end(), draw_state_less);
+	auto comparison_time = test::elapsed_ms(start);
+
+	start = std::chrono::steady_clock::now();
+	list.sort_draws();
+	auto radix_time = test::elapsed_ms(start);
+
+	std::cout << "Queued " << NUM_DRAWS << " draws in " << fill_time << " ms, comparison sort took " << comparison_time
+	          << " ms, key sort took " << radix_time << " ms" << std::endl;
+
+	ASSERT_EQ(NUM_DRAWS, list.num_draws());
+	for (size_t i = 1; i < list.num_draws(); ++i) {
+		ASSERT_LE(list.get_sort_key(i - 1), list.get_sort_key(i));
+	}
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <model/model.h>
+#include <model/modelcache.h>
+
+class ModelCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		pm = make_polymodel();
+
+		// submodel 0 gets a single triangle, submodel 1 has no geometry at all
+		int tree_index = model_create_bsp_collision_tree();
+		pm->submodel[0].collision_tree_index = tree_index;
+
+		auto tree = model_get_bsp_collision_tree(tree_index);
+
+		tree->n_verts = 3;
+		tree->point_list = static_cast<vec3d*>(vm_malloc(sizeof(vec3d) * 3));
+		tree->point_list[0] = vec3d{ {{0.0f, 0.0f, 0.0f}} };
+		tree->point_list[1] = vec3d{ {{1.0f, 0.0f, 0.0f}} };
+		tree->point_list[2] = vec3d{ {{0.0f, 1.0f, 0.0f}} };
+
+		tree->n_nodes = 1;
+		tree->node_list = static_cast<bsp_collision_node*>(vm_malloc(sizeof(bsp_collision_node)));
+		tree->node_list[0] = bsp_collision_node{ vmd_zero_vector, vec3d{ {{1.0f, 1.0f, 0.0f}} }, -1, -1, 0 };
+
+		tree->n_leaves = 1;
+		tree->leaf_list = static_cast<bsp_collision_leaf*>(vm_malloc(sizeof(bsp_collision_leaf)));
+		tree->leaf_list[0] = bsp_collision_leaf{ vec3d{ {{0.0f, 0.0f, 1.0f}} }, 0, 3, 2, -1 };
+
+		tree->vert_list = static_cast<model_tmap_vert*>(vm_malloc(sizeof(model_tmap_vert) * 3));
+		for (ushort i = 0; i < 3; ++i) {
+			tree->vert_list[i].vertnum = i;
+			tree->vert_list[i].normnum = i;
+			tree->vert_list[i].u = static_cast<float>(i);
+			tree->vert_list[i].v = 0.5f;
+		}
+
+		tree->poly_centers.push_back(vec3d{ {{1.0f / 3.0f, 1.0f / 3.0f, 0.0f}} });
+
+		pm->submodel[1].collision_tree_index = model_create_bsp_collision_tree();
+	}
+
+	void TearDown() override {
+		free_polymodel(pm);
+	}
+
+	static polymodel* make_polymodel() {
+		auto model = new polymodel();
+		model->version = 2117;
+		model->n_models = 2;
+		model->submodel = make_shared<bsp_info[]>(2);
+
+		for (int i = 0; i < model->n_models; ++i) {
+			model->submodel[i].bsp_data_size = 8;
+			model->submodel[i].bsp_data = make_shared<ubyte[]>(8);
+			for (int j = 0; j < 8; ++j) {
+				model->submodel[i].bsp_data[j] = static_cast<ubyte>(i * 8 + j);
+			}
+		}
+
+		return model;
+	}
+
+	static void free_polymodel(polymodel* model) {
+		for (int i = 0; i < model->n_models; ++i) {
+			if (model->submodel[i].collision_tree_index >= 0) {
+				model_remove_bsp_collision_tree(model->submodel[i].collision_tree_index);
+			}
+		}
+		delete model;
+	}
+
+	polymodel* pm = nullptr;
+};
+
+TEST_F(ModelCacheTest, roundtrip) {
+	auto key = model_cache_key(pm);
+
+	SCP_vector<ubyte> data;
+	model_cache_serialize_collision_trees(pm, key, data);
+
+	auto loaded = make_polymodel();
+	ASSERT_TRUE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+
+	auto expected = model_get_bsp_collision_tree(pm->submodel[0].collision_tree_index);
+	auto actual = model_get_bsp_collision_tree(loaded->submodel[0].collision_tree_index);
+
+	ASSERT_EQ(actual->n_verts, 3);
+	ASSERT_EQ(actual->n_nodes, 1);
+	ASSERT_EQ(actual->n_leaves, 1);
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_TRUE(vm_vec_same(&actual->point_list[i], &expected->point_list[i]));
+		EXPECT_EQ(actual->vert_list[i].vertnum, expected->vert_list[i].vertnum);
+		EXPECT_EQ(actual->vert_list[i].u, expected->vert_list[i].u);
+	}
+	EXPECT_TRUE(vm_vec_same(&actual->node_list[0].max, &expected->node_list[0].max));
+	EXPECT_EQ(actual->node_list[0].leaf, 0);
+	EXPECT_EQ(actual->leaf_list[0].num_verts, 3);
+	EXPECT_EQ(actual->leaf_list[0].tmap_num, 2);
+	EXPECT_EQ(actual->leaf_list[0].next, -1);
+	ASSERT_EQ(actual->poly_centers.size(), 1u);
+	EXPECT_TRUE(vm_vec_same(&actual->poly_centers[0], &expected->poly_centers[0]));
+
+	auto empty = model_get_bsp_collision_tree(loaded->submodel[1].collision_tree_index);
+	EXPECT_EQ(empty->n_verts, 0);
+	EXPECT_EQ(empty->point_list, nullptr);
+	EXPECT_EQ(empty->node_list, nullptr);
+	EXPECT_EQ(empty->leaf_list, nullptr);
+
+	free_polymodel(loaded);
+}
+
+TEST_F(ModelCacheTest, key_follows_bsp_data) {
+	auto key = model_cache_key(pm);
+
+	auto other = make_polymodel();
+	EXPECT_EQ(model_cache_key(other), key);
+
+	other->submodel[1].bsp_data[3] ^= 0xff;
+	EXPECT_NE(model_cache_key(other), key);
+
+	SCP_vector<ubyte> data;
+	model_cache_serialize_collision_trees(pm, key, data);
+
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(other, model_cache_key(other), data.data(), data.size()));
+	EXPECT_EQ(other->submodel[0].collision_tree_index, -1);
+	EXPECT_EQ(other->submodel[1].collision_tree_index, -1);
+
+	free_polymodel(other);
+}
+
+TEST_F(ModelCacheTest, rejects_damaged_data) {
+	auto key = model_cache_key(pm);
+
+	SCP_vector<ubyte> data;
+	model_cache_serialize_collision_trees(pm, key, data);
+
+	auto loaded = make_polymodel();
+
+	// cut off in the middle of the arrays
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size() / 2));
+
+	// a node pointing past the end of the node list
+	auto tree = model_get_bsp_collision_tree(pm->submodel[0].collision_tree_index);
+	tree->node_list[0].front = 5;
+	model_cache_serialize_collision_trees(pm, key, data);
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+
+	EXPECT_EQ(loaded->submodel[0].collision_tree_index, -1);
+	EXPECT_EQ(loaded->submodel[1].collision_tree_index, -1);
+
+	free_polymodel(loaded);
+}
+
+TEST_F(ModelCacheTest, rejects_cyclic_trees) {
+	auto key = model_cache_key(pm);
+	auto tree = model_get_bsp_collision_tree(pm->submodel[0].collision_tree_index);
+	auto loaded = make_polymodel();
+	SCP_vector<ubyte> data;
+
+	// a node that is its own child
+	tree->node_list[0].front = 0;
+	model_cache_serialize_collision_trees(pm, key, data);
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+	tree->node_list[0].front = -1;
+
+	// a second node leading back to the root
+	tree->n_nodes = 2;
+	tree->node_list = static_cast<bsp_collision_node*>(vm_realloc(tree->node_list, sizeof(bsp_collision_node) * 2));
+	tree->node_list[0].back = 1;
+	tree->node_list[1] = bsp_collision_node{ vmd_zero_vector, vec3d{ {{1.0f, 1.0f, 0.0f}} }, 0, -1, -1 };
+	model_cache_serialize_collision_trees(pm, key, data);
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+
+	// which is fine once it ends there
+	tree->node_list[1].back = -1;
+	model_cache_serialize_collision_trees(pm, key, data);
+	EXPECT_TRUE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+	free_polymodel(loaded);
+	loaded = make_polymodel();
+
+	// a leaf list that never ends
+	tree->leaf_list[0].next = 0;
+	model_cache_serialize_collision_trees(pm, key, data);
+	EXPECT_FALSE(model_cache_deserialize_collision_trees(loaded, key, data.data(), data.size()));
+
+	EXPECT_EQ(loaded->submodel[0].collision_tree_index, -1);
+
+	free_polymodel(loaded);
+}
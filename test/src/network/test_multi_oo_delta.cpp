@@ -0,0 +1,417 @@
+#include <gtest/gtest.h>
+#include <math/vecmat.h>
+#include <network/multi_oo_delta.h>
+#include <network/multiutil.h>
+#include <physics/physics.h>
+
+#include <deque>
+
+namespace {
+
+constexpr float UPDATE_INTERVAL = 0.1f;	// seconds between two updates of the same ship
+constexpr int UPDATE_COUNT = 600;			// one minute of flight
+
+// The physics state of a ship at some point of a flight
+struct flight_sample {
+	vec3d pos;
+	angles ang;
+	physics_info pi;
+};
+
+// A fighter flying circles around a cruiser that slowly moves in a straight line
+flight_sample record_flight(int ship, int update)
+{
+	flight_sample sample;
+	physics_init(&sample.pi);
+	sample.pi.max_vel = vec3d{ {{20.0f, 20.0f, 75.0f}} };
+	sample.pi.afterburner_max_vel = vec3d{ {{20.0f, 20.0f, 120.0f}} };
+	sample.pi.max_rotvel = vec3d{ {{3.0f, 3.0f, 3.0f}} };
+
+	float t = update * UPDATE_INTERVAL;
+	float speed;
+	float turn_rate;
+
+	if (ship == 0) {
+		speed = 60.0f;
+		turn_rate = 0.1f;
+		sample.pos = vec3d{ {{600.0f * sinf(turn_rate * t), 35.0f * sinf(0.3f * t), 600.0f * cosf(turn_rate * t)}} };
+		sample.ang = angles{ 0.05f * sinf(t), turn_rate * t + PI_2, 0.3f };
+	} else {
+		speed = 10.0f;
+		turn_rate = 0.0f;
+		sample.pos = vec3d{ {{-2000.0f, 150.0f, 1000.0f + speed * t}} };
+		sample.ang = angles{ 0.0f, 0.0f, 0.0f };
+	}
+
+	matrix orient;
+	vm_angles_2_matrix(&orient, &sample.ang);
+
+	vm_vec_copy_scale(&sample.pi.vel, &orient.vec.fvec, speed);
+	sample.pi.desired_vel = sample.pi.vel;
+	sample.pi.rotvel = vec3d{ {{0.0f, turn_rate, 0.0f}} };
+	sample.pi.desired_rotvel = sample.pi.rotvel;
+
+	return sample;
+}
+
+// Packs a position section the way multi_oo_pack_data() does
+int pack_section(flight_sample& sample, bool full_physics, ubyte* section)
+{
+	matrix orient;
+	vm_angles_2_matrix(&orient, &sample.ang);
+
+	vec3d local_desired_vel;
+	vm_vec_rotate(&local_desired_vel, &sample.pi.desired_vel, &orient);
+
+	int size = multi_pack_unpack_position(1, section, &sample.pos);
+	size += multi_pack_unpack_orient(1, section + size, &sample.ang);
+	size += multi_pack_unpack_vel(1, section + size, &orient, &sample.pi);
+	size += multi_pack_unpack_rotvel(1, section + size, &sample.pi);
+	size += multi_pack_unpack_desired_vel_and_desired_rotvel(1, full_physics, section + size, &sample.pi, &local_desired_vel);
+
+	return size;
+}
+
+struct replay_result {
+	int absolute_bytes = 0;
+	int sent_bytes = 0;
+	int resyncs = 0;
+	int skipped = 0;	// updates the client got but couldn't use, while waiting for a resync
+};
+
+// A ship in a replay, and whether its updates include the full physics
+struct replayed_ship {
+	int ship;
+	bool full_physics;
+};
+
+// What the client sends back, as in multi_oo_pack_client_data()
+struct client_ack {
+	oo_packet_acks received_packets;
+	SCP_vector<bool> resync;
+};
+
+// Sends the recorded flights of some ships from a server to a client that acknowledges packets two updates late and
+// loses every dropped_every'th packet, checking that the client always ends up with what the server packed. Each frame
+// is sent as one packet, or with split_frames as one packet per ship like multi_oo_process_all() does once a packet is
+// full.
+SCP_vector<replay_result> replay(const SCP_vector<replayed_ship>& ships, bool split_frames, int dropped_every)
+{
+	SCP_vector<replay_result> results(ships.size());
+
+	SCP_vector<oo_position_history> server_history(ships.size());
+	SCP_vector<oo_position_history> client_history(ships.size());
+	SCP_vector<bool> resync_pending(ships.size(), false);
+
+	oo_sent_packets sent_packets;
+	std::deque<client_ack> acks_in_flight;
+	oo_packet_acks received_packets;
+	int packet_number = -1;
+
+	for (int frame = 0; frame < UPDATE_COUNT; ++frame) {
+		for (size_t i = 0; i < ships.size(); ++i) {
+			auto& result = results[i];
+			bool full_physics = ships[i].full_physics;
+
+			if ((i == 0) || split_frames) {
+				packet_number = sent_packets.begin(frame);
+			}
+			sent_packets.add_ship(static_cast<ushort>(i));
+
+			auto sample = record_flight(ships[i].ship, frame);
+
+			ubyte section[OO_POSITION_SECTION_MAX_SIZE];
+			int section_size = pack_section(sample, full_physics, section);
+			EXPECT_EQ(section_size, multi_oo_position_section_size(full_physics));
+
+			// server side, as in multi_oo_pack_data()
+			ubyte delta[OO_POSITION_DELTA_MAX_SIZE];
+			int delta_size = 0;
+			int baseline_age = 0;
+
+			auto baseline = server_history[i].find_newest_confirmed();
+			if (baseline != nullptr) {
+				delta_size = multi_oo_delta_encode(baseline->section, section, full_physics, delta);
+				baseline_age = frame - baseline->frame;
+			}
+
+			bool send_delta = (delta_size > 0) && (delta_size + 1 < section_size);
+			server_history[i].add(frame, full_physics, section, section_size);
+
+			result.absolute_bytes += section_size;
+			result.sent_bytes += send_delta ? delta_size + 1 : section_size;
+
+			// client side, as in multi_oo_process_update() and multi_oo_unpack_data()
+			if ((dropped_every != 0) && (packet_number % dropped_every == dropped_every - 1)) {
+				continue;
+			}
+
+			received_packets.add(packet_number);
+
+			if (send_delta) {
+				auto client_baseline = client_history[i].find(frame - baseline_age);
+				if (client_baseline == nullptr) {
+					// the ship stays where it is until the server hears about this and sends it in full
+					if (resync_pending[i]) {
+						++result.skipped;
+					} else {
+						resync_pending[i] = true;
+						++result.resyncs;
+					}
+				} else {
+					ubyte decoded[OO_POSITION_SECTION_MAX_SIZE];
+					int decoded_size;
+
+					EXPECT_EQ(multi_oo_delta_decode(client_baseline->section, delta, full_physics, decoded, &decoded_size), delta_size);
+					EXPECT_EQ(decoded_size, section_size);
+					EXPECT_EQ(memcmp(decoded, section, section_size), 0) << "frame " << frame;
+
+					client_history[i].add(frame, full_physics, decoded, decoded_size);
+				}
+			} else {
+				client_history[i].add(frame, full_physics, section, section_size);
+				resync_pending[i] = false;
+			}
+		}
+
+		// the server only learns about received packets and resync requests two updates later
+		client_ack ack;
+		ack.received_packets = received_packets;
+		ack.resync = resync_pending;
+		acks_in_flight.push_back(ack);
+
+		if (acks_in_flight.size() > 2) {
+			const auto& arrived = acks_in_flight.front();
+
+			// as in multi_oo_unpack_client_data()
+			sent_packets.acknowledge(arrived.received_packets, [&server_history](ushort net_signature, int acked_frame) {
+				server_history[net_signature].confirm(acked_frame);
+			});
+
+			for (size_t i = 0; i < ships.size(); ++i) {
+				if (arrived.resync[i]) {
+					server_history[i].clear();
+				}
+			}
+			acks_in_flight.pop_front();
+		}
+	}
+
+	return results;
+}
+
+void record_bytes_per_second(const char* name, const replay_result& result)
+{
+	float seconds = UPDATE_COUNT * UPDATE_INTERVAL;
+
+	::testing::Test::RecordProperty(SCP_string(name) + "_absolute_bytes_per_second", static_cast<int>(result.absolute_bytes / seconds));
+	::testing::Test::RecordProperty(SCP_string(name) + "_delta_bytes_per_second", static_cast<int>(result.sent_bytes / seconds));
+}
+
+}
+
+TEST(MultiObjectUpdateDelta, section_size)
+{
+	EXPECT_EQ(multi_oo_position_section_size(true), OO_POSITION_SECTION_MAX_SIZE);
+	EXPECT_EQ(multi_oo_position_section_size(false), OO_POSITION_SECTION_MAX_SIZE - 1);
+}
+
+TEST(MultiObjectUpdateDelta, roundtrip_against_any_baseline)
+{
+	auto first = record_flight(0, 0);
+	auto last = record_flight(0, UPDATE_COUNT - 1);
+
+	for (bool full_physics : { true, false }) {
+		ubyte baseline[OO_POSITION_SECTION_MAX_SIZE];
+		ubyte section[OO_POSITION_SECTION_MAX_SIZE];
+		pack_section(first, full_physics, baseline);
+		int section_size = pack_section(last, full_physics, section);
+
+		// nothing in common with the baseline at all
+		ubyte delta[OO_POSITION_DELTA_MAX_SIZE];
+		int delta_size = multi_oo_delta_encode(baseline, section, full_physics, delta);
+		EXPECT_LE(delta_size, OO_POSITION_DELTA_MAX_SIZE);
+
+		ubyte decoded[OO_POSITION_SECTION_MAX_SIZE];
+		int decoded_size;
+		EXPECT_EQ(multi_oo_delta_decode(baseline, delta, full_physics, decoded, &decoded_size), delta_size);
+		ASSERT_EQ(decoded_size, section_size);
+		EXPECT_EQ(memcmp(decoded, section, section_size), 0);
+
+		// nothing changed at all, one bit per field
+		delta_size = multi_oo_delta_encode(section, section, full_physics, delta);
+		EXPECT_EQ(delta_size, full_physics ? 3 : 2);
+	}
+}
+
+TEST(MultiObjectUpdateDelta, history_drops_ambiguous_frames)
+{
+	oo_position_history history;
+	ubyte section[OO_POSITION_SECTION_MAX_SIZE] = {};
+
+	history.add(10, true, section, 29);
+	history.add(12, true, section, 29);
+
+	history.confirm(9);
+	EXPECT_EQ(history.find_newest_confirmed(), nullptr);
+	history.confirm(10);
+	history.confirm(11);
+	EXPECT_EQ(history.find_newest_confirmed()->frame, 10);
+	history.confirm(12);
+	EXPECT_EQ(history.find_newest_confirmed()->frame, 12);
+
+	// the other side may have gotten either of two sections sent for the same frame
+	history.add(12, true, section, 29);
+	EXPECT_EQ(history.find(12), nullptr);
+	EXPECT_EQ(history.find_newest_confirmed()->frame, 10);
+
+	for (int frame = 20; frame < 20 + OO_POSITION_HISTORY_SIZE; ++frame) {
+		history.add(frame, true, section, 29);
+	}
+	EXPECT_EQ(history.find(10), nullptr);
+	EXPECT_NE(history.find(20), nullptr);
+	EXPECT_EQ(history.find_newest_confirmed(), nullptr);
+}
+
+TEST(MultiObjectUpdateDelta, acks_only_cover_received_packets)
+{
+	oo_packet_acks client;
+	client.add(10);
+	client.add(13);
+	client.add(12);
+
+	EXPECT_TRUE(client.contains(10));
+	EXPECT_FALSE(client.contains(11));
+	EXPECT_TRUE(client.contains(12));
+	EXPECT_TRUE(client.contains(13));
+	EXPECT_FALSE(client.contains(14));
+
+	// acknowledgements may reach the server out of order
+	oo_packet_acks older;
+	older.add(5);
+	oo_packet_acks server;
+	server.merge(client.newest, client.mask);
+	server.merge(older.newest, older.mask);
+
+	EXPECT_TRUE(server.contains(5));
+	EXPECT_FALSE(server.contains(6));
+	EXPECT_TRUE(server.contains(13));
+
+	// packets too far behind the newest one are forgotten rather than guessed
+	server.add(5 + OO_ACKED_PACKETS_TRACKED);
+	EXPECT_FALSE(server.contains(5));
+	EXPECT_TRUE(server.contains(13));
+}
+
+TEST(MultiObjectUpdateDelta, acks_confirm_only_ships_in_received_packets)
+{
+	// one frame split over two packets, the client only gets the second one
+	oo_sent_packets sent;
+	int first = sent.begin(7);
+	sent.add_ship(1);
+	int second = sent.begin(7);
+	sent.add_ship(2);
+	sent.add_ship(3);
+
+	oo_packet_acks acks;
+	acks.add(second);
+
+	SCP_vector<ushort> confirmed;
+	sent.acknowledge(acks, [&confirmed](ushort net_signature, int frame) {
+		EXPECT_EQ(frame, 7);
+		confirmed.push_back(net_signature);
+	});
+	EXPECT_EQ(confirmed, SCP_vector<ushort>({ 2, 3 }));
+
+	// a packet is only acknowledged once, even though later acks still contain it
+	confirmed.clear();
+	acks.add(first);
+	sent.acknowledge(acks, [&confirmed](ushort net_signature, int) { confirmed.push_back(net_signature); });
+	EXPECT_EQ(confirmed, SCP_vector<ushort>({ 1 }));
+}
+
+TEST(MultiObjectUpdateDelta, replay_recorded_flight)
+{
+	auto fighter = replay({ { 0, true } }, false, 0)[0];
+	auto cruiser = replay({ { 1, false } }, false, 0)[0];
+
+	EXPECT_EQ(fighter.resyncs, 0);
+	EXPECT_EQ(cruiser.resyncs, 0);
+	EXPECT_LT(fighter.sent_bytes, fighter.absolute_bytes);
+	EXPECT_LT(cruiser.sent_bytes, cruiser.absolute_bytes / 2);
+
+	record_bytes_per_second("fighter", fighter);
+	record_bytes_per_second("cruiser", cruiser);
+}
+
+TEST(MultiObjectUpdateDelta, replay_with_packet_loss)
+{
+	auto fighter = replay({ { 0, true } }, false, 7)[0];
+	auto cruiser = replay({ { 1, false } }, false, 5)[0];
+
+	// deltas only refer to packets the client acknowledged, so a lost packet never leaves it waiting for a resync
+	EXPECT_EQ(fighter.resyncs, 0);
+	EXPECT_EQ(cruiser.resyncs, 0);
+	EXPECT_EQ(fighter.skipped, 0);
+	EXPECT_EQ(cruiser.skipped, 0);
+	EXPECT_LT(fighter.sent_bytes, fighter.absolute_bytes);
+	EXPECT_LT(cruiser.sent_bytes, cruiser.absolute_bytes);
+
+	record_bytes_per_second("fighter_lossy", fighter);
+	record_bytes_per_second("cruiser_lossy", cruiser);
+}
+
+TEST(MultiObjectUpdateDelta, replay_split_frames_with_packet_loss)
+{
+	// every frame goes out as two packets, of which every fifth one is lost, so the client keeps getting frames with
+	// the update of only one of the ships. The other one must not be encoded against that frame.
+	auto results = replay({ { 0, true }, { 1, false } }, true, 5);
+
+	for (const auto& result : results) {
+		EXPECT_EQ(result.resyncs, 0);
+		EXPECT_EQ(result.skipped, 0);
+		EXPECT_LT(result.sent_bytes, result.absolute_bytes);
+	}
+
+	// and in one packet per frame, losing it loses both updates
+	results = replay({ { 0, true }, { 1, false } }, false, 5);
+
+	for (const auto& result : results) {
+		EXPECT_EQ(result.resyncs, 0);
+		EXPECT_EQ(result.skipped, 0);
+	}
+}
+
+TEST(MultiObjectUpdateDelta, lz4_roundtrip)
+{
+	// a packet worth of ship updates that repeat a lot, like a fleet of ships sitting still
+	SCP_vector<ubyte> packet;
+	for (int ship = 0; ship < 16; ++ship) {
+		auto sample = record_flight(1, 0);
+		ubyte section[OO_POSITION_SECTION_MAX_SIZE];
+		int size = pack_section(sample, false, section);
+
+		packet.push_back(0xff);
+		packet.insert(packet.end(), section, section + size);
+	}
+	packet.push_back(0x00);
+
+	ubyte compressed[1024];
+	int compressed_size = multi_oo_compress(packet.data(), static_cast<int>(packet.size()), compressed, sizeof(compressed));
+	ASSERT_GT(compressed_size, 0);
+	EXPECT_LT(compressed_size, static_cast<int>(packet.size()));
+
+	ubyte decompressed[1024];
+	ASSERT_EQ(multi_oo_decompress(compressed, compressed_size, decompressed, sizeof(decompressed)), static_cast<int>(packet.size()));
+	EXPECT_EQ(memcmp(decompressed, packet.data(), packet.size()), 0);
+
+	// data that doesn't get smaller is sent as it is
+	ubyte noise[64];
+	for (int i = 0; i < 64; ++i) {
+		noise[i] = static_cast<ubyte>((i * 151) ^ (i * i * 17));
+	}
+	EXPECT_EQ(multi_oo_compress(noise, sizeof(noise), compressed, sizeof(compressed)), 0);
+
+	// and damaged data is rejected
+	EXPECT_EQ(multi_oo_decompress(noise, sizeof(noise), decompressed, sizeof(decompressed)), -1);
+}
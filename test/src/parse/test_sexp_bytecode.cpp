@@ -0,0 +1,188 @@
+
+#include <gtest/gtest.h>
+
+#include <mission/missiongoals.h>
+#include <parse/parselo.h>
+#include <parse/sexp.h>
+#include <parse/sexp/sexp_bytecode.h>
+
+#include "util/FSTestFixture.h"
+
+namespace {
+
+// How often every formula is evaluated, known values and NaNs of one round change what the next one does
+constexpr int NUM_ROUNDS = 3;
+
+int parse_formula(const char* text)
+{
+	SCP_string buf(text);
+	auto old_Mp = Mp;
+
+	Mp = &buf[0];
+	int formula = get_sexp_main();
+	Mp = old_Mp;
+
+	return formula;
+}
+
+// Walks both copies of a formula together and compares the value of every node
+void expect_same_values(int tree_node, int program_node, const char* text)
+{
+	if (tree_node < 0 || program_node < 0) {
+		EXPECT_EQ(tree_node < 0, program_node < 0) << text;
+		return;
+	}
+
+	EXPECT_EQ(Sexp_nodes[tree_node].value, Sexp_nodes[program_node].value)
+		<< text << ": node '" << Sexp_nodes[tree_node].text << "' differs";
+
+	expect_same_values(Sexp_nodes[tree_node].first, Sexp_nodes[program_node].first, text);
+	expect_same_values(Sexp_nodes[tree_node].rest, Sexp_nodes[program_node].rest, text);
+}
+
+class SexpBytecodeTest : public test::FSTestFixture {
+  public:
+	SexpBytecodeTest() : test::FSTestFixture(INIT_CFILE) {}
+
+  protected:
+	void SetUp() override
+	{
+		test::FSTestFixture::SetUp();
+
+		init_sexp();
+		Mission_events.clear();
+		Sexp_bytecode_enabled = true;
+	}
+
+	void TearDown() override
+	{
+		Sexp_bytecode_enabled = false;
+		sexp_bytecode_clear();
+		Mission_events.clear();
+		sexp_shutdown();
+
+		test::FSTestFixture::TearDown();
+	}
+
+	// Parses a formula twice, once for the tree evaluator and once as an event for the compiled program
+	void addFormula(const char* text)
+	{
+		_texts.push_back(text);
+		_tree_formulas.push_back(parse_formula(text));
+		ASSERT_GE(_tree_formulas.back(), 0) << text;
+
+		mission_event event;
+		event.name = text;
+		event.formula = parse_formula(text);
+		ASSERT_GE(event.formula, 0) << text;
+		Mission_events.push_back(event);
+	}
+
+	// Sets the value a node was left with by an earlier evaluation in both copies of a formula
+	void presetValue(size_t formula, int (*find_node)(int formula), int value)
+	{
+		Sexp_nodes[find_node(_tree_formulas[formula])].value = value;
+		Sexp_nodes[find_node(Mission_events[formula].formula)].value = value;
+	}
+
+	void expectSameResults()
+	{
+		sexp_bytecode_compile_events();
+
+		for (int round = 0; round < NUM_ROUNDS; ++round) {
+			for (size_t i = 0; i < _texts.size(); ++i) {
+				int tree_result = eval_sexp(_tree_formulas[i]);
+				int program_result = sexp_bytecode_eval_event(static_cast<int>(i));
+
+				EXPECT_EQ(tree_result, program_result) << _texts[i] << " in round " << round;
+				expect_same_values(_tree_formulas[i], Mission_events[i].formula, _texts[i]);
+			}
+		}
+	}
+
+	SCP_vector<const char*> _texts;
+	SCP_vector<int> _tree_formulas;
+};
+
+// the operator of the first argument
+int first_argument(int formula)
+{
+	return CAR(CDR(formula));
+}
+
+// the operator of the second argument
+int second_argument(int formula)
+{
+	return CAR(CDR(CDR(formula)));
+}
+
+}
+
+TEST_F(SexpBytecodeTest, logical_operators_short_circuit)
+{
+	addFormula("( and ( false ) ( < 1 2 ) )");
+	addFormula("( and ( < 1 2 ) ( false ) ( > 1 2 ) )");
+	addFormula("( and ( < 1 2 ) ( not ( > 1 2 ) ) ( or ( false ) ( >= 3 3 ) ) )");
+	addFormula("( or ( true ) ( = 1 2 ) )");
+	addFormula("( or ( > 1 2 ) ( true ) ( = 1 2 ) )");
+	addFormula("( or ( > 1 2 ) ( = 1 2 ) )");
+	addFormula("( not ( and ( < 1 2 ) ( <= 2 2 ) ) )");
+
+	expectSameResults();
+}
+
+TEST_F(SexpBytecodeTest, known_values_are_trapped)
+{
+	addFormula("( and ( true ) ( true ) )");
+	addFormula("( and ( true ) ( < 1 2 ) )");
+	addFormula("( or ( false ) ( false ) )");
+	addFormula("( or ( false ) ( < 2 1 ) )");
+	addFormula("( not ( true ) )");
+	addFormula("( not ( false ) )");
+	addFormula("( and ( or ( true ) ( < 2 1 ) ) ( not ( false ) ) )");
+	addFormula("( when ( false ) ( do-nothing ) )");
+
+	expectSameResults();
+}
+
+TEST_F(SexpBytecodeTest, number_comparisons)
+{
+	addFormula("( < 1 2 3 )");
+	addFormula("( < 1 3 2 )");
+	addFormula("( = 2 2 2 )");
+	addFormula("( = 2 2 3 )");
+	addFormula("( != 1 2 )");
+	addFormula("( >= 5 5 4 )");
+	addFormula("( <= 5 5 4 )");
+	addFormula("( > ( + 2 3 ) 4 )");
+
+	expectSameResults();
+}
+
+TEST_F(SexpBytecodeTest, nan_comparisons)
+{
+	addFormula("( < ( + 1 2 ) 5 )");
+	addFormula("( = 3 ( + 1 2 ) )");
+	addFormula("( > ( + 1 2 ) 1 )");
+	addFormula("( not ( < ( + 1 2 ) 5 ) )");
+
+	// as if an earlier evaluation of the argument had no number to give
+	presetValue(0, first_argument, SEXP_NAN);
+	presetValue(1, second_argument, SEXP_NAN);
+	presetValue(2, first_argument, SEXP_NAN_FOREVER);
+	presetValue(3, [](int formula) { return first_argument(first_argument(formula)); }, SEXP_NAN);
+
+	expectSameResults();
+}
+
+TEST_F(SexpBytecodeTest, when_and_when_argument)
+{
+	addFormula("( when ( < 1 2 ) ( do-nothing ) )");
+	addFormula("( when ( > 1 2 ) ( do-nothing ) )");
+	addFormula("( when ( true ) ( do-nothing ) ( do-nothing ) )");
+	addFormula("( when-argument ( any-of \"a\" \"b\" ) ( true ) ( do-nothing ) )");
+	addFormula("( and ( when-argument ( any-of \"a\" \"b\" ) ( < 1 2 ) ( do-nothing ) ) ( < 1 2 ) )");
+	addFormula("( or ( when ( > 1 2 ) ( do-nothing ) ) ( when-argument ( any-of \"a\" ) ( false ) ( do-nothing ) ) )");
+
+	expectSameResults();
+}
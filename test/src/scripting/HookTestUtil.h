@@ -0,0 +1,73 @@
+#pragma once
+
+// Include the engine headers of the hook under test first, the namespace test::scripting of the fixture would make
+// their scripting namespace ambiguous otherwise
+#include "scripting/hook_api.h"
+#include "scripting/lua/LuaHeaders.h"
+#include "scripting/scripting.h"
+
+namespace test {
+namespace hooks {
+
+// Compares one field of the conditions a hook runs with against an expected value
+template <typename conditions_t>
+class TestCondition : public ::scripting::EvaluatableCondition {
+	int _expected;
+	int conditions_t::*_field;
+
+  public:
+	TestCondition(int conditions_t::*field, int expected) : _expected(expected), _field(field) {}
+
+	bool evaluate(const ::scripting::HookConditionContext& conditionContext) const override
+	{
+		return conditionContext.get<conditions_t>().*_field == _expected;
+	}
+};
+
+// Adds a script to the hook which only runs when field of the conditions has the expected value
+template <typename conditions_t>
+void add_action(script_state& state, int hook_id, int conditions_t::*field, int expected, const char* code,
+	const char* override_code = nullptr)
+{
+	script_action action;
+	action.local_conditions.push_back(std::make_unique<TestCondition<conditions_t>>(field, expected));
+	action.hook.hook_function.language = SC_LUA;
+	action.hook.hook_function.function =
+		luacpp::LuaFunction::createFromCode(state.GetLuaSession(), code, "hook test");
+	if (override_code != nullptr) {
+		action.hook.override_function.language = SC_LUA;
+		action.hook.override_function.function =
+			luacpp::LuaFunction::createFromCode(state.GetLuaSession(), override_code, "hook test override");
+	}
+
+	state.AddConditionedHook(hook_id, std::move(action));
+	state.ProcessAddedHooks();
+}
+
+inline SCP_string get_global_string(script_state& state, const char* name)
+{
+	auto L = state.GetLuaSession();
+
+	lua_getglobal(L, name);
+	SCP_string value = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
+	lua_pop(L, 1);
+
+	return value;
+}
+
+inline bool has_hook_variable(script_state& state, const char* name)
+{
+	const auto& hookVars = state.GetHookVariableReferences();
+	const auto id = script_state::FindHookVariableId(name);
+
+	return id >= 0 && static_cast<size_t>(id) < hookVars.size() && !hookVars[id].empty();
+}
+
+// The parameters of the OnKeyPressed hook
+inline auto key_params()
+{
+	return ::scripting::hook_param_list(::scripting::hook_param("Key", 's', "A"), ::scripting::hook_param("RawKey", 's', "B"));
+}
+
+}
+}
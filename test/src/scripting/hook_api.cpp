@@ -0,0 +1,135 @@
+
+#include "scripting/global_hooks.h"
+#include "scripting/HookTestUtil.h"
+
+// after the engine headers, its namespace test::scripting would make their scripting namespace ambiguous
+#include "scripting/ScriptingTestFixture.h"
+
+namespace {
+
+using ::scripting::hook_param;
+using ::scripting::hook_param_list;
+using ::scripting::HookConditionContext;
+using test::hooks::add_action;
+using test::hooks::get_global_string;
+using test::hooks::has_hook_variable;
+
+// Far away from the ids of the real hooks
+const int TEST_HOOK_ID = 100000;
+
+struct TestConditions {
+	int value;
+};
+
+class CountingFrame : public ::scripting::HookVariableFrame {
+	::scripting::HookVariableFrame& _frame;
+
+  public:
+	int numSet = 0;
+	int numRemoved = 0;
+
+	explicit CountingFrame(::scripting::HookVariableFrame& frame) : _frame(frame) {}
+
+	void set(script_state& state) override
+	{
+		++numSet;
+		_frame.set(state);
+	}
+
+	void remove(script_state& state) override
+	{
+		++numRemoved;
+		_frame.remove(state);
+	}
+};
+
+template <typename... Args>
+::scripting::detail::HookParameterFrame<Args...> make_frame(
+	::scripting::detail::HookParameterInstanceList<Args...>& args)
+{
+	return {*::scripting::hooks::OnKeyPressed, args};
+}
+
+class HookApiTest : public test::scripting::ScriptingTestFixture {
+  public:
+	HookApiTest() : test::scripting::ScriptingTestFixture(INIT_CFILE) {}
+
+	void addAction(int expected, const char* code, const char* override_code = nullptr)
+	{
+		add_action(*_state, TEST_HOOK_ID, &TestConditions::value, expected, code, override_code);
+	}
+};
+
+} // namespace
+
+TEST_F(HookApiTest, variableIdsAreInterned)
+{
+	const auto id = script_state::GetHookVariableId("HookApiTestVariable");
+
+	ASSERT_EQ(id, script_state::GetHookVariableId("HookApiTestVariable"));
+	ASSERT_EQ(id, script_state::FindHookVariableId("HookApiTestVariable"));
+	ASSERT_EQ("HookApiTestVariable", script_state::GetHookVariableName(id));
+	ASSERT_EQ(-1, script_state::FindHookVariableId("HookApiTestNeverUsed"));
+
+	// The parameters of hooks are interned when the hook is created
+	ASSERT_GE(script_state::FindHookVariableId("RawKey"), 0);
+}
+
+TEST_F(HookApiTest, variablesOnlySetForMatchingScripts)
+{
+	addAction(1, "SeenKey = hv.Key");
+
+	auto args = hook_param_list(hook_param("Key", 's', "A"), hook_param("RawKey", 's', "B", false));
+	auto parameters = make_frame(args);
+	CountingFrame frame(parameters);
+
+	ASSERT_EQ(0, _state->RunCondition(TEST_HOOK_ID, HookConditionContext(TestConditions{2}), &frame));
+	ASSERT_EQ(0, frame.numSet);
+	ASSERT_EQ(0, frame.numRemoved);
+	ASSERT_EQ("", get_global_string(*_state, "SeenKey"));
+
+	ASSERT_EQ(1, _state->RunCondition(TEST_HOOK_ID, HookConditionContext(TestConditions{1}), &frame));
+	ASSERT_EQ(1, frame.numSet);
+	ASSERT_EQ(1, frame.numRemoved);
+	ASSERT_EQ("A", get_global_string(*_state, "SeenKey"));
+
+	ASSERT_FALSE(has_hook_variable(*_state, "Key"));
+	ASSERT_FALSE(has_hook_variable(*_state, "RawKey"));
+}
+
+TEST_F(HookApiTest, variablesSetOnceForSeveralScripts)
+{
+	addAction(1, "FirstKey = hv.Key");
+	addAction(1, "SecondKey = hv.Key");
+
+	auto args = hook_param_list(hook_param("Key", 's', "K"));
+	auto parameters = make_frame(args);
+	CountingFrame frame(parameters);
+
+	ASSERT_EQ(2, _state->RunCondition(TEST_HOOK_ID, HookConditionContext(TestConditions{1}), &frame));
+	ASSERT_EQ(1, frame.numSet);
+	ASSERT_EQ(1, frame.numRemoved);
+	ASSERT_EQ("K", get_global_string(*_state, "FirstKey"));
+	ASSERT_EQ("K", get_global_string(*_state, "SecondKey"));
+
+	ASSERT_FALSE(has_hook_variable(*_state, "Key"));
+}
+
+TEST_F(HookApiTest, overrideOnlySetsVariablesForMatchingScripts)
+{
+	addAction(1, "", "return hv.Key == 'O'");
+
+	auto args = hook_param_list(hook_param("Key", 's', "O"));
+	auto parameters = make_frame(args);
+	CountingFrame frame(parameters);
+
+	ASSERT_FALSE(_state->IsConditionOverride(TEST_HOOK_ID, HookConditionContext(TestConditions{2}), &frame));
+	ASSERT_EQ(0, frame.numSet);
+	ASSERT_EQ(0, frame.numRemoved);
+
+	ASSERT_TRUE(_state->IsConditionOverride(TEST_HOOK_ID, HookConditionContext(TestConditions{1}), &frame));
+	ASSERT_EQ(1, frame.numSet);
+	ASSERT_EQ(1, frame.numRemoved);
+
+	ASSERT_FALSE(has_hook_variable(*_state, "Key"));
+}
@@ -25,6 +25,8 @@ add_file_folder("Globalincs"
 
 add_file_folder("Graphics"
 	   graphics/test_font.cpp
+	   graphics/test_light_clusters.cpp
+	   graphics/test_render_queue.cpp
 )
 
 add_file_folder("Math"
@@ -40,12 +42,18 @@ add_file_folder("mod"
 )
 
 add_file_folder("model"
+    model/test_modelcache.cpp
     model/test_modelread.cpp
 )
 
+add_file_folder("Network"
+    network/test_multi_oo_delta.cpp
+)
+
 add_file_folder("Parse"
     parse/test_parselo.cpp
     parse/test_replace.cpp
+    parse/test_sexp_bytecode.cpp
 )
 
 add_file_folder("Pilotfile"
@@ -55,6 +63,8 @@ add_file_folder("Pilotfile"
 add_file_folder("Scripting"
     scripting/ade_args.cpp
     scripting/doc_parser.cpp
+    scripting/hook_api.cpp
+    scripting/HookTestUtil.h
     scripting/require.cpp
     scripting/script_state.cpp
     scripting/ScriptingTestFixture.h
@@ -87,8 +97,14 @@ add_file_folder("Test Util"
     util/test_util.h
 )
 
+add_file_folder("Tracing"
+    tracing/test_binary_trace.cpp
+)
+
 add_file_folder("Utils"
     utils/HeapAllocatorTest.cpp
+    utils/JobSystemTest.cpp
+    utils/SpscRingTest.cpp
 )
 
 add_file_folder("Weapon"
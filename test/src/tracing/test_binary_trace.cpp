@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "tracing/BinaryTraceFormat.h"
+
+#include <sstream>
+
+using namespace tracing::binary;
+
+namespace {
+std::vector<std::uint8_t> make_trace() {
+	std::vector<std::uint8_t> data;
+	Encoder encoder(data);
+
+	encoder.writeHeader(1234);
+	encoder.writeString(1, "Render \"frame\"");
+	encoder.writeString(2, "Frame rate");
+
+	event_record evt;
+	evt.kind = EventKind::Complete;
+	evt.name = 1;
+	evt.tid = 7;
+	evt.timestamp = 5000000;
+	evt.duration = 16000;
+	encoder.writeEvent(evt);
+
+	// older than the previous one, as events of another thread can be
+	evt = event_record();
+	evt.kind = EventKind::Counter;
+	evt.flags = EVENT_FLAG_GPU;
+	evt.name = 2;
+	evt.scope = 2;
+	evt.tid = -1;
+	evt.timestamp = 4000000;
+	evt.value = 60.5f;
+	encoder.writeEvent(evt);
+
+	return data;
+}
+}
+
+TEST(BinaryTraceTest, roundtrip) {
+	auto data = make_trace();
+	Decoder decoder(data.data(), data.size());
+
+	std::int64_t pid = 0;
+	ASSERT_TRUE(decoder.readHeader(pid));
+	ASSERT_EQ(1234, pid);
+
+	RecordType type;
+	std::uint32_t string_id;
+	std::string text;
+	event_record evt;
+
+	ASSERT_TRUE(decoder.next(type, string_id, text, evt));
+	ASSERT_EQ(RecordType::String, type);
+	ASSERT_EQ(1u, string_id);
+	ASSERT_EQ("Render \"frame\"", text);
+
+	ASSERT_TRUE(decoder.next(type, string_id, text, evt));
+	ASSERT_EQ(RecordType::String, type);
+	ASSERT_EQ(2u, string_id);
+	ASSERT_EQ("Frame rate", text);
+
+	ASSERT_TRUE(decoder.next(type, string_id, text, evt));
+	ASSERT_EQ(RecordType::Event, type);
+	ASSERT_EQ(EventKind::Complete, evt.kind);
+	ASSERT_EQ(1u, evt.name);
+	ASSERT_EQ(0u, evt.scope);
+	ASSERT_EQ(7, evt.tid);
+	ASSERT_EQ(5000000u, evt.timestamp);
+	ASSERT_EQ(16000u, evt.duration);
+
+	ASSERT_TRUE(decoder.next(type, string_id, text, evt));
+	ASSERT_EQ(RecordType::Event, type);
+	ASSERT_EQ(EventKind::Counter, evt.kind);
+	ASSERT_EQ(EVENT_FLAG_GPU, evt.flags);
+	ASSERT_EQ(2u, evt.scope);
+	ASSERT_EQ(-1, evt.tid);
+	ASSERT_EQ(4000000u, evt.timestamp);
+	ASSERT_FLOAT_EQ(60.5f, evt.value);
+
+	ASSERT_FALSE(decoder.next(type, string_id, text, evt));
+	ASSERT_FALSE(decoder.damaged());
+}
+
+TEST(BinaryTraceTest, convertToJson) {
+	auto data = make_trace();
+	std::ostringstream out;
+
+	ASSERT_TRUE(convert_to_json(data.data(), data.size(), out));
+
+	auto json = out.str();
+	ASSERT_NE(std::string::npos, json.find("\"name\":\"Render \\\"frame\\\"\",\"ph\":\"X\",\"dur\":16.000"));
+	ASSERT_NE(std::string::npos, json.find("\"tid\": 7,\"ts\":5000.000,\"pid\":1234"));
+	ASSERT_NE(std::string::npos, json.find("\"pid\":\"GPU\",\"cat\":\"Frame rate\""));
+	ASSERT_NE(std::string::npos, json.find("\"ph\":\"C\""));
+}
+
+TEST(BinaryTraceTest, truncatedTrace) {
+	auto data = make_trace();
+	data.pop_back();
+
+	std::ostringstream out;
+	ASSERT_FALSE(convert_to_json(data.data(), data.size(), out));
+
+	// the events before the damage are still there
+	ASSERT_NE(std::string::npos, out.str().find("\"ph\":\"X\""));
+}
+
+TEST(BinaryTraceTest, wrongMagic) {
+	auto data = make_trace();
+	data[0] = 'X';
+
+	Decoder decoder(data.data(), data.size());
+	std::int64_t pid;
+	ASSERT_FALSE(decoder.readHeader(pid));
+	ASSERT_TRUE(decoder.damaged());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "cmdline/cmdline.h"
+#include "utils/threading.h"
+
+namespace {
+class JobSystemTest : public ::testing::Test {
+  protected:
+	int _oldMultithreading = 0;
+
+	void SetUp() override {
+		_oldMultithreading = Cmdline_multithreading;
+		Cmdline_multithreading = 4;
+		threading::init_task_pool();
+	}
+
+	void TearDown() override {
+		threading::shut_down_task_pool();
+		Cmdline_multithreading = _oldMultithreading;
+	}
+};
+}
+
+TEST_F(JobSystemTest, parallelForCoversRange) {
+	SCP_vector<int> values(10000, 0);
+
+	threading::parallel_for(values.size(), 37, [&values](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			values[i] += 1;
+		}
+	});
+
+	for (auto value : values) {
+		ASSERT_EQ(1, value);
+	}
+}
+
+TEST_F(JobSystemTest, counterWaitsForAllJobs) {
+	std::atomic<int> done{0};
+	threading::JobCounter counter;
+
+	for (int i = 0; i < 500; ++i) {
+		threading::submit_job([&done]() { done.fetch_add(1); }, &counter);
+	}
+	threading::wait_for(counter);
+
+	ASSERT_TRUE(counter.is_done());
+	ASSERT_EQ(500, done.load());
+}
+
+TEST_F(JobSystemTest, dependenciesRunAfterwards) {
+	std::atomic<int> first_stage{0};
+	std::atomic<int> out_of_order{0};
+	threading::JobCounter first, second;
+
+	for (int i = 0; i < 100; ++i) {
+		threading::submit_job([&first_stage]() { first_stage.fetch_add(1); }, &first);
+	}
+	for (int i = 0; i < 100; ++i) {
+		threading::submit_job([&first_stage, &out_of_order]() {
+			if (first_stage.load() != 100) {
+				out_of_order.fetch_add(1);
+			}
+		}, &second, &first);
+	}
+	threading::wait_for(second);
+
+	ASSERT_EQ(0, out_of_order.load());
+}
+
+TEST_F(JobSystemTest, nestedParallelFor) {
+	std::atomic<size_t> sum{0};
+
+	threading::parallel_for(16, 1, [&sum](size_t, size_t) {
+		threading::parallel_for(100, 10, [&sum](size_t begin, size_t end) { sum.fetch_add(end - begin); });
+	});
+
+	ASSERT_EQ((size_t)1600, sum.load());
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "utils/spsc_ring.h"
+
+#include <thread>
+
+TEST(SpscRingTest, pushPopInOrder) {
+	util::spsc_ring<int, 4> ring;
+	int value;
+
+	ASSERT_FALSE(ring.try_pop(value));
+
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(ring.try_push(i));
+	}
+	ASSERT_FALSE(ring.try_push(4));
+	ASSERT_EQ(4u, ring.size());
+
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(ring.try_pop(value));
+		ASSERT_EQ(i, value);
+	}
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, producerConsumerThreads) {
+	util::spsc_ring<size_t, 64> ring;
+	const size_t count = 100000;
+
+	std::thread producer([&ring, count]() {
+		for (size_t i = 0; i < count; ++i) {
+			while (!ring.try_push(i))
+				std::this_thread::yield();
+		}
+	});
+
+	// Keep draining after a mismatch, otherwise the producer never finishes and the test can't join it
+	size_t expected = 0;
+	size_t mismatches = 0;
+	while (expected < count) {
+		size_t value;
+		if (ring.try_pop(value)) {
+			if (value != expected) {
+				++mismatches;
+			}
+			++expected;
+		}
+	}
+
+	producer.join();
+	ASSERT_EQ(0u, mismatches);
+	ASSERT_TRUE(ring.empty());
+}
@@ -0,0 +1,56 @@
+/**
+ * Converts the binary traces written by -binary_profiling into the JSON format of chrome://tracing and Perfetto
+ */
+
+#include "tracing/BinaryTraceFormat.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Usage: " << argv[0] << " <trace.fstrace> [trace.json]\n";
+		std::cerr << "Without an output file the JSON is written next to the trace.\n";
+		return 1;
+	}
+
+	std::string in_name = argv[1];
+	std::string out_name;
+	if (argc == 3) {
+		out_name = argv[2];
+	} else {
+		auto dot = in_name.find_last_of('.');
+		auto slash = in_name.find_last_of("/\\");
+		if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+			out_name = in_name.substr(0, dot);
+		} else {
+			out_name = in_name;
+		}
+		out_name += ".json";
+	}
+
+	std::ifstream in(in_name, std::ios::binary);
+	if (!in) {
+		std::cerr << "Could not open " << in_name << "\n";
+		return 1;
+	}
+
+	std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	std::ofstream out(out_name);
+	if (!out) {
+		std::cerr << "Could not open " << out_name << " for writing\n";
+		return 1;
+	}
+
+	if (!tracing::binary::convert_to_json(data.data(), data.size(), out)) {
+		// a game that crashed leaves a trace that ends in the middle of a record
+		std::cerr << in_name << " is damaged or incomplete, converted what could be read\n";
+		return 2;
+	}
+
+	return 0;
+}